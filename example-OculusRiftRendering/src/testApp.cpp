@@ -33,6 +33,8 @@ void testApp::setup()
         d.bMouseOver = false;
         d.bGazeOver  = false;
         
+        d.pickId = oculusRift.addPickableSphere(d.floatPos, d.radius);
+        
 		demos.push_back(d);
 	}
 	
@@ -50,21 +52,16 @@ void testApp::update()
 									  demos[i].pos.x/100.0,
 									  demos[i].pos.z/100.0,
 									  demos[i].radius*100.0) * demos[i].radius*20.;
-		
+		oculusRift.updatePickableSphere(demos[i].pickId, demos[i].floatPos, demos[i].radius);
 	}
     
     if(oculusRift.isSetup()){
-        ofRectangle viewport = oculusRift.getOculusViewport();
+        // mouse and gaze selection
+        int mouseId = oculusRift.pickMouse();
+        int gazeId = oculusRift.pickGaze();
         for(int i = 0; i < demos.size(); i++){
-            // mouse selection
-			float mouseDist = oculusRift.distanceFromMouse(demos[i].floatPos);
-            demos[i].bMouseOver = (mouseDist < 50);
-            
-            // gaze selection
-            ofVec3f screenPos = oculusRift.worldToScreen(demos[i].floatPos, true);
-            float gazeDist = ofDist(screenPos.x, screenPos.y,
-                                    viewport.getCenter().x, viewport.getCenter().y);
-            demos[i].bGazeOver = (gazeDist < 25);
+            demos[i].bMouseOver = (demos[i].pickId == mouseId);
+            demos[i].bGazeOver  = (demos[i].pickId == gazeId);
         }
     }
 }
@@ -8,6 +8,7 @@ typedef struct{
 	ofVec3f pos;
 	ofVec3f floatPos;
 	float radius;
+    int pickId;
     bool bMouseOver;
     bool bGazeOver;
 } DemoSphere;
@@ -26,7 +26,9 @@ limitations under the License.
 
 #include "CAPI_DistortionRenderer.h"
 
-#if defined (OVR_OS_WIN32)
+// Windows builds that compile LibOVR without the D3D1X and D3D9 back ends
+// (such as the ofxOculusDK2Lib project) define OVR_CAPI_NO_D3D, leaving GL only.
+#if defined (OVR_OS_WIN32) && !defined (OVR_CAPI_NO_D3D)
 
 // TBD: Move to separate config file that handles back-ends.
 #define OVR_D3D_VERSION 11
@@ -57,7 +59,7 @@ DistortionRenderer::CreateFunc DistortionRenderer::APICreateRegistry[ovrRenderAP
     0, // None
     &GL::DistortionRenderer::Create,
     0, // Android_GLES
-#if defined (OVR_OS_WIN32)
+#if defined (OVR_OS_WIN32) && !defined (OVR_CAPI_NO_D3D)
     &D3D9::DistortionRenderer::Create,
     &D3D10::DistortionRenderer::Create,
     &D3D11::DistortionRenderer::Create
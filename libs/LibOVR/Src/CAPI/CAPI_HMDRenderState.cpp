@@ -84,12 +84,12 @@ ovrHmdDesc HMDRenderState::GetDesc() const
     const DistortionRenderDesc& rightDistortion = Distortion[1];
   
     // The suggested FOV (assuming eye rotation)
-    d.DefaultEyeFov[0] = CalculateFovFromHmdInfo(StereoEye_Left, leftDistortion, RenderInfo, OVR_DEFAULT_EXTRA_EYE_ROTATION);
-    d.DefaultEyeFov[1] = CalculateFovFromHmdInfo(StereoEye_Right, rightDistortion, RenderInfo, OVR_DEFAULT_EXTRA_EYE_ROTATION);
+    d.DefaultEyeFov[0] = CachedCalculateFovFromHmdInfo(StereoEye_Left, leftDistortion, RenderInfo, OVR_DEFAULT_EXTRA_EYE_ROTATION);
+    d.DefaultEyeFov[1] = CachedCalculateFovFromHmdInfo(StereoEye_Right, rightDistortion, RenderInfo, OVR_DEFAULT_EXTRA_EYE_ROTATION);
 
     // FOV extended across the entire screen
-    d.MaxEyeFov[0] = GetPhysicalScreenFov(StereoEye_Left, leftDistortion);
-    d.MaxEyeFov[1] = GetPhysicalScreenFov(StereoEye_Right, rightDistortion);
+    d.MaxEyeFov[0] = CachedGetPhysicalScreenFov(StereoEye_Left, leftDistortion);
+    d.MaxEyeFov[1] = CachedGetPhysicalScreenFov(StereoEye_Right, rightDistortion);
     
     if (OurHMDInfo.Shutter.Type == HmdShutter_RollingRightToLeft)
     {
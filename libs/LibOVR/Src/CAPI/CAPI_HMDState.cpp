@@ -27,6 +27,7 @@ limitations under the License.
 #include "CAPI_HMDState.h"
 #include "../OVR_Profile.h"
 #include "../Service/Service_NetClient.h"
+#include "../Util/Util_Render_HiddenArea.h"
 #ifdef OVR_OS_WIN32
 #include "../Displays/OVR_Win32_ShimFunctions.h"
 #endif
@@ -269,15 +270,12 @@ HMDState* HMDState::CreateHMDState(NetClient* client, const HMDNetworkInfo& netI
 
     HMDState* hmds = new HMDState(netInfo, hinfo, pDefaultProfile, client);
 
-    if (!hmds->SharedStateReader.Open(netInfo.SharedMemoryName.ToCStr()))
+    if (!hmds->AttachSharedState(netInfo.SharedMemoryName.ToCStr()))
     {
         delete hmds;
         return NULL;
     }
 
-    hmds->TheSensorStateReader.SetUpdater(hmds->SharedStateReader.Get());
-    hmds->TheLatencyTestStateReader.SetUpdater(hmds->SharedStateReader.Get());
-
     return hmds;
 }
 
@@ -309,6 +307,41 @@ void HMDState::ResetTracking()
 	if (pClient) pClient->Hmd_ResetTracking(NetId);
 }        
 
+bool HMDState::AttachSharedState(const char* sharedMemoryName)
+{
+    if (!SharedStateReader.Open(sharedMemoryName))
+    {
+        return false;
+    }
+
+    TheSensorStateReader.SetUpdater(SharedStateReader.Get());
+    TheLatencyTestStateReader.SetUpdater(SharedStateReader.Get());
+
+    // Older services do not publish a pose history; past times then get the latest pose.
+    String historyName = String(sharedMemoryName) + Tracking::PoseHistorySharedMemorySuffix;
+    if (SharedPoseHistoryReader.Open(historyName.ToCStr()))
+    {
+        TheSensorStateReader.SetPoseHistory(SharedPoseHistoryReader.Get());
+    }
+    else
+    {
+        TheSensorStateReader.SetPoseHistory(NULL);
+    }
+
+    return true;
+}
+
+// Whether anything is publishing tracking: the service, or for a debug HMD whatever
+// it was attached to.
+bool HMDState::trackingConnected()
+{
+    if (pClient)
+    {
+        return pClient->IsConnected(false, false);
+    }
+    return SharedStateReader.Get() != NULL;
+}
+
 // Re-center the orientation.
 void HMDState::RecenterPose()
 {
@@ -322,7 +355,7 @@ ovrTrackingState HMDState::PredictedTrackingState(double absTime)
     TheSensorStateReader.GetSensorStateAtTime(absTime, ss);
 
     // Zero out the status flags
-    if (!pClient || !pClient->IsConnected(false, false))
+    if (!trackingConnected())
     {
         ss.StatusFlags = 0;
     }
@@ -330,6 +363,19 @@ ovrTrackingState HMDState::PredictedTrackingState(double absTime)
     return ss;
 }
 
+// Returns predictions for many times from one sensor state.
+bool HMDState::PredictedPosesAtTimes(const double* absTimes, int count, ovrPosef* poses)
+{
+    // Without the service nothing is tracked, as PredictedTrackingState reports in its flags
+    if (!trackingConnected())
+    {
+        return false;
+    }
+
+    OVR_COMPILER_ASSERT(sizeof(Posef) == sizeof(ovrPosef));
+    return TheSensorStateReader.GetPosesAtTimes(absTimes, count, reinterpret_cast<Posef*>(poses));
+}
+
 void HMDState::SetEnabledHmdCaps(unsigned hmdCaps)
 {
     if (OurHMDInfo.HmdType < HmdType_DK2)
@@ -747,8 +793,9 @@ ovrBool ovrHmd_CreateDistortionMeshInternal( ovrHmdStruct *  hmd,
         return 0;
     HMDState* hmds = (HMDState*)hmd;
 
-    // Not used now, but Chromatic flag or others could possibly be checked for in the future.
-    OVR_UNUSED1(distortionCaps); 
+    // Only the inverse is picked from the caps, the other flags change how the mesh is rendered.
+    DistortionMeshInverse inverse = (distortionCaps & ovrDistortionCap_TabulatedInverse) ?
+                                    DistortionMeshInverse_Table : DistortionMeshInverse_Newton;
    
 #if defined (OVR_CC_MSVC)
     static_assert(sizeof(DistortionMeshVertexData) == sizeof(ovrDistortionVertex), "DistortionMeshVertexData size mismatch");
@@ -767,7 +814,7 @@ ovrBool ovrHmd_CreateDistortionMeshInternal( ovrHmdStruct *  hmd,
     DistortionRenderDesc& distortion = hmds->RenderState.Distortion[eyeType];
 	if (overrideEyeReliefIfNonZero)
 	{
-		distortion.Lens = GenerateLensConfigFromEyeRelief(overrideEyeReliefIfNonZero,hmdri);
+		distortion.Lens = CachedGenerateLensConfigFromEyeRelief(overrideEyeReliefIfNonZero,hmdri);
 	}
 
     // Find the mapping from TanAngle space to target NDC space.
@@ -780,7 +827,7 @@ ovrBool ovrHmd_CreateDistortionMeshInternal( ovrHmdStruct *  hmd,
                          (uint16_t**)&meshData->pIndexData,
                           &vertexCount, &triangleCount,
                           (stereoEye == StereoEye_Right),
-                          hmdri, distortion, eyeToSourceNDC);
+                          hmdri, distortion, eyeToSourceNDC, 0, inverse);
 
     if (meshData->pVertexData)
     {
@@ -793,6 +840,105 @@ ovrBool ovrHmd_CreateDistortionMeshInternal( ovrHmdStruct *  hmd,
     return 0;
 }
 
+ovrBool ovrHmd_CreateDistortionMeshAdaptiveInternal( ovrHmdStruct *  hmd,
+                                                     ovrEyeType eyeType, ovrFovPort fov,
+                                                     unsigned int distortionCaps,
+                                                     float maxUVError,
+                                                     ovrDistortionMesh *meshData )
+{
+    if (!meshData)
+        return 0;
+    HMDState* hmds = (HMDState*)hmd;
+
+    DistortionMeshInverse inverse = (distortionCaps & ovrDistortionCap_TabulatedInverse) ?
+                                    DistortionMeshInverse_Table : DistortionMeshInverse_Newton;
+
+    const HmdRenderInfo&        hmdri          = hmds->RenderState.RenderInfo;    
+    const DistortionRenderDesc& distortion     = hmds->RenderState.Distortion[eyeType];
+    ScaleAndOffset2D            eyeToSourceNDC = CreateNDCScaleAndOffsetFromFov(fov);
+
+    int triangleCount = 0;
+    int vertexCount = 0;
+
+    DistortionMeshCreateAdaptive((DistortionMeshVertexData**)&meshData->pVertexData,
+                                 (uint16_t**)&meshData->pIndexData,
+                                 &vertexCount, &triangleCount,
+                                 (eyeType == ovrEye_Right),
+                                 hmdri, distortion, eyeToSourceNDC, maxUVError, 6, 0, inverse);
+
+    if (meshData->pVertexData)
+    {
+        meshData->IndexCount = triangleCount * 3;
+        meshData->VertexCount = vertexCount;
+        return 1;
+    }
+
+    return 0;
+}
+
+ovrBool ovrHmd_CreateHiddenAreaMeshInternal( ovrHmdStruct *  hmd,
+                                             ovrEyeType eyeType, ovrFovPort fov,
+                                             ovrHiddenAreaMesh *meshData )
+{
+    if (!meshData)
+        return 0;
+    HMDState* hmds = (HMDState*)hmd;
+
+    const HmdRenderInfo&        hmdri          = hmds->RenderState.RenderInfo;    
+    const DistortionRenderDesc& distortion     = hmds->RenderState.Distortion[eyeType];
+    ScaleAndOffset2D            eyeToSourceNDC = CreateNDCScaleAndOffsetFromFov(fov);
+
+    int triangleCount = 0;
+    int vertexCount = 0;
+
+    bool ok = HiddenAreaMeshCreate((Vector2f**)&meshData->pVertexData,
+                                   (uint16_t**)&meshData->pIndexData,
+                                   &vertexCount, &triangleCount,
+                                   (eyeType == ovrEye_Right),
+                                   hmdri, distortion, eyeToSourceNDC);
+
+    meshData->IndexCount = triangleCount * 3;
+    meshData->VertexCount = vertexCount;
+    return ok ? 1 : 0;
+}
+
+ovrBool ovrHmd_CreateDistortionMeshesInternal( ovrHmdStruct *  hmd,
+                                               const ovrFovPort eyeFov[2],
+                                               unsigned int distortionCaps,
+                                               ovrDistortionMesh meshData[2] )
+{
+    if (!meshData)
+        return 0;
+    HMDState* hmds = (HMDState*)hmd;
+
+    DistortionMeshInverse inverse = (distortionCaps & ovrDistortionCap_TabulatedInverse) ?
+                                    DistortionMeshInverse_Table : DistortionMeshInverse_Newton;
+
+    const HmdRenderInfo&  hmdri = hmds->RenderState.RenderInfo;    
+    ScaleAndOffset2D      eyeToSourceNDC[2];
+    eyeToSourceNDC[0] = CreateNDCScaleAndOffsetFromFov(eyeFov[0]);
+    eyeToSourceNDC[1] = CreateNDCScaleAndOffsetFromFov(eyeFov[1]);
+
+    DistortionMeshVertexData* vertices[2];
+    uint16_t*                 indices[2];
+    int triangleCount = 0;
+    int vertexCount = 0;
+
+    // Same meshes as two ovrHmd_CreateDistortionMeshInternal calls, but both eyes are built together.
+    DistortionMeshCreateBothEyes(vertices, indices, &vertexCount, &triangleCount,
+                                 hmdri, hmds->RenderState.Distortion, eyeToSourceNDC, 0, inverse);
+
+    for (int eyeNum = 0; eyeNum < 2; eyeNum++)
+    {
+        meshData[eyeNum].pVertexData = (ovrDistortionVertex*)vertices[eyeNum];
+        meshData[eyeNum].pIndexData  = indices[eyeNum];
+        meshData[eyeNum].IndexCount  = triangleCount * 3;
+        meshData[eyeNum].VertexCount = vertexCount;
+    }
+
+    return vertices[0] ? 1 : 0;
+}
+
 
 
 }} // namespace OVR::CAPI
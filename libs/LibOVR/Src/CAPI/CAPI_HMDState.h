@@ -149,6 +149,11 @@ public:
     void            ResetTracking();
 	void			RecenterPose();
     ovrTrackingState PredictedTrackingState(double absTime);
+    bool             PredictedPosesAtTimes(const double* absTimes, int count, ovrPosef* poses);
+
+    // Reads the tracking state the service, or a Tracking::SimulatedTrackingService,
+    // publishes under sharedMemoryName. Lets a debug HMD be tracked.
+    bool            AttachSharedState(const char* sharedMemoryName);
 
     // Changes HMD Caps.
     // Capability bits that are not directly or logically tied to one system (such as sensor)
@@ -175,6 +180,8 @@ public:
 
     void applyProfileToSensorFusion();
 
+    bool trackingConnected();
+
     // INlines so that they can be easily compiled out.    
     // Does debug ASSERT checks for functions that require BeginFrame.
     // Also verifies that we are on the right thread.
@@ -244,6 +251,7 @@ public:
     
     // *** Sensor
     Tracking::CombinedSharedStateReader SharedStateReader;
+    Tracking::PoseHistoryReader         SharedPoseHistoryReader;
     Tracking::SensorStateReader         TheSensorStateReader;
     Util::RecordStateReader             TheLatencyTestStateReader;
 
@@ -295,6 +303,21 @@ ovrBool ovrHmd_CreateDistortionMeshInternal( ovrHmdStruct *  hmd,
                                              ovrDistortionMesh *meshData,
 											 float overrideEyeReliefIfNonZero=0 );
 
+ovrBool ovrHmd_CreateDistortionMeshAdaptiveInternal( ovrHmdStruct *  hmd,
+                                                     ovrEyeType eyeType, ovrFovPort fov,
+                                                     unsigned int distortionCaps,
+                                                     float maxUVError,
+                                                     ovrDistortionMesh *meshData );
+
+ovrBool ovrHmd_CreateHiddenAreaMeshInternal( ovrHmdStruct *  hmd,
+                                             ovrEyeType eyeType, ovrFovPort fov,
+                                             ovrHiddenAreaMesh *meshData );
+
+ovrBool ovrHmd_CreateDistortionMeshesInternal( ovrHmdStruct *  hmd,
+                                               const ovrFovPort eyeFov[2],
+                                               unsigned int distortionCaps,
+                                               ovrDistortionMesh meshData[2] );
+
 
 
 
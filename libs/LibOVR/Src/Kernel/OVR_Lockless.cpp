@@ -36,6 +36,7 @@ namespace OVR { namespace LocklessTest {
 
 
 const int TestIterations = 10000000;
+const int NumConsumers   = 4;
 
 // Use volatile dummies to force compiler to do spinning.
 volatile int Dummy1;
@@ -62,7 +63,7 @@ struct TestData
         }
     }
 
-    int ReadAndCheckConsistency(int prevValue) const
+    int ReadAndCheckConsistency(int prevValue, int* failures) const
     {
         int val = Data[0];
 
@@ -77,6 +78,7 @@ struct TestData
                     LogText("LocklessTest Fail - corruption at %d inside block %d\n",
                             i, val/100);
                     // OVR_ASSERT(Data[i] == val + i);
+                    (*failures)++;
                 }
                 break;
             }
@@ -87,9 +89,7 @@ struct TestData
 };
 
 
-
 volatile bool              FirstItemWritten = false;
-LocklessUpdater<TestData, TestData>  TestDataUpdater;
 
 // Use this lock to verify that testing algorithm is otherwise correct...
 Lock                       TestLock;   
@@ -97,11 +97,15 @@ Lock                       TestLock;
 
 //-------------------------------------------------------------------------------------
 
-// Consumer thread reads values from TestDataUpdater and
+// Consumer thread reads values from the updater and
 // ensures that each one is internally consistent.
 
+template<class Updater>
 class Consumer : public Thread
 {
+public:
+    Consumer(const Updater* updater) : TestDataUpdater(updater), Failures(0) { }
+
     virtual int Run()
     {
         LogText("LocklessTest::Consumer::Run started.\n");
@@ -119,10 +123,10 @@ class Consumer : public Thread
         {
             {
                 //Lock::Locker scope(&TestLock);
-                d = TestDataUpdater.GetState();
+                d = TestDataUpdater->GetState();
             }
             
-            newValue = d.ReadAndCheckConsistency(oldValue);
+            newValue = d.ReadAndCheckConsistency(oldValue, &Failures);
             
             // Values should increase or stay the same!
             if (newValue < oldValue)
@@ -130,6 +134,7 @@ class Consumer : public Thread
                 LogText("LocklessTest Fail - %d after %d;  delta = %d\n",
                         newValue, oldValue, newValue - oldValue);
          //       OVR_ASSERT(0);
+                Failures++;
             }
             
 
@@ -157,13 +162,18 @@ class Consumer : public Thread
         return 0;
     }
 
+    const Updater* TestDataUpdater;
+    int            Failures;
 };
 
 
 //-------------------------------------------------------------------------------------
 
+template<class Updater>
 class Producer : public Thread
 {
+public:
+    Producer(Updater* updater) : TestDataUpdater(updater) { }
 
     virtual int Run()
     {
@@ -176,7 +186,7 @@ class Producer : public Thread
 
             {
                 //Lock::Locker scope(&TestLock);
-                TestDataUpdater.SetState(d);
+                TestDataUpdater->SetState(d);
             }
 
             FirstItemWritten = true;
@@ -197,25 +207,196 @@ class Producer : public Thread
         LogText("LocklessTest::Producer::Run exiting.\n");
         return 0;
     }
+
+    Updater* TestDataUpdater;
 };
 
 
+// One producer against NumConsumers consumers. Returns the number of failures seen.
+template<class Updater>
+int RunStressTest(const char* name)
+{
+    LogText("LocklessTest - %s, %d consumers\n", name, NumConsumers);
+
+    Updater* updater = new Updater;
+    FirstItemWritten = false;
+
+    Ptr<Producer<Updater> > producerThread = *new Producer<Updater>(updater);
+    Ptr<Consumer<Updater> > consumerThreads[NumConsumers];
+    for (int i = 0; i < NumConsumers; i++)
+    {
+        consumerThreads[i] = *new Consumer<Updater>(updater);
+        consumerThreads[i]->Start();
+    }
+    producerThread->Start();
+
+    producerThread->Join();
+    int failures = 0;
+    for (int i = 0; i < NumConsumers; i++)
+    {
+        consumerThreads[i]->Join();
+        failures += consumerThreads[i]->Failures;
+    }
+
+    delete updater;
+    LogText("LocklessTest - %s %s\n", name, failures ? "FAILED" : "passed");
+    return failures;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Latency benchmark
+
+// GetState() timed by consumers spinning on it while the producer updates at 1000 Hz,
+// the rate the sensor state is published at. The slot is the size of the sensor state's.
+
+const int    BenchmarkSeconds = 2;
+const int    HistogramBuckets = 1000;    // 10 ns each; the last one takes everything slower
+const double BucketNanos      = 10.0;
+
+struct BenchmarkData
+{
+    BenchmarkData() { memset(Words, 0, sizeof(Words)); }
+
+    uint64_t Words[64];
+};
+
+volatile bool BenchmarkFinished = false;
+
+template<class Updater>
+class BenchmarkProducer : public Thread
+{
+public:
+    BenchmarkProducer(Updater* updater) : TheUpdater(updater) { }
+
+    virtual int Run()
+    {
+        BenchmarkData d;
+        double endTime = Timer::GetSeconds() + BenchmarkSeconds;
+        for (uint64_t value = 1; Timer::GetSeconds() < endTime; value++)
+        {
+            for (int i = 0; i < 64; i++)
+            {
+                d.Words[i] = value;
+            }
+            TheUpdater->SetState(d);
+            Thread::MSleep(1);
+        }
+        BenchmarkFinished = true;
+        return 0;
+    }
+
+    Updater* TheUpdater;
+};
+
+template<class Updater>
+class BenchmarkConsumer : public Thread
+{
+public:
+    BenchmarkConsumer(const Updater* updater) : TheUpdater(updater), Calls(0), Torn(0), TotalNanos(0)
+    {
+        memset(Histogram, 0, sizeof(Histogram));
+    }
+
+    virtual int Run()
+    {
+        while (!BenchmarkFinished)
+        {
+            uint64_t start = Timer::GetTicksNanos();
+            BenchmarkData d = TheUpdater->GetState();
+            uint64_t nanos = Timer::GetTicksNanos() - start;
+
+            if (d.Words[0] != d.Words[63])
+            {
+                Torn++;
+            }
+            Calls++;
+            TotalNanos += nanos;
+            int bucket = (int)(nanos / BucketNanos);
+            Histogram[bucket < HistogramBuckets ? bucket : HistogramBuckets - 1]++;
+        }
+        return 0;
+    }
+
+    const Updater* TheUpdater;
+    uint64_t       Calls;
+    uint64_t       Torn;
+    uint64_t       TotalNanos;
+    uint64_t       Histogram[HistogramBuckets];
+};
+
+template<class Updater>
+void RunLatencyBenchmark(const char* name, int numConsumers)
+{
+    Updater* updater = new Updater;
+    BenchmarkFinished = false;
+
+    Ptr<BenchmarkProducer<Updater> > producerThread = *new BenchmarkProducer<Updater>(updater);
+    Ptr<BenchmarkConsumer<Updater> > consumerThreads[NumConsumers];
+    for (int i = 0; i < numConsumers; i++)
+    {
+        consumerThreads[i] = *new BenchmarkConsumer<Updater>(updater);
+        consumerThreads[i]->Start();
+    }
+    producerThread->Start();
+    producerThread->Join();
+
+    uint64_t calls = 0, torn = 0, totalNanos = 0;
+    uint64_t histogram[HistogramBuckets] = { 0 };
+    for (int i = 0; i < numConsumers; i++)
+    {
+        consumerThreads[i]->Join();
+        calls      += consumerThreads[i]->Calls;
+        torn       += consumerThreads[i]->Torn;
+        totalNanos += consumerThreads[i]->TotalNanos;
+        for (int b = 0; b < HistogramBuckets; b++)
+        {
+            histogram[b] += consumerThreads[i]->Histogram[b];
+        }
+    }
+    delete updater;
+
+    // Percentiles to the top of their bucket
+    double percentiles[3] = { 0.5, 0.99, 0.9999 };
+    double nanosAt[3] = { 0, 0, 0 };
+    for (int p = 0; p < 3; p++)
+    {
+        uint64_t needed = (uint64_t)(percentiles[p] * (double)calls);
+        uint64_t seen = 0;
+        for (int b = 0; b < HistogramBuckets; b++)
+        {
+            seen += histogram[b];
+            if (seen >= needed)
+            {
+                nanosAt[p] = (b + 1) * BucketNanos;
+                break;
+            }
+        }
+    }
+
+    LogText("LocklessTest - %-26s %d consumers: %9.1f M calls/s, mean %6.1f ns, "
+            "50%% < %5.0f ns, 99%% < %5.0f ns, 99.99%% < %5.0f ns, %d torn\n",
+            name, numConsumers, (double)calls / BenchmarkSeconds * 1e-6,
+            calls ? (double)totalNanos / (double)calls : 0.0,
+            nanosAt[0], nanosAt[1], nanosAt[2], (int)torn);
+}
+
+
 } // namespace LocklessTest
 
 
 
 void StartLocklessTest()
 {
-    // These threads will release themselves once done
-    Ptr<LocklessTest::Producer> producerThread = *new LocklessTest::Producer;
-    Ptr<LocklessTest::Consumer> consumerThread = *new LocklessTest::Consumer;
+    using namespace LocklessTest;
 
-    producerThread->Start();
-    consumerThread->Start();
+    RunStressTest<LocklessUpdater<TestData, TestData> >("LocklessUpdater");
+    RunStressTest<CompatibleLocklessUpdater<TestData, TestData> >("CompatibleLocklessUpdater");
 
-    while (!producerThread->IsFinished() && consumerThread->IsFinished())
+    for (int numConsumers = 1; numConsumers <= NumConsumers; numConsumers *= 2)
     {
-        Thread::MSleep(500);
+        RunLatencyBenchmark<LocklessUpdater<BenchmarkData, BenchmarkData> >("LocklessUpdater", numConsumers);
+        RunLatencyBenchmark<CompatibleLocklessUpdater<BenchmarkData, BenchmarkData> >("CompatibleLocklessUpdater", numConsumers);
     }
 }
 
@@ -41,20 +41,108 @@ namespace OVR {
 // For single producer cases where you only care about the most recent update, not
 // necessarily getting every one that happens (vsync timing, SensorFusion updates).
 //
-// This is multiple consumer safe, but is currently only used with a single consumer.
+// This is multiple consumer safe. Consumers only load from the updater, never store,
+// so it can be read from a read-only mapping of shared memory, and readers on other
+// cores or processes do not take its cache lines away from the producer or each other.
+//
+// The producer bumps Version to odd before writing a slot and back to even after, the
+// way a seqlock does, alternating between two slots so that a consumer can always copy
+// the last complete update out of the slot that is not being written. A consumer only
+// retries if the producer comes round to that slot again before the copy is done.
 //
 // The SlotType can be the same as T, but should probably be a larger fixed size.
 // This allows for forward compatibility when the updater is shared between processes.
 
-// FIXME: ExchangeAdd_Sync() should be replaced with a portable read-only primitive,
-// so that the lockless pose state can be read-only on remote processes and to reduce
-// false sharing between processes and improve performance.
+// Distance to keep between data written by different parties. Anything that starts
+// this far after the start of something no larger than a cache line is on another line,
+// whatever the alignment of the whole.
+static const int LocklessCacheLineSize = 64;
+
+// Keeps the loads copying out a slot ahead of the load that checks it was not being
+// overwritten. Load_Acquire orders the loads after it, not the ones before it.
+OVR_FORCE_INLINE void LocklessLoadFence()
+{
+#if defined(OVR_CPU_X86) || defined(OVR_CPU_X86_64)
+    // X86 does not reorder loads with other loads; only the compiler needs stopping.
+  #if defined(OVR_CC_MSVC)
+    _ReadBarrier();
+  #else
+    asm volatile ("" : : : "memory");
+  #endif
+#elif defined(OVR_CC_MSVC)
+    MemoryBarrier();
+#else
+    __sync_synchronize();
+#endif
+}
 
 template<class T, class SlotType>
 class LocklessUpdater
 {
 public:
-	LocklessUpdater() : UpdateBegin( 0 ), UpdateEnd( 0 )
+	LocklessUpdater() : Version( 0 )
+    {
+        OVR_COMPILER_ASSERT(sizeof(T) <= sizeof(SlotType));
+    }
+
+	T GetState() const
+	{
+		T	state;
+
+		for(;;)
+		{
+            const uint32_t version   = Version.Load_Acquire();
+            // Updates completed; while the next is being written it is in the other slot.
+            const uint32_t completed = version >> 1;
+            state = Slots[ (completed - 1) & 1 ].Slot;
+
+            LocklessLoadFence();
+
+            // That slot is next written by update completed + 1, which makes Version
+            // 2 * completed + 3 before it starts writing.
+            const uint32_t final = Version.Load_Acquire();
+			if ( final - 2 * completed < 3 ) {
+				break;
+			}
+		}
+		return state;
+	}
+
+	void	SetState( const T& state )
+	{
+        // Version is odd while the slot is written. Only the producer stores, so the
+        // full barriers here cost the consumers nothing.
+        const uint32_t version = Version.ExchangeAdd_Sync(1);
+        Slots[ (version >> 1) & 1 ].Slot = state;
+        Version.ExchangeAdd_Sync(1);
+	}
+
+private:
+    struct PaddedSlot
+    {
+        SlotType Slot;
+        char     Padding[LocklessCacheLineSize];
+    };
+
+    char                LeadingPadding[LocklessCacheLineSize];
+    AtomicInt<uint32_t> Version;
+    char                VersionPadding[LocklessCacheLineSize];
+    PaddedSlot          Slots[2];
+};
+
+
+// ***** CompatibleLocklessUpdater
+
+// The LocklessUpdater layout and protocol of the 0.4 runtime, which the tracking service
+// still writes into the shared sensor and latency tester state. Consumers only load from
+// it as well, but its counters and slots share cache lines, so use LocklessUpdater for
+// anything whose producer is built from this tree.
+
+template<class T, class SlotType>
+class CompatibleLocklessUpdater
+{
+public:
+	CompatibleLocklessUpdater() : UpdateBegin( 0 ), UpdateEnd( 0 )
     {
         OVR_COMPILER_ASSERT(sizeof(T) <= sizeof(SlotType));
     }
@@ -69,10 +157,9 @@ public:
 
 		for(;;)
 		{
-			// We are adding 0, only using these as atomic memory barriers, so it
-			// is ok to cast off the const, allowing GetState() to remain const.
             end   = UpdateEnd.Load_Acquire();
             state = Slots[ end & 1 ];
+            LocklessLoadFence();
             begin = UpdateBegin.Load_Acquire();
 			if ( begin == end ) {
 				break;
@@ -81,6 +168,7 @@ public:
 			// The producer is potentially blocked while only having partially
 			// written the update, so copy out the other slot.
             state = Slots[ (begin & 1) ^ 1 ];
+            LocklessLoadFence();
             final = UpdateBegin.Load_Acquire();
 			if ( final == begin ) {
 				break;
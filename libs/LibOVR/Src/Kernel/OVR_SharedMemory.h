@@ -141,7 +141,12 @@ public:
 // A shared object
 // Its constructor will be called when creating a writer
 // Its destructor will not be called
-template<class SharedType>
+// RemoteAccess is the access other processes get when the writer creates the region.
+// It defaults to read-write: the first 0.4 release's LocklessUpdater wrote to the region
+// to read it (incremented by 0), and clients that old still open the service's combined
+// sensor state, whose layout is unchanged. Only regions that no 0.4.0 client opens, such
+// as the pose history, should ask for RemoteMode_ReadOnly.
+template<class SharedType, SharedMemory::RemoteMode RemoteAccess = SharedMemory::RemoteMode_ReadWrite>
 class ISharedObject : public NewOverrideBase
 {
 public:
@@ -155,13 +160,7 @@ protected:
 		// Configure open parameters based on read-only mode
 		SharedMemory::OpenParameters params;
 
-        // FIXME: This is a hack.  We currently need to allow clients to open this for read-write even
-        // though they only need read-only access.  This is because in the first 0.4 release the
-        // LocklessUpdater class technically writes to it (increments by 0) to read from the space.
-        // This was quickly corrected in 0.4.1 and we are waiting for the right time to disallow write
-        // access when everyone upgrades to 0.4.1+.
-        //params.remoteMode = SharedMemory::RemoteMode_ReadOnly;
-        params.remoteMode = SharedMemory::RemoteMode_ReadWrite;
+        params.remoteMode = RemoteAccess;
 
         params.globalName = name;
         params.accessMode = readOnly ? SharedMemory::AccessMode_ReadOnly : SharedMemory::AccessMode_ReadWrite;
@@ -205,32 +204,32 @@ protected:
 };
 
 // Writer specialized shared object: Ctor will be called on Open()
-template<class SharedType>
-class SharedObjectWriter : public ISharedObject<SharedType>
+template<class SharedType, SharedMemory::RemoteMode RemoteAccess = SharedMemory::RemoteMode_ReadWrite>
+class SharedObjectWriter : public ISharedObject<SharedType, RemoteAccess>
 {
 public:
 	OVR_FORCE_INLINE bool Open(const char* name)
 	{
-		return ISharedObject<SharedType>::Open(name, false);
+		return ISharedObject<SharedType, RemoteAccess>::Open(name, false);
 	}
 	OVR_FORCE_INLINE SharedType* Get()
 	{
-		return ISharedObject<SharedType>::Get();
+		return ISharedObject<SharedType, RemoteAccess>::Get();
 	}
 };
 
 // Reader specialized shared object: Ctor will not be called
-template<class SharedType>
-class SharedObjectReader : public ISharedObject<SharedType>
+template<class SharedType, SharedMemory::RemoteMode RemoteAccess = SharedMemory::RemoteMode_ReadWrite>
+class SharedObjectReader : public ISharedObject<SharedType, RemoteAccess>
 {
 public:
 	OVR_FORCE_INLINE bool Open(const char* name)
 	{
-		return ISharedObject<SharedType>::Open(name, true);
+		return ISharedObject<SharedType, RemoteAccess>::Open(name, true);
 	}
 	OVR_FORCE_INLINE const SharedType* Get() const
 	{
-		return ISharedObject<SharedType>::Get();
+		return ISharedObject<SharedType, RemoteAccess>::Get();
 	}
 };
 
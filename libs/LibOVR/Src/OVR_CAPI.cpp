@@ -34,6 +34,7 @@ limitations under the License.
 
 #include "CAPI/CAPI_HMDState.h"
 #include "CAPI/CAPI_FrameTimeManager.h"
+#include "Util/Util_Render_HiddenArea.h"
 
 #include "Service/Service_NetClient.h"
 #ifdef OVR_SINGLE_PROCESS
@@ -553,6 +554,15 @@ OVR_EXPORT ovrTrackingState ovrHmd_GetTrackingState(ovrHmd hmddesc, double absTi
     return result;
 }
 
+OVR_EXPORT ovrBool ovrHmd_GetPosesAtTimes(ovrHmd hmddesc, const double* absTimes, int count, ovrPosef* outPoses)
+{
+    if (!hmddesc || !absTimes || !outPoses)
+        return 0;
+
+    HMDState* p = (HMDState*)hmddesc->Handle;
+    return p->PredictedPosesAtTimes(absTimes, count, outPoses) ? 1 : 0;
+}
+
 
 //-------------------------------------------------------------------------------------
 // *** General Setup
@@ -910,6 +920,30 @@ OVR_EXPORT ovrBool ovrHmd_CreateDistortionMesh( ovrHmd hmddesc,
 
 }
 
+OVR_EXPORT ovrBool ovrHmd_CreateDistortionMeshAdaptive( ovrHmd hmddesc,
+                                                        ovrEyeType eyeType, ovrFovPort fov,
+                                                        unsigned int distortionCaps,
+                                                        float maxUVError,
+                                                        ovrDistortionMesh *meshData)
+{
+    return(ovrHmd_CreateDistortionMeshAdaptiveInternal( hmddesc->Handle,
+                                                        eyeType, fov,
+                                                        distortionCaps,
+                                                        maxUVError,
+                                                        meshData));
+}
+
+OVR_EXPORT ovrBool ovrHmd_CreateDistortionMeshes( ovrHmd hmddesc,
+                                                  const ovrFovPort eyeFov[2],
+                                                  unsigned int distortionCaps,
+                                                  ovrDistortionMesh meshData[2])
+{
+    return(ovrHmd_CreateDistortionMeshesInternal( hmddesc->Handle,
+                                                  eyeFov,
+                                                  distortionCaps,
+                                                  meshData));
+}
+
 
 
 // Frees distortion mesh allocated by ovrHmd_GenerateDistortionMesh. meshData elements
@@ -925,6 +959,24 @@ OVR_EXPORT void ovrHmd_DestroyDistortionMesh(ovrDistortionMesh* meshData)
     meshData->IndexCount  = 0;
 }
 
+OVR_EXPORT ovrBool ovrHmd_CreateHiddenAreaMesh( ovrHmd hmddesc,
+                                                ovrEyeType eyeType, ovrFovPort fov,
+                                                ovrHiddenAreaMesh *meshData)
+{
+    return(ovrHmd_CreateHiddenAreaMeshInternal( hmddesc->Handle,
+                                                eyeType, fov,
+                                                meshData));
+}
+
+OVR_EXPORT void ovrHmd_DestroyHiddenAreaMesh(ovrHiddenAreaMesh* meshData)
+{
+    HiddenAreaMeshDestroy((Vector2f*)meshData->pVertexData, meshData->pIndexData);
+    meshData->pVertexData = 0;
+    meshData->pIndexData  = 0;
+    meshData->VertexCount = 0;
+    meshData->IndexCount  = 0;
+}
+
 
 
 // Computes updated 'uvScaleOffsetOut' to be used with a distortion if render target size or
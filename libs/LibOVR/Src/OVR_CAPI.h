@@ -201,6 +201,7 @@ typedef enum
     ovrDistortionCap_Overdrive          = 0x80,     /// Overdrive brightness transitions to reduce artifacts on DK2+ displays
     ovrDistortionCap_HqDistortion       = 0x100,    /// High-quality sampling of distortion buffer for anti-aliasing
     ovrDistortionCap_LinuxDevFullscreen = 0x200,    /// Indicates window is fullscreen on a device when set. The SDK will automatically apply distortion mesh rotation if needed.
+    ovrDistortionCap_TabulatedInverse   = 0x400,    /// Place distortion mesh vertices with a lookup table of the lens inverse. Faster to build, the vertices move slightly.
 
     ovrDistortionCap_ProfileNoTimewarpSpinWaits = 0x10000,  /// Use when profiling with timewarp to remove false positives
 } ovrDistortionCaps;
@@ -559,6 +560,13 @@ OVR_EXPORT void     ovrHmd_RecenterPose(ovrHmd hmd);
 /// This may also be used for more refined timing of FrontBuffer rendering logic, etc.
 OVR_EXPORT ovrTrackingState ovrHmd_GetTrackingState(ovrHmd hmd, double absTime);
 
+/// Returns the predicted head poses at count absolute system times, each the same as the
+/// HeadPose.ThePose ovrHmd_GetTrackingState would return, from a single reading of the
+/// sensor state. Use this where a frame needs many poses, such as one per scanline for
+/// rolling shutter timewarp; it costs a fraction of a ovrHmd_GetTrackingState call per pose.
+/// Returns 0 and leaves outPoses untouched if the HMD is not being tracked.
+OVR_EXPORT ovrBool ovrHmd_GetPosesAtTimes(ovrHmd hmd, const double* absTimes, int count, ovrPosef* outPoses);
+
 //-------------------------------------------------------------------------------------
 // ***** Graphics Setup
 
@@ -713,10 +721,50 @@ OVR_EXPORT ovrBool  ovrHmd_CreateDistortionMesh( ovrHmd hmd,
                                                  unsigned int distortionCaps,
                                                  ovrDistortionMesh *meshData);
 
+/// Same as ovrHmd_CreateDistortionMesh, but tessellates only as finely as the lens needs,
+/// keeping the interpolated texture coordinates within maxUVError (in render target UV units)
+/// of the exact distortion at the vertices of the ovrHmd_CreateDistortionMesh grid that it
+/// covers. Between those vertices it also carries that grid's own interpolation error.
+/// Freed with ovrHmd_DestroyDistortionMesh.
+OVR_EXPORT ovrBool  ovrHmd_CreateDistortionMeshAdaptive( ovrHmd hmd,
+                                                         ovrEyeType eyeType, ovrFovPort fov,
+                                                         unsigned int distortionCaps,
+                                                         float maxUVError,
+                                                         ovrDistortionMesh *meshData);
+
+/// Generates the distortion meshes for both eyes at once, spreading the work over
+/// all CPU cores. The result is identical to calling ovrHmd_CreateDistortionMesh
+/// for ovrEye_Left and ovrEye_Right. Free each mesh with ovrHmd_DestroyDistortionMesh.
+OVR_EXPORT ovrBool  ovrHmd_CreateDistortionMeshes( ovrHmd hmd,
+                                                   const ovrFovPort eyeFov[2],
+                                                   unsigned int distortionCaps,
+                                                   ovrDistortionMesh meshData[2]);
+
 /// Used to free the distortion mesh allocated by ovrHmd_GenerateDistortionMesh. meshData elements
 /// are set to null and zeroes after the call.
 OVR_EXPORT void     ovrHmd_DestroyDistortionMesh( ovrDistortionMesh* meshData );
 
+/// Triangles covering the parts of an eye's render target viewport that are never seen: past the
+/// lens rim, off the screen, or where the vignette has faded to black.
+typedef struct ovrHiddenAreaMesh_
+{
+    ovrVector2f*         pVertexData;
+    unsigned short*      pIndexData;
+    unsigned int         VertexCount;
+    unsigned int         IndexCount;
+} ovrHiddenAreaMesh;
+
+/// Generates the hidden area mesh for an eye rendered with the given fov. Vertices are in NDC of the
+/// eye's render viewport, so it can be drawn with identity transforms into the depth buffer at the near
+/// plane, or into the stencil buffer, before the scene to save shading those pixels. The mesh is empty
+/// when nothing is hidden, which is usual for the DK2. Returns 0 only on a configuration or memory error.
+/// Free it with ovrHmd_DestroyHiddenAreaMesh.
+OVR_EXPORT ovrBool  ovrHmd_CreateHiddenAreaMesh( ovrHmd hmd,
+                                                 ovrEyeType eyeType, ovrFovPort fov,
+                                                 ovrHiddenAreaMesh *meshData);
+
+OVR_EXPORT void     ovrHmd_DestroyHiddenAreaMesh( ovrHiddenAreaMesh* meshData );
+
 /// Computes updated 'uvScaleOffsetOut' to be used with a distortion if render target size or
 /// viewport changes after the fact. This can be used to adjust render size every frame if desired.
 OVR_EXPORT void     ovrHmd_GetRenderScaleAndOffset( ovrFovPort fov,
@@ -28,6 +28,20 @@ limitations under the License.
 #include "OVR_Profile.h"
 #include "Kernel/OVR_Log.h"
 #include "Kernel/OVR_Alg.h"
+#include "Kernel/OVR_Atomic.h"
+
+#if defined(OVR_LENS_INVERSE_TEST) || defined(OVR_LENS_SPLINE_TEST)
+    #include "Kernel/OVR_Timer.h"
+#endif
+
+// The batched spline kernel needs SSE2 for the integer conversions.
+#if defined(OVR_CPU_SSE) && ( defined(__SSE2__) || defined(_M_AMD64) || ( defined(_M_IX86_FP) && ( _M_IX86_FP >= 2 ) ) )
+    #define OVR_STEREO_SSE2
+    #include <emmintrin.h>
+#elif defined(OVR_CPU_ARM_NEON)
+    #define OVR_STEREO_NEON
+    #include <arm_neon.h>
+#endif
 
 //To allow custom distortion to be introduced to CatMulSpline.
 float (*CustomDistortion)(float) = NULL;
@@ -94,30 +108,11 @@ static int num_out_of_range_over_3 = 0;
 static float percent_out_of_range;
 #endif
 
-float EvalCatmullRom10Spline ( float const *K, float scaledVal )
+// Picks the Hermite segment of the spline that scaledVal falls in, and returns the parameter within it.
+static inline float CatmullRom10Segment ( float const *K, float scaledVal, float *pp0, float *pm0, float *pp1, float *pm1 )
 {
     int const NumSegments = LensConfig::NumCoefficients;
 
-	#if TPH_SPLINE_STATISTICS
-	//Value should be in range of 0 to (NumSegments-1) (typically 10) if spline is valid. Right?
-	if (scaledVal > (NumSegments-1))
-	{
-		num_out_of_range++;
-		average_total_out_of_range+=scaledVal;
-		average_out_of_range = average_total_out_of_range / ((float) num_out_of_range); 
-		percent_out_of_range = 100.0f*(num_out_of_range)/num_total;
-	}
-	if (scaledVal > (NumSegments-1+1)) num_out_of_range_over_1++;
-	if (scaledVal > (NumSegments-1+2)) num_out_of_range_over_2++;
-	if (scaledVal > (NumSegments-1+3)) num_out_of_range_over_3++;
-	num_total++;
-	if (scaledVal > max_scaledVal)
-	{
-		max_scaledVal = scaledVal;
-		max_scaledVal = scaledVal;
-	}
-	#endif
-
     float scaledValFloor = floorf ( scaledVal );
     scaledValFloor = Alg::Max ( 0.0f, Alg::Min ( (float)(NumSegments-1), scaledValFloor ) );
     float t = scaledVal - scaledValFloor;
@@ -157,6 +152,41 @@ float EvalCatmullRom10Spline ( float const *K, float scaledVal )
         break;
     }
 
+    *pp0 = p0;
+    *pm0 = m0;
+    *pp1 = p1;
+    *pm1 = m1;
+    return t;
+}
+
+float EvalCatmullRom10Spline ( float const *K, float scaledVal )
+{
+	#if TPH_SPLINE_STATISTICS
+    int const NumSegments = LensConfig::NumCoefficients;
+
+	//Value should be in range of 0 to (NumSegments-1) (typically 10) if spline is valid. Right?
+	if (scaledVal > (NumSegments-1))
+	{
+		num_out_of_range++;
+		average_total_out_of_range+=scaledVal;
+		average_out_of_range = average_total_out_of_range / ((float) num_out_of_range); 
+		percent_out_of_range = 100.0f*(num_out_of_range)/num_total;
+	}
+	if (scaledVal > (NumSegments-1+1)) num_out_of_range_over_1++;
+	if (scaledVal > (NumSegments-1+2)) num_out_of_range_over_2++;
+	if (scaledVal > (NumSegments-1+3)) num_out_of_range_over_3++;
+	num_total++;
+	if (scaledVal > max_scaledVal)
+	{
+		max_scaledVal = scaledVal;
+		max_scaledVal = scaledVal;
+	}
+	#endif
+
+    float p0, p1;
+    float m0, m1;
+    float t = CatmullRom10Segment ( K, scaledVal, &p0, &m0, &p1, &m1 );
+
     float omt = 1.0f - t;
     float res  = ( p0 * ( 1.0f + 2.0f *   t ) + m0 *   t ) * omt * omt
                + ( p1 * ( 1.0f + 2.0f * omt ) - m1 * omt ) *   t *   t;
@@ -241,8 +271,257 @@ Vector3f LensConfig::DistortionFnScaleRadiusSquaredChroma (float rsq) const
     return scaleRGB;
 }
 
+// The Hermite control values of one spline segment, p0 m0 p1 m1, so a single load picks up a whole
+// segment and the batched kernels can gather without branching on the segment index.
+typedef float CatmullRom10SegmentTable[LensConfig::NumCoefficients][4];
+
+static void CatmullRom10BuildSegmentTable ( float const *K, CatmullRom10SegmentTable table )
+{
+    for ( int k = 0; k < LensConfig::NumCoefficients; k++ )
+    {
+        CatmullRom10Segment ( K, (float)k, &table[k][0], &table[k][1], &table[k][2], &table[k][3] );
+    }
+}
+
+// The same operations in the same order as EvalCatmullRom10Spline and DistortionFnScaleRadiusSquaredChroma,
+// so with SSE2 the results match the scalar path bit for bit.
+#if defined(OVR_STEREO_SSE2)
+
+static inline void CatmullRom10Chroma4 ( CatmullRom10SegmentTable const table, float const *rsq, float maxRsq,
+                                         float const *chroma, float *pScaleR, float *pScaleG, float *pScaleB )
+{
+    __m128 one = _mm_set1_ps ( 1.0f );
+    __m128 two = _mm_set1_ps ( 2.0f );
+
+    __m128 r = _mm_loadu_ps ( rsq );
+    __m128 scaledVal = _mm_div_ps ( _mm_mul_ps ( _mm_set1_ps ( (float)(LensConfig::NumCoefficients-1) ), r ),
+                                    _mm_set1_ps ( maxRsq ) );
+    // Clamping before the conversion keeps huge values in range, and truncation is floor for anything >= 0.
+    __m128 clamped = _mm_max_ps ( _mm_setzero_ps(), _mm_min_ps ( _mm_set1_ps ( (float)(LensConfig::NumCoefficients-1) ), scaledVal ) );
+    __m128i k = _mm_cvttps_epi32 ( clamped );
+    __m128 t = _mm_sub_ps ( scaledVal, _mm_cvtepi32_ps ( k ) );
+
+    OVR_ALIGNAS(16) int32_t index[4];
+    _mm_store_si128 ( (__m128i*)index, k );
+    __m128 p0 = _mm_loadu_ps ( table[index[0]] );
+    __m128 m0 = _mm_loadu_ps ( table[index[1]] );
+    __m128 p1 = _mm_loadu_ps ( table[index[2]] );
+    __m128 m1 = _mm_loadu_ps ( table[index[3]] );
+    _MM_TRANSPOSE4_PS ( p0, m0, p1, m1 );
+
+    __m128 omt = _mm_sub_ps ( one, t );
+    __m128 a = _mm_mul_ps ( _mm_mul_ps ( _mm_add_ps ( _mm_mul_ps ( p0, _mm_add_ps ( one, _mm_mul_ps ( two, t ) ) ),
+                                                      _mm_mul_ps ( m0, t ) ), omt ), omt );
+    __m128 b = _mm_mul_ps ( _mm_mul_ps ( _mm_sub_ps ( _mm_mul_ps ( p1, _mm_add_ps ( one, _mm_mul_ps ( two, omt ) ) ),
+                                                      _mm_mul_ps ( m1, omt ) ), t ), t );
+    __m128 scale = _mm_add_ps ( a, b );
+
+    __m128 red  = _mm_add_ps ( _mm_add_ps ( one, _mm_set1_ps ( chroma[0] ) ), _mm_mul_ps ( r, _mm_set1_ps ( chroma[1] ) ) );
+    __m128 blue = _mm_add_ps ( _mm_add_ps ( one, _mm_set1_ps ( chroma[2] ) ), _mm_mul_ps ( r, _mm_set1_ps ( chroma[3] ) ) );
+    _mm_storeu_ps ( pScaleR, _mm_mul_ps ( scale, red ) );
+    _mm_storeu_ps ( pScaleG, scale );
+    _mm_storeu_ps ( pScaleB, _mm_mul_ps ( scale, blue ) );
+}
+
+#elif defined(OVR_STEREO_NEON)
+
+// ARMv7 has no vector divide and may fuse multiply-adds, so expect an ulp or two against the scalar path here.
+static inline void CatmullRom10Chroma4 ( CatmullRom10SegmentTable const table, float const *rsq, float maxRsq,
+                                         float const *chroma, float *pScaleR, float *pScaleG, float *pScaleB )
+{
+    float32x4_t one = vdupq_n_f32 ( 1.0f );
+    float32x4_t two = vdupq_n_f32 ( 2.0f );
+
+    float32x4_t r = vld1q_f32 ( rsq );
+    float32x4_t scaled = vmulq_f32 ( vdupq_n_f32 ( (float)(LensConfig::NumCoefficients-1) ), r );
+#if defined(__aarch64__)
+    float32x4_t scaledVal = vdivq_f32 ( scaled, vdupq_n_f32 ( maxRsq ) );
+#else
+    float32x4_t denom = vdupq_n_f32 ( maxRsq );
+    float32x4_t recip = vrecpeq_f32 ( denom );
+    recip = vmulq_f32 ( recip, vrecpsq_f32 ( denom, recip ) );
+    recip = vmulq_f32 ( recip, vrecpsq_f32 ( denom, recip ) );
+    float32x4_t scaledVal = vmulq_f32 ( scaled, recip );
+#endif
+    float32x4_t clamped = vmaxq_f32 ( vdupq_n_f32 ( 0.0f ), vminq_f32 ( vdupq_n_f32 ( (float)(LensConfig::NumCoefficients-1) ), scaledVal ) );
+    int32x4_t k = vcvtq_s32_f32 ( clamped );
+    float32x4_t t = vsubq_f32 ( scaledVal, vcvtq_f32_s32 ( k ) );
+
+    int32_t index[4];
+    vst1q_s32 ( index, k );
+    float32x4x2_t lo = vtrnq_f32 ( vld1q_f32 ( table[index[0]] ), vld1q_f32 ( table[index[1]] ) );
+    float32x4x2_t hi = vtrnq_f32 ( vld1q_f32 ( table[index[2]] ), vld1q_f32 ( table[index[3]] ) );
+    float32x4_t p0 = vcombine_f32 ( vget_low_f32  ( lo.val[0] ), vget_low_f32  ( hi.val[0] ) );
+    float32x4_t m0 = vcombine_f32 ( vget_low_f32  ( lo.val[1] ), vget_low_f32  ( hi.val[1] ) );
+    float32x4_t p1 = vcombine_f32 ( vget_high_f32 ( lo.val[0] ), vget_high_f32 ( hi.val[0] ) );
+    float32x4_t m1 = vcombine_f32 ( vget_high_f32 ( lo.val[1] ), vget_high_f32 ( hi.val[1] ) );
+
+    float32x4_t omt = vsubq_f32 ( one, t );
+    float32x4_t a = vmulq_f32 ( vmulq_f32 ( vaddq_f32 ( vmulq_f32 ( p0, vaddq_f32 ( one, vmulq_f32 ( two, t ) ) ),
+                                                        vmulq_f32 ( m0, t ) ), omt ), omt );
+    float32x4_t b = vmulq_f32 ( vmulq_f32 ( vsubq_f32 ( vmulq_f32 ( p1, vaddq_f32 ( one, vmulq_f32 ( two, omt ) ) ),
+                                                        vmulq_f32 ( m1, omt ) ), t ), t );
+    float32x4_t scale = vaddq_f32 ( a, b );
+
+    float32x4_t red  = vaddq_f32 ( vaddq_f32 ( one, vdupq_n_f32 ( chroma[0] ) ), vmulq_f32 ( r, vdupq_n_f32 ( chroma[1] ) ) );
+    float32x4_t blue = vaddq_f32 ( vaddq_f32 ( one, vdupq_n_f32 ( chroma[2] ) ), vmulq_f32 ( r, vdupq_n_f32 ( chroma[3] ) ) );
+    vst1q_f32 ( pScaleR, vmulq_f32 ( scale, red ) );
+    vst1q_f32 ( pScaleG, scale );
+    vst1q_f32 ( pScaleB, vmulq_f32 ( scale, blue ) );
+}
+
+#endif
+
+// Batched version of the above; pscaleRGB[i] gets the scales for rsq[i].
+void LensConfig::DistortionFnScaleRadiusSquaredChroma (Vector3f *pscaleRGB, float const *rsq, int count) const
+{
+    int i = 0;
+
+#if defined(OVR_STEREO_SSE2) || defined(OVR_STEREO_NEON)
+    // The other equations are cheap enough already, and a custom distortion overrules the spline anyway.
+    if ( ( Eqn == Distortion_CatmullRom10 ) && ( CustomDistortion == NULL ) )
+    {
+        CatmullRom10SegmentTable table;
+        CatmullRom10BuildSegmentTable ( K, table );
+        float maxRsq = MaxR * MaxR;
+
+        for ( ; i + 4 <= count; i += 4 )
+        {
+            float scaleR[4], scaleG[4], scaleB[4];
+            CatmullRom10Chroma4 ( table, rsq + i, maxRsq, ChromaticAberration, scaleR, scaleG, scaleB );
+            for ( int j = 0; j < 4; j++ )
+            {
+                pscaleRGB[i+j].x = scaleR[j];
+                pscaleRGB[i+j].y = scaleG[j];
+                pscaleRGB[i+j].z = scaleB[j];
+            }
+        }
+    }
+#endif
+
+    // Whatever is left over, or everything on other CPUs.
+    for ( ; i < count; i++ )
+    {
+        pscaleRGB[i] = DistortionFnScaleRadiusSquaredChroma ( rsq[i] );
+    }
+}
+
+// Evaluates DistortionFn and its derivative together, sharing the spline segment lookup.
+static float DistortionFnWithSlope ( LensConfig const &lens, float r, float *pSlope )
+{
+    // d/dr ( r * scale(r^2) ) = scale(r^2) + 2 r^2 scale'(r^2)
+    float const *K = lens.K;
+    float rsq = r * r;
+    float scale = 1.0f;
+    float scaleDerivative = 0.0f;
+    switch ( lens.Eqn )
+    {
+    case Distortion_Poly4:
+        scale           = K[0] + rsq * ( K[1] + rsq * ( K[2] + rsq * K[3] ) );
+        scaleDerivative = K[1] + rsq * ( 2.0f * K[2] + rsq * 3.0f * K[3] );
+        break;
+    case Distortion_RecipPoly4:{
+        float poly      = K[0] + rsq * ( K[1] + rsq * ( K[2] + rsq * K[3] ) );
+        float polySlope = K[1] + rsq * ( 2.0f * K[2] + rsq * 3.0f * K[3] );
+        scale           = 1.0f / poly;
+        scaleDerivative = -polySlope * scale * scale;
+        }break;
+    case Distortion_CatmullRom10:{
+        // A custom curve has no known derivative, so difference it instead.
+        if (CustomDistortion)
+        {
+            float h = Max ( 1e-4f, fabsf ( r ) * 1e-3f );
+            *pSlope = ( lens.DistortionFn ( r + h ) - lens.DistortionFn ( r - h ) ) / ( 2.0f * h );
+            return lens.DistortionFn ( r );
+        }
+        const int NumSegments = LensConfig::NumCoefficients;
+        float rsqToScaled = (float)(NumSegments-1) / ( lens.MaxR * lens.MaxR );
+
+        float p0, p1;
+        float m0, m1;
+        float t = CatmullRom10Segment ( K, rsq * rsqToScaled, &p0, &m0, &p1, &m1 );
+        float omt = 1.0f - t;
+        scale = ( p0 * ( 1.0f + 2.0f *   t ) + m0 *   t ) * omt * omt
+              + ( p1 * ( 1.0f + 2.0f * omt ) - m1 * omt ) *   t *   t;
+        scaleDerivative = ( 6.0f * t * ( t - 1.0f ) * ( p0 - p1 )
+                          + ( ( 3.0f * t - 4.0f ) * t + 1.0f ) * m0
+                          + ( 3.0f * t - 2.0f ) * t * m1 ) * rsqToScaled;
+        }break;
+    default:
+        OVR_ASSERT ( false );
+        break;
+    }
+    *pSlope = scale + 2.0f * rsq * scaleDerivative;
+    return r * scale;
+}
+
+float LensConfig::DistortionFnDerivative(float r) const
+{
+    float slope;
+    DistortionFnWithSlope ( *this, r, &slope );
+    return slope;
+}
+
 // DistortionFnInverse computes the inverse of the distortion function on an argument.
 float LensConfig::DistortionFnInverse(float r) const
+{
+    OVR_ASSERT((r <= 20.0f));
+
+    // DistortionFn is odd, so solve for |r| and put the sign back at the end.
+    float target = fabsf ( r );
+    if ( target == 0.0f )
+    {
+        return 0.0f;
+    }
+
+    // Safeguarded Newton-Raphson. Every evaluation narrows the bracket [lo,hi] around the
+    // root, and a step that leaves it or meets a flat slope bisects (or grows) instead.
+    float lo = 0.0f;
+    float hi = -1.0f;   // No upper bound found yet.
+
+    // One fixed-point step from s = r is a much better start than the search's r * 0.25.
+    float s = target / DistortionFnScaleRadiusSquared ( target * target );
+    if ( !( s > 0.0f ) || ( s > 4.0f * target ) )
+    {
+        s = target * 0.25f;
+    }
+
+    for (int i = 0; i < 20; i++)
+    {
+        float slope;
+        float error = DistortionFnWithSlope ( *this, s, &slope ) - target;
+        if ( error == 0.0f )
+        {
+            break;
+        }
+        else if ( error < 0.0f )
+        {
+            lo = s;
+        }
+        else
+        {
+            hi = s;
+        }
+
+        float next = ( slope > 0.0f ) ? s - error / slope : -1.0f;
+        if ( !( next >= lo ) || ( ( hi >= 0.0f ) && !( next <= hi ) ) )
+        {
+            next = ( hi >= 0.0f ) ? 0.5f * ( lo + hi ) : s * 2.0f;
+        }
+
+        float step = fabsf ( next - s );
+        s = next;
+        if ( step <= 1e-6f * s )
+        {
+            break;
+        }
+    }
+
+    return ( r < 0.0f ) ? -s : s;
+}
+
+// The original inverse: a step-halving search costing up to 41 DistortionFn calls.
+float LensConfig::DistortionFnInverseSearch(float r) const
 {    
     OVR_ASSERT((r <= 20.0f));
 
@@ -318,6 +597,320 @@ float LensConfig::DistortionFnInverseApprox(float r) const
     return r * scale;
 }
 
+void LensInverseTable::Build(LensConfig const &lens, float maxR, int numSamples)
+{
+    NumSamples = Alg::Clamp ( numSamples, 2, (int)MaxSamples );
+    MaxR = maxR;
+    Step = maxR / (float)( NumSamples - 1 );
+
+    for ( int i = 0; i < NumSamples; i++ )
+    {
+        Value[i] = lens.DistortionFnInverse ( (float)i * Step );
+        // The inverse's slope is the reciprocal of the forward slope at the solution.
+        float forwardSlope = lens.DistortionFnDerivative ( Value[i] );
+        Slope[i] = ( forwardSlope > 0.0f ) ? 1.0f / forwardSlope : 0.0f;
+    }
+
+    // Fritsch-Carlson: limit the slopes so each cubic segment stays monotone,
+    // which keeps the inverse from folding back between samples.
+    for ( int i = 0; i < NumSamples - 1; i++ )
+    {
+        float secant = ( Value[i+1] - Value[i] ) / Step;
+        if ( secant <= 0.0f )
+        {
+            Slope[i]   = 0.0f;
+            Slope[i+1] = 0.0f;
+            continue;
+        }
+        float a = Slope[i]   / secant;
+        float b = Slope[i+1] / secant;
+        float lengthSq = a * a + b * b;
+        if ( lengthSq > 9.0f )
+        {
+            float tau = 3.0f / sqrtf ( lengthSq );
+            Slope[i]   = tau * a * secant;
+            Slope[i+1] = tau * b * secant;
+        }
+    }
+
+#ifdef OVR_BUILD_DEBUG
+    // Midpoints are where the interpolation is worst.
+    for ( int i = 0; i < NumSamples - 1; i++ )
+    {
+        float checkR = ( (float)i + 0.5f ) * Step;
+        float error = fabsf ( lens.DistortionFnInverse ( checkR ) - Evaluate ( checkR ) );
+        OVR_ASSERT ( error < 0.001f * Alg::Max ( maxR, 1.0f ) );
+        OVR_UNUSED ( error );
+    }
+#endif
+}
+
+float LensInverseTable::Evaluate(float r) const
+{
+    OVR_ASSERT ( IsValid() );
+
+    float absR = fabsf ( r );
+    float scaled = absR / Step;
+    int i = (int)scaled;
+    float result;
+    if ( i >= NumSamples - 1 )
+    {
+        // Past the table just continue the last slope.
+        result = Value[NumSamples-1] + ( absR - MaxR ) * Slope[NumSamples-1];
+    }
+    else
+    {
+        float t = scaled - (float)i;
+        float omt = 1.0f - t;
+        float p0 = Value[i];
+        float p1 = Value[i+1];
+        float m0 = Slope[i] * Step;
+        float m1 = Slope[i+1] * Step;
+        result = ( p0 * ( 1.0f + 2.0f *   t ) + m0 *   t ) * omt * omt
+               + ( p1 * ( 1.0f + 2.0f * omt ) - m1 * omt ) *   t *   t;
+    }
+    return ( r < 0.0f ) ? -result : result;
+}
+
+#ifdef OVR_LENS_INVERSE_TEST
+
+// Worst |DistortionFn(inverse(r)) - r| and time per call of one inverse over numR radii up to maxR.
+struct LensInverseResult
+{
+    float       MaxResidual;
+    float       MaxDiffFromNewton;
+    double      NanosPerCall;
+};
+
+template<class InverseFn>
+static LensInverseResult LensInverseMeasure ( LensConfig const &lens, float maxR, int numR, InverseFn inverse )
+{
+    LensInverseResult result;
+    result.MaxResidual          = 0.0f;
+    result.MaxDiffFromNewton    = 0.0f;
+    for ( int i = 0; i <= numR; i++ )
+    {
+        float r = maxR * (float)i / (float)numR;
+        float inv = inverse ( r );
+        result.MaxResidual          = Alg::Max ( result.MaxResidual, fabsf ( lens.DistortionFn ( inv ) - r ) );
+        result.MaxDiffFromNewton    = Alg::Max ( result.MaxDiffFromNewton, fabsf ( inv - lens.DistortionFnInverse ( r ) ) );
+    }
+
+    // The sum keeps the calls from being optimised away.
+    const int numPasses = 20;
+    volatile float sum = 0.0f;
+    double start = Timer::GetSeconds();
+    for ( int pass = 0; pass < numPasses; pass++ )
+    {
+        for ( int i = 0; i <= numR; i++ )
+        {
+            sum += inverse ( maxR * (float)i / (float)numR );
+        }
+    }
+    result.NanosPerCall = ( Timer::GetSeconds() - start ) * 1e9 / (double)( numPasses * ( numR + 1 ) );
+    return result;
+}
+
+struct LensInverseSearchFn
+{
+    LensConfig const *pLens;
+    float operator() ( float r ) const { return pLens->DistortionFnInverseSearch ( r ); }
+};
+struct LensInverseNewtonFn
+{
+    LensConfig const *pLens;
+    float operator() ( float r ) const { return pLens->DistortionFnInverse ( r ); }
+};
+struct LensInverseTableFn
+{
+    LensInverseTable const *pTable;
+    float operator() ( float r ) const { return pTable->Evaluate ( r ); }
+};
+
+bool LensInverseLogReport ( int numSamples /*= 64*/ )
+{
+    const DistortionEqnType eqns[]      = { Distortion_CatmullRom10, Distortion_RecipPoly4 };
+    const char *            eqnNames[]  = { "CatmullRom10", "RecipPoly4" };
+    // Newton converges to float precision; the table is held to what its debug build check allows.
+    const float       newtonBound   = 1e-5f;
+    const float       tableBound    = 1e-3f;
+    const int         numR          = 1000;
+
+    bool passed = true;
+    LogText ( "Lens inverse, %d table samples, %d radii\n", numSamples, numR + 1 );
+    LogText ( "DK2 lens fit   inverse  max residual  max diff from Newton  ns/call  speedup\n" );
+    for ( int eqnNum = 0; eqnNum < 2; eqnNum++ )
+    {
+        HMDInfo hmdInfo = CreateDebugHMDInfo ( HmdType_DK2 );
+        Ptr<Profile> profile = *ProfileManager::GetInstance()->GetDefaultProfile ( HmdType_DK2 );
+        HmdRenderInfo renderInfo = GenerateHmdRenderInfoFromHmdInfo ( hmdInfo, profile, eqns[eqnNum] );
+        LensConfig lens = CalculateDistortionRenderDesc ( StereoEye_Left, renderInfo ).Lens;
+        OVR_ASSERT ( lens.Eqn == eqns[eqnNum] );
+
+        // Everything the lens can show, up to where the curve stops being defined.
+        float maxR = lens.DistortionFn ( lens.MaxR );
+        LensInverseTable table;
+        table.Build ( lens, maxR, numSamples );
+
+        LensInverseSearchFn searchFn = { &lens };
+        LensInverseNewtonFn newtonFn = { &lens };
+        LensInverseTableFn  tableFn  = { &table };
+        LensInverseResult search = LensInverseMeasure ( lens, maxR, numR, searchFn );
+        LensInverseResult newton = LensInverseMeasure ( lens, maxR, numR, newtonFn );
+        LensInverseResult tab    = LensInverseMeasure ( lens, maxR, numR, tableFn );
+
+        const char *        names[3]    = { "search", "Newton", "table" };
+        LensInverseResult * results[3]  = { &search, &newton, &tab };
+        for ( int i = 0; i < 3; i++ )
+        {
+            LogText ( "%-12s   %-7s  %12.2e  %20.2e  %7.1f  %6.1fx\n", eqnNames[eqnNum], names[i],
+                      results[i]->MaxResidual, results[i]->MaxDiffFromNewton, results[i]->NanosPerCall,
+                      search.NanosPerCall / Alg::Max ( results[i]->NanosPerCall, 1e-3 ) );
+        }
+
+        if ( newton.MaxResidual > newtonBound * Alg::Max ( maxR, 1.0f ) )
+        {
+            LogError ( "{ERR-LENSINV} %s Newton inverse residual %g is over %g", eqnNames[eqnNum], newton.MaxResidual, newtonBound );
+            passed = false;
+        }
+        if ( tab.MaxDiffFromNewton > tableBound * Alg::Max ( maxR, 1.0f ) )
+        {
+            LogError ( "{ERR-LENSINV} %s inverse table is %g from Newton, over %g", eqnNames[eqnNum], tab.MaxDiffFromNewton, tableBound );
+            passed = false;
+        }
+    }
+    return passed;
+}
+
+#endif // OVR_LENS_INVERSE_TEST
+
+#ifdef OVR_LENS_SPLINE_TEST
+
+// Distance between two floats in units in the last place; 0 when they are the same value.
+static uint32_t LensSplineUlps ( float a, float b )
+{
+    int32_t ia, ib;
+    memcpy ( &ia, &a, sizeof(ia) );
+    memcpy ( &ib, &b, sizeof(ib) );
+    // Map the sign-magnitude bits onto a monotonic integer line so -0 and +0 land together, not 2^31 apart.
+    if ( ia < 0 ) ia = (int32_t)0x80000000 - ia;
+    if ( ib < 0 ) ib = (int32_t)0x80000000 - ib;
+    int64_t diff = (int64_t)ia - (int64_t)ib;
+    return (uint32_t)Alg::Min ( diff < 0 ? -diff : diff, (int64_t)0xffffffff );
+}
+
+bool LensSplineLogReport ( int numR /*= 10000*/ )
+{
+    const HmdTypeEnum hmdTypes[]    = { HmdType_DK1, HmdType_DK2 };
+    const char *      hmdNames[]    = { "DK1", "DK2" };
+    // SSE2 does the same float operations in the same order as the scalar code, so it must match exactly.
+    // NEON may fuse the multiply-adds, which is worth an ulp or two.
+#if defined(OVR_STEREO_NEON)
+    const uint32_t    ulpBound      = 4;
+    const char *      pathName      = "NEON";
+#elif defined(OVR_STEREO_SSE2)
+    const uint32_t    ulpBound      = 0;
+    const char *      pathName      = "SSE2";
+#else
+    const uint32_t    ulpBound      = 0;
+    const char *      pathName      = "scalar";
+#endif
+    const float       hugeValues[]  = { 1e3f, 1e6f, 1e12f, 1e20f, 1e30f, FLT_MAX };
+    const int         numHuge       = sizeof(hugeValues) / sizeof(hugeValues[0]);
+    // Odd, so the batched call has a scalar tail to get through as well.
+    const int         numTotal      = ( numR + numHuge + LensConfig::NumCoefficients + 3 ) | 1;
+
+    bool passed = true;
+    LogText ( "Lens spline, %s batch path, %d radii\n", pathName, numTotal );
+    LogText ( "Lens  mismatches  max ulps  scalar ns/radius  batch ns/radius  speedup\n" );
+    for ( int hmdNum = 0; hmdNum < 2; hmdNum++ )
+    {
+        HMDInfo hmdInfo = CreateDebugHMDInfo ( hmdTypes[hmdNum] );
+        Ptr<Profile> profile = *ProfileManager::GetInstance()->GetDefaultProfile ( hmdTypes[hmdNum] );
+        HmdRenderInfo renderInfo = GenerateHmdRenderInfoFromHmdInfo ( hmdInfo, profile, Distortion_CatmullRom10 );
+        LensConfig lens = CalculateDistortionRenderDesc ( StereoEye_Left, renderInfo ).Lens;
+        OVR_ASSERT ( lens.Eqn == Distortion_CatmullRom10 );
+
+        // 0 up to twice MaxR squared, then every segment boundary including MaxR itself, then the huge ones.
+        float maxRsq = lens.MaxR * lens.MaxR;
+        Array<float> rsq;
+        rsq.Resize ( numTotal );
+        int n = 0;
+        for ( int i = 0; i <= numR; i++ )
+        {
+            rsq[n++] = 2.0f * maxRsq * (float)i / (float)numR;
+        }
+        for ( int i = 1; i < LensConfig::NumCoefficients; i++ )
+        {
+            rsq[n++] = maxRsq * (float)i / (float)( LensConfig::NumCoefficients - 1 );
+        }
+        for ( int i = 0; i < numHuge; i++ )
+        {
+            rsq[n++] = hugeValues[i];
+        }
+        while ( n < numTotal )
+        {
+            rsq[n++] = 0.0f;
+        }
+
+        Array<Vector3f> batch;
+        batch.Resize ( numTotal );
+        lens.DistortionFnScaleRadiusSquaredChroma ( &batch[0], &rsq[0], numTotal );
+
+        int      mismatches = 0;
+        uint32_t maxUlps    = 0;
+        for ( int i = 0; i < numTotal; i++ )
+        {
+            Vector3f scalar = lens.DistortionFnScaleRadiusSquaredChroma ( rsq[i] );
+            uint32_t ulps = Alg::Max ( LensSplineUlps ( scalar.x, batch[i].x ),
+                            Alg::Max ( LensSplineUlps ( scalar.y, batch[i].y ),
+                                       LensSplineUlps ( scalar.z, batch[i].z ) ) );
+            if ( ulps > ulpBound )
+            {
+                if ( mismatches == 0 )
+                {
+                    LogError ( "{ERR-LENSSPLINE} %s rsq %.9g: scalar (%.9g %.9g %.9g) batch (%.9g %.9g %.9g)", hmdNames[hmdNum], rsq[i],
+                               scalar.x, scalar.y, scalar.z, batch[i].x, batch[i].y, batch[i].z );
+                }
+                mismatches++;
+            }
+            maxUlps = Alg::Max ( maxUlps, ulps );
+        }
+
+        // The sums keep the calls from being optimised away.
+        const int numPasses = 20;
+        volatile float sum = 0.0f;
+        double start = Timer::GetSeconds();
+        for ( int pass = 0; pass < numPasses; pass++ )
+        {
+            for ( int i = 0; i < numTotal; i++ )
+            {
+                sum += lens.DistortionFnScaleRadiusSquaredChroma ( rsq[i] ).y;
+            }
+        }
+        double scalarNanos = ( Timer::GetSeconds() - start ) * 1e9 / (double)( numPasses * numTotal );
+
+        start = Timer::GetSeconds();
+        for ( int pass = 0; pass < numPasses; pass++ )
+        {
+            lens.DistortionFnScaleRadiusSquaredChroma ( &batch[0], &rsq[0], numTotal );
+            sum += batch[pass].y;
+        }
+        double batchNanos = ( Timer::GetSeconds() - start ) * 1e9 / (double)( numPasses * numTotal );
+
+        LogText ( "%-4s  %10d  %8u  %16.2f  %15.2f  %6.1fx\n", hmdNames[hmdNum], mismatches, maxUlps,
+                  scalarNanos, batchNanos, scalarNanos / Alg::Max ( batchNanos, 1e-3 ) );
+        if ( mismatches > 0 )
+        {
+            LogError ( "{ERR-LENSSPLINE} %s batched spline differs from the scalar one at %d of %d radii", hmdNames[hmdNum], mismatches, numTotal );
+            passed = false;
+        }
+    }
+    return passed;
+}
+
+#endif // OVR_LENS_SPLINE_TEST
+
 void LensConfig::SetUpInverseApprox()
 {
     float maxR = MaxInvR;
@@ -887,7 +1480,7 @@ HmdRenderInfo GenerateHmdRenderInfoFromHmdInfo ( HMDInfo const &hmdInfo,
         HmdRenderInfo::EyeConfig *pHmdEyeConfig = ( eyeNum == 0 ) ? &(renderInfo.EyeLeft) : &(renderInfo.EyeRight);
 
         float eye_relief = pHmdEyeConfig->ReliefInMeters;
-        LensConfig distortionConfig = GenerateLensConfigFromEyeRelief ( eye_relief, renderInfo, distortionType );
+        LensConfig distortionConfig = CachedGenerateLensConfigFromEyeRelief ( eye_relief, renderInfo, distortionType );
         pHmdEyeConfig->Distortion = distortionConfig;
     }
 
@@ -1368,6 +1961,22 @@ DistortionRenderDesc CalculateDistortionRenderDesc ( StereoEye eyeType, HmdRende
     return localDistortion;
 }
 
+// How far the pupil moves sideways and backwards when the eye turns by eyeRotationInRadians.
+static void CalculatePupilShiftFromEyeRotation ( float eyeRotationInRadians,
+                                                 float *pSidewaysInMeters, float *pBackwardsInMeters )
+{
+    // Beyond 30 degrees does not increase FOV because the pupil starts moving backwards more than sideways.
+    eyeRotationInRadians = Alg::Min ( DegreeToRad ( 30.0f ), Alg::Max ( 0.0f, eyeRotationInRadians ) );
+
+    // The rotation of the eye is a bit more complex than a simple circle.  The center of rotation
+    // at 13.5mm from cornea is slightly further back than the actual center of the eye.
+    // Additionally the rotation contains a small lateral component as the muscles pull the eye
+    const float eyeballCenterToPupil = 0.0135f;  // center of eye rotation
+    const float eyeballLateralPull = 0.001f * (eyeRotationInRadians / DegreeToRad ( 30.0f));  // lateral motion as linear function 
+    *pSidewaysInMeters  = eyeballCenterToPupil * sinf ( eyeRotationInRadians ) + eyeballLateralPull;
+    *pBackwardsInMeters = eyeballCenterToPupil * ( 1.0f - cosf ( eyeRotationInRadians ) );
+}
+
 FovPort CalculateFovFromEyePosition ( float eyeReliefInMeters,
                                       float offsetToRightInMeters,
                                       float offsetDownwardsInMeters,
@@ -1399,17 +2008,8 @@ FovPort CalculateFovFromEyePosition ( float eyeReliefInMeters,
         // But if you look left, the pupil moves left as the eyeball rotates, which
         // means you can see more to the right than this geometry suggests.
         // So add in the bounds for the extra movement of the pupil.
-
-        // Beyond 30 degrees does not increase FOV because the pupil starts moving backwards more than sideways.
-        extraEyeRotationInRadians = Alg::Min ( DegreeToRad ( 30.0f ), Alg::Max ( 0.0f, extraEyeRotationInRadians ) );
-        
-        // The rotation of the eye is a bit more complex than a simple circle.  The center of rotation
-        // at 13.5mm from cornea is slightly further back than the actual center of the eye.
-        // Additionally the rotation contains a small lateral component as the muscles pull the eye
-        const float eyeballCenterToPupil = 0.0135f;  // center of eye rotation
-        const float eyeballLateralPull = 0.001f * (extraEyeRotationInRadians / DegreeToRad ( 30.0f));  // lateral motion as linear function 
-        float extraTranslation = eyeballCenterToPupil * sinf ( extraEyeRotationInRadians ) + eyeballLateralPull;
-        float extraRelief = eyeballCenterToPupil * ( 1.0f - cosf ( extraEyeRotationInRadians ) );
+        float extraTranslation, extraRelief;
+        CalculatePupilShiftFromEyeRotation ( extraEyeRotationInRadians, &extraTranslation, &extraRelief );
 
         fovPort.UpTan    = Alg::Max ( fovPort.UpTan   , ( halfLensDiameter + offsetDownwardsInMeters + extraTranslation ) / ( eyeReliefInMeters + extraRelief ) );
         fovPort.DownTan  = Alg::Max ( fovPort.DownTan , ( halfLensDiameter - offsetDownwardsInMeters + extraTranslation ) / ( eyeReliefInMeters + extraRelief ) );
@@ -1422,6 +2022,53 @@ FovPort CalculateFovFromEyePosition ( float eyeReliefInMeters,
 
 
 
+LensRim CalculateLensRimFromEyePosition ( float eyeReliefInMeters,
+                                          float offsetToRightInMeters,
+                                          float offsetDownwardsInMeters,
+                                          float lensDiameterInMeters,
+                                          float eyeRotationInRadians /*= 0.0f*/ )
+{
+    // The same geometry as CalculateFovFromEyePosition, whose FovPort is the box around this circle.
+    // The pupil moves towards whichever way the eye turns, so the rim is as far away as that in every direction.
+    float pupilSideways, pupilBackwards;
+    CalculatePupilShiftFromEyeRotation ( eyeRotationInRadians, &pupilSideways, &pupilBackwards );
+    float relief = eyeReliefInMeters + pupilBackwards;
+
+    LensRim rim;
+    rim.CenterTan = Vector2f ( -offsetToRightInMeters, -offsetDownwardsInMeters ) / relief;
+    rim.RadiusTan = ( lensDiameterInMeters * 0.5f + pupilSideways ) / relief;
+    return rim;
+}
+
+
+static void CalculateEyePositionFromHmdInfo ( StereoEye eyeType, HmdRenderInfo const &hmd,
+                                              float *pEyeReliefInMeters, float *pOffsetToRightInMeters )
+{
+    if ( eyeType == StereoEye_Right )
+    {
+        *pEyeReliefInMeters     = hmd.EyeRight.ReliefInMeters;
+        *pOffsetToRightInMeters = hmd.EyeRight.NoseToPupilInMeters - 0.5f * hmd.LensSeparationInMeters;
+    }
+    else
+    {
+        *pEyeReliefInMeters     = hmd.EyeLeft.ReliefInMeters;
+        *pOffsetToRightInMeters = -(hmd.EyeLeft.NoseToPupilInMeters - 0.5f * hmd.LensSeparationInMeters);
+    }
+}
+
+LensRim CalculateLensRimFromHmdInfo ( StereoEye eyeType,
+                                      HmdRenderInfo const &hmd,
+                                      float eyeRotationInRadians /*= 0.0f*/ )
+{
+    // Unlike the FOV, no lower limit on eye relief: a closer eye sees more, and this is used to find what it can't see.
+    float eyeReliefInMeters;
+    float offsetToRightInMeters;
+    CalculateEyePositionFromHmdInfo ( eyeType, hmd, &eyeReliefInMeters, &offsetToRightInMeters );
+    return CalculateLensRimFromEyePosition ( eyeReliefInMeters, offsetToRightInMeters, 0.0f,
+                                             hmd.LensDiameterInMeters, eyeRotationInRadians );
+}
+
+
 FovPort CalculateFovFromHmdInfo ( StereoEye eyeType,
                                   DistortionRenderDesc const &distortion,
                                   HmdRenderInfo const &hmd,
@@ -1430,16 +2077,7 @@ FovPort CalculateFovFromHmdInfo ( StereoEye eyeType,
     FovPort fovPort;
     float eyeReliefInMeters;
     float offsetToRightInMeters;
-    if ( eyeType == StereoEye_Right )
-    {
-        eyeReliefInMeters     = hmd.EyeRight.ReliefInMeters;
-        offsetToRightInMeters = hmd.EyeRight.NoseToPupilInMeters - 0.5f * hmd.LensSeparationInMeters;
-    }
-    else
-    {
-        eyeReliefInMeters     = hmd.EyeLeft.ReliefInMeters;
-        offsetToRightInMeters = -(hmd.EyeLeft.NoseToPupilInMeters - 0.5f * hmd.LensSeparationInMeters);
-    }
+    CalculateEyePositionFromHmdInfo ( eyeType, hmd, &eyeReliefInMeters, &offsetToRightInMeters );
 
     // Limit the eye-relief to 6 mm for FOV calculations since this just tends to spread off-screen
     // and get clamped anyways on DK1 (but in Unity it continues to spreads and causes 
@@ -1766,6 +2404,40 @@ void TransformScreenNDCToTanFovSpaceChroma ( Vector2f *resultR, Vector2f *result
     *resultB = tanEyeAngleDistorted * distortionScales.z;
 }
 
+// Same, for a whole array of points at once. The distortion scales go through the batched spline.
+void TransformScreenNDCToTanFovSpaceChroma ( Vector2f *resultR, Vector2f *resultG, Vector2f *resultB, 
+                                             DistortionRenderDesc const &distortion,
+                                             const Vector2f *framebufferNDC, int count )
+{
+    // Blocks keep the intermediate arrays on the stack.
+    const int BlockSize = 64;
+    Vector2f tanEyeAngleDistorted[BlockSize];
+    float    radiusSquared[BlockSize];
+    Vector3f distortionScales[BlockSize];
+
+    for ( int blockStart = 0; blockStart < count; blockStart += BlockSize )
+    {
+        int blockCount = Alg::Min ( BlockSize, count - blockStart );
+        for ( int i = 0; i < blockCount; i++ )
+        {
+            Vector2f const &ndc = framebufferNDC[blockStart + i];
+            tanEyeAngleDistorted[i].x = ( ndc.x - distortion.LensCenter.x ) * distortion.TanEyeAngleScale.x;
+            tanEyeAngleDistorted[i].y = ( ndc.y - distortion.LensCenter.y ) * distortion.TanEyeAngleScale.y;
+            radiusSquared[i] = ( tanEyeAngleDistorted[i].x * tanEyeAngleDistorted[i].x )
+                             + ( tanEyeAngleDistorted[i].y * tanEyeAngleDistorted[i].y );
+        }
+
+        distortion.Lens.DistortionFnScaleRadiusSquaredChroma ( distortionScales, radiusSquared, blockCount );
+
+        for ( int i = 0; i < blockCount; i++ )
+        {
+            resultR[blockStart + i] = tanEyeAngleDistorted[i] * distortionScales[i].x;
+            resultG[blockStart + i] = tanEyeAngleDistorted[i] * distortionScales[i].y;
+            resultB[blockStart + i] = tanEyeAngleDistorted[i] * distortionScales[i].z;
+        }
+    }
+}
+
 // This mimics the second half of the distortion shader's function.
 Vector2f TransformTanFovSpaceToRendertargetTexUV( ScaleAndOffset2D const &eyeToSourceUV,
                                                   Vector2f const &tanEyeAngle )
@@ -1824,15 +2496,10 @@ Vector2f TransformScreenPixelToRendertargetTexUV( Recti const &distortionViewpor
 //-----------------------------------------------------------------------------------
 // A set of "reverse-mapping" functions, mapping from real-world and/or texture space back to the framebuffer.
 
-Vector2f TransformTanFovSpaceToScreenNDC( DistortionRenderDesc const &distortion,
-                                          const Vector2f &tanEyeAngle, bool usePolyApprox /*= false*/ )
+// The part of TransformTanFovSpaceToScreenNDC after the lens has been inverted.
+static Vector2f TransformDistortedTanFovSpaceToScreenNDC( DistortionRenderDesc const &distortion, const Vector2f &tanEyeAngle,
+                                                          float tanEyeAngleRadius, float tanEyeAngleDistortedRadius )
 {
-    float tanEyeAngleRadius = tanEyeAngle.Length();
-    float tanEyeAngleDistortedRadius = distortion.Lens.DistortionFnInverseApprox ( tanEyeAngleRadius );
-    if ( !usePolyApprox )
-    {
-        tanEyeAngleDistortedRadius = distortion.Lens.DistortionFnInverse ( tanEyeAngleRadius );
-    }
     Vector2f tanEyeAngleDistorted = tanEyeAngle;
     if ( tanEyeAngleRadius > 0.0f )
     {   
@@ -1846,6 +2513,26 @@ Vector2f TransformTanFovSpaceToScreenNDC( DistortionRenderDesc const &distortion
     return framebufferNDC;
 }
 
+Vector2f TransformTanFovSpaceToScreenNDC( DistortionRenderDesc const &distortion,
+                                          const Vector2f &tanEyeAngle, bool usePolyApprox /*= false*/ )
+{
+    float tanEyeAngleRadius = tanEyeAngle.Length();
+    float tanEyeAngleDistortedRadius = distortion.Lens.DistortionFnInverseApprox ( tanEyeAngleRadius );
+    if ( !usePolyApprox )
+    {
+        tanEyeAngleDistortedRadius = distortion.Lens.DistortionFnInverse ( tanEyeAngleRadius );
+    }
+    return TransformDistortedTanFovSpaceToScreenNDC ( distortion, tanEyeAngle, tanEyeAngleRadius, tanEyeAngleDistortedRadius );
+}
+
+Vector2f TransformTanFovSpaceToScreenNDC( DistortionRenderDesc const &distortion,
+                                          LensInverseTable const &inverseTable,
+                                          const Vector2f &tanEyeAngle )
+{
+    float tanEyeAngleRadius = tanEyeAngle.Length();
+    return TransformDistortedTanFovSpaceToScreenNDC ( distortion, tanEyeAngle, tanEyeAngleRadius, inverseTable.Evaluate ( tanEyeAngleRadius ) );
+}
+
 Vector2f TransformRendertargetNDCToTanFovSpace( const ScaleAndOffset2D &eyeToSourceNDC,
                                                 const Vector2f &textureNDC )
 {
@@ -1854,6 +2541,263 @@ Vector2f TransformRendertargetNDCToTanFovSpace( const ScaleAndOffset2D &eyeToSou
 }
 
 
+//-----------------------------------------------------------------------------------
+// ***** Stereo cache
+
+// One lock guards all the memos; lookups are a few compares, the work they save is done outside it.
+static Lock         StereoCacheLock;
+static int          StereoCacheCapacity = StereoCacheDefaultCapacity;
+static uint64_t     StereoCacheUseCount = 0;
+
+// Keys are compared and hashed bytewise, so each key zeroes itself, padding included, before
+// its fields are filled in.
+struct LensConfigCacheKey
+{
+    float             (*pCustomDistortion)(float);
+    float             (*pCustomDistortionInv)(float);
+    float               EyeReliefInMeters;
+    EyeCupType          EyeCups;            // The only part of the HmdRenderInfo the lens fit reads.
+    DistortionEqnType   DistortionType;
+
+    LensConfigCacheKey() { memset ( (void*)this, 0, sizeof(*this) ); }
+};
+
+struct FovCacheKey
+{
+    float             (*pCustomDistortion)(float);
+    float             (*pCustomDistortionInv)(float);
+    HmdRenderInfo       Hmd;
+    DistortionRenderDesc Distortion;
+    StereoEye           EyeType;
+    float               ExtraEyeRotationInRadians;
+
+    FovCacheKey() { memset ( (void*)this, 0, sizeof(*this) ); }
+};
+
+struct PhysicalScreenFovCacheKey
+{
+    float             (*pCustomDistortion)(float);
+    float             (*pCustomDistortionInv)(float);
+    DistortionRenderDesc Distortion;
+    StereoEye           EyeType;
+
+    PhysicalScreenFovCacheKey() { memset ( (void*)this, 0, sizeof(*this) ); }
+};
+
+// Least recently used memo of up to StereoCacheMaxCapacity results.
+template<class KeyType, class ValueType>
+class StereoCacheMemo
+{
+public:
+    StereoCacheMemo() : NumEntries(0)
+    {
+        memset ( &Counters, 0, sizeof(Counters) );
+    }
+
+    bool Find ( KeyType const &key, ValueType *presult )
+    {
+        uint32_t hash = Hash ( key );
+        Lock::Locker locker ( &StereoCacheLock );
+        int entryNum = FindEntry ( key, hash );
+        if ( entryNum < 0 )
+        {
+            Counters.Misses++;
+            return false;
+        }
+        Entries[entryNum].LastUse = ++StereoCacheUseCount;
+        *presult = Entries[entryNum].Value;
+        Counters.Hits++;
+        return true;
+    }
+
+    void Insert ( KeyType const &key, ValueType const &value )
+    {
+        uint32_t hash = Hash ( key );
+        Lock::Locker locker ( &StereoCacheLock );
+        // Another thread may have missed on the same key and got here first.
+        if ( ( StereoCacheCapacity == 0 ) || ( FindEntry ( key, hash ) >= 0 ) )
+        {
+            return;
+        }
+        int entryNum = NumEntries;
+        if ( NumEntries < StereoCacheCapacity )
+        {
+            NumEntries++;
+        }
+        else
+        {
+            entryNum = FindLeastRecentlyUsed();
+            Counters.Evictions++;
+        }
+        Entry &entry  = Entries[entryNum];
+        entry.Key     = key;
+        entry.Hash    = hash;
+        entry.LastUse = ++StereoCacheUseCount;
+        entry.Value   = value;
+    }
+
+    // The caller holds StereoCacheLock for these.
+    void Trim ( int capacity )
+    {
+        while ( NumEntries > capacity )
+        {
+            Entries[FindLeastRecentlyUsed()] = Entries[NumEntries - 1];
+            NumEntries--;
+            Counters.Evictions++;
+        }
+    }
+
+    void Clear()
+    {
+        NumEntries = 0;
+        memset ( &Counters, 0, sizeof(Counters) );
+    }
+
+    StereoCacheCounters Counters;
+
+private:
+    struct Entry
+    {
+        KeyType     Key;
+        uint32_t    Hash;
+        uint64_t    LastUse;
+        ValueType   Value;
+    };
+
+    static uint32_t Hash ( KeyType const &key )
+    {
+        // FNV-1a.
+        uint8_t const *pbytes = (uint8_t const *)&key;
+        uint32_t hash = 2166136261u;
+        for ( size_t byteNum = 0; byteNum < sizeof(KeyType); byteNum++ )
+        {
+            hash = ( hash ^ pbytes[byteNum] ) * 16777619u;
+        }
+        return hash;
+    }
+
+    int FindEntry ( KeyType const &key, uint32_t hash ) const
+    {
+        for ( int entryNum = 0; entryNum < NumEntries; entryNum++ )
+        {
+            if ( ( Entries[entryNum].Hash == hash ) &&
+                 ( memcmp ( &Entries[entryNum].Key, &key, sizeof(KeyType) ) == 0 ) )
+            {
+                return entryNum;
+            }
+        }
+        return -1;
+    }
+
+    int FindLeastRecentlyUsed() const
+    {
+        int oldest = 0;
+        for ( int entryNum = 1; entryNum < NumEntries; entryNum++ )
+        {
+            if ( Entries[entryNum].LastUse < Entries[oldest].LastUse )
+            {
+                oldest = entryNum;
+            }
+        }
+        return oldest;
+    }
+
+    Entry   Entries[StereoCacheMaxCapacity];
+    int     NumEntries;
+};
+
+static StereoCacheMemo<LensConfigCacheKey, LensConfig>      LensConfigCache;
+static StereoCacheMemo<FovCacheKey, FovPort>                FovCache;
+static StereoCacheMemo<PhysicalScreenFovCacheKey, FovPort>  PhysicalScreenFovCache;
+
+
+LensConfig CachedGenerateLensConfigFromEyeRelief ( float eyeReliefInMeters, HmdRenderInfo const &hmd,
+                                                   DistortionEqnType distortionType /*= Distortion_CatmullRom10*/ )
+{
+    LensConfigCacheKey key;
+    key.pCustomDistortion       = CustomDistortion;
+    key.pCustomDistortionInv    = CustomDistortionInv;
+    key.EyeReliefInMeters       = eyeReliefInMeters;
+    key.EyeCups                 = hmd.EyeCups;
+    key.DistortionType          = distortionType;
+
+    LensConfig result;
+    if ( !LensConfigCache.Find ( key, &result ) )
+    {
+        result = GenerateLensConfigFromEyeRelief ( eyeReliefInMeters, hmd, distortionType );
+        LensConfigCache.Insert ( key, result );
+    }
+    return result;
+}
+
+FovPort CachedCalculateFovFromHmdInfo ( StereoEye eyeType,
+                                        DistortionRenderDesc const &distortion,
+                                        HmdRenderInfo const &hmd,
+                                        float extraEyeRotationInRadians /*= OVR_DEFAULT_EXTRA_EYE_ROTATION*/ )
+{
+    FovCacheKey key;
+    key.pCustomDistortion           = CustomDistortion;
+    key.pCustomDistortionInv        = CustomDistortionInv;
+    key.Hmd                         = hmd;
+    key.Distortion                  = distortion;
+    key.EyeType                     = eyeType;
+    key.ExtraEyeRotationInRadians   = extraEyeRotationInRadians;
+
+    FovPort result;
+    if ( !FovCache.Find ( key, &result ) )
+    {
+        result = CalculateFovFromHmdInfo ( eyeType, distortion, hmd, extraEyeRotationInRadians );
+        FovCache.Insert ( key, result );
+    }
+    return result;
+}
+
+FovPort CachedGetPhysicalScreenFov ( StereoEye eyeType, DistortionRenderDesc const &distortion )
+{
+    PhysicalScreenFovCacheKey key;
+    key.pCustomDistortion       = CustomDistortion;
+    key.pCustomDistortionInv    = CustomDistortionInv;
+    key.Distortion              = distortion;
+    key.EyeType                 = eyeType;
+
+    FovPort result;
+    if ( !PhysicalScreenFovCache.Find ( key, &result ) )
+    {
+        result = GetPhysicalScreenFov ( eyeType, distortion );
+        PhysicalScreenFovCache.Insert ( key, result );
+    }
+    return result;
+}
+
+void SetStereoCacheCapacity ( int capacity )
+{
+    Lock::Locker locker ( &StereoCacheLock );
+    StereoCacheCapacity = Alg::Clamp ( capacity, 0, (int)StereoCacheMaxCapacity );
+    LensConfigCache.Trim ( StereoCacheCapacity );
+    FovCache.Trim ( StereoCacheCapacity );
+    PhysicalScreenFovCache.Trim ( StereoCacheCapacity );
+}
+
+StereoCacheStats GetStereoCacheStats ( )
+{
+    Lock::Locker locker ( &StereoCacheLock );
+    StereoCacheStats stats;
+    stats.Capacity          = StereoCacheCapacity;
+    stats.LensConfig        = LensConfigCache.Counters;
+    stats.Fov               = FovCache.Counters;
+    stats.PhysicalScreenFov = PhysicalScreenFovCache.Counters;
+    return stats;
+}
+
+void ClearStereoCache ( )
+{
+    Lock::Locker locker ( &StereoCacheLock );
+    LensConfigCache.Clear();
+    FovCache.Clear();
+    PhysicalScreenFovCache.Clear();
+}
+
+
 
 } //namespace OVR
 
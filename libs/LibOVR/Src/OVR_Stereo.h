@@ -31,6 +31,12 @@ limitations under the License.
 #include "Displays/OVR_Display.h"
 #include "OVR_Profile.h"
 
+// Define this to compile-in the lens inverse error and speed check
+//#define OVR_LENS_INVERSE_TEST
+
+// Define this to compile-in the batched lens spline accuracy and speed check
+//#define OVR_LENS_SPLINE_TEST
+
 // CAPI Forward declaration.
 typedef struct ovrFovPort_ ovrFovPort;
 typedef struct ovrRecti_ ovrRecti;
@@ -151,6 +157,19 @@ struct ScaleAndOffset2D
 };
 
 
+//-----------------------------------------------------------------------------------
+// ***** LensRim
+
+// A circle in tan-angle space, where the lens housing starts to block the view.
+struct LensRim
+{
+    Vector2f CenterTan;
+    float    RadiusTan;
+
+    LensRim() : CenterTan(0.0f), RadiusTan(0.0f) { }
+};
+
+
 //-----------------------------------------------------------------------------------
 // ***** Misc. utility functions.
 
@@ -193,6 +212,9 @@ struct LensConfig
     float    DistortionFnScaleRadiusSquared (float rsq) const;
     // x,y,z components map to r,g,b scales.
     Vector3f DistortionFnScaleRadiusSquaredChroma (float rsq) const;
+    // Batched version for count radii at once. With SSE2 or NEON the Catmull-Rom spline is evaluated four
+    // radii at a time; on SSE2 the results are bit-identical to the single radius version.
+    void     DistortionFnScaleRadiusSquaredChroma (Vector3f *pscaleRGB, float const *rsq, int count) const;
 
     // DistortionFn applies distortion to the argument.
     // Input: the distance in TanAngle/NIC space from the optical center to the input pixel.
@@ -202,8 +224,14 @@ struct LensConfig
         return r * DistortionFnScaleRadiusSquared ( r * r );
     }
 
+    // Analytic derivative of DistortionFn.
+    float DistortionFnDerivative(float r) const;
+
     // DistortionFnInverse computes the inverse of the distortion function on an argument.
+    // Uses Newton-Raphson on DistortionFnDerivative, converging in a handful of evaluations.
     float DistortionFnInverse(float r) const;
+    // The original step-halving search. Much slower, kept as a reference for the other inverses.
+    float DistortionFnInverseSearch(float r) const;
 
     // Also computes the inverse, but using a polynomial approximation. Warning - it's just an approximation!
     float DistortionFnInverseApprox(float r) const;
@@ -235,6 +263,43 @@ struct LensConfig
 };
 
 
+// A tabulated DistortionFnInverse for code that inverts the same lens many times over.
+// Samples the exact inverse at evenly spaced radii and interpolates between them with
+// monotone cubic segments. Has to be rebuilt whenever the lens config changes.
+struct LensInverseTable
+{
+    enum { MaxSamples = 256 };
+
+    LensInverseTable() : NumSamples(0), MaxR(0.0f), Step(0.0f) {}
+
+    // maxR is the largest distorted radius you expect to invert; beyond it the
+    // last slope is extended linearly.
+    void  Build(LensConfig const &lens, float maxR, int numSamples = 64);
+    bool  IsValid() const { return NumSamples > 1; }
+    float Evaluate(float r) const;
+
+    int   NumSamples;
+    float MaxR;
+    float Step;
+    float Value[MaxSamples];
+    float Slope[MaxSamples];
+};
+
+#ifdef OVR_LENS_INVERSE_TEST
+// Checks DistortionFnInverse and a LensInverseTable of numSamples against DistortionFnInverseSearch
+// on the debug DK2 lens fitted as CatmullRom10 and as RecipPoly4, and logs how long each inverse takes.
+// Returns false if either inverse misses its error bound.
+bool LensInverseLogReport ( int numSamples = 64 );
+#endif
+
+#ifdef OVR_LENS_SPLINE_TEST
+// Checks the batched DistortionFnScaleRadiusSquaredChroma against the one radius version over numR
+// radii on the debug DK1 and DK2 lenses, from 0 to well past MaxR plus some huge values, and logs
+// how long each takes per radius. Returns false on any difference, except for a few ulps on NEON.
+bool LensSplineLogReport ( int numR = 10000 );
+#endif
+
+
 // For internal use - storing and loading lens config data
 
 // Returns true on success.
@@ -573,6 +638,20 @@ FovPort             CalculateFovFromHmdInfo ( StereoEye eyeType,
                                               HmdRenderInfo const &hmd,
                                               float extraEyeRotationInRadians = OVR_DEFAULT_EXTRA_EYE_ROTATION );
 
+// The edge of a round lens as seen from the pupil with the eye turned by eyeRotationInRadians:
+// a circle in tan-angle space, +X right and +Y down. The eye cannot see past it whichever way it turns.
+// What the eye can see at all, looking straight ahead or turned as far as extraEyeRotationInRadians,
+// is the union of the circles for rotation 0 and for the extra rotation.
+LensRim             CalculateLensRimFromEyePosition ( float eyeReliefInMeters,
+                                                      float offsetToRightInMeters,
+                                                      float offsetDownwardsInMeters,
+                                                      float lensDiameterInMeters,
+                                                      float eyeRotationInRadians = 0.0f );
+
+LensRim             CalculateLensRimFromHmdInfo ( StereoEye eyeType,
+                                                  HmdRenderInfo const &hmd,
+                                                  float eyeRotationInRadians = 0.0f );
+
 FovPort             GetPhysicalScreenFov ( StereoEye eyeType, DistortionRenderDesc const &distortion );
 
 FovPort             ClampToPhysicalScreenFov ( StereoEye eyeType, DistortionRenderDesc const &distortion,
@@ -599,6 +678,54 @@ ScaleAndOffset2D    CreateUVScaleAndOffsetfromNDCScaleandOffset ( ScaleAndOffset
                                                                   Sizei renderTargetSize );
 
 
+//-----------------------------------------------------------------------------------
+// ***** Stereo cache
+
+// GenerateLensConfigFromEyeRelief fits a spline and an inverse polynomial, and the FOV
+// functions invert the distortion dozens of times, so reconfiguring an HMD repeats a lot
+// of work. The Cached versions below return exactly what the plain functions return,
+// remembering the last results in a small process-wide cache. They are thread-safe.
+// Keys hold every input the functions read, including the CustomDistortion hooks.
+
+enum
+{
+    StereoCacheDefaultCapacity  = 16,
+    StereoCacheMaxCapacity      = 64
+};
+
+struct StereoCacheCounters
+{
+    int     Hits;
+    int     Misses;
+    int     Evictions;     // Entries dropped to make room, least recently used first.
+};
+
+struct StereoCacheStats
+{
+    int                 Capacity;           // Entries each kind of result may keep.
+    StereoCacheCounters LensConfig;
+    StereoCacheCounters Fov;
+    StereoCacheCounters PhysicalScreenFov;
+};
+
+LensConfig          CachedGenerateLensConfigFromEyeRelief ( float eyeReliefInMeters, HmdRenderInfo const &hmd,
+                                                            DistortionEqnType distortionType = Distortion_CatmullRom10 );
+
+FovPort             CachedCalculateFovFromHmdInfo ( StereoEye eyeType,
+                                                    DistortionRenderDesc const &distortion,
+                                                    HmdRenderInfo const &hmd,
+                                                    float extraEyeRotationInRadians = OVR_DEFAULT_EXTRA_EYE_ROTATION );
+
+FovPort             CachedGetPhysicalScreenFov ( StereoEye eyeType, DistortionRenderDesc const &distortion );
+
+// Capacity 0 turns the cache off, so the Cached functions just call the plain ones.
+// Lowering the capacity drops the least recently used entries.
+void                SetStereoCacheCapacity ( int capacity );
+StereoCacheStats    GetStereoCacheStats ( );
+// Drops every entry and zeroes the counters. Keeps the capacity.
+void                ClearStereoCache ( );
+
+
 //-----------------------------------------------------------------------------------
 // ***** StereoEyeParams
 
@@ -629,6 +756,9 @@ Vector2f TransformScreenNDCToTanFovSpace ( DistortionRenderDesc const &distortio
 void TransformScreenNDCToTanFovSpaceChroma ( Vector2f *resultR, Vector2f *resultG, Vector2f *resultB, 
                                              DistortionRenderDesc const &distortion,
                                              const Vector2f &framebufferNDC );
+void TransformScreenNDCToTanFovSpaceChroma ( Vector2f *resultR, Vector2f *resultG, Vector2f *resultB, 
+                                             DistortionRenderDesc const &distortion,
+                                             const Vector2f *framebufferNDC, int count );
 Vector2f TransformTanFovSpaceToRendertargetTexUV ( ScaleAndOffset2D const &eyeToSourceUV,
                                                    Vector2f const &tanEyeAngle );
 Vector2f TransformTanFovSpaceToRendertargetNDC ( ScaleAndOffset2D const &eyeToSourceNDC,
@@ -650,6 +780,10 @@ Vector2f TransformScreenPixelToRendertargetTexUV( Recti const &distortionViewpor
 // Be aware that many of these are significantly slower than their forward-mapping counterparts.
 Vector2f TransformTanFovSpaceToScreenNDC( DistortionRenderDesc const &distortion,
                                           const Vector2f &tanEyeAngle, bool usePolyApprox = false );
+// Same, with the inverse read from a table built for distortion.Lens.
+Vector2f TransformTanFovSpaceToScreenNDC( DistortionRenderDesc const &distortion,
+                                          LensInverseTable const &inverseTable,
+                                          const Vector2f &tanEyeAngle );
 Vector2f TransformRendertargetNDCToTanFovSpace( const ScaleAndOffset2D &eyeToSourceNDC,
                                                 const Vector2f &textureNDC );
 
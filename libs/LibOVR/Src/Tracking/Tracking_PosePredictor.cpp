@@ -0,0 +1,655 @@
+/************************************************************************************
+
+Filename    :   Tracking_PosePredictor.cpp
+Content     :   Interchangeable head pose predictors and a harness to compare them
+Created     :   October 17, 2026
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "Tracking_PosePredictor.h"
+#include "../Kernel/OVR_SysFile.h"
+
+#ifdef OVR_POSE_PREDICTOR_TOOL
+#include "../Kernel/OVR_Log.h"
+#include "../Kernel/OVR_System.h"
+#endif
+
+namespace OVR { namespace Tracking {
+
+
+//-------------------------------------------------------------------------------------
+
+// The rotation by the length of rotationVector about its direction. Zero is no rotation.
+static Quatd quatFromRotationVector(const Vector3d& rotationVector)
+{
+	return Quatd(rotationVector, rotationVector.Length());
+}
+
+// The inverse of quatFromRotationVector, taking the short way round. Unlike GetAxisAngle
+// this stays accurate for tiny angles, which is all prediction errors and jitter are.
+static Vector3d rotationVectorFromQuat(const Quatd& q)
+{
+	Vector3d v(q.x, q.y, q.z);
+	double w = q.w;
+	if (w < 0.)
+	{
+		v = -v;
+		w = -w;
+	}
+	double s = v.Length();
+	if (s < 1e-300)
+	{
+		return v * 2.;
+	}
+	return v * (2. * atan2(s, w) / s);
+}
+
+// This is a "perceptually tuned predictive filter", which means that it is optimized
+// for improvements in the VR experience, rather than pure error.  In particular,
+// jitter is more perceptible at lower speeds whereas latency is more perceptible
+// after a high-speed motion.  Therefore, the prediction interval is dynamically
+// adjusted based on speed.  Significant more research is needed to further improve
+// this family of filters.
+Posed CalcPredictedPose(const PoseState<double>& poseState, double predictionDt)
+{
+	Pose<double> pose = poseState.ThePose;
+	Vector3d angularVelocity = poseState.AngularVelocity;
+	double angularSpeed = angularVelocity.Length();
+
+	double speed = angularSpeed + PredictionLinearCoef * poseState.LinearVelocity.Length();
+
+	double candidateDt = PredictionSlope * speed; // TODO: Replace with smoothstep function
+
+	double dynamicDt = predictionDt;
+
+	// Choose the candidate if it is shorter, to improve stability
+	if (candidateDt < predictionDt)
+	{
+		dynamicDt = candidateDt;
+	}
+
+	if (angularSpeed > 0.001)
+	{
+		pose.Rotation = pose.Rotation * Quatd(angularVelocity, angularSpeed * dynamicDt);
+	}
+
+	pose.Translation += poseState.LinearVelocity * dynamicDt;
+
+	return pose;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Predictors
+
+Posed PerceptualPosePredictor::Predict(const PoseState<double>& worldFromImu, double predictionDt) const
+{
+	return CalcPredictedPose(worldFromImu, predictionDt);
+}
+
+Posed ConstantAccelerationPosePredictor::Predict(const PoseState<double>& worldFromImu, double predictionDt) const
+{
+	double dt = predictionDt;
+	double halfDt2 = 0.5 * AccelerationGain * dt * dt;
+
+	Posed pose = worldFromImu.ThePose;
+	pose.Rotation = pose.Rotation * quatFromRotationVector(worldFromImu.AngularVelocity * dt +
+	                                                       worldFromImu.AngularAcceleration * halfDt2);
+	pose.Translation += worldFromImu.LinearVelocity * dt + worldFromImu.LinearAcceleration * halfDt2;
+	return pose;
+}
+
+
+// A gap this long means tracking was lost or nobody was reading; start the filter over.
+static const double AlphaBetaResetInterval = 0.25;
+
+AlphaBetaPosePredictor::AlphaBetaPosePredictor(double alpha, double beta) :
+	Alpha(alpha),
+	Beta(beta),
+	Initialized(false),
+	LastTime(0.)
+{
+}
+
+void AlphaBetaPosePredictor::Observe(const PoseState<double>& worldFromImu)
+{
+	Lock::Locker locker(&FilterLock);
+
+	double dt = worldFromImu.TimeInSeconds - LastTime;
+	if (Initialized && dt <= 0.)
+	{
+		return;
+	}
+
+	if (!Initialized || dt > AlphaBetaResetInterval)
+	{
+		AngularVelocity     = worldFromImu.AngularVelocity;
+		LinearVelocity      = worldFromImu.LinearVelocity;
+		AngularAcceleration = Vector3d();
+		LinearAcceleration  = Vector3d();
+		LastTime    = worldFromImu.TimeInSeconds;
+		Initialized = true;
+		return;
+	}
+
+	// The velocities are what is measured, the accelerations their rates of change.
+	Vector3d angularResidual = worldFromImu.AngularVelocity - (AngularVelocity + AngularAcceleration * dt);
+	Vector3d linearResidual  = worldFromImu.LinearVelocity - (LinearVelocity + LinearAcceleration * dt);
+	AngularVelocity     += AngularAcceleration * dt + angularResidual * Alpha;
+	LinearVelocity      += LinearAcceleration * dt + linearResidual * Alpha;
+	AngularAcceleration += angularResidual * (Beta / dt);
+	LinearAcceleration  += linearResidual * (Beta / dt);
+	LastTime = worldFromImu.TimeInSeconds;
+}
+
+Posed AlphaBetaPosePredictor::Predict(const PoseState<double>& worldFromImu, double predictionDt) const
+{
+	// Nothing observed yet predicts constant velocity
+	Vector3d angularAcceleration, linearAcceleration;
+	{
+		Lock::Locker locker(&FilterLock);
+		if (Initialized)
+		{
+			angularAcceleration = AngularAcceleration;
+			linearAcceleration  = LinearAcceleration;
+		}
+	}
+
+	double dt = predictionDt;
+	double halfDt2 = 0.5 * dt * dt;
+
+	Posed pose = worldFromImu.ThePose;
+	pose.Rotation = pose.Rotation * quatFromRotationVector(worldFromImu.AngularVelocity * dt + angularAcceleration * halfDt2);
+	pose.Translation += worldFromImu.LinearVelocity * dt + linearAcceleration * halfDt2;
+	return pose;
+}
+
+void AlphaBetaPosePredictor::Reset()
+{
+	Lock::Locker locker(&FilterLock);
+	Initialized = false;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Pose traces
+
+static const char     PoseTraceMagic[8] = { 'O', 'V', 'R', 'P', 'O', 'S', 'E', 'T' };
+static const uint32_t PoseTraceVersion  = 1;
+
+struct PoseTraceHeader
+{
+	char     Magic[8];
+	uint32_t Version;
+	uint32_t StateSize;
+	uint32_t Count;
+	uint32_t Reserved;
+};
+
+bool SavePoseTrace(const char* path, const PoseState<double>* trace, int count)
+{
+	SysFile f;
+	if (!f.Open(path, File::Open_Write | File::Open_Create | File::Open_Truncate, File::Mode_Write))
+	{
+		return false;
+	}
+
+	PoseTraceHeader header;
+	memcpy(header.Magic, PoseTraceMagic, sizeof(header.Magic));
+	header.Version   = PoseTraceVersion;
+	header.StateSize = sizeof(PoseState<double>);
+	header.Count     = (uint32_t)count;
+	header.Reserved  = 0;
+
+	int stateBytes = count * (int)sizeof(PoseState<double>);
+	bool ok = (f.Write((const uint8_t*)&header, sizeof(header)) == (int)sizeof(header)) &&
+	          (f.Write((const uint8_t*)trace, stateBytes) == stateBytes);
+	f.Close();
+	return ok;
+}
+
+bool LoadPoseTrace(const char* path, Array< PoseState<double> >& trace)
+{
+	trace.Clear();
+
+	SysFile f;
+	if (!f.Open(path, File::Open_Read, File::Mode_Read))
+	{
+		return false;
+	}
+
+	PoseTraceHeader header;
+	bool ok = (f.Read((uint8_t*)&header, sizeof(header)) == (int)sizeof(header)) &&
+	          (memcmp(header.Magic, PoseTraceMagic, sizeof(header.Magic)) == 0) &&
+	          (header.Version == PoseTraceVersion) &&
+	          (header.StateSize == sizeof(PoseState<double>)) &&
+	          (f.GetLength() - (int)sizeof(header) == (int)(header.Count * sizeof(PoseState<double>)));
+	if (ok && header.Count > 0)
+	{
+		trace.Resize(header.Count);
+		int stateBytes = (int)(header.Count * sizeof(PoseState<double>));
+		ok = (f.Read((uint8_t*)&trace[0], stateBytes) == stateBytes);
+	}
+	f.Close();
+
+	if (!ok)
+	{
+		trace.Clear();
+	}
+	return ok;
+}
+
+void PoseTraceRecorder::Update(const CombinedSharedStateUpdater* state, const PoseHistoryUpdater* history)
+{
+	if (history)
+	{
+		PoseState<double> before, after;
+		if (Trace.GetSize() == 0)
+		{
+			// Start from the oldest pose kept
+			if (!history->GetPosesAround(-1e300, before, after))
+			{
+				return;
+			}
+			Trace.PushBack(before);
+		}
+
+		for (;;)
+		{
+			double lastTime = Trace.Back().TimeInSeconds;
+			if (!history->GetPosesAround(lastTime, before, after))
+			{
+				break;
+			}
+
+			if (before.TimeInSeconds > lastTime)
+			{
+				// The history wrapped since the last Update, so some poses are missing
+				Trace.PushBack(before);
+			}
+			else if (after.TimeInSeconds > lastTime)
+			{
+				Trace.PushBack(after);
+			}
+			else
+			{
+				break;
+			}
+		}
+	}
+	else if (state)
+	{
+		PoseState<double> latest = state->SharedSensorState.GetState().WorldFromImu;
+		if (Trace.GetSize() == 0 || latest.TimeInSeconds > Trace.Back().TimeInSeconds)
+		{
+			Trace.PushBack(latest);
+		}
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Scripted motion
+
+static Posed scriptedPose(double absoluteTime)
+{
+	double t = absoluteTime;
+
+	// Looking around
+	double yaw   = 0.6 * sin(MATH_DOUBLE_TWOPI * 0.23 * t) + 0.3 * sin(MATH_DOUBLE_TWOPI * 0.61 * t + 1.0);
+	double pitch = 0.25 * sin(MATH_DOUBLE_TWOPI * 0.37 * t + 0.5);
+	double roll  = 0.05 * sin(MATH_DOUBLE_TWOPI * 0.9 * t);
+
+	// A 3 Hz head shake for 0.6 s every 4 s, eased in and out so that it stays smooth
+	const double shakePeriod = 4.0, shakeLength = 0.6;
+	double shakeTime = fmod(t, shakePeriod);
+	if (shakeTime < 0.)
+	{
+		shakeTime += shakePeriod;
+	}
+	if (shakeTime < shakeLength)
+	{
+		double ease = sin(MATH_DOUBLE_PI * shakeTime / shakeLength);
+		yaw += 0.25 * ease * ease * sin(MATH_DOUBLE_TWOPI * 3.0 * shakeTime);
+	}
+
+	Quatd rotation = Quatd(Axis_Y, yaw) * Quatd(Axis_X, pitch) * Quatd(Axis_Z, roll);
+
+	// Swaying, with the eyes turning about the neck
+	Vector3d neckToEye(0.0, 0.15, -0.08);
+	Vector3d translation(0.05 * sin(MATH_DOUBLE_TWOPI * 0.3 * t),
+	                     0.02 * sin(MATH_DOUBLE_TWOPI * 0.5 * t + 1.0),
+	                     0.03 * sin(MATH_DOUBLE_TWOPI * 0.2 * t));
+	return Posed(rotation, translation + rotation.Rotate(neckToEye));
+}
+
+// Angular velocity in the frame CalcPredictedPose applies it in, and linear velocity.
+static void scriptedVelocities(double absoluteTime, Vector3d& angularVelocity, Vector3d& linearVelocity)
+{
+	const double h = 1e-4;
+	Posed before = scriptedPose(absoluteTime - h);
+	Posed after  = scriptedPose(absoluteTime + h);
+	angularVelocity = rotationVectorFromQuat(before.Rotation.Inverted() * after.Rotation) / (2. * h);
+	linearVelocity  = (after.Translation - before.Translation) / (2. * h);
+}
+
+PoseState<double> ScriptedPoseState(double absoluteTime)
+{
+	PoseState<double> state(scriptedPose(absoluteTime), absoluteTime);
+	scriptedVelocities(absoluteTime, state.AngularVelocity, state.LinearVelocity);
+
+	const double h = 1e-3;
+	Vector3d angularBefore, linearBefore, angularAfter, linearAfter;
+	scriptedVelocities(absoluteTime - h, angularBefore, linearBefore);
+	scriptedVelocities(absoluteTime + h, angularAfter, linearAfter);
+	state.AngularAcceleration = (angularAfter - angularBefore) / (2. * h);
+	state.LinearAcceleration  = (linearAfter - linearBefore) / (2. * h);
+	return state;
+}
+
+// Roughly normal, zero mean and unit deviation, from a sum of uniforms.
+static double noiseSample(uint32_t& seed)
+{
+	double sum = 0.;
+	for (int i = 0; i < 4; i++)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		sum += (double)(seed >> 8) / (double)(1 << 24);
+	}
+	return (sum - 2.) * 1.7320508;
+}
+
+static Vector3d noiseVector(uint32_t& seed, double deviation)
+{
+	double x = noiseSample(seed);
+	double y = noiseSample(seed);
+	double z = noiseSample(seed);
+	return Vector3d(x, y, z) * deviation;
+}
+
+void AddSensorNoise(PoseState<double>& state, uint32_t& seed)
+{
+	// Gyro noise, and the noise of velocity from the accelerometer and camera; the
+	// accelerations are differences of those and noisier still.
+	const double angularVelocityNoise     = 0.02;
+	const double linearVelocityNoise      = 0.01;
+	const double angularAccelerationNoise = 10.0;
+	const double linearAccelerationNoise  = 3.0;
+
+	state.AngularVelocity     += noiseVector(seed, angularVelocityNoise);
+	state.LinearVelocity      += noiseVector(seed, linearVelocityNoise);
+	state.AngularAcceleration += noiseVector(seed, angularAccelerationNoise);
+	state.LinearAcceleration  += noiseVector(seed, linearAccelerationNoise);
+}
+
+void MakeScriptedPoseTrace(Array< PoseState<double> >& trace, double startTime, double seconds, bool sensorNoise)
+{
+	int count = (int)(seconds * 1000.);
+	trace.Resize(count);
+	uint32_t seed = 12345;
+	for (int i = 0; i < count; i++)
+	{
+		trace[i] = ScriptedPoseState(startTime + i * 0.001);
+		if (sensorNoise)
+		{
+			AddSensorNoise(trace[i], seed);
+		}
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Evaluation
+
+// The pose at absoluteTime, interpolated between the trace states either side of it.
+// index is where the search starts and is left at the state before, so a series of
+// increasing times walks the trace once.
+static Posed traceTruthAt(const PoseState<double>* trace, int count, int& index, double absoluteTime)
+{
+	while (index + 1 < count && trace[index + 1].TimeInSeconds <= absoluteTime)
+	{
+		index++;
+	}
+	if (index + 1 >= count)
+	{
+		return trace[count - 1].ThePose;
+	}
+
+	const PoseState<double>& before = trace[index];
+	const PoseState<double>& after  = trace[index + 1];
+	double span = after.TimeInSeconds - before.TimeInSeconds;
+	double f = (span > 0.) ? (absoluteTime - before.TimeInSeconds) / span : 0.;
+
+	Vector3d turn = rotationVectorFromQuat(before.ThePose.Rotation.Inverted() * after.ThePose.Rotation);
+	return Posed(before.ThePose.Rotation * quatFromRotationVector(turn * f),
+	             before.ThePose.Translation.Lerp(after.ThePose.Translation, f));
+}
+
+void EvaluatePosePredictor(PosePredictor* predictor, const PoseState<double>* trace, int count, double frameRate,
+                           const double* horizons, int numHorizons, PosePredictorScore* scores)
+{
+	if (numHorizons <= 0)
+	{
+		return;
+	}
+
+	// Per horizon: where its truth lookup is, and the previous frame's error for jitter
+	Array<int>      truthIndex;
+	Array<Quatd>    lastAngleError;
+	Array<Vector3d> lastDistanceError;
+	truthIndex.Resize(numHorizons);
+	lastAngleError.Resize(numHorizons);
+	lastDistanceError.Resize(numHorizons);
+
+	for (int h = 0; h < numHorizons; h++)
+	{
+		PosePredictorScore& score = scores[h];
+		score.Horizon        = horizons[h];
+		score.NumFrames      = 0;
+		score.RmsAngle       = 0.;
+		score.MaxAngle       = 0.;
+		score.AngleJitter    = 0.;
+		score.RmsDistance    = 0.;
+		score.DistanceJitter = 0.;
+		truthIndex[h] = 0;
+	}
+
+	if (predictor)
+	{
+		predictor->Reset();
+	}
+
+	if (count < 2 || frameRate <= 0.)
+	{
+		return;
+	}
+
+	int latest = 0;
+	for (int frame = 0; ; frame++)
+	{
+		double frameTime = trace[0].TimeInSeconds + frame / frameRate;
+		while (latest + 1 < count && trace[latest + 1].TimeInSeconds <= frameTime)
+		{
+			latest++;
+		}
+
+		const PoseState<double>& state = trace[latest];
+		if (predictor)
+		{
+			predictor->Observe(state);
+		}
+
+		bool pastEnd = false;
+		for (int h = 0; h < numHorizons; h++)
+		{
+			double targetTime = frameTime + horizons[h];
+			if (targetTime > trace[count - 1].TimeInSeconds)
+			{
+				pastEnd = true;
+				break;
+			}
+
+			double pdt = Alg::Clamp(targetTime - state.TimeInSeconds, 0., MaxPredictionDt);
+			Posed predicted = predictor ? predictor->Predict(state, pdt) : CalcPredictedPose(state, pdt);
+			Posed truth = traceTruthAt(trace, count, truthIndex[h], targetTime);
+
+			Quatd angleError = truth.Rotation.Inverted() * predicted.Rotation;
+			Vector3d distanceError = predicted.Translation - truth.Translation;
+			double angle = rotationVectorFromQuat(angleError).Length();
+			double distance = distanceError.Length();
+
+			PosePredictorScore& score = scores[h];
+			score.RmsAngle    += angle * angle;
+			score.MaxAngle     = Alg::Max(score.MaxAngle, angle);
+			score.RmsDistance += distance * distance;
+			if (score.NumFrames > 0)
+			{
+				double angleChange = rotationVectorFromQuat(lastAngleError[h].Inverted() * angleError).Length();
+				double distanceChange = (distanceError - lastDistanceError[h]).Length();
+				score.AngleJitter    += angleChange * angleChange;
+				score.DistanceJitter += distanceChange * distanceChange;
+			}
+			lastAngleError[h] = angleError;
+			lastDistanceError[h] = distanceError;
+			score.NumFrames++;
+		}
+		if (pastEnd)
+		{
+			break;
+		}
+	}
+
+	for (int h = 0; h < numHorizons; h++)
+	{
+		PosePredictorScore& score = scores[h];
+		if (score.NumFrames > 0)
+		{
+			score.RmsAngle    = sqrt(score.RmsAngle / score.NumFrames);
+			score.RmsDistance = sqrt(score.RmsDistance / score.NumFrames);
+		}
+		if (score.NumFrames > 1)
+		{
+			score.AngleJitter    = sqrt(score.AngleJitter / (score.NumFrames - 1));
+			score.DistanceJitter = sqrt(score.DistanceJitter / (score.NumFrames - 1));
+		}
+	}
+}
+
+#ifdef OVR_POSE_PREDICTOR_TOOL
+bool PosePredictorLogReport(const char* tracePath, double frameRate)
+{
+	Array< PoseState<double> > trace;
+	if (tracePath)
+	{
+		if (!LoadPoseTrace(tracePath, trace) || trace.GetSize() < 2)
+		{
+			LogText("PosePredictor - could not read a pose trace from %s\n", tracePath);
+			return false;
+		}
+	}
+	else
+	{
+		MakeScriptedPoseTrace(trace, 0., 20., true);
+	}
+
+	struct Candidate
+	{
+		const char*         Label;
+		Ptr<PosePredictor>  Predictor;
+	};
+	Candidate candidates[5];
+	candidates[0].Label = "perceptual (default)";
+	candidates[1].Label = "constant velocity";
+	candidates[1].Predictor = *new ConstantAccelerationPosePredictor(0.0);
+	candidates[2].Label = "constant acceleration";
+	candidates[2].Predictor = *new ConstantAccelerationPosePredictor();
+	candidates[3].Label = "alpha-beta 0.5 0.4";
+	candidates[3].Predictor = *new AlphaBetaPosePredictor();
+	candidates[4].Label = "alpha-beta 0.5 0.1";
+	candidates[4].Predictor = *new AlphaBetaPosePredictor(0.5, 0.1);
+
+	const double horizons[] = { 0.010, 0.020, 0.030, 0.040, 0.050, 0.060 };
+	const int    numHorizons = sizeof(horizons) / sizeof(horizons[0]);
+	PosePredictorScore scores[numHorizons];
+
+	LogText("PosePredictor - %s, %d states over %.1f s, read at %.0f Hz\n",
+	        tracePath ? tracePath : "scripted motion with sensor noise", (int)trace.GetSize(),
+	        trace.Back().TimeInSeconds - trace[0].TimeInSeconds, frameRate);
+	LogText("predictor              horizon  rms deg  max deg  jitter deg  rms mm  jitter mm\n");
+	for (int c = 0; c < (int)(sizeof(candidates) / sizeof(candidates[0])); c++)
+	{
+		EvaluatePosePredictor(candidates[c].Predictor, &trace[0], (int)trace.GetSize(), frameRate,
+		                      horizons, numHorizons, scores);
+		for (int h = 0; h < numHorizons; h++)
+		{
+			const PosePredictorScore& score = scores[h];
+			LogText("%-21s  %4.0f ms  %7.3f  %7.3f  %10.4f  %6.2f  %9.3f\n",
+			        (h == 0) ? candidates[c].Label : "", score.Horizon * 1000.,
+			        RadToDegree(score.RmsAngle), RadToDegree(score.MaxAngle), RadToDegree(score.AngleJitter),
+			        score.RmsDistance * 1000., score.DistanceJitter * 1000.);
+		}
+	}
+	return true;
+}
+#endif // OVR_POSE_PREDICTOR_TOOL
+
+
+}} // namespace OVR::Tracking
+
+
+#ifdef OVR_POSE_PREDICTOR_TOOL
+
+// Replays each trace given through every predictor, or scripted motion if there are none.
+// -fps sets how often the simulated game reads the state.
+int main(int argc, const char* argv[])
+{
+	OVR::System::Init(OVR::Log::ConfigureDefaultLog(OVR::LogMask_All));
+
+	double frameRate = 75.0;
+	for (int i = 1; i + 1 < argc; i++)
+	{
+		if (strcmp(argv[i], "-fps") == 0)
+		{
+			frameRate = atof(argv[i + 1]);
+		}
+	}
+
+	int  numTraces = 0;
+	bool ok = true;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-fps") == 0)
+		{
+			i++;
+			continue;
+		}
+		ok = OVR::Tracking::PosePredictorLogReport(argv[i], frameRate) && ok;
+		numTraces++;
+	}
+	if (numTraces == 0)
+	{
+		ok = OVR::Tracking::PosePredictorLogReport(NULL, frameRate);
+	}
+
+	OVR::System::Destroy();
+	return ok ? 0 : 1;
+}
+
+#endif // OVR_POSE_PREDICTOR_TOOL
@@ -0,0 +1,199 @@
+/************************************************************************************
+
+Filename    :   Tracking_PosePredictor.h
+Content     :   Interchangeable head pose predictors and a harness to compare them
+Created     :   October 17, 2026
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#ifndef Tracking_PosePredictor_h
+#define Tracking_PosePredictor_h
+
+#include "../Kernel/OVR_RefCount.h"
+#include "../Kernel/OVR_Atomic.h"
+#include "../Kernel/OVR_Array.h"
+#include "Tracking_PoseState.h"
+#include "Tracking_SensorState.h"
+
+// Define this to compile-in PosePredictorLogReport, and a main() that runs it on pose traces
+//#define OVR_POSE_PREDICTOR_TOOL
+
+namespace OVR { namespace Tracking {
+
+
+//-----------------------------------------------------------------------------
+// ***** Prediction limits
+
+// This could be tuned so that linear and angular are combined with different coefficients
+static const double PredictionLinearCoef = 1.0;
+// The rate at which the dynamic prediction interval varies
+static const double PredictionSlope = 0.2;
+// Longest interval predicted over
+static const double MaxPredictionDt = 0.1;
+
+// The default, "perceptually tuned" prediction: constant velocity over an interval that
+// shrinks at low speeds, where jitter shows more than latency.
+Posed CalcPredictedPose(const PoseState<double>& poseState, double predictionDt);
+
+
+//-----------------------------------------------------------------------------
+// ***** PosePredictor
+
+// Predicts where the IMU will be a short time after a sensor state was sampled.
+// SensorStateReader shows each predictor every state it reads before asking it to predict
+// from that state, so predictors that filter over time can keep up.
+class PosePredictor : public RefCountBase<PosePredictor>
+{
+public:
+    virtual ~PosePredictor() { }
+
+    virtual const char* GetName() const = 0;
+
+    // Called with every state read; a state with a time already seen is a repeat.
+    virtual void        Observe(const PoseState<double>& worldFromImu) { OVR_UNUSED(worldFromImu); }
+
+    // The pose predictionDt seconds after worldFromImu was sampled, with predictionDt
+    // already clamped to [0, MaxPredictionDt].
+    virtual Posed       Predict(const PoseState<double>& worldFromImu, double predictionDt) const = 0;
+
+    // Forgets everything Observe has seen, such as after recentering or a tracking loss.
+    virtual void        Reset() { }
+};
+
+
+// CalcPredictedPose, the default. SensorStateReader uses it without one being set, and
+// then GetPosesAtTimes can batch it.
+class PerceptualPosePredictor : public PosePredictor
+{
+public:
+    virtual const char* GetName() const { return "perceptual"; }
+    virtual Posed       Predict(const PoseState<double>& worldFromImu, double predictionDt) const;
+};
+
+
+// Second order: extrapolates with the velocities and accelerations in the sensor state
+// over the whole interval. Accelerations are differentiated from noisy sensors, so this
+// is the most responsive predictor and the most jittery.
+class ConstantAccelerationPosePredictor : public PosePredictor
+{
+public:
+    // accelerationGain scales the accelerations, 0 gives plain constant velocity.
+    ConstantAccelerationPosePredictor(double accelerationGain = 1.0) : AccelerationGain(accelerationGain) { }
+
+    virtual const char* GetName() const { return "constant acceleration"; }
+    virtual Posed       Predict(const PoseState<double>& worldFromImu, double predictionDt) const;
+
+    double AccelerationGain;
+};
+
+
+// Constant acceleration with the accelerations estimated by an alpha-beta filter over the
+// measured velocities, rather than taken from the sensor state. Alpha is how far each
+// observation pulls the filtered velocity, beta how far it pulls the acceleration; lower
+// is smoother and lags more. The defaults are tuned with PosePredictorLogReport for
+// observations at 60 to 90 Hz, which is how often a game reads the state.
+class AlphaBetaPosePredictor : public PosePredictor
+{
+public:
+    AlphaBetaPosePredictor(double alpha = 0.5, double beta = 0.4);
+
+    virtual const char* GetName() const { return "alpha-beta"; }
+    virtual void        Observe(const PoseState<double>& worldFromImu);
+    virtual Posed       Predict(const PoseState<double>& worldFromImu, double predictionDt) const;
+    virtual void        Reset();
+
+    double Alpha;
+    double Beta;
+
+private:
+    mutable Lock FilterLock;
+    bool         Initialized;
+    double       LastTime;
+    Vector3d     AngularVelocity;
+    Vector3d     AngularAcceleration;
+    Vector3d     LinearVelocity;
+    Vector3d     LinearAcceleration;
+};
+
+
+//-----------------------------------------------------------------------------
+// ***** Pose traces
+
+// A pose trace is the sensor states the service published, oldest first. They are saved
+// as raw PoseState<double>s behind a small header, so only read them on the kind of
+// machine that wrote them.
+bool SavePoseTrace(const char* path, const PoseState<double>* trace, int count);
+bool LoadPoseTrace(const char* path, Array< PoseState<double> >& trace);
+
+// Copies the states the service publishes into a trace. With a pose history every state is
+// kept, as long as Update is called before the history wraps (every 100 ms will do);
+// without one only the latest state at each Update is, so call it as often as possible.
+class PoseTraceRecorder
+{
+public:
+    void Update(const CombinedSharedStateUpdater* state, const PoseHistoryUpdater* history);
+    void Clear() { Trace.Clear(); }
+
+    Array< PoseState<double> > Trace;
+};
+
+// A head looking around, nodding and swaying, with a short fast head shake every few
+// seconds. Velocities and accelerations are the exact derivatives, in the frames the
+// predictors take them in.
+PoseState<double> ScriptedPoseState(double absoluteTime);
+
+// Makes the velocities and accelerations about as noisy as the DK2's are. seed is any
+// number to start with, and is updated for the next call.
+void AddSensorNoise(PoseState<double>& state, uint32_t& seed);
+
+// seconds of ScriptedPoseState at 1000 Hz, starting at startTime, optionally with AddSensorNoise.
+void MakeScriptedPoseTrace(Array< PoseState<double> >& trace, double startTime, double seconds, bool sensorNoise);
+
+
+//-----------------------------------------------------------------------------
+// ***** Evaluation
+
+struct PosePredictorScore
+{
+    double  Horizon;            // How far ahead the poses were predicted, in seconds.
+    int     NumFrames;
+    double  RmsAngle;           // Angle between predicted and actual orientation, radians.
+    double  MaxAngle;
+    double  AngleJitter;        // RMS of how much that error changes from frame to frame.
+    double  RmsDistance;        // Same for position, in meters.
+    double  DistanceJitter;
+};
+
+// Replays a trace the way a game running at frameRate would see it: each frame the predictor
+// observes the latest state and predicts every horizon ahead of the frame, which is compared
+// against the trace at that time. predictor may be NULL for the default.
+void EvaluatePosePredictor(PosePredictor* predictor, const PoseState<double>* trace, int count, double frameRate,
+                           const double* horizons, int numHorizons, PosePredictorScore* scores);
+
+#ifdef OVR_POSE_PREDICTOR_TOOL
+// Logs the scores of every predictor at 10 to 60 ms for the trace at tracePath, or for a noisy
+// scripted trace if it is NULL. Returns false if the trace could not be read.
+bool PosePredictorLogReport(const char* tracePath = NULL, double frameRate = 75.0);
+#endif
+
+
+}} // namespace OVR::Tracking
+
+#endif // Tracking_PosePredictor_h
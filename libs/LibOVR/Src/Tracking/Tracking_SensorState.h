@@ -191,12 +191,16 @@ inline LocklessSensorState& LocklessSensorState::operator = (const LocklessSenso
 
 #pragma pack(pop)
 
-// A lockless updater for sensor state
-typedef LocklessUpdater<LocklessSensorState, LocklessSensorStatePadding> SensorStateUpdater;
+// A lockless updater for sensor state, laid out the way the service writes it
+typedef CompatibleLocklessUpdater<LocklessSensorState, LocklessSensorStatePadding> SensorStateUpdater;
 
 
 //// Combined state
 
+// What the tracking service publishes. Its layout is the same as before LocklessUpdater
+// became a padded seqlock: both members stay on CompatibleLocklessUpdater, and the region
+// stays open read-write to other processes, so services and clients of any 0.4 release
+// still work with this one.
 struct CombinedSharedStateUpdater
 {
     SensorStateUpdater         SharedSensorState;
@@ -207,6 +211,94 @@ typedef SharedObjectWriter< CombinedSharedStateUpdater > CombinedSharedStateWrit
 typedef SharedObjectReader< CombinedSharedStateUpdater > CombinedSharedStateReader;
 
 
+//// Pose history
+
+#pragma pack(push, 8)
+
+// The most recent IMU poses, so that a reader can look up where the head was at a time
+// that has already passed (a scanline that went out, the frame that was rendered)
+// instead of being handed the latest pose for it.
+//
+// There is one writer, which appends every pose it also puts in SharedSensorState.
+// Readers copy out the entries they need and then check that the writer has not come
+// round the ring to them, the same way CompatibleLocklessUpdater checks its slots.
+// The counters are on their own cache line, so readers polling them do not slow the
+// writer's stores to the slots.
+//
+// It lives in its own shared region, named after the combined state's with
+// PoseHistorySharedMemorySuffix appended, so that readers still open the combined state
+// of a service that does not publish a history.
+class PoseHistoryUpdater
+{
+public:
+    // 128 ms of 1000 Hz IMU updates. Must be a power of two.
+    enum { Capacity = 128 };
+
+    PoseHistoryUpdater() : UpdateBegin(0), UpdateEnd(0)
+    {
+        OVR_COMPILER_ASSERT((Capacity & (Capacity - 1)) == 0);
+    }
+
+    // Appends a pose. Times must not go backwards.
+    void AddPose(const PoseState<double>& pose)
+    {
+        const uint32_t index = UpdateBegin.ExchangeAdd_Sync(1);
+        Slots[index & (Capacity - 1)] = pose;
+        UpdateEnd.ExchangeAdd_Sync(1);
+    }
+
+    // Finds the entries either side of absoluteTime, with before.TimeInSeconds <= absoluteTime <=
+    // after.TimeInSeconds. Past the newest entry both are the newest, before the oldest both are
+    // the oldest. Returns false if nothing has been added yet.
+    bool GetPosesAround(double absoluteTime, PoseState<double>& before, PoseState<double>& after) const
+    {
+        for(;;)
+        {
+            const uint32_t end = UpdateEnd.Load_Acquire();
+            if (end == 0)
+            {
+                return false;
+            }
+
+            // Walk back from the newest entry. The writer may already be overwriting the oldest.
+            const uint32_t count = (end < (uint32_t)Capacity) ? end : (uint32_t)Capacity - 1;
+            uint32_t index = end - 1;
+            for (uint32_t walked = 1; walked < count; walked++, index--)
+            {
+                if (Slots[index & (Capacity - 1)].TimeInSeconds <= absoluteTime)
+                {
+                    break;
+                }
+            }
+            before = Slots[index & (Capacity - 1)];
+            after  = (before.TimeInSeconds <= absoluteTime && index + 1 != end) ? Slots[(index + 1) & (Capacity - 1)] : before;
+
+            LocklessLoadFence();
+
+            // Entries older than this may have been written over while we were copying.
+            const uint32_t begin = UpdateBegin.Load_Acquire();
+            if ((int32_t)(index - (begin - (uint32_t)Capacity)) >= 0)
+            {
+                return true;
+            }
+        }
+    }
+
+    AtomicInt<uint32_t> UpdateBegin;
+    AtomicInt<uint32_t> UpdateEnd;
+    char                CounterPadding[LocklessCacheLineSize];
+    PoseState<double>   Slots[Capacity];
+};
+
+#pragma pack(pop)
+
+static const char PoseHistorySharedMemorySuffix[] = ".PoseHistory";
+
+// Every reader of the history only loads, so other processes get read-only access.
+typedef SharedObjectWriter< PoseHistoryUpdater, SharedMemory::RemoteMode_ReadOnly > PoseHistoryWriter;
+typedef SharedObjectReader< PoseHistoryUpdater, SharedMemory::RemoteMode_ReadOnly > PoseHistoryReader;
+
+
 }} // namespace OVR::Tracking
 
 #endif
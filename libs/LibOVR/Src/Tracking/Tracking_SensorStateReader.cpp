@@ -27,46 +27,270 @@ limitations under the License.
 #include "Tracking_SensorStateReader.h"
 #include "Tracking_PoseState.h"
 
+// The batched prediction runs four times side by side.
+#if defined(OVR_CPU_SSE) && ( defined(__SSE2__) || defined(_M_AMD64) || ( defined(_M_IX86_FP) && ( _M_IX86_FP >= 2 ) ) )
+    #define OVR_TRACKING_SSE2
+    #include <emmintrin.h>
+#endif
+
+#ifdef OVR_POSE_HISTORY_TEST
+#include "../Kernel/OVR_Threads.h"
+#include "../Kernel/OVR_Timer.h"
+#include "../Kernel/OVR_Log.h"
+#endif
+
 namespace OVR { namespace Tracking {
 
 
 //-------------------------------------------------------------------------------------
 
-// This is a "perceptually tuned predictive filter", which means that it is optimized
-// for improvements in the VR experience, rather than pure error.  In particular,
-// jitter is more perceptible at lower speeds whereas latency is more perceptible
-// after a high-speed motion.  Therefore, the prediction interval is dynamically
-// adjusted based on speed.  Significant more research is needed to further improve
-// this family of filters.
-static Pose<double> calcPredictedPose(const PoseState<double>& poseState, double predictionDt)
+// Where the IMU was at a time between two recorded poses: the orientation is slerped and
+// everything else lerped. The samples are a millisecond apart, so this is exact to well
+// under what anyone could see.
+static PoseState<double> interpolatePoseState(const PoseState<double>& before, const PoseState<double>& after, double absoluteTime)
 {
-	Pose<double> pose = poseState.ThePose;
-	const double linearCoef = 1.0;
-	Vector3d angularVelocity = poseState.AngularVelocity;
-	double angularSpeed = angularVelocity.Length();
+	double span = after.TimeInSeconds - before.TimeInSeconds;
+	if (span <= 0.)
+	{
+		return before;
+	}
+	double f = (absoluteTime - before.TimeInSeconds) / span;
+
+	// Take the short way round
+	Quatd delta = before.ThePose.Rotation.Inverted() * after.ThePose.Rotation;
+	if (delta.w < 0.)
+	{
+		delta = delta * -1.;
+	}
+
+	PoseState<double> result;
+	result.ThePose.Rotation    = before.ThePose.Rotation * delta.PowNormalized(f);
+	result.ThePose.Translation = before.ThePose.Translation.Lerp(after.ThePose.Translation, f);
+	result.AngularVelocity     = before.AngularVelocity.Lerp(after.AngularVelocity, f);
+	result.LinearVelocity      = before.LinearVelocity.Lerp(after.LinearVelocity, f);
+	result.AngularAcceleration = before.AngularAcceleration.Lerp(after.AngularAcceleration, f);
+	result.LinearAcceleration  = before.LinearAcceleration.Lerp(after.LinearAcceleration, f);
+	result.TimeInSeconds       = absoluteTime;
+	return result;
+}
 
-	// This could be tuned so that linear and angular are combined with different coefficients
-	double speed = angularSpeed + linearCoef * poseState.LinearVelocity.Length();
+// The tracking flags that still apply once the connection flags are taken into account.
+static uint32_t effectiveStatusFlags(uint32_t statusFlags)
+{
+	// If no hardware is connected, override the tracking flags
+	if (0 == (statusFlags & Status_HMDConnected))
+	{
+		statusFlags &= ~Status_TrackingMask;
+	}
+	if (0 == (statusFlags & Status_PositionConnected))
+	{
+		statusFlags &= ~(Status_PositionTracked | Status_CameraPoseTracked);
+	}
+	return statusFlags;
+}
 
-	const double slope = 0.2; // The rate at which the dynamic prediction interval varies
-	double candidateDt = slope * speed; // TODO: Replace with smoothstep function
 
-	double dynamicDt = predictionDt;
+//-------------------------------------------------------------------------------------
 
-	// Choose the candidate if it is shorter, to improve stability
-	if (candidateDt < predictionDt)
+// CalcPredictedPose for many times from one pose, with CenteredFromWorld and ImuFromCpf
+// folded in. Turning by the predicted angle is the quaternion exponential
+// (axis * sin(angle/2), cos(angle/2)), so every result's rotation is cos * RotationCos +
+// sin * RotationSin and its translation a quadratic in the same sine and cosine. What is
+// left for each time is one sine and cosine and a handful of multiply-adds, done in float
+// for four times at once.
+struct PosePredictionKernel
+{
+	double SampleTime;
+	float  CandidateDt;
+	float  HalfAngularSpeed;
+
+	float  RotationCos[4];
+	float  RotationSin[4];
+	float  Translation[3];
+	float  TranslationDt[3];
+	float  TranslationCos2[3];
+	float  TranslationCosSin[3];
+	float  TranslationSin2[3];
+
+	PosePredictionKernel(const PoseState<double>& worldFromImu, const Posed& centeredFromWorld, const Posed& imuFromCpf)
 	{
-		dynamicDt = candidateDt;
+		SampleTime = worldFromImu.TimeInSeconds;
+
+		double angularSpeed = worldFromImu.AngularVelocity.Length();
+		double speed = angularSpeed + PredictionLinearCoef * worldFromImu.LinearVelocity.Length();
+		CandidateDt = (float)(PredictionSlope * speed);
+
+		// Below the speed CalcPredictedPose ignores, the angle stays 0 and the axis does not matter.
+		Vector3d axis(1, 0, 0);
+		if (angularSpeed > 0.001)
+		{
+			axis = worldFromImu.AngularVelocity / angularSpeed;
+			HalfAngularSpeed = (float)(0.5 * angularSpeed);
+		}
+		else
+		{
+			HalfAngularSpeed = 0.0f;
+		}
+
+		// centeredFromWorld * (R * (cos + sin * axis), T + v * dt) * imuFromCpf
+		Quatd p     = centeredFromWorld.Rotation * worldFromImu.ThePose.Rotation;
+		Quatd pAxis = p * Quatd(axis.x, axis.y, axis.z, 0);
+		Quatd rotationCos = p * imuFromCpf.Rotation;
+		Quatd rotationSin = pAxis * imuFromCpf.Rotation;
+
+		// (cos * p + sin * pAxis) t (cos * p + sin * pAxis)* expands into three rotations of t.
+		Quatd t(imuFromCpf.Translation.x, imuFromCpf.Translation.y, imuFromCpf.Translation.z, 0);
+		Vector3d translation   = centeredFromWorld.Apply(worldFromImu.ThePose.Translation);
+		Vector3d translationDt = centeredFromWorld.Rotate(worldFromImu.LinearVelocity);
+		Vector3d cos2   = p.Rotate(imuFromCpf.Translation);
+		Vector3d cosSin = (p * t * pAxis.Conj() + pAxis * t * p.Conj()).Imag();
+		Vector3d sin2   = pAxis.Rotate(imuFromCpf.Translation);
+
+		RotationCos[0] = (float)rotationCos.x; RotationCos[1] = (float)rotationCos.y;
+		RotationCos[2] = (float)rotationCos.z; RotationCos[3] = (float)rotationCos.w;
+		RotationSin[0] = (float)rotationSin.x; RotationSin[1] = (float)rotationSin.y;
+		RotationSin[2] = (float)rotationSin.z; RotationSin[3] = (float)rotationSin.w;
+		for (int i = 0; i < 3; i++)
+		{
+			Translation[i]       = (float)translation[i];
+			TranslationDt[i]     = (float)translationDt[i];
+			TranslationCos2[i]   = (float)cos2[i];
+			TranslationCosSin[i] = (float)cosSin[i];
+			TranslationSin2[i]   = (float)sin2[i];
+		}
 	}
 
-	if (angularSpeed > 0.001)
+	// The interval to predict over, clamped as GetSensorStateAtTime clamps it.
+	float PredictionDt(double absoluteTime) const
 	{
-		pose.Rotation = pose.Rotation * Quatd(angularVelocity, angularSpeed * dynamicDt);
+		double pdt = absoluteTime - SampleTime;
+		return (float)((pdt < 0.) ? 0. : (pdt > MaxPredictionDt) ? MaxPredictionDt : pdt);
 	}
 
-	pose.Translation += poseState.LinearVelocity * dynamicDt;
+	void Predict(const double* absoluteTimes, int count, Posef* transforms) const;
+};
+
+// Sine and cosine of a non-negative angle: reduced by multiples of pi/2 in three steps so
+// the reduction is exact, then minimax polynomials on [-pi/4, pi/4] good to float precision.
+// The scalar and SSE2 versions do the same float operations in the same order.
+static const float SinCosTwoOverPi = 0.636619772367581f;
+static const float SinCosPiOver2A  = 1.5703125f;
+static const float SinCosPiOver2B  = 4.837512969970703125e-4f;
+static const float SinCosPiOver2C  = 7.54978995489188216e-8f;
+static const float SinCoef1        = -1.6666654611e-1f;
+static const float SinCoef2        = 8.3321608736e-3f;
+static const float SinCoef3        = -1.9515295891e-4f;
+static const float CosCoef1        = 4.166664568298827e-2f;
+static const float CosCoef2        = -1.388731625493765e-3f;
+static const float CosCoef3        = 2.443315711809948e-5f;
+
+static inline void poseSinCos(float angle, float* psin, float* pcos)
+{
+	int   quadrant = (int)(angle * SinCosTwoOverPi + 0.5f);
+	float k = (float)quadrant;
+	float r = ((angle - k * SinCosPiOver2A) - k * SinCosPiOver2B) - k * SinCosPiOver2C;
+	float r2 = r * r;
+	float s = r + r * r2 * (SinCoef1 + r2 * (SinCoef2 + r2 * SinCoef3));
+	float c = (1.0f - 0.5f * r2) + r2 * r2 * (CosCoef1 + r2 * (CosCoef2 + r2 * CosCoef3));
+	float sinValue = (quadrant & 1) ? c : s;
+	float cosValue = (quadrant & 1) ? s : c;
+	*psin = (quadrant & 2) ? -sinValue : sinValue;
+	*pcos = ((quadrant + 1) & 2) ? -cosValue : cosValue;
+}
+
+void PosePredictionKernel::Predict(const double* absoluteTimes, int count, Posef* transforms) const
+{
+	int i = 0;
+
+#if defined(OVR_TRACKING_SSE2)
+	const __m128 candidateDt = _mm_set1_ps(CandidateDt);
+	const __m128 halfSpeed   = _mm_set1_ps(HalfAngularSpeed);
+	const __m128i one        = _mm_set1_epi32(1);
+	const __m128i two        = _mm_set1_epi32(2);
+	const __m128 signBit     = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000));
 
-	return pose;
+	for (; i < count; i += 4)
+	{
+		int lanes = (count - i < 4) ? count - i : 4;
+		OVR_ALIGNAS(16) float dtLanes[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (int lane = 0; lane < lanes; lane++)
+		{
+			dtLanes[lane] = PredictionDt(absoluteTimes[i + lane]);
+		}
+
+		__m128 dt    = _mm_min_ps(_mm_load_ps(dtLanes), candidateDt);
+		__m128 angle = _mm_mul_ps(dt, halfSpeed);
+
+		__m128i quadrant = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(angle, _mm_set1_ps(SinCosTwoOverPi)), _mm_set1_ps(0.5f)));
+		__m128 k  = _mm_cvtepi32_ps(quadrant);
+		__m128 r  = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(angle, _mm_mul_ps(k, _mm_set1_ps(SinCosPiOver2A))),
+		                                  _mm_mul_ps(k, _mm_set1_ps(SinCosPiOver2B))),
+		                       _mm_mul_ps(k, _mm_set1_ps(SinCosPiOver2C)));
+		__m128 r2 = _mm_mul_ps(r, r);
+		__m128 s  = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2),
+		                _mm_add_ps(_mm_set1_ps(SinCoef1), _mm_mul_ps(r2, _mm_add_ps(_mm_set1_ps(SinCoef2), _mm_mul_ps(r2, _mm_set1_ps(SinCoef3)))))));
+		__m128 c  = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), r2)), _mm_mul_ps(_mm_mul_ps(r2, r2),
+		                _mm_add_ps(_mm_set1_ps(CosCoef1), _mm_mul_ps(r2, _mm_add_ps(_mm_set1_ps(CosCoef2), _mm_mul_ps(r2, _mm_set1_ps(CosCoef3)))))));
+		__m128 swap    = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+		__m128 sinSign = _mm_and_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, two), two)), signBit);
+		__m128 cosSign = _mm_and_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), two)), signBit);
+		__m128 sinValue = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s)), sinSign);
+		__m128 cosValue = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c)), cosSign);
+
+		__m128 cos2   = _mm_mul_ps(cosValue, cosValue);
+		__m128 cosSin = _mm_mul_ps(cosValue, sinValue);
+		__m128 sin2   = _mm_mul_ps(sinValue, sinValue);
+
+		OVR_ALIGNAS(16) float results[7][4];
+		for (int j = 0; j < 4; j++)
+		{
+			_mm_store_ps(results[j], _mm_add_ps(_mm_mul_ps(cosValue, _mm_set1_ps(RotationCos[j])),
+			                                    _mm_mul_ps(sinValue, _mm_set1_ps(RotationSin[j]))));
+		}
+		for (int j = 0; j < 3; j++)
+		{
+			__m128 v = _mm_add_ps(_mm_set1_ps(Translation[j]), _mm_mul_ps(dt, _mm_set1_ps(TranslationDt[j])));
+			v = _mm_add_ps(v, _mm_mul_ps(cos2, _mm_set1_ps(TranslationCos2[j])));
+			v = _mm_add_ps(v, _mm_mul_ps(cosSin, _mm_set1_ps(TranslationCosSin[j])));
+			v = _mm_add_ps(v, _mm_mul_ps(sin2, _mm_set1_ps(TranslationSin2[j])));
+			_mm_store_ps(results[4 + j], v);
+		}
+
+		for (int lane = 0; lane < lanes; lane++)
+		{
+			Posef& transform = transforms[i + lane];
+			transform.Rotation    = Quatf(results[0][lane], results[1][lane], results[2][lane], results[3][lane]);
+			transform.Translation = Vector3f(results[4][lane], results[5][lane], results[6][lane]);
+		}
+	}
+#else
+	for (; i < count; i++)
+	{
+		float dt = PredictionDt(absoluteTimes[i]);
+		dt = (dt < CandidateDt) ? dt : CandidateDt;
+
+		float sinValue, cosValue;
+		poseSinCos(dt * HalfAngularSpeed, &sinValue, &cosValue);
+		float cos2   = cosValue * cosValue;
+		float cosSin = cosValue * sinValue;
+		float sin2   = sinValue * sinValue;
+
+		float results[7];
+		for (int j = 0; j < 4; j++)
+		{
+			results[j] = cosValue * RotationCos[j] + sinValue * RotationSin[j];
+		}
+		for (int j = 0; j < 3; j++)
+		{
+			results[4 + j] = (((Translation[j] + dt * TranslationDt[j]) + cos2 * TranslationCos2[j]) +
+			                  cosSin * TranslationCosSin[j]) + sin2 * TranslationSin2[j];
+		}
+
+		Posef& transform = transforms[i];
+		transform.Rotation    = Quatf(results[0], results[1], results[2], results[3]);
+		transform.Translation = Vector3f(results[4], results[5], results[6]);
+	}
+#endif
 }
 
 
@@ -74,6 +298,7 @@ static Pose<double> calcPredictedPose(const PoseState<double>& poseState, double
 
 SensorStateReader::SensorStateReader() :
 	Updater(NULL),
+	History(NULL),
     LastLatWarnTime(0.)
 {
 }
@@ -83,6 +308,16 @@ void SensorStateReader::SetUpdater(const CombinedSharedStateUpdater* updater)
 	Updater = updater;
 }
 
+void SensorStateReader::SetPoseHistory(const PoseHistoryUpdater* history)
+{
+	History = history;
+}
+
+void SensorStateReader::SetPredictor(PosePredictor* predictor)
+{
+	Predictor = predictor;
+}
+
 void SensorStateReader::RecenterPose()
 {
 	if (!Updater)
@@ -120,16 +355,7 @@ bool SensorStateReader::GetSensorStateAtTime(double absoluteTime, TrackingState&
 	ss.HeadPose.TimeInSeconds = absoluteTime;
 
 	// Update the status flags
-	ss.StatusFlags = lstate.StatusFlags;
-	// If no hardware is connected, override the tracking flags
-	if (0 == (ss.StatusFlags & Status_HMDConnected))
-	{
-		ss.StatusFlags &= ~Status_TrackingMask;
-	}
-	if (0 == (ss.StatusFlags & Status_PositionConnected))
-	{
-		ss.StatusFlags &= ~(Status_PositionTracked | Status_CameraPoseTracked);
-	}
+	ss.StatusFlags = effectiveStatusFlags(lstate.StatusFlags);
 
 	// If tracking info is invalid,
     if (0 == (ss.StatusFlags & Status_TrackingMask))
@@ -139,26 +365,50 @@ bool SensorStateReader::GetSensorStateAtTime(double absoluteTime, TrackingState&
     
     // Delta time from the last available data
 	double pdt = absoluteTime - lstate.WorldFromImu.TimeInSeconds;
-	static const double maxPdt = 0.1;
+	const double maxPdt = MaxPredictionDt;
 
-	// If delta went negative due to synchronization problems between processes or just a lag spike,
-	if (pdt < 0.)
+	PoseState<double> worldFromImu = lstate.WorldFromImu;
+	PoseState<double> before, after;
+
+	// A time that has already passed is looked up in the history, which clamps at its oldest pose.
+	// If the history is behind the latest pose, the time falls through to the latest pose below.
+	if (pdt < 0. && History && History->GetPosesAround(absoluteTime, before, after) &&
+		absoluteTime <= after.TimeInSeconds)
 	{
-		pdt = 0.;
+		worldFromImu = interpolatePoseState(before, after, absoluteTime);
 	}
-	else if (pdt > maxPdt)
+	else
 	{
-        if (LastLatWarnTime != lstate.WorldFromImu.TimeInSeconds)
-        {
-            LastLatWarnTime = lstate.WorldFromImu.TimeInSeconds;
-            LogText("[SensorStateReader] Prediction interval too high: %f s, clamping at %f s\n", pdt, maxPdt);
-        }
-		pdt = maxPdt;
+		// If delta went negative due to synchronization problems between processes or just a lag spike,
+		if (pdt < 0.)
+		{
+			pdt = 0.;
+		}
+		else if (pdt > maxPdt)
+		{
+			if (LastLatWarnTime != lstate.WorldFromImu.TimeInSeconds)
+			{
+				LastLatWarnTime = lstate.WorldFromImu.TimeInSeconds;
+				LogText("[SensorStateReader] Prediction interval too high: %f s, clamping at %f s\n", pdt, maxPdt);
+			}
+			pdt = maxPdt;
+		}
+
+		// Do prediction logic
+		if (Predictor)
+		{
+			Predictor->Observe(lstate.WorldFromImu);
+			worldFromImu.ThePose = Predictor->Predict(lstate.WorldFromImu, pdt);
+		}
+		else
+		{
+			worldFromImu.ThePose = CalcPredictedPose(lstate.WorldFromImu, pdt);
+		}
 	}
 
-	ss.HeadPose = PoseStatef(lstate.WorldFromImu);
-	// Do prediction logic and ImuFromCpf transformation
-	ss.HeadPose.ThePose = Posef(CenteredFromWorld * calcPredictedPose(lstate.WorldFromImu, pdt) * lstate.ImuFromCpf);
+	ss.HeadPose = PoseStatef(worldFromImu);
+	// ImuFromCpf transformation
+	ss.HeadPose.ThePose = Posef(CenteredFromWorld * worldFromImu.ThePose * lstate.ImuFromCpf);
 
     ss.CameraPose = Posef(CenteredFromWorld * lstate.WorldFromCamera);
 
@@ -185,6 +435,69 @@ bool SensorStateReader::GetPoseAtTime(double absoluteTime, Posef& transform) con
 	return true;
 }
 
+bool SensorStateReader::GetPosesAtTimes(const double* absoluteTimes, int count, Posef* transforms) const
+{
+	if (!Updater || count <= 0)
+	{
+		return false;
+	}
+
+	const LocklessSensorState lstate = Updater->SharedSensorState.GetState();
+
+	// If tracking info is invalid,
+	if (0 == (effectiveStatusFlags(lstate.StatusFlags) & Status_TrackingMask))
+	{
+		return false;
+	}
+
+	if (Predictor)
+	{
+		// Only the default folds into the kernel
+		Predictor->Observe(lstate.WorldFromImu);
+		for (int i = 0; i < count; i++)
+		{
+			double pdt = Alg::Clamp(absoluteTimes[i] - lstate.WorldFromImu.TimeInSeconds, 0., MaxPredictionDt);
+			Posed worldFromImu = Predictor->Predict(lstate.WorldFromImu, pdt);
+			transforms[i] = Posef(CenteredFromWorld * worldFromImu * lstate.ImuFromCpf);
+		}
+	}
+	else
+	{
+		PosePredictionKernel kernel(lstate.WorldFromImu, CenteredFromWorld, lstate.ImuFromCpf);
+		kernel.Predict(absoluteTimes, count, transforms);
+	}
+
+	double latestTime = absoluteTimes[0];
+	for (int i = 0; i < count; i++)
+	{
+		latestTime = Alg::Max(latestTime, absoluteTimes[i]);
+	}
+	double pdt = latestTime - lstate.WorldFromImu.TimeInSeconds;
+	if (pdt > MaxPredictionDt && LastLatWarnTime != lstate.WorldFromImu.TimeInSeconds)
+	{
+		LastLatWarnTime = lstate.WorldFromImu.TimeInSeconds;
+		LogText("[SensorStateReader] Prediction interval too high: %f s, clamping at %f s\n", pdt, MaxPredictionDt);
+	}
+
+	// Times that have already passed are looked up the way GetSensorStateAtTime does.
+	if (History)
+	{
+		PoseState<double> before, after;
+		for (int i = 0; i < count; i++)
+		{
+			if (absoluteTimes[i] < lstate.WorldFromImu.TimeInSeconds &&
+				History->GetPosesAround(absoluteTimes[i], before, after) &&
+				absoluteTimes[i] <= after.TimeInSeconds)
+			{
+				PoseState<double> worldFromImu = interpolatePoseState(before, after, absoluteTimes[i]);
+				transforms[i] = Posef(CenteredFromWorld * worldFromImu.ThePose * lstate.ImuFromCpf);
+			}
+		}
+	}
+
+	return true;
+}
+
 uint32_t SensorStateReader::GetStatus() const
 {
 	if (!Updater)
@@ -204,4 +517,300 @@ uint32_t SensorStateReader::GetStatus() const
 	return lstate.StatusFlags;
 }
 
+
+#ifdef OVR_POSE_HISTORY_TEST
+
+//-------------------------------------------------------------------------------------
+
+void GetPosesAtTimesLogReport()
+{
+    struct Motion
+    {
+        const char* Name;
+        double      AngularSpeed;
+        double      LinearSpeed;
+    };
+    const Motion motions[] =
+    {
+        { "still",      0.0, 0.0 },
+        { "turning",    2.0, 0.3 },
+        // Fast enough that the predicted angle needs reducing by more than pi/2
+        { "whipping", 120.0, 2.0 },
+    };
+    const int   counts[]   = { 2, 16, 1080 };
+    const int   numRepeats = 200;
+
+    CombinedSharedStateUpdater* updater = new CombinedSharedStateUpdater;
+    SensorStateReader reader;
+    reader.SetUpdater(updater);
+    reader.setCenteredFromWorld(Posed(Quatd(Vector3d(0, 1, 0), 0.4), Vector3d(-0.1, -0.3, 0.2)));
+
+    Posef* batched  = new Posef[1080];
+    Posef* single   = new Posef[1080];
+    double* times   = new double[1080];
+
+    LogText("GetPosesAtTimes against GetPoseAtTime, best of %d\n", numRepeats);
+    LogText("motion     poses  batched us  ns/pose   single us  ns/pose  speedup  max diff rad  max diff m\n");
+    for (int motionNum = 0; motionNum < (int)(sizeof(motions) / sizeof(motions[0])); motionNum++)
+    {
+        const Motion& motion = motions[motionNum];
+        double now = Timer::GetSeconds();
+
+        LocklessSensorState lstate;
+        lstate.StatusFlags = Status_HMDConnected | Status_OrientationTracked | Status_PositionConnected | Status_PositionTracked;
+        lstate.WorldFromImu.ThePose = Posed(Quatd(Vector3d(1, 2, 3), 0.7), Vector3d(0.05, 1.6, -0.4));
+        lstate.WorldFromImu.AngularVelocity = Vector3d(0.3, 1.0, -0.2).Normalized() * motion.AngularSpeed;
+        lstate.WorldFromImu.LinearVelocity  = Vector3d(1.0, 0.2, 0.4).Normalized() * motion.LinearSpeed;
+        lstate.WorldFromImu.TimeInSeconds = now;
+        lstate.ImuFromCpf = Posed(Quatd(Vector3d(1, 0, 0), 0.1), Vector3d(0.0, 0.05, 0.08));
+        updater->SharedSensorState.SetState(lstate);
+
+        for (int countNum = 0; countNum < (int)(sizeof(counts) / sizeof(counts[0])); countNum++)
+        {
+            // Spread over a 75 Hz frame, starting one frame ahead
+            int count = counts[countNum];
+            for (int i = 0; i < count; i++)
+            {
+                times[i] = now + 0.0133 + 0.0133 * i / count;
+            }
+
+            double bestBatched = 1e10, bestSingle = 1e10;
+            for (int repeat = 0; repeat < numRepeats; repeat++)
+            {
+                double start = Timer::GetSeconds();
+                reader.GetPosesAtTimes(times, count, batched);
+                double middle = Timer::GetSeconds();
+                for (int i = 0; i < count; i++)
+                {
+                    reader.GetPoseAtTime(times[i], single[i]);
+                }
+                double end = Timer::GetSeconds();
+                bestBatched = Alg::Min(bestBatched, middle - start);
+                bestSingle  = Alg::Min(bestSingle, end - middle);
+            }
+
+            double maxAngle = 0., maxDistance = 0.;
+            for (int i = 0; i < count; i++)
+            {
+                Quatd a(batched[i].Rotation), b(single[i].Rotation);
+                maxAngle    = Alg::Max(maxAngle, a.Normalized().Angle(b.Normalized()));
+                maxDistance = Alg::Max(maxDistance, (double)(batched[i].Translation - single[i].Translation).Length());
+            }
+
+            LogText("%-9s  %5d  %10.2f  %7.1f  %10.2f  %7.1f  %6.1fx  %12.2e  %10.2e\n",
+                    motion.Name, count, bestBatched * 1e6, bestBatched * 1e9 / count,
+                    bestSingle * 1e6, bestSingle * 1e9 / count, bestSingle / bestBatched, maxAngle, maxDistance);
+        }
+    }
+
+    delete[] batched;
+    delete[] single;
+    delete[] times;
+    delete updater;
+}
+
+
+namespace PoseHistoryTest {
+
+
+const int    PacedSamples   = 3000;     // 3 seconds at the IMU rate
+const int    BurstSamples   = 3000000;  // then as fast as the writer can go
+const int    NumReaders     = 3;
+const double SampleInterval = 0.001;
+
+// The writer's clock starts here so the test does not depend on the real one.
+const double StartTime      = 1000.0;
+
+// Interpolating 1 ms samples of TruePose is out by about 1e-5 rad; a torn copy is out by far more.
+const double MaxAngleError       = 1e-4;
+const double MaxTranslationError = 1e-5;
+
+// A head turning, nodding and swaying at unrelated rates.
+static Posed TruePose(double absoluteTime)
+{
+    double t = absoluteTime - StartTime;
+    Quatd yaw(Vector3d(0, 1, 0), 0.8 * sin(MATH_DOUBLE_TWOPI * 0.7 * t));
+    Quatd pitch(Vector3d(1, 0, 0), 0.3 * sin(MATH_DOUBLE_TWOPI * 1.3 * t));
+    Vector3d translation(0.1 * sin(MATH_DOUBLE_TWOPI * 0.5 * t), 0.01 * cos(MATH_DOUBLE_TWOPI * 1.1 * t), 0.0);
+    return Posed(yaw * pitch, translation);
+}
+
+volatile bool WriterFinished = false;
+
+
+//-------------------------------------------------------------------------------------
+
+// Stands in for the service: every sample goes to the latest state and to the history.
+
+class Writer : public Thread
+{
+public:
+    Writer(CombinedSharedStateUpdater* state, PoseHistoryUpdater* history) :
+        State(state), History(history)
+    {
+    }
+
+    virtual int Run()
+    {
+        LocklessSensorState lstate;
+        lstate.StatusFlags = Status_HMDConnected | Status_OrientationTracked |
+                             Status_PositionConnected | Status_PositionTracked;
+
+        for (int sample = 0; sample < PacedSamples + BurstSamples; sample++)
+        {
+            double time = StartTime + sample * SampleInterval;
+            lstate.WorldFromImu = PoseState<double>(TruePose(time), time);
+
+            History->AddPose(lstate.WorldFromImu);
+            State->SharedSensorState.SetState(lstate);
+
+            if (sample < PacedSamples)
+            {
+                Thread::MSleep(1);
+            }
+        }
+
+        WriterFinished = true;
+        return 0;
+    }
+
+    CombinedSharedStateUpdater* State;
+    PoseHistoryUpdater*         History;
+};
+
+
+//-------------------------------------------------------------------------------------
+
+// Opens the regions by name, as a game would, and looks up times up to 150 ms in the past,
+// which reaches past the oldest pose in the history.
+
+class Reader : public Thread
+{
+public:
+    Reader(const char* stateName, const char* historyName, int seed) :
+        StateName(stateName), HistoryName(historyName), Seed((uint32_t)seed),
+        NumQueries(0), NumInterpolated(0), NumFailures(0),
+        MaxAngle(0.), MaxTranslation(0.), SumLatestAngle(0.)
+    {
+    }
+
+    virtual int Run()
+    {
+        CombinedSharedStateReader stateReader;
+        PoseHistoryReader         historyReader;
+        if (!stateReader.Open(StateName) || !historyReader.Open(HistoryName))
+        {
+            LogText("PoseHistoryTest Fail - reader could not open the shared regions\n");
+            NumFailures++;
+            return 0;
+        }
+
+        SensorStateReader reader;
+        reader.SetUpdater(stateReader.Get());
+        reader.SetPoseHistory(historyReader.Get());
+
+        while (!WriterFinished)
+        {
+            double latest = stateReader.Get()->SharedSensorState.GetState().WorldFromImu.TimeInSeconds;
+            Seed = Seed * 1664525u + 1013904223u;
+            double absoluteTime = latest - 0.150 * (double)(Seed >> 8) / (double)(1 << 24);
+
+            TrackingState ss;
+            if (!reader.GetSensorStateAtTime(absoluteTime, ss))
+            {
+                LogText("PoseHistoryTest Fail - no state at %f\n", absoluteTime);
+                NumFailures++;
+                continue;
+            }
+            NumQueries++;
+
+            // Whatever time the reader settled on, the pose has to be the one for that time.
+            Posed expected = TruePose(ss.HeadPose.TimeInSeconds);
+            Posed actual(ss.HeadPose.ThePose);
+            double angle = actual.Rotation.Normalized().Angle(expected.Rotation);
+            double translation = (actual.Translation - expected.Translation).Length();
+            MaxAngle = Alg::Max(MaxAngle, angle);
+            MaxTranslation = Alg::Max(MaxTranslation, translation);
+            if (angle > MaxAngleError || translation > MaxTranslationError)
+            {
+                if (NumFailures++ < 10)
+                {
+                    LogText("PoseHistoryTest Fail - pose for %f is off by %g rad, %g m\n",
+                            ss.HeadPose.TimeInSeconds, angle, translation);
+                }
+            }
+
+            if (ss.HeadPose.TimeInSeconds == absoluteTime)
+            {
+                // What the reader answered before there was a history.
+                NumInterpolated++;
+                SumLatestAngle += TruePose(latest).Rotation.Angle(TruePose(absoluteTime).Rotation);
+            }
+        }
+        return 0;
+    }
+
+    const char* StateName;
+    const char* HistoryName;
+    uint32_t    Seed;
+
+    int         NumQueries;
+    int         NumInterpolated;
+    int         NumFailures;
+    double      MaxAngle;
+    double      MaxTranslation;
+    double      SumLatestAngle;
+};
+
+
+} // namespace PoseHistoryTest
+
+
+bool RunPoseHistoryTest()
+{
+    using namespace PoseHistoryTest;
+
+    String stateName = "OVR_PoseHistoryTest";
+    String historyName = stateName + PoseHistorySharedMemorySuffix;
+
+    CombinedSharedStateWriter stateWriter;
+    PoseHistoryWriter         historyWriter;
+    if (!stateWriter.Open(stateName.ToCStr()) || !historyWriter.Open(historyName.ToCStr()))
+    {
+        LogText("PoseHistoryTest Fail - could not create the shared regions\n");
+        return false;
+    }
+
+    WriterFinished = false;
+    Ptr<Writer> writer = *new Writer(stateWriter.Get(), historyWriter.Get());
+    Ptr<Reader> readers[NumReaders];
+
+    // Let the history fill before the readers start
+    writer->Start();
+    Thread::MSleep(200);
+    for (int i = 0; i < NumReaders; i++)
+    {
+        readers[i] = *new Reader(stateName.ToCStr(), historyName.ToCStr(), i + 1);
+        readers[i]->Start();
+    }
+
+    writer->Join();
+    bool passed = true;
+    for (int i = 0; i < NumReaders; i++)
+    {
+        readers[i]->Join();
+        Reader& r = *readers[i];
+        LogText("PoseHistoryTest reader %d: %d queries, %d interpolated, max error %g rad %g m, "
+                "mean error answering with the latest pose %g rad\n",
+                i, r.NumQueries, r.NumInterpolated, r.MaxAngle, r.MaxTranslation,
+                r.NumInterpolated ? r.SumLatestAngle / r.NumInterpolated : 0.);
+        passed = passed && (r.NumFailures == 0) && (r.NumInterpolated > 0);
+    }
+
+    LogText("PoseHistoryTest %s\n", passed ? "passed" : "FAILED");
+    return passed;
+}
+
+#endif // OVR_POSE_HISTORY_TEST
+
 }} // namespace OVR::Tracking
@@ -29,9 +29,13 @@ limitations under the License.
 
 #include "../Kernel/OVR_Lockless.h"
 #include "Tracking_SensorState.h"
+#include "Tracking_PosePredictor.h"
 
 #include "../OVR_Profile.h"
 
+// Define this to compile-in pose history test logic and the batched lookup report
+//#define OVR_POSE_HISTORY_TEST
+
 namespace OVR { namespace Tracking {
 
 
@@ -44,6 +48,11 @@ class SensorStateReader : public NewOverrideBase
 protected:
 	const CombinedSharedStateUpdater *Updater;
 
+    // Optional, for times that have already passed
+    const PoseHistoryUpdater *History;
+
+    // NULL for CalcPredictedPose
+    Ptr<PosePredictor> Predictor;
 
     // Last latency warning time
     mutable double LastLatWarnTime;
@@ -57,16 +66,31 @@ public:
 	// Initialize the updater
     void         SetUpdater(const CombinedSharedStateUpdater *updater);
 
+    // Set the pose history, which lets times before the latest pose be interpolated
+    // from the poses around them rather than answered with the latest pose.
+    void         SetPoseHistory(const PoseHistoryUpdater *history);
+
+    // Set how times after the latest pose are predicted, NULL for the default. Other
+    // predictors make GetPosesAtTimes predict each time on its own, at GetPoseAtTime's cost.
+    void         SetPredictor(PosePredictor *predictor);
+    PosePredictor* GetPredictor() const { return Predictor; }
+
 	// Re-centers on the current yaw (optionally pitch) and translation
 	void		 RecenterPose();
 
 	// Get the full dynamical system state of the CPF, which includes velocities and accelerations,
-	// predicted at a specified absolute point in time.
+	// predicted at a specified absolute point in time. Past times are interpolated from the pose
+	// history if one is set; only times after the newest pose are predicted.
 	bool		 GetSensorStateAtTime(double absoluteTime, Tracking::TrackingState& state) const;
 
 	// Get the predicted pose (orientation, position) of the center pupil frame (CPF) at a specific point in time.
 	bool		 GetPoseAtTime(double absoluteTime, Posef& transform) const;
 
+	// Get the poses of the CPF at count points in time, as GetPoseAtTime would give them, from
+	// a single read of the sensor state. Much cheaper per pose than GetPoseAtTime, for rolling
+	// shutter timewarp and the like. Leaves transforms untouched and returns false if not tracking.
+	bool		 GetPosesAtTimes(const double* absoluteTimes, int count, Posef* transforms) const;
+
 	// Get the sensor status (same as GetSensorStateAtTime(...).Status)
 	uint32_t     GetStatus() const;
 
@@ -82,6 +106,20 @@ public:
 };
 
 
+
+#ifdef OVR_POSE_HISTORY_TEST
+// Times GetPosesAtTimes against as many GetPoseAtTime calls for 2, 16 and 1080 times
+// (both eyes, a few per eye, one per scanline) over the next frame, and logs how far apart
+// their poses are.
+void GetPosesAtTimesLogReport();
+
+// Publishes a known head motion through shared memory the way the service does, at 1000 Hz
+// and then as fast as it can, while reader threads check every pose they look up against it.
+// Returns true if all the checks passed.
+bool RunPoseHistoryTest();
+#endif
+
+
 }} // namespace OVR::Tracking
 
 #endif // Tracking_SensorStateReader_h
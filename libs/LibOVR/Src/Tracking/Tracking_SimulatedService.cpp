@@ -0,0 +1,264 @@
+/************************************************************************************
+
+Filename    :   Tracking_SimulatedService.cpp
+Content     :   Publishes scripted or recorded head motion the way the tracking service does
+Created     :   October 17, 2026
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "Tracking_SimulatedService.h"
+#include "../Kernel/OVR_Timer.h"
+#include "../Kernel/OVR_Log.h"
+
+#if defined(OVR_OS_WIN32)
+#include <windows.h>
+#else
+#include <unistd.h>
+#define GetCurrentProcessId getpid
+#endif
+
+#ifdef OVR_SIMULATED_TRACKING_TOOL
+#include "../Kernel/OVR_System.h"
+#endif
+
+namespace OVR { namespace Tracking {
+
+
+//-------------------------------------------------------------------------------------
+
+// The IMU's rate
+static const double SimulatedSampleInterval = 0.001;
+
+// After a stall, such as a debugger break, only this much of the missed motion is published.
+static const double SimulatedMaxCatchUp = 0.1;
+
+SimulatedTrackingService::SimulatedTrackingService() :
+	SensorNoise(false),
+	NoiseSeed(12345),
+	StartTime(0.),
+	StopRequested(false),
+	NumPublished(0)
+{
+}
+
+void SimulatedTrackingService::SetTrace(const PoseState<double>* trace, int count)
+{
+	Trace.Resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		Trace[i] = trace[i];
+	}
+}
+
+bool SimulatedTrackingService::Open(const char* sharedMemoryName)
+{
+	if (sharedMemoryName)
+	{
+		SharedMemoryName = sharedMemoryName;
+	}
+	else
+	{
+		char name[64];
+		OVR_sprintf(name, sizeof(name), "OVR_SimulatedTracking_%u", (unsigned)GetCurrentProcessId());
+		SharedMemoryName = name;
+	}
+
+	String historyName = SharedMemoryName + PoseHistorySharedMemorySuffix;
+	if (!StateWriter.Open(SharedMemoryName.ToCStr()) || !HistoryWriter.Open(historyName.ToCStr()))
+	{
+		LogError("[SimulatedTrackingService] Unable to create shared memory %s", SharedMemoryName.ToCStr());
+		return false;
+	}
+	return true;
+}
+
+void SimulatedTrackingService::Stop()
+{
+	StopRequested = true;
+	Join();
+}
+
+// When a sample is due. A trace keeps its own spacing and repeats one sample interval
+// after its last state.
+double SimulatedTrackingService::sampleTime(int64_t sample) const
+{
+	if (Trace.GetSize() == 0)
+	{
+		return StartTime + (double)sample * SimulatedSampleInterval;
+	}
+
+	int count = (int)Trace.GetSize();
+	double period = Trace[count - 1].TimeInSeconds - Trace[0].TimeInSeconds + SimulatedSampleInterval;
+	int64_t loop = sample / count;
+	int index = (int)(sample % count);
+	return StartTime + (double)loop * period + (Trace[index].TimeInSeconds - Trace[0].TimeInSeconds);
+}
+
+LocklessSensorState SimulatedTrackingService::sampleState(int64_t sample, double absoluteTime)
+{
+	LocklessSensorState lstate;
+	lstate.StatusFlags = Status_HMDConnected | Status_OrientationTracked |
+	                     Status_PositionConnected | Status_PositionTracked | Status_CameraPoseTracked;
+
+	if (Trace.GetSize() == 0)
+	{
+		lstate.WorldFromImu = ScriptedPoseState(absoluteTime - StartTime);
+		if (SensorNoise)
+		{
+			AddSensorNoise(lstate.WorldFromImu, NoiseSeed);
+		}
+	}
+	else
+	{
+		lstate.WorldFromImu = Trace[(int)(sample % (int64_t)Trace.GetSize())];
+	}
+	lstate.WorldFromImu.TimeInSeconds = absoluteTime;
+
+	// What the IMU would have read, with gravity in the accelerometer
+	const PoseState<double>& imu = lstate.WorldFromImu;
+	Vector3d acceleration = imu.ThePose.Rotation.Inverted().Rotate(imu.LinearAcceleration + Vector3d(0, 9.81, 0));
+	lstate.RawSensorData.Acceleration        = Vector3f(acceleration);
+	lstate.RawSensorData.RotationRate        = Vector3f(imu.AngularVelocity);
+	lstate.RawSensorData.Temperature         = 30.0f;
+	lstate.RawSensorData.AbsoluteTimeSeconds = absoluteTime;
+
+	// A camera on the desk a meter in front, facing the user
+	lstate.WorldFromCamera = Posed(Quatd(Axis_Y, MATH_DOUBLE_PI), Vector3d(0, 0, -1));
+	return lstate;
+}
+
+int SimulatedTrackingService::Run()
+{
+	SetThreadName("SimulatedTracking");
+
+	CombinedSharedStateUpdater* state   = StateWriter.Get();
+	PoseHistoryUpdater*         history = HistoryWriter.Get();
+	if (!state || !history)
+	{
+		return -1;
+	}
+
+	StartTime = Timer::GetSeconds();
+	// 64 bits, since an int would wrap after 24 days at 1000 Hz.
+	int64_t sample = 0;
+	while (!StopRequested)
+	{
+		// Publish everything that has come due since the last wake, oldest first, as the
+		// service does when it falls behind the IMU.
+		double now = Timer::GetSeconds();
+		for (;;)
+		{
+			double time = sampleTime(sample);
+			if (time > now)
+			{
+				break;
+			}
+			if (now - time <= SimulatedMaxCatchUp)
+			{
+				LocklessSensorState lstate = sampleState(sample, time);
+				history->AddPose(lstate.WorldFromImu);
+				state->SharedSensorState.SetState(lstate);
+				NumPublished++;
+			}
+			sample++;
+		}
+
+		Thread::MSleep(1);
+	}
+	return 0;
+}
+
+
+}} // namespace OVR::Tracking
+
+
+#ifdef OVR_SIMULATED_TRACKING_TOOL
+
+// Publishes until killed, or for -seconds. Replays the trace if one is given, otherwise
+// scripted motion, with sensor noise if -noise is given. -name sets the shared memory name.
+int main(int argc, const char* argv[])
+{
+	OVR::System::Init(OVR::Log::ConfigureDefaultLog(OVR::LogMask_All));
+
+	const char* name = NULL;
+	const char* tracePath = NULL;
+	double      seconds = 0.;
+	bool        noise = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-name") == 0 && i + 1 < argc)
+		{
+			name = argv[++i];
+		}
+		else if (strcmp(argv[i], "-seconds") == 0 && i + 1 < argc)
+		{
+			seconds = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-noise") == 0)
+		{
+			noise = true;
+		}
+		else
+		{
+			tracePath = argv[i];
+		}
+	}
+
+	int result = 0;
+	{
+		OVR::Ptr<OVR::Tracking::SimulatedTrackingService> service = *new OVR::Tracking::SimulatedTrackingService;
+		service->SetSensorNoise(noise);
+
+		OVR::Array< OVR::PoseState<double> > trace;
+		if (tracePath)
+		{
+			if (!OVR::Tracking::LoadPoseTrace(tracePath, trace) || trace.GetSize() == 0)
+			{
+				OVR::LogText("Could not read a pose trace from %s\n", tracePath);
+				result = 1;
+			}
+			else
+			{
+				service->SetTrace(&trace[0], (int)trace.GetSize());
+			}
+		}
+
+		if (result == 0 && service->Open(name) && service->Start())
+		{
+			OVR::LogText("Publishing simulated tracking as %s\n", service->GetSharedMemoryName());
+			double endTime = OVR::Timer::GetSeconds() + seconds;
+			while (seconds <= 0. || OVR::Timer::GetSeconds() < endTime)
+			{
+				OVR::Thread::MSleep(100);
+			}
+			service->Stop();
+			OVR::LogText("Published %lld states\n", (long long)service->GetNumPublished());
+		}
+		else
+		{
+			result = 1;
+		}
+	}
+
+	OVR::System::Destroy();
+	return result;
+}
+
+#endif // OVR_SIMULATED_TRACKING_TOOL
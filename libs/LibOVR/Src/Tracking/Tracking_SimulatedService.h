@@ -0,0 +1,93 @@
+/************************************************************************************
+
+Filename    :   Tracking_SimulatedService.h
+Content     :   Publishes scripted or recorded head motion the way the tracking service does
+Created     :   October 17, 2026
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#ifndef Tracking_SimulatedService_h
+#define Tracking_SimulatedService_h
+
+#include "../Kernel/OVR_Threads.h"
+#include "../Kernel/OVR_String.h"
+#include "Tracking_SensorState.h"
+#include "Tracking_PosePredictor.h"
+
+// Define this to compile-in a main() that publishes simulated tracking from its own process
+//#define OVR_SIMULATED_TRACKING_TOOL
+
+namespace OVR { namespace Tracking {
+
+
+//-----------------------------------------------------------------------------
+// ***** SimulatedTrackingService
+
+// Stands in for the tracking service when there is no headset. A thread writes a
+// CombinedSharedStateUpdater and a PoseHistoryUpdater with the same names and layout the
+// service uses, at the IMU's 1000 Hz, so readers attached to it see the same load and
+// timing as with a real headset. HMDState::AttachSharedState attaches a debug HMD.
+//
+// The motion is ScriptedPoseState, or a trace replayed in a loop at its own rate, with
+// its times moved to the present.
+class SimulatedTrackingService : public Thread
+{
+public:
+    SimulatedTrackingService();
+
+    // Replay trace instead of the scripted motion; it is copied. Call before Start.
+    void        SetTrace(const PoseState<double>* trace, int count);
+    // Add AddSensorNoise to the scripted motion. Call before Start.
+    void        SetSensorNoise(bool sensorNoise) { SensorNoise = sensorNoise; }
+
+    // Creates the shared regions, with a name unique to this process if none is given.
+    // Call before Start.
+    bool        Open(const char* sharedMemoryName = NULL);
+    const char* GetSharedMemoryName() const { return SharedMemoryName.ToCStr(); }
+
+    // Stops publishing and waits for the thread to finish. The last state stays readable
+    // until this object is released.
+    void        Stop();
+
+    // States published so far. Only the service thread counts, so this is exact once Stop returns;
+    // a 32-bit build reading it while the service runs may see a torn value.
+    int64_t     GetNumPublished() const { return NumPublished; }
+
+    virtual int Run();
+
+private:
+    double              sampleTime(int64_t sample) const;
+    LocklessSensorState sampleState(int64_t sample, double absoluteTime);
+
+    String                      SharedMemoryName;
+    CombinedSharedStateWriter   StateWriter;
+    PoseHistoryWriter           HistoryWriter;
+    Array< PoseState<double> >  Trace;
+    bool                        SensorNoise;
+    uint32_t                    NoiseSeed;
+    double                      StartTime;
+    volatile bool               StopRequested;
+    volatile int64_t            NumPublished;
+};
+
+
+}} // namespace OVR::Tracking
+
+#endif // Tracking_SimulatedService_h
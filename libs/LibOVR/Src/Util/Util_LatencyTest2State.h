@@ -88,7 +88,7 @@ struct FrameTimeRecordSet
     bool IsAllZeroes() const;
 };
 
-typedef LocklessUpdater<FrameTimeRecordSet, FrameTimeRecordSet> LockessRecordUpdater;
+typedef CompatibleLocklessUpdater<FrameTimeRecordSet, FrameTimeRecordSet> LockessRecordUpdater;
 
 
 }} // namespace OVR::Util
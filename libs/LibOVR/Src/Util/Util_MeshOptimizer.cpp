@@ -0,0 +1,337 @@
+/************************************************************************************
+
+Filename    :   Util_MeshOptimizer.cpp
+Content     :   Vertex cache and vertex fetch ordering for indexed triangle lists
+Created     :   October 17, 2026
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "Util_MeshOptimizer.h"
+#include "../Kernel/OVR_Array.h"
+#include "../Kernel/OVR_Alg.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace OVR { namespace Util {
+
+
+//-----------------------------------------------------------------------------------
+// ***** Forsyth vertex cache optimizer
+
+// Scores straight from the paper. The last triangle's three vertices get a flat score
+// lower than the next few, so the optimizer does not keep fanning around one vertex.
+static const float VCO_LastTriScore         = 0.75f;
+static const float VCO_CacheDecayPower      = 1.5f;
+static const float VCO_ValenceBoostScale    = 2.0f;
+static const float VCO_ValenceBoostPower    = 0.5f;
+// Valences past this all score the same, which keeps the table small.
+static const int   VCO_MaxValence           = 32;
+
+struct VertexCacheOptimizerState
+{
+    Array<float>    CachePositionScore;     // Per cache slot, cacheSize+3 of them.
+    Array<float>    ValenceScore;           // Per number of remaining triangles.
+
+    Array<int>      FirstTriangle;          // Per vertex, start of its slice of VertexTriangles.
+    Array<int>      NumRemaining;           // Per vertex, triangles not yet emitted.
+    Array<int>      VertexTriangles;        // Triangles using each vertex, not yet emitted ones first.
+    Array<int>      CachePosition;          // Per vertex, -1 when it is not in the cache.
+    Array<float>    VertexScore;
+
+    Array<uint8_t>  TriangleEmitted;
+
+    float ScoreVertex ( int vertex ) const
+    {
+        int remaining = NumRemaining[vertex];
+        if ( remaining == 0 )
+        {
+            // Nothing left to draw with it, so it is worth nothing.
+            return -1.0f;
+        }
+        int position = CachePosition[vertex];
+        float score = ( position < 0 ) ? 0.0f : CachePositionScore[position];
+        return score + ValenceScore[Alg::Min ( remaining, VCO_MaxValence )];
+    }
+};
+
+void OptimizeVertexCache ( uint16_t *pTriangleListIndices, int numTriangles, int numVertices,
+                           int cacheSize /*= VertexCacheDefaultSize*/ )
+{
+    if ( numTriangles <= 0 )
+    {
+        return;
+    }
+    // The three vertices of the last triangle always sit at the front.
+    cacheSize = Alg::Max ( cacheSize, 4 );
+
+    VertexCacheOptimizerState state;
+
+    // Slots past cacheSize hold vertices that are about to fall out, so score nothing.
+    state.CachePositionScore.Resize ( cacheSize + 3 );
+    for ( int position = 0; position < cacheSize + 3; position++ )
+    {
+        float score = 0.0f;
+        if ( position < 3 )
+        {
+            score = VCO_LastTriScore;
+        }
+        else if ( position < cacheSize )
+        {
+            float scaler = 1.0f / (float)( cacheSize - 3 );
+            score = powf ( 1.0f - (float)( position - 3 ) * scaler, VCO_CacheDecayPower );
+        }
+        state.CachePositionScore[position] = score;
+    }
+    // Vertices with few triangles left get a boost, so lone triangles are not left behind.
+    state.ValenceScore.Resize ( VCO_MaxValence + 1 );
+    state.ValenceScore[0] = 0.0f;
+    for ( int valence = 1; valence <= VCO_MaxValence; valence++ )
+    {
+        state.ValenceScore[valence] = VCO_ValenceBoostScale * powf ( (float)valence, -VCO_ValenceBoostPower );
+    }
+
+    // Triangles of every vertex, as slices of one array.
+    state.FirstTriangle.Resize ( numVertices + 1 );
+    state.NumRemaining.Resize ( numVertices );
+    memset ( &state.NumRemaining[0], 0, sizeof(int) * numVertices );
+    for ( int i = 0; i < numTriangles * 3; i++ )
+    {
+        OVR_ASSERT ( pTriangleListIndices[i] < numVertices );
+        state.NumRemaining[pTriangleListIndices[i]]++;
+    }
+    state.FirstTriangle[0] = 0;
+    for ( int vertex = 0; vertex < numVertices; vertex++ )
+    {
+        state.FirstTriangle[vertex+1] = state.FirstTriangle[vertex] + state.NumRemaining[vertex];
+        state.NumRemaining[vertex] = 0;
+    }
+    state.VertexTriangles.Resize ( numTriangles * 3 );
+    for ( int triangle = 0; triangle < numTriangles; triangle++ )
+    {
+        for ( int corner = 0; corner < 3; corner++ )
+        {
+            int vertex = pTriangleListIndices[triangle * 3 + corner];
+            state.VertexTriangles[state.FirstTriangle[vertex] + state.NumRemaining[vertex]++] = triangle;
+        }
+    }
+
+    state.CachePosition.Resize ( numVertices );
+    state.VertexScore.Resize ( numVertices );
+    for ( int vertex = 0; vertex < numVertices; vertex++ )
+    {
+        state.CachePosition[vertex] = -1;
+        state.VertexScore[vertex] = state.ScoreVertex ( vertex );
+    }
+    state.TriangleEmitted.Resize ( numTriangles );
+    memset ( &state.TriangleEmitted[0], 0, numTriangles );
+
+    // The cache as an LRU list, plus room for the three vertices pushed in by each triangle.
+    Array<int> cacheBuffers;
+    cacheBuffers.Resize ( ( cacheSize + 3 ) * 2 );
+    int *pCache         = &cacheBuffers[0];
+    int *pNewCache      = &cacheBuffers[cacheSize + 3];
+    int  cacheCount     = 0;
+
+    Array<uint16_t> output;
+    output.Resize ( numTriangles * 3 );
+
+    int bestTriangle = -1;
+    // Where to look for a fresh start when nothing in the cache has triangles left.
+    // Taking the next triangle in input order keeps this linear, and the input order
+    // of the meshes here is already a sensible place to start from.
+    int nextUnemitted = 0;
+
+    for ( int emitted = 0; emitted < numTriangles; emitted++ )
+    {
+        if ( bestTriangle < 0 )
+        {
+            while ( state.TriangleEmitted[nextUnemitted] )
+            {
+                nextUnemitted++;
+            }
+            bestTriangle = nextUnemitted;
+        }
+
+        uint16_t const *pTri = &pTriangleListIndices[bestTriangle * 3];
+        output[emitted * 3 + 0] = pTri[0];
+        output[emitted * 3 + 1] = pTri[1];
+        output[emitted * 3 + 2] = pTri[2];
+        state.TriangleEmitted[bestTriangle] = 1;
+
+        // Take the triangle out of the slices of its vertices.
+        int newCount = 0;
+        for ( int corner = 0; corner < 3; corner++ )
+        {
+            int vertex = pTri[corner];
+            int first = state.FirstTriangle[vertex];
+            int last = first + state.NumRemaining[vertex] - 1;
+            for ( int i = first; i <= last; i++ )
+            {
+                if ( state.VertexTriangles[i] == bestTriangle )
+                {
+                    state.VertexTriangles[i] = state.VertexTriangles[last];
+                    state.VertexTriangles[last] = bestTriangle;
+                    break;
+                }
+            }
+            state.NumRemaining[vertex]--;
+            pNewCache[newCount++] = vertex;
+        }
+
+        // The triangle's vertices move to the front, everything else slides back.
+        for ( int i = 0; i < cacheCount; i++ )
+        {
+            int vertex = pCache[i];
+            if ( ( vertex != pTri[0] ) && ( vertex != pTri[1] ) && ( vertex != pTri[2] ) )
+            {
+                pNewCache[newCount++] = vertex;
+            }
+        }
+        for ( int i = cacheSize; i < newCount; i++ )
+        {
+            state.CachePosition[pNewCache[i]] = -1;
+            state.VertexScore[pNewCache[i]] = state.ScoreVertex ( pNewCache[i] );
+        }
+        cacheCount = Alg::Min ( newCount, cacheSize );
+        for ( int i = 0; i < cacheCount; i++ )
+        {
+            state.CachePosition[pNewCache[i]] = i;
+            state.VertexScore[pNewCache[i]] = state.ScoreVertex ( pNewCache[i] );
+        }
+        Alg::Swap ( pCache, pNewCache );
+
+        // Only triangles touching the cache changed score, and the next one comes from them.
+        bestTriangle = -1;
+        float bestScore = -1.0f;
+        for ( int i = 0; i < cacheCount; i++ )
+        {
+            int vertex = pCache[i];
+            int first = state.FirstTriangle[vertex];
+            int end = first + state.NumRemaining[vertex];
+            for ( int j = first; j < end; j++ )
+            {
+                int triangle = state.VertexTriangles[j];
+                uint16_t const *pCandidate = &pTriangleListIndices[triangle * 3];
+                float score = state.VertexScore[pCandidate[0]] + state.VertexScore[pCandidate[1]] + state.VertexScore[pCandidate[2]];
+                if ( score > bestScore )
+                {
+                    bestScore = score;
+                    bestTriangle = triangle;
+                }
+            }
+        }
+    }
+
+    memcpy ( pTriangleListIndices, &output[0], sizeof(uint16_t) * numTriangles * 3 );
+}
+
+
+//-----------------------------------------------------------------------------------
+// ***** Vertex fetch order
+
+int OptimizeVertexFetch ( void *pVertices, int vertexSize,
+                          uint16_t *pTriangleListIndices, int numTriangles, int numVertices )
+{
+    if ( numVertices <= 0 )
+    {
+        return 0;
+    }
+
+    Array<int> remap;
+    remap.Resize ( numVertices );
+    for ( int vertex = 0; vertex < numVertices; vertex++ )
+    {
+        remap[vertex] = -1;
+    }
+    int numUsed = 0;
+    for ( int i = 0; i < numTriangles * 3; i++ )
+    {
+        int &newIndex = remap[pTriangleListIndices[i]];
+        if ( newIndex < 0 )
+        {
+            newIndex = numUsed++;
+        }
+        pTriangleListIndices[i] = (uint16_t)newIndex;
+    }
+    int numAssigned = numUsed;
+    for ( int vertex = 0; vertex < numVertices; vertex++ )
+    {
+        if ( remap[vertex] < 0 )
+        {
+            remap[vertex] = numAssigned++;
+        }
+    }
+
+    Array<uint8_t> reordered;
+    reordered.Resize ( (size_t)numVertices * vertexSize );
+    uint8_t const *pSource = (uint8_t const*)pVertices;
+    for ( int vertex = 0; vertex < numVertices; vertex++ )
+    {
+        memcpy ( &reordered[(size_t)remap[vertex] * vertexSize], pSource + (size_t)vertex * vertexSize, vertexSize );
+    }
+    memcpy ( pVertices, &reordered[0], (size_t)numVertices * vertexSize );
+    return numUsed;
+}
+
+
+//-----------------------------------------------------------------------------------
+// ***** Cache simulation
+
+VertexCacheStats MeasureVertexCache ( uint16_t const *pTriangleListIndices, int numTriangles, int numVertices,
+                                      int cacheSize /*= VertexCacheDefaultSize*/ )
+{
+    VertexCacheStats stats;
+    stats.NumTransforms = 0;
+    stats.ACMR          = 0.0f;
+    stats.ATVR          = 0.0f;
+    if ( ( numTriangles <= 0 ) || ( numVertices <= 0 ) )
+    {
+        return stats;
+    }
+
+    // A FIFO only moves on a miss, so a vertex is still cached while fewer than
+    // cacheSize misses have happened since its own. 0 means never loaded.
+    Array<int> loadedAt;
+    loadedAt.Resize ( numVertices );
+    memset ( &loadedAt[0], 0, sizeof(int) * numVertices );
+    int numUsed = 0;
+    for ( int i = 0; i < numTriangles * 3; i++ )
+    {
+        int &loaded = loadedAt[pTriangleListIndices[i]];
+        if ( loaded == 0 )
+        {
+            numUsed++;
+        }
+        else if ( stats.NumTransforms - loaded < cacheSize )
+        {
+            continue;
+        }
+        stats.NumTransforms++;
+        loaded = stats.NumTransforms;
+    }
+
+    stats.ACMR = (float)stats.NumTransforms / (float)numTriangles;
+    stats.ATVR = (float)stats.NumTransforms / (float)numUsed;
+    return stats;
+}
+
+
+}} // namespace OVR::Util
@@ -0,0 +1,72 @@
+/************************************************************************************
+
+Filename    :   Util_MeshOptimizer.h
+Content     :   Vertex cache and vertex fetch ordering for indexed triangle lists
+Created     :   October 17, 2026
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#ifndef OVR_Util_MeshOptimizer_h
+#define OVR_Util_MeshOptimizer_h
+
+#include "../Kernel/OVR_Types.h"
+
+namespace OVR { namespace Util {
+
+
+//-----------------------------------------------------------------------------------
+// ***** Vertex cache optimization
+
+// Size of the post-transform cache the optimizer plans for when none is given.
+// Real hardware ranges from 16 to 32 entries; planning for a smaller cache than
+// the hardware has costs little, planning for a larger one costs a lot.
+static const int VertexCacheDefaultSize = 16;
+
+// Reorders the triangles of an indexed triangle list so that vertices are reused
+// while they are still in a post-transform cache of cacheSize entries, using
+// Tom Forsyth's "Linear-Speed Vertex Cache Optimisation". Triangles keep their
+// winding. Runs in time linear in the number of triangles.
+void OptimizeVertexCache ( uint16_t *pTriangleListIndices, int numTriangles, int numVertices,
+                           int cacheSize = VertexCacheDefaultSize );
+
+// Renumbers the vertices in the order the triangles first use them, so vertex fetches
+// walk forwards through the buffer, and rewrites the indices to match. Run it after
+// OptimizeVertexCache. Vertices no triangle uses are moved to the end.
+// Returns the number of vertices that are used.
+int OptimizeVertexFetch ( void *pVertices, int vertexSize,
+                          uint16_t *pTriangleListIndices, int numTriangles, int numVertices );
+
+
+// What a FIFO post-transform cache of a given size makes of an index buffer.
+struct VertexCacheStats
+{
+    int     NumTransforms;      // Vertices the cache missed, so had to be shaded.
+    float   ACMR;               // Average cache miss ratio: transforms per triangle. 0.5 is ideal for a grid.
+    float   ATVR;               // Average transform to vertex ratio: transforms per used vertex. 1.0 is ideal.
+};
+
+// Plays the index buffer through a simulated FIFO cache, which is how most hardware behaves.
+VertexCacheStats MeasureVertexCache ( uint16_t const *pTriangleListIndices, int numTriangles, int numVertices,
+                                      int cacheSize = VertexCacheDefaultSize );
+
+
+}} // namespace OVR::Util
+
+#endif // OVR_Util_MeshOptimizer_h
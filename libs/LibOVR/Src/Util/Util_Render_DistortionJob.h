@@ -0,0 +1,65 @@
+/************************************************************************************
+
+Filename    :   Util_Render_DistortionJob.h
+Content     :   Rows of distortion work spread over helper threads
+Created     :   October 17, 2026
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#ifndef OVR_Util_Render_DistortionJob_h
+#define OVR_Util_Render_DistortionJob_h
+
+#include "../Kernel/OVR_RefCount.h"
+#include "../Kernel/OVR_Atomic.h"
+#include "../Kernel/OVR_Threads.h"
+
+namespace OVR { namespace Util { namespace Render {
+
+
+//-----------------------------------------------------------------------------------
+// ***** Distortion Row Jobs
+//
+// For internal use by the Util_Render files that build meshes, maps and images a row at a time.
+
+// Rows of work handed out one at a time to whichever thread asks next.
+// Each row depends only on its own position, so the result is the same whatever the thread count.
+// Ref-counted because a helper thread can still be looking for work after the last row is done.
+class DistortionRowJob : public RefCountBase<DistortionRowJob>
+{
+public:
+    DistortionRowJob() : NumRows(0), NextRow(0), RowsDone(0) { }
+    virtual ~DistortionRowJob() { }
+
+    virtual void DoRow ( int row ) = 0;
+
+    int                         NumRows;
+    AtomicInt<int>              NextRow;
+    AtomicInt<int>              RowsDone;
+    Event                       Finished;
+};
+
+// Spreads the rows of the job over numThreads threads including the caller, 0 for one per CPU,
+// and returns when all are done. The helpers come from a pool kept between jobs.
+void DistortionRowJobRun ( DistortionRowJob *pjob, int numThreads );
+
+
+}}} // namespace OVR::Util::Render
+
+#endif // OVR_Util_Render_DistortionJob_h
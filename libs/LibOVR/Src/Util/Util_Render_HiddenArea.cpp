@@ -0,0 +1,459 @@
+/************************************************************************************
+
+Filename    :   Util_Render_HiddenArea.cpp
+Content     :   Meshes covering the rendertarget pixels the lens never shows
+Created     :   October 17, 2026
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "Util_Render_HiddenArea.h"
+
+namespace OVR { namespace Util { namespace Render {
+
+
+//-----------------------------------------------------------------------------------
+// *****  Hidden Area Mesh
+
+
+// How far beyond what a visible triangle samples a cell still counts as seen, in rendertarget NDC.
+// Covers the bilinear footprint and the adaptive mesh's error, a few pixels at the recommended size.
+static const float HAM_Margin           = 0.01f;
+// Keeps four vertices per rectangle within 16 bit indices for any pattern of hidden cells.
+static const int   HAM_MaxGridSize      = 128;
+// The eye looking straight ahead, and turned as far as the default FOV allows for.
+static const int   HAM_NumLensRims      = 2;
+
+
+static void HiddenAreaMeshFindLensRims ( LensRim rims[HAM_NumLensRims], bool rightEye,
+                                         const HmdRenderInfo &hmdRenderInfo, const ScaleAndOffset2D &eyeToSourceNDC )
+{
+    StereoEye eye = rightEye ? StereoEye_Right : StereoEye_Left;
+    rims[0] = CalculateLensRimFromHmdInfo ( eye, hmdRenderInfo, 0.0f );
+    rims[1] = CalculateLensRimFromHmdInfo ( eye, hmdRenderInfo, OVR_DEFAULT_EXTRA_EYE_ROTATION );
+    // The same margin in tan angles, along the axis where it is widest.
+    float margin = HAM_Margin / Alg::Min ( Alg::Abs ( eyeToSourceNDC.Scale.x ), Alg::Abs ( eyeToSourceNDC.Scale.y ) );
+    for ( int rimNum = 0; rimNum < HAM_NumLensRims; rimNum++ )
+    {
+        rims[rimNum].RadiusTan += margin;
+    }
+}
+
+// Whether any of the tan angle box can be seen past the lens rims.
+static bool HiddenAreaMeshBoxInsideRims ( const LensRim rims[HAM_NumLensRims], Vector2f lo, Vector2f hi )
+{
+    for ( int rimNum = 0; rimNum < HAM_NumLensRims; rimNum++ )
+    {
+        Vector2f center = rims[rimNum].CenterTan;
+        Vector2f nearest ( Alg::Clamp ( center.x, lo.x, hi.x ), Alg::Clamp ( center.y, lo.y, hi.y ) );
+        if ( ( nearest - center ).LengthSq() <= rims[rimNum].RadiusTan * rims[rimNum].RadiusTan )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void HiddenAreaMeshMarkSeen ( uint8_t *pSeen, int gridSize, const LensRim rims[HAM_NumLensRims],
+                                     const DistortionMeshVertexData *pVertices, const uint16_t *pTriangleListIndices,
+                                     int numTriangles, const ScaleAndOffset2D &eyeToSourceNDC )
+{
+    float cellsPerNDC = (float)gridSize * 0.5f;
+    for ( int tri = 0; tri < numTriangles; tri++ )
+    {
+        DistortionMeshVertexData const *pv[3];
+        float maxShade = -FLT_MAX;
+        for ( int k = 0; k < 3; k++ )
+        {
+            pv[k] = &pVertices[ pTriangleListIndices[tri*3+k] ];
+            maxShade = Alg::Max ( maxShade, pv[k]->Shade );
+        }
+        // Shade is interpolated linearly, so a triangle with black corners is black throughout.
+        if ( maxShade <= 0.0f )
+        {
+            continue;
+        }
+
+        // The tan angles are interpolated linearly too, so each channel looks inside the triangle
+        // its corners make, and samples inside the triangle they make in the rendertarget.
+        for ( int channel = 0; channel < 3; channel++ )
+        {
+            Vector2f tanLo (  FLT_MAX );
+            Vector2f tanHi ( -FLT_MAX );
+            for ( int k = 0; k < 3; k++ )
+            {
+                Vector2f const *pTan = &pv[k]->TanEyeAnglesR;
+                tanLo = Vector2f ( Alg::Min ( tanLo.x, pTan[channel].x ), Alg::Min ( tanLo.y, pTan[channel].y ) );
+                tanHi = Vector2f ( Alg::Max ( tanHi.x, pTan[channel].x ), Alg::Max ( tanHi.y, pTan[channel].y ) );
+            }
+            if ( !HiddenAreaMeshBoxInsideRims ( rims, tanLo, tanHi ) )
+            {
+                continue;
+            }
+            // The transform is a scale and offset, so the box maps to the box.
+            Vector2f ndc0 = TransformTanFovSpaceToRendertargetNDC ( eyeToSourceNDC, tanLo );
+            Vector2f ndc1 = TransformTanFovSpaceToRendertargetNDC ( eyeToSourceNDC, tanHi );
+            Vector2f lo ( Alg::Min ( ndc0.x, ndc1.x ), Alg::Min ( ndc0.y, ndc1.y ) );
+            Vector2f hi ( Alg::Max ( ndc0.x, ndc1.x ), Alg::Max ( ndc0.y, ndc1.y ) );
+            // Clamping to the lattice matches the sampler, which clamps reads off the edge to the border.
+            int x0 = Alg::Clamp ( (int)floorf ( ( lo.x - HAM_Margin + 1.0f ) * cellsPerNDC ), 0, gridSize - 1 );
+            int x1 = Alg::Clamp ( (int)floorf ( ( hi.x + HAM_Margin + 1.0f ) * cellsPerNDC ), 0, gridSize - 1 );
+            int y0 = Alg::Clamp ( (int)floorf ( ( lo.y - HAM_Margin + 1.0f ) * cellsPerNDC ), 0, gridSize - 1 );
+            int y1 = Alg::Clamp ( (int)floorf ( ( hi.y + HAM_Margin + 1.0f ) * cellsPerNDC ), 0, gridSize - 1 );
+            for ( int y = y0; y <= y1; y++ )
+            {
+                memset ( &pSeen[ y * gridSize + x0 ], 1, x1 - x0 + 1 );
+            }
+        }
+    }
+}
+
+bool HiddenAreaMeshCreate ( Vector2f **ppVertices, uint16_t **ppTriangleListIndices,
+                            int *pNumVertices, int *pNumTriangles,
+                            bool rightEye,
+                            const HmdRenderInfo &hmdRenderInfo,
+                            const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC,
+                            int gridSize /*= HiddenAreaMeshDefaultGridSize*/ )
+{
+    *ppVertices             = NULL;
+    *ppTriangleListIndices  = NULL;
+    *pNumVertices           = 0;
+    *pNumTriangles          = 0;
+    gridSize = Alg::Clamp ( gridSize, 1, HAM_MaxGridSize );
+
+    DistortionMeshVertexData *pMeshVertices = NULL;
+    uint16_t *pMeshIndices = NULL;
+    int meshVertexCount = 0, meshTriangleCount = 0;
+    DistortionMeshCreate ( &pMeshVertices, &pMeshIndices, &meshVertexCount, &meshTriangleCount,
+                           rightEye, hmdRenderInfo, distortion, eyeToSourceNDC );
+    if ( !pMeshVertices )
+    {
+        return false;
+    }
+    LensRim rims[HAM_NumLensRims];
+    HiddenAreaMeshFindLensRims ( rims, rightEye, hmdRenderInfo, eyeToSourceNDC );
+    Array<uint8_t> seen;
+    seen.Resize ( gridSize * gridSize );
+    memset ( &seen[0], 0, seen.GetSize() );
+    HiddenAreaMeshMarkSeen ( &seen[0], gridSize, rims, pMeshVertices, pMeshIndices, meshTriangleCount, eyeToSourceNDC );
+    DistortionMeshDestroy ( pMeshVertices, pMeshIndices );
+
+    // Each run of hidden cells in a row carries on the rectangle above it when that has the
+    // same ends, otherwise it starts a new one. Rectangles not carried on are finished.
+    Array<Recti> rects;
+    Array<Recti> open;
+    Array<Recti> carried;
+    for ( int y = 0; y <= gridSize; y++ )
+    {
+        carried.Resize ( 0 );
+        int x = 0;
+        while ( ( y < gridSize ) && ( x < gridSize ) )
+        {
+            if ( seen[ y * gridSize + x ] )
+            {
+                x++;
+                continue;
+            }
+            int runStart = x;
+            while ( ( x < gridSize ) && !seen[ y * gridSize + x ] )
+            {
+                x++;
+            }
+
+            Recti run ( runStart, y, x - runStart, 1 );
+            for ( int i = 0; i < (int)open.GetSize(); i++ )
+            {
+                if ( ( open[i].x == run.x ) && ( open[i].w == run.w ) )
+                {
+                    run = open[i];
+                    run.h++;
+                    open.RemoveAt ( i );
+                    break;
+                }
+            }
+            carried.PushBack ( run );
+        }
+        rects.Append ( open );
+        open = carried;
+    }
+
+    int numRects = (int)rects.GetSize();
+    if ( numRects == 0 )
+    {
+        return true;
+    }
+    *ppVertices             = (Vector2f*)OVR_ALLOC ( sizeof(Vector2f) * numRects * 4 );
+    *ppTriangleListIndices  = (uint16_t*)OVR_ALLOC ( sizeof(uint16_t) * numRects * 6 );
+    if ( !*ppVertices || !*ppTriangleListIndices )
+    {
+        HiddenAreaMeshDestroy ( *ppVertices, *ppTriangleListIndices );
+        *ppVertices             = NULL;
+        *ppTriangleListIndices  = NULL;
+        return false;
+    }
+
+    float ndcPerCell = 2.0f / (float)gridSize;
+    Vector2f *pVertex = *ppVertices;
+    uint16_t *pIndex  = *ppTriangleListIndices;
+    for ( int rectNum = 0; rectNum < numRects; rectNum++ )
+    {
+        Recti const &rect = rects[rectNum];
+        float x0 = (float)rect.x * ndcPerCell - 1.0f;
+        float y0 = (float)rect.y * ndcPerCell - 1.0f;
+        float x1 = (float)( rect.x + rect.w ) * ndcPerCell - 1.0f;
+        float y1 = (float)( rect.y + rect.h ) * ndcPerCell - 1.0f;
+        uint16_t first = (uint16_t)( rectNum * 4 );
+        *(pVertex++) = Vector2f ( x0, y0 );
+        *(pVertex++) = Vector2f ( x1, y0 );
+        *(pVertex++) = Vector2f ( x1, y1 );
+        *(pVertex++) = Vector2f ( x0, y1 );
+        // Anticlockwise with NDC y up.
+        *(pIndex++) = first;
+        *(pIndex++) = first + 1;
+        *(pIndex++) = first + 2;
+        *(pIndex++) = first;
+        *(pIndex++) = first + 2;
+        *(pIndex++) = first + 3;
+    }
+    *pNumVertices  = numRects * 4;
+    *pNumTriangles = numRects * 2;
+    return true;
+}
+
+void HiddenAreaMeshDestroy ( Vector2f *pVertices, uint16_t *pTriangleListIndices )
+{
+    OVR_FREE ( pVertices );
+    OVR_FREE ( pTriangleListIndices );
+}
+
+
+// Calls fn(x, y, b0, b1, b2) for every pixel whose centre is inside the triangle, with pixel
+// coordinates scaled from NDC to the given size.
+template<class Fn>
+static void HiddenAreaMeshRasterize ( Vector2f ndc0, Vector2f ndc1, Vector2f ndc2, Sizei pixels, Fn &fn )
+{
+    Vector2f size ( (float)pixels.w, (float)pixels.h );
+    Vector2f p0 = ( ndc0 * 0.5f + Vector2f ( 0.5f ) ).EntrywiseMultiply ( size );
+    Vector2f e1 = ( ndc1 * 0.5f + Vector2f ( 0.5f ) ).EntrywiseMultiply ( size ) - p0;
+    Vector2f e2 = ( ndc2 * 0.5f + Vector2f ( 0.5f ) ).EntrywiseMultiply ( size ) - p0;
+    float det = e1.x * e2.y - e1.y * e2.x;
+    if ( det == 0.0f )
+    {
+        return;
+    }
+
+    int minX = Alg::Max ( 0,            (int)floorf ( p0.x + Alg::Min ( 0.0f, Alg::Min ( e1.x, e2.x ) ) ) );
+    int maxX = Alg::Min ( pixels.w - 1, (int)ceilf  ( p0.x + Alg::Max ( 0.0f, Alg::Max ( e1.x, e2.x ) ) ) );
+    int minY = Alg::Max ( 0,            (int)floorf ( p0.y + Alg::Min ( 0.0f, Alg::Min ( e1.y, e2.y ) ) ) );
+    int maxY = Alg::Min ( pixels.h - 1, (int)ceilf  ( p0.y + Alg::Max ( 0.0f, Alg::Max ( e1.y, e2.y ) ) ) );
+    for ( int y = minY; y <= maxY; y++ )
+    {
+        for ( int x = minX; x <= maxX; x++ )
+        {
+            Vector2f ep = Vector2f ( (float)x + 0.5f, (float)y + 0.5f ) - p0;
+            float b1 = ( ep.x * e2.y - ep.y * e2.x ) / det;
+            float b2 = ( e1.x * ep.y - e1.y * ep.x ) / det;
+            float b0 = 1.0f - b1 - b2;
+            if ( ( b0 >= 0.0f ) && ( b1 >= 0.0f ) && ( b2 >= 0.0f ) )
+            {
+                fn ( x, y, b0, b1, b2 );
+            }
+        }
+    }
+}
+
+struct HiddenAreaMeshMarkHidden
+{
+    uint8_t    *pHidden;
+    int         Width;
+
+    void operator() ( int x, int y, float, float, float )
+    {
+        pHidden[ y * Width + x ] = 1;
+    }
+};
+
+struct HiddenAreaMeshMarkSampled
+{
+    uint8_t                        *pSampled;
+    Sizei                           Pixels;
+    ScaleAndOffset2D                EyeToSourceNDC;
+    LensRim                         Rims[HAM_NumLensRims];
+    DistortionMeshVertexData const *pv[3];
+
+    void operator() ( int x, int y, float b0, float b1, float b2 )
+    {
+        OVR_UNUSED2 ( x, y );
+        if ( pv[0]->Shade * b0 + pv[1]->Shade * b1 + pv[2]->Shade * b2 <= 0.0f )
+        {
+            return;
+        }
+        for ( int channel = 0; channel < 3; channel++ )
+        {
+            Vector2f const *pTan0 = &pv[0]->TanEyeAnglesR;
+            Vector2f const *pTan1 = &pv[1]->TanEyeAnglesR;
+            Vector2f const *pTan2 = &pv[2]->TanEyeAnglesR;
+            Vector2f tan = pTan0[channel] * b0 + pTan1[channel] * b1 + pTan2[channel] * b2;
+            if ( !HiddenAreaMeshBoxInsideRims ( Rims, tan, tan ) )
+            {
+                continue;
+            }
+            Vector2f ndc = TransformTanFovSpaceToRendertargetNDC ( EyeToSourceNDC, tan );
+            // The four texels a bilinear fetch reads, clamped to the edge.
+            float tx = ( ndc.x * 0.5f + 0.5f ) * (float)Pixels.w - 0.5f;
+            float ty = ( ndc.y * 0.5f + 0.5f ) * (float)Pixels.h - 0.5f;
+            int x0 = Alg::Clamp ( (int)floorf ( tx ), 0, Pixels.w - 1 );
+            int y0 = Alg::Clamp ( (int)floorf ( ty ), 0, Pixels.h - 1 );
+            int x1 = Alg::Clamp ( (int)floorf ( tx ) + 1, 0, Pixels.w - 1 );
+            int y1 = Alg::Clamp ( (int)floorf ( ty ) + 1, 0, Pixels.h - 1 );
+            pSampled[ y0 * Pixels.w + x0 ] = 1;
+            pSampled[ y0 * Pixels.w + x1 ] = 1;
+            pSampled[ y1 * Pixels.w + x0 ] = 1;
+            pSampled[ y1 * Pixels.w + x1 ] = 1;
+        }
+    }
+};
+
+HiddenAreaMeshCoverage HiddenAreaMeshMeasureCoverage ( const Vector2f *pHiddenVertices, const uint16_t *pHiddenTriangleListIndices,
+                                                       int numHiddenTriangles,
+                                                       const DistortionMeshVertexData *pVertices, const uint16_t *pTriangleListIndices,
+                                                       int numTriangles, bool rightEye,
+                                                       const HmdRenderInfo &hmdRenderInfo, const ScaleAndOffset2D &eyeToSourceNDC,
+                                                       Sizei eyePixels, Sizei rendertargetPixels )
+{
+    HiddenAreaMeshCoverage result;
+    result.NumPixels        = 0;
+    result.NumHiddenPixels  = 0;
+    result.NumWrongPixels   = 0;
+    if ( ( eyePixels.w <= 0 ) || ( eyePixels.h <= 0 ) || ( rendertargetPixels.w <= 0 ) || ( rendertargetPixels.h <= 0 ) )
+    {
+        return result;
+    }
+    result.NumPixels = rendertargetPixels.w * rendertargetPixels.h;
+
+    Array<uint8_t> hidden;
+    hidden.Resize ( result.NumPixels );
+    memset ( &hidden[0], 0, hidden.GetSize() );
+    HiddenAreaMeshMarkHidden markHidden;
+    markHidden.pHidden  = &hidden[0];
+    markHidden.Width    = rendertargetPixels.w;
+    for ( int tri = 0; tri < numHiddenTriangles; tri++ )
+    {
+        uint16_t const *pTri = &pHiddenTriangleListIndices[tri*3];
+        HiddenAreaMeshRasterize ( pHiddenVertices[pTri[0]], pHiddenVertices[pTri[1]], pHiddenVertices[pTri[2]],
+                                  rendertargetPixels, markHidden );
+    }
+
+    Array<uint8_t> sampled;
+    sampled.Resize ( result.NumPixels );
+    memset ( &sampled[0], 0, sampled.GetSize() );
+    HiddenAreaMeshMarkSampled markSampled;
+    markSampled.pSampled        = &sampled[0];
+    markSampled.Pixels          = rendertargetPixels;
+    markSampled.EyeToSourceNDC  = eyeToSourceNDC;
+    HiddenAreaMeshFindLensRims ( markSampled.Rims, rightEye, hmdRenderInfo, eyeToSourceNDC );
+    float xOffset = rightEye ? 1.0f : 0.0f;
+    for ( int tri = 0; tri < numTriangles; tri++ )
+    {
+        // Undo DistortionMeshMakeVertex's mapping to get back to this eye's screen NDC.
+        Vector2f screenNDC[3];
+        for ( int k = 0; k < 3; k++ )
+        {
+            markSampled.pv[k] = &pVertices[ pTriangleListIndices[tri*3+k] ];
+            screenNDC[k] = Vector2f ( ( markSampled.pv[k]->ScreenPosNDC.x + 0.5f - xOffset ) * 2.0f,
+                                      -markSampled.pv[k]->ScreenPosNDC.y );
+        }
+        HiddenAreaMeshRasterize ( screenNDC[0], screenNDC[1], screenNDC[2], eyePixels, markSampled );
+    }
+
+    for ( int i = 0; i < result.NumPixels; i++ )
+    {
+        result.NumHiddenPixels += hidden[i];
+        result.NumWrongPixels  += hidden[i] & sampled[i];
+    }
+    return result;
+}
+
+#ifdef OVR_HIDDEN_AREA_MESH_TEST
+void HiddenAreaMeshLogReport ( )
+{
+    const HmdTypeEnum hmdTypes[]    = { HmdType_DK1, HmdType_DK2 };
+    const char *      hmdNames[]    = { "DK1", "DK2" };
+
+    LogText ( "Hidden area mesh, %dx%d cells\n", HiddenAreaMeshDefaultGridSize, HiddenAreaMeshDefaultGridSize );
+    LogText ( "HMD eye   fov      rendertarget   tris  hidden  wrong uniform  wrong adaptive\n" );
+    for ( int hmdNum = 0; hmdNum < 2; hmdNum++ )
+    {
+        DebugHmdSetup hmd = CreateDebugHmdSetup ( hmdTypes[hmdNum] );
+        HmdRenderInfo const &renderInfo = hmd.RenderInfo;
+        Sizei eyePixels = hmd.EyePixels;
+
+        for ( int eyeNum = 0; eyeNum < 2; eyeNum++ )
+        {
+            StereoEye eye = ( eyeNum == 0 ) ? StereoEye_Left : StereoEye_Right;
+            DistortionRenderDesc const &distortion = hmd.Distortion[eyeNum];
+
+            // The CAPI's default and maximum eye FOVs.
+            for ( int maxFov = 0; maxFov < 2; maxFov++ )
+            {
+                FovPort fov = maxFov ? GetPhysicalScreenFov ( eye, distortion ) : hmd.Fov[eyeNum];
+                ScaleAndOffset2D eyeToSourceNDC = CreateNDCScaleAndOffsetFromFov ( fov );
+                Sizei rendertargetPixels = CalculateIdealPixelSize ( eye, distortion, fov, 1.0f );
+
+                Vector2f *pHiddenVertices = NULL;
+                uint16_t *pHiddenIndices = NULL;
+                int numHiddenVertices = 0, numHiddenTriangles = 0;
+                HiddenAreaMeshCreate ( &pHiddenVertices, &pHiddenIndices, &numHiddenVertices, &numHiddenTriangles,
+                                       eyeNum == 1, renderInfo, distortion, eyeToSourceNDC );
+
+                HiddenAreaMeshCoverage coverage[2];
+                for ( int adaptive = 0; adaptive < 2; adaptive++ )
+                {
+                    DistortionMeshVertexData *pVertices = NULL;
+                    uint16_t *pIndices = NULL;
+                    int numVertices = 0, numTriangles = 0;
+                    if ( adaptive )
+                    {
+                        DistortionMeshCreateAdaptive ( &pVertices, &pIndices, &numVertices, &numTriangles, eyeNum == 1,
+                                                       renderInfo, distortion, eyeToSourceNDC, 1.0f / 1024.0f );
+                    }
+                    else
+                    {
+                        DistortionMeshCreate ( &pVertices, &pIndices, &numVertices, &numTriangles, eyeNum == 1,
+                                               renderInfo, distortion, eyeToSourceNDC );
+                    }
+                    coverage[adaptive] = HiddenAreaMeshMeasureCoverage ( pHiddenVertices, pHiddenIndices, numHiddenTriangles,
+                                                                         pVertices, pIndices, numTriangles, eyeNum == 1,
+                                                                         renderInfo, eyeToSourceNDC, eyePixels, rendertargetPixels );
+                    DistortionMeshDestroy ( pVertices, pIndices );
+                }
+
+                float hiddenPercent = ( coverage[0].NumPixels > 0 ) ? 100.0f * (float)coverage[0].NumHiddenPixels / (float)coverage[0].NumPixels : 0.0f;
+                LogText ( "%-3s %-5s %-7s %5dx%-5d  %5d  %5.1f%%  %13d  %14d\n", hmdNames[hmdNum], eyeNum == 0 ? "left" : "right",
+                          maxFov ? "max" : "default", rendertargetPixels.w, rendertargetPixels.h, numHiddenTriangles, hiddenPercent,
+                          coverage[0].NumWrongPixels, coverage[1].NumWrongPixels );
+                HiddenAreaMeshDestroy ( pHiddenVertices, pHiddenIndices );
+            }
+        }
+    }
+}
+#endif // OVR_HIDDEN_AREA_MESH_TEST
+
+
+}}} // namespace OVR::Util::Render
@@ -0,0 +1,89 @@
+/************************************************************************************
+
+Filename    :   Util_Render_HiddenArea.h
+Content     :   Meshes covering the rendertarget pixels the lens never shows
+Created     :   October 17, 2026
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#ifndef OVR_Util_Render_HiddenArea_h
+#define OVR_Util_Render_HiddenArea_h
+
+#include "Util_Render_Stereo.h"
+
+// Define this to compile-in the hidden area mesh report
+//#define OVR_HIDDEN_AREA_MESH_TEST
+
+namespace OVR { namespace Util { namespace Render {
+
+
+//-----------------------------------------------------------------------------------
+// *****  Hidden Area Mesh
+//
+// The parts of an eye's rendertarget that the eye never sees: past the rim of the lens, off
+// the screen, or where the vignette has faded to black. Drawing the mesh into the depth buffer at the near
+// plane, or into the stencil buffer, before the scene saves shading those pixels.
+
+static const int HiddenAreaMeshDefaultGridSize = 64;
+
+// Builds the mesh for one eye from the uniform distortion mesh. A cell of a gridSize x gridSize
+// lattice over the eye's rendertarget viewport is hidden when no distortion triangle with any
+// shade left, and inside the lens rim for the eye looking ahead or turned as far as
+// OVR_DEFAULT_EXTRA_EYE_ROTATION, can sample it in any colour channel. Hidden cells are merged into rectangles of two
+// triangles each. Vertices are in rendertarget NDC, like TransformTanFovSpaceToRendertargetNDC,
+// so draw it with identity matrices once the eye's viewport is set; it suits any viewport size.
+// gridSize is at most 128. Returns false if out of memory; a mesh of no triangles, with NULL
+// buffers, means nothing is hidden.
+bool HiddenAreaMeshCreate ( Vector2f **ppVertices, uint16_t **ppTriangleListIndices,
+                            int *pNumVertices, int *pNumTriangles,
+                            bool rightEye,
+                            const HmdRenderInfo &hmdRenderInfo,
+                            const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC,
+                            int gridSize = HiddenAreaMeshDefaultGridSize );
+
+void HiddenAreaMeshDestroy ( Vector2f *pVertices, uint16_t *pTriangleListIndices );
+
+struct HiddenAreaMeshCoverage
+{
+    int         NumPixels;          // Pixels in the eye's rendertarget viewport.
+    int         NumHiddenPixels;    // Pixels under the hidden area mesh.
+    int         NumWrongPixels;     // Hidden pixels the distortion mesh samples anyway. Should be 0.
+};
+
+// Rasterizes the hidden area mesh over the rendertarget viewport, and the distortion mesh over
+// the eye's screen pixels the way DistortionMeshMeasureError does, marking the texels the
+// bilinear fetches of every pixel with some shade and inside the lens rim touch.
+HiddenAreaMeshCoverage HiddenAreaMeshMeasureCoverage ( const Vector2f *pHiddenVertices, const uint16_t *pHiddenTriangleListIndices,
+                                                       int numHiddenTriangles,
+                                                       const DistortionMeshVertexData *pVertices, const uint16_t *pTriangleListIndices,
+                                                       int numTriangles, bool rightEye,
+                                                       const HmdRenderInfo &hmdRenderInfo, const ScaleAndOffset2D &eyeToSourceNDC,
+                                                       Sizei eyePixels, Sizei rendertargetPixels );
+
+#ifdef OVR_HIDDEN_AREA_MESH_TEST
+// Logs triangle counts and the share of rendertarget pixels hidden for both eyes of the debug
+// DK1 and DK2 at their recommended rendertarget size, checked against the uniform and adaptive meshes.
+void HiddenAreaMeshLogReport ( );
+#endif
+
+
+}}} // namespace OVR::Util::Render
+
+#endif // OVR_Util_Render_HiddenArea_h
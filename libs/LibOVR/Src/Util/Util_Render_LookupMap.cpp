@@ -0,0 +1,588 @@
+/************************************************************************************
+
+Filename    :   Util_Render_LookupMap.cpp
+Content     :   Per-pixel distortion lookup maps
+Created     :   October 17, 2026
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "Util_Render_LookupMap.h"
+#include "Util_Render_DistortionJob.h"
+#include "../Kernel/OVR_Timer.h"
+#include "../Kernel/OVR_SysFile.h"
+#include "../Kernel/OVR_CRC32.h"
+
+namespace OVR { namespace Util { namespace Render {
+
+
+//-----------------------------------------------------------------------------------
+// *****  Distortion Lookup Map
+
+// Texels that go through the lens spline in one batch, few enough to keep on the stack.
+static const int DLM_BatchSize = 256;
+
+static const char       DLM_FileMagic[4]    = { 'O', 'D', 'L', 'M' };
+static const uint32_t   DLM_FileVersion     = 1;
+
+// Everything in the file is in the byte order of the machine that wrote it.
+struct DistortionMapFileHeader
+{
+    char        Magic[4];
+    uint32_t    Version;
+    int32_t     Width;
+    int32_t     Height;
+    uint32_t    Format;
+    uint32_t    SourceKey;
+    float       UVScale[2];
+    float       UVBias[2];
+    uint32_t    DataBytes;
+    uint32_t    DataChecksum;
+};
+
+static uint32_t DistortionMapMakeSourceKey ( const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceUV )
+{
+    // Both hold only floats and enums, so there is no padding to trip over.
+    uint32_t key = CRC32_Calculate ( &distortion, sizeof(distortion) );
+    return CRC32_Calculate ( &eyeToSourceUV, sizeof(eyeToSourceUV), key );
+}
+
+// Fletcher style sum over 32 bit words. The texel data runs to megabytes, and a CRC of it
+// would take longer than making the map again.
+static uint32_t DistortionMapChecksum ( uint8_t const *pData, int bytes )
+{
+    uint64_t sum1 = 0, sum2 = 0;
+    int words = bytes / 4;
+    for ( int i = 0; i < words; i++ )
+    {
+        uint32_t word;
+        memcpy ( &word, pData + i * 4, sizeof(word) );
+        sum1 += word;
+        sum2 += sum1;
+    }
+    for ( int i = words * 4; i < bytes; i++ )
+    {
+        sum1 += pData[i];
+        sum2 += sum1;
+    }
+    return (uint32_t)( sum1 ^ ( sum1 >> 32 ) ) ^ (uint32_t)( ( sum2 ^ ( sum2 >> 32 ) ) * 2654435761u );
+}
+
+static Vector2f DistortionMapTexelToScreenNDC ( Sizei resolution, int x, int y )
+{
+    return Vector2f ( ( (float)x + 0.5f ) / (float)resolution.w * 2.0f - 1.0f,
+                      ( (float)y + 0.5f ) / (float)resolution.h * 2.0f - 1.0f );
+}
+
+// Rendertarget UVs of the red, green and blue channels for up to DLM_BatchSize screen positions.
+static void DistortionMapComputeUVs ( Vector2f *pUVs[3], const Vector2f *pScreenNDC, int count,
+                                      const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceUV )
+{
+    OVR_ASSERT ( count <= DLM_BatchSize );
+    TransformScreenNDCToTanFovSpaceChroma ( pUVs[0], pUVs[1], pUVs[2], distortion, pScreenNDC, count );
+    for ( int channel = 0; channel < 3; channel++ )
+    {
+        Vector2f *pUV = pUVs[channel];
+        for ( int i = 0; i < count; i++ )
+        {
+            pUV[i] = TransformTanFovSpaceToRendertargetTexUV ( eyeToSourceUV, pUV[i] );
+        }
+    }
+}
+
+class DistortionMapJob : public DistortionRowJob
+{
+public:
+    DistortionMap              *pMap;
+    const DistortionRenderDesc *pDistortion;
+    ScaleAndOffset2D            EyeToSourceUV;
+
+    // Row y of all three channels, in batches across the row.
+    virtual void DoRow ( int y )
+    {
+        Vector2f screenNDC[DLM_BatchSize];
+        Vector2f uvR[DLM_BatchSize], uvG[DLM_BatchSize], uvB[DLM_BatchSize];
+        Vector2f *pUVs[3] = { uvR, uvG, uvB };
+
+        const DistortionMap &map = *pMap;
+        Vector2f invUVScale ( 1.0f / map.UVScale.x, 1.0f / map.UVScale.y );
+        for ( int x0 = 0; x0 < map.Resolution.w; x0 += DLM_BatchSize )
+        {
+            int count = Alg::Min ( DLM_BatchSize, map.Resolution.w - x0 );
+            for ( int i = 0; i < count; i++ )
+            {
+                screenNDC[i] = DistortionMapTexelToScreenNDC ( map.Resolution, x0 + i, y );
+            }
+            DistortionMapComputeUVs ( pUVs, screenNDC, count, *pDistortion, EyeToSourceUV );
+
+            int firstTexel = y * map.Resolution.w + x0;
+            for ( int channel = 0; channel < 3; channel++ )
+            {
+                Vector2f const *pUV = pUVs[channel];
+                if ( map.Format == DistortionMapFormat_RG16 )
+                {
+                    uint16_t *pTexel = (uint16_t*)map.GetChannel ( channel ) + firstTexel * 2;
+                    for ( int i = 0; i < count; i++ )
+                    {
+                        Vector2f normalized = ( pUV[i] - map.UVBias ).EntrywiseMultiply ( invUVScale );
+                        pTexel[i*2+0] = (uint16_t)( Alg::Clamp ( normalized.x, 0.0f, 1.0f ) * 65535.0f + 0.5f );
+                        pTexel[i*2+1] = (uint16_t)( Alg::Clamp ( normalized.y, 0.0f, 1.0f ) * 65535.0f + 0.5f );
+                    }
+                }
+                else
+                {
+                    memcpy ( (float*)map.GetChannel ( channel ) + firstTexel * 2, pUV, sizeof(Vector2f) * count );
+                }
+            }
+        }
+    }
+};
+
+// The distortion grows with radius, so the outline of the map holds its smallest and
+// largest UVs. Sets the RG16 range to cover them.
+static void DistortionMapFindUVRange ( DistortionMap *pMap, const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceUV )
+{
+    Sizei res = pMap->Resolution;
+    Vector2f screenNDC[DLM_BatchSize];
+    Vector2f uvR[DLM_BatchSize], uvG[DLM_BatchSize], uvB[DLM_BatchSize];
+    Vector2f *pUVs[3] = { uvR, uvG, uvB };
+    Vector2f uvMin (  1e30f );
+    Vector2f uvMax ( -1e30f );
+
+    int perimeter = 2 * ( res.w + res.h );
+    for ( int first = 0; first < perimeter; first += DLM_BatchSize )
+    {
+        int count = Alg::Min ( DLM_BatchSize, perimeter - first );
+        for ( int i = 0; i < count; i++ )
+        {
+            int k = first + i;
+            int x, y;
+            if      ( k < res.w )                 { x = k;                        y = 0; }
+            else if ( k < 2 * res.w )             { x = k - res.w;                y = res.h - 1; }
+            else if ( k < 2 * res.w + res.h )     { x = 0;                        y = k - 2 * res.w; }
+            else                                  { x = res.w - 1;                y = k - 2 * res.w - res.h; }
+            screenNDC[i] = DistortionMapTexelToScreenNDC ( res, x, y );
+        }
+        DistortionMapComputeUVs ( pUVs, screenNDC, count, distortion, eyeToSourceUV );
+        for ( int channel = 0; channel < 3; channel++ )
+        {
+            for ( int i = 0; i < count; i++ )
+            {
+                uvMin.x = Alg::Min ( uvMin.x, pUVs[channel][i].x );
+                uvMin.y = Alg::Min ( uvMin.y, pUVs[channel][i].y );
+                uvMax.x = Alg::Max ( uvMax.x, pUVs[channel][i].x );
+                uvMax.y = Alg::Max ( uvMax.y, pUVs[channel][i].y );
+            }
+        }
+    }
+
+    pMap->UVBias  = uvMin;
+    pMap->UVScale = Vector2f ( Alg::Max ( uvMax.x - uvMin.x, 1e-6f ), Alg::Max ( uvMax.y - uvMin.y, 1e-6f ) );
+}
+
+Vector2f DistortionMap::GetUV ( int channel, int x, int y ) const
+{
+    OVR_ASSERT ( ( x >= 0 ) && ( x < Resolution.w ) && ( y >= 0 ) && ( y < Resolution.h ) );
+    int texel = y * Resolution.w + x;
+    if ( Format == DistortionMapFormat_RG16 )
+    {
+        uint16_t const *pTexel = (uint16_t const*)GetChannel ( channel ) + texel * 2;
+        Vector2f normalized ( (float)pTexel[0] * ( 1.0f / 65535.0f ), (float)pTexel[1] * ( 1.0f / 65535.0f ) );
+        return normalized.EntrywiseMultiply ( UVScale ) + UVBias;
+    }
+    float const *pTexel = (float const*)GetChannel ( channel ) + texel * 2;
+    return Vector2f ( pTexel[0], pTexel[1] );
+}
+
+bool DistortionMapCreate ( DistortionMap *pMap, Sizei resolution, DistortionMapFormat format,
+                           const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceUV,
+                           int numThreads /*= 0*/ )
+{
+    OVR_ASSERT ( ( resolution.w > 0 ) && ( resolution.h > 0 ) );
+    pMap->Resolution    = resolution;
+    pMap->Format        = format;
+    pMap->UVScale       = Vector2f ( 1.0f );
+    pMap->UVBias        = Vector2f ( 0.0f );
+    pMap->SourceKey     = DistortionMapMakeSourceKey ( distortion, eyeToSourceUV );
+    pMap->pTexels       = OVR_ALLOC ( 3 * pMap->GetChannelSize() );
+    if ( !pMap->pTexels )
+    {
+        pMap->Resolution = Sizei ( 0 );
+        return false;
+    }
+
+    if ( format == DistortionMapFormat_RG16 )
+    {
+        DistortionMapFindUVRange ( pMap, distortion, eyeToSourceUV );
+    }
+
+    Ptr<DistortionMapJob> job = *new DistortionMapJob;
+    job->pMap           = pMap;
+    job->pDistortion    = &distortion;
+    job->EyeToSourceUV  = eyeToSourceUV;
+    job->NumRows        = resolution.h;
+    DistortionRowJobRun ( job, numThreads );
+    return true;
+}
+
+void DistortionMapDestroy ( DistortionMap *pMap )
+{
+    OVR_FREE ( pMap->pTexels );
+    pMap->pTexels       = NULL;
+    pMap->Resolution    = Sizei ( 0 );
+}
+
+// Each component is predicted from the two before it along the row, and the difference
+// stored in a byte. A smooth map rarely misses by more than a unit or two; the odd bigger
+// miss, and the start of each row, escape to the full 16 bit value.
+static const int DLM_Escape = -128;
+
+static void DistortionMapEncodeRG16 ( Array<uint8_t> *pData, const DistortionMap &map )
+{
+    pData->Reserve ( 3 * map.Resolution.w * map.Resolution.h * 2 + 1024 );
+    for ( int row = 0; row < 3 * map.Resolution.h; row++ )
+    {
+        uint16_t const *pTexel = (uint16_t const*)map.pTexels + row * map.Resolution.w * 2;
+        for ( int component = 0; component < 2; component++ )
+        {
+            int prev1 = 0, prev2 = 0;
+            for ( int x = 0; x < map.Resolution.w; x++ )
+            {
+                int value = pTexel[x*2 + component];
+                int predicted = ( x >= 2 ) ? ( 2 * prev1 - prev2 ) : prev1;
+                int delta = value - predicted;
+                if ( ( x == 0 ) || ( delta <= DLM_Escape ) || ( delta > 127 ) )
+                {
+                    pData->PushBack ( (uint8_t)(int8_t)DLM_Escape );
+                    pData->PushBack ( (uint8_t)( value & 0xff ) );
+                    pData->PushBack ( (uint8_t)( value >> 8 ) );
+                }
+                else
+                {
+                    pData->PushBack ( (uint8_t)(int8_t)delta );
+                }
+                prev2 = prev1;
+                prev1 = value;
+            }
+        }
+    }
+}
+
+static bool DistortionMapDecodeRG16 ( DistortionMap *pMap, uint8_t const *pData, int dataBytes )
+{
+    uint8_t const *pEnd = pData + dataBytes;
+    for ( int row = 0; row < 3 * pMap->Resolution.h; row++ )
+    {
+        uint16_t *pTexel = (uint16_t*)pMap->pTexels + row * pMap->Resolution.w * 2;
+        for ( int component = 0; component < 2; component++ )
+        {
+            // Every row starts with an escape, which also gets the predictor going.
+            if ( ( pEnd - pData < 3 ) || ( (int8_t)pData[0] != DLM_Escape ) )
+            {
+                return false;
+            }
+            int prev2 = pData[1] | ( pData[2] << 8 );
+            int prev1 = prev2;
+            pTexel[component] = (uint16_t)prev1;
+            pData += 3;
+            for ( int x = 1; x < pMap->Resolution.w; x++ )
+            {
+                if ( pData == pEnd )
+                {
+                    return false;
+                }
+                int delta = (int8_t)*pData++;
+                int value = 2 * prev1 - prev2 + delta;
+                if ( delta == DLM_Escape )
+                {
+                    if ( pEnd - pData < 2 )
+                    {
+                        return false;
+                    }
+                    value = pData[0] | ( pData[1] << 8 );
+                    pData += 2;
+                }
+                // Out of range values can only come from a damaged file.
+                if ( (unsigned)value > 0xffff )
+                {
+                    return false;
+                }
+                pTexel[x*2 + component] = (uint16_t)value;
+                prev2 = prev1;
+                prev1 = value;
+            }
+        }
+    }
+    return ( pData == pEnd );
+}
+
+bool DistortionMapSave ( const DistortionMap &map, const char *path )
+{
+    if ( !map.pTexels )
+    {
+        return false;
+    }
+
+    Array<uint8_t> encoded;
+    uint8_t const *pData = (uint8_t const*)map.pTexels;
+    int dataBytes = 3 * map.GetChannelSize();
+    if ( map.Format == DistortionMapFormat_RG16 )
+    {
+        DistortionMapEncodeRG16 ( &encoded, map );
+        pData = &encoded[0];
+        dataBytes = (int)encoded.GetSize();
+    }
+
+    DistortionMapFileHeader header;
+    memcpy ( header.Magic, DLM_FileMagic, sizeof(header.Magic) );
+    header.Version      = DLM_FileVersion;
+    header.Width        = map.Resolution.w;
+    header.Height       = map.Resolution.h;
+    header.Format       = (uint32_t)map.Format;
+    header.SourceKey    = map.SourceKey;
+    header.UVScale[0]   = map.UVScale.x;
+    header.UVScale[1]   = map.UVScale.y;
+    header.UVBias[0]    = map.UVBias.x;
+    header.UVBias[1]    = map.UVBias.y;
+    header.DataBytes    = (uint32_t)dataBytes;
+    header.DataChecksum = DistortionMapChecksum ( pData, dataBytes );
+
+    SysFile f;
+    if ( !f.Open ( path, File::Open_Write | File::Open_Create | File::Open_Truncate, File::Mode_Write ) )
+    {
+        return false;
+    }
+    bool ok = ( f.Write ( (uint8_t const*)&header, sizeof(header) ) == (int)sizeof(header) ) &&
+              ( f.Write ( pData, dataBytes ) == dataBytes );
+    f.Close();
+    return ok;
+}
+
+bool DistortionMapLoad ( DistortionMap *pMap, const char *path,
+                         const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceUV )
+{
+    SysFile f;
+    if ( !f.Open ( path, File::Open_Read, File::Mode_Read ) )
+    {
+        return false;
+    }
+
+    DistortionMapFileHeader header;
+    int length = f.GetLength();
+    if ( ( length < (int)sizeof(header) ) ||
+         ( f.Read ( (uint8_t*)&header, sizeof(header) ) != (int)sizeof(header) ) )
+    {
+        return false;
+    }
+    if ( ( memcmp ( header.Magic, DLM_FileMagic, sizeof(header.Magic) ) != 0 ) ||
+         ( header.Version != DLM_FileVersion ) ||
+         ( header.Format > (uint32_t)DistortionMapFormat_RG32F ) ||
+         ( header.Width <= 0 ) || ( header.Width > 16384 ) ||
+         ( header.Height <= 0 ) || ( header.Height > 16384 ) ||
+         ( header.DataBytes != (uint32_t)( length - (int)sizeof(header) ) ) ||
+         ( header.SourceKey != DistortionMapMakeSourceKey ( distortion, eyeToSourceUV ) ) )
+    {
+        return false;
+    }
+
+    DistortionMap map;
+    map.Resolution  = Sizei ( header.Width, header.Height );
+    map.Format      = (DistortionMapFormat)header.Format;
+    map.UVScale     = Vector2f ( header.UVScale[0], header.UVScale[1] );
+    map.UVBias      = Vector2f ( header.UVBias[0], header.UVBias[1] );
+    map.SourceKey   = header.SourceKey;
+    int dataBytes   = (int)header.DataBytes;
+    if ( ( map.Format == DistortionMapFormat_RG32F ) && ( dataBytes != 3 * map.GetChannelSize() ) )
+    {
+        return false;
+    }
+
+    map.pTexels = OVR_ALLOC ( 3 * map.GetChannelSize() );
+    if ( !map.pTexels )
+    {
+        return false;
+    }
+    // RG32F texels are stored as they are, so they can be read straight into place.
+    uint8_t *pData = ( map.Format == DistortionMapFormat_RG32F ) ? (uint8_t*)map.pTexels : (uint8_t*)OVR_ALLOC ( dataBytes );
+    bool ok = ( pData != NULL ) && ( dataBytes > 0 ) && ( f.Read ( pData, dataBytes ) == dataBytes ) &&
+              ( DistortionMapChecksum ( pData, dataBytes ) == header.DataChecksum );
+    f.Close();
+    if ( ok && ( map.Format == DistortionMapFormat_RG16 ) )
+    {
+        ok = DistortionMapDecodeRG16 ( &map, pData, dataBytes );
+    }
+    if ( pData != map.pTexels )
+    {
+        OVR_FREE ( pData );
+    }
+    if ( !ok )
+    {
+        DistortionMapDestroy ( &map );
+        return false;
+    }
+
+    *pMap = map;
+    return true;
+}
+
+#ifdef OVR_DISTORTION_MAP_TEST
+// Worst and rms UV error of the map sampled bilinearly at every pixel centre of the eye,
+// against the exact distortion, over the same pixels DistortionMeshMeasureError covers.
+static DistortionMeshError DistortionMapMeasureError ( const DistortionMap &map, const DistortionRenderDesc &distortion,
+                                                       const ScaleAndOffset2D &eyeToSourceUV, Sizei eyePixels )
+{
+    DistortionMeshError result;
+    result.MaxUVError = 0.0f;
+    result.RmsUVError = 0.0f;
+    result.NumPixels  = 0;
+    double sumSquares = 0.0;
+
+    Vector2f screenNDC[DLM_BatchSize];
+    Vector2f uvR[DLM_BatchSize], uvG[DLM_BatchSize], uvB[DLM_BatchSize];
+    Vector2f *pUVs[3] = { uvR, uvG, uvB };
+    for ( int y = 0; y < eyePixels.h; y++ )
+    {
+        float mapY = Alg::Clamp ( ( (float)y + 0.5f ) / (float)eyePixels.h * (float)map.Resolution.h - 0.5f,
+                                  0.0f, (float)( map.Resolution.h - 1 ) );
+        int y0 = Alg::Min ( (int)mapY, map.Resolution.h - 2 );
+        float fy = mapY - (float)y0;
+        if ( map.Resolution.h == 1 )
+        {
+            y0 = 0;
+            fy = 0.0f;
+        }
+        int y1 = Alg::Min ( y0 + 1, map.Resolution.h - 1 );
+
+        for ( int x0 = 0; x0 < eyePixels.w; x0 += DLM_BatchSize )
+        {
+            int count = Alg::Min ( DLM_BatchSize, eyePixels.w - x0 );
+            for ( int i = 0; i < count; i++ )
+            {
+                screenNDC[i] = DistortionMapTexelToScreenNDC ( eyePixels, x0 + i, y );
+            }
+            DistortionMapComputeUVs ( pUVs, screenNDC, count, distortion, eyeToSourceUV );
+
+            for ( int i = 0; i < count; i++ )
+            {
+                float mapX = Alg::Clamp ( ( (float)( x0 + i ) + 0.5f ) / (float)eyePixels.w * (float)map.Resolution.w - 0.5f,
+                                          0.0f, (float)( map.Resolution.w - 1 ) );
+                int tx0 = Alg::Max ( 0, Alg::Min ( (int)mapX, map.Resolution.w - 2 ) );
+                int tx1 = Alg::Min ( tx0 + 1, map.Resolution.w - 1 );
+                float fx = mapX - (float)tx0;
+
+                float error = 0.0f;
+                for ( int channel = 0; channel < 3; channel++ )
+                {
+                    Vector2f top    = map.GetUV ( channel, tx0, y0 ) * ( 1.0f - fx ) + map.GetUV ( channel, tx1, y0 ) * fx;
+                    Vector2f bottom = map.GetUV ( channel, tx0, y1 ) * ( 1.0f - fx ) + map.GetUV ( channel, tx1, y1 ) * fx;
+                    Vector2f uv     = top * ( 1.0f - fy ) + bottom * fy;
+                    error = Alg::Max ( error, ( uv - pUVs[channel][i] ).Length() );
+                }
+                result.MaxUVError = Alg::Max ( result.MaxUVError, error );
+                sumSquares += (double)error * (double)error;
+                result.NumPixels++;
+            }
+        }
+    }
+
+    if ( result.NumPixels > 0 )
+    {
+        result.RmsUVError = (float)sqrt ( sumSquares / (double)result.NumPixels );
+    }
+    return result;
+}
+
+void DistortionMapLogReport ( const char *tempPath )
+{
+    DebugHmdSetup hmd = CreateDebugHmdSetup ( HmdType_DK2 );
+    HmdRenderInfo const &renderInfo = hmd.RenderInfo;
+    Sizei eyePixels = hmd.EyePixels;
+    DistortionRenderDesc const &distortion = hmd.Distortion[0];
+    ScaleAndOffset2D const &eyeToSourceNDC = hmd.EyeToSourceNDC[0];
+    // UVs across the whole rendertarget, the units DistortionMeshMeasureError uses.
+    ScaleAndOffset2D eyeToSourceUV = CreateUVScaleAndOffsetfromNDCScaleandOffset ( eyeToSourceNDC, Recti ( 0, 0, 1, 1 ), Sizei ( 1 ) );
+
+    LogText ( "Distortion lookup map against mesh, DK2 left eye, %dx%d pixels\n", eyePixels.w, eyePixels.h );
+    LogText ( "kind   size        create ms  memory KB  file KB   load ms  max UV err  rms UV err\n" );
+
+    DistortionMeshVertexData *pVertices = NULL;
+    uint16_t *pIndices = NULL;
+    int numVertices = 0, numTriangles = 0;
+    double start = Timer::GetSeconds();
+    DistortionMeshCreate ( &pVertices, &pIndices, &numVertices, &numTriangles, false,
+                           renderInfo, distortion, eyeToSourceNDC );
+    double createTime = Timer::GetSeconds() - start;
+    if ( pVertices )
+    {
+        DistortionMeshError error = DistortionMeshMeasureError ( pVertices, pIndices, numTriangles, false,
+                                                                 distortion, eyeToSourceNDC, eyePixels );
+        int bytes = numVertices * sizeof(DistortionMeshVertexData) + numTriangles * 3 * sizeof(uint16_t);
+        int gridSize = (int)sqrtf ( (float)numVertices ) - 1;
+        LogText ( "mesh   %4dx%-4d   %9.2f  %9d        -         -  %10.6f  %10.6f\n", gridSize, gridSize,
+                  createTime * 1000.0, bytes / 1024, error.MaxUVError, error.RmsUVError );
+        DistortionMeshDestroy ( pVertices, pIndices );
+    }
+
+    for ( int divisor = 1; divisor <= 2; divisor *= 2 )
+    {
+        for ( int formatNum = 0; formatNum < 2; formatNum++ )
+        {
+            DistortionMapFormat format = ( formatNum == 0 ) ? DistortionMapFormat_RG16 : DistortionMapFormat_RG32F;
+            Sizei resolution ( eyePixels.w / divisor, eyePixels.h / divisor );
+
+            DistortionMap map;
+            start = Timer::GetSeconds();
+            if ( !DistortionMapCreate ( &map, resolution, format, distortion, eyeToSourceUV ) )
+            {
+                continue;
+            }
+            createTime = Timer::GetSeconds() - start;
+
+            int fileBytes = 0;
+            double loadTime = 0.0;
+            if ( DistortionMapSave ( map, tempPath ) )
+            {
+                DistortionMap loaded;
+                start = Timer::GetSeconds();
+                bool ok = DistortionMapLoad ( &loaded, tempPath, distortion, eyeToSourceUV );
+                loadTime = Timer::GetSeconds() - start;
+                if ( ok )
+                {
+                    OVR_ASSERT ( memcmp ( loaded.pTexels, map.pTexels, 3 * map.GetChannelSize() ) == 0 );
+                    SysFile f;
+                    if ( f.Open ( tempPath, File::Open_Read, File::Mode_Read ) )
+                    {
+                        fileBytes = f.GetLength();
+                    }
+                    DistortionMapDestroy ( &loaded );
+                }
+            }
+
+            DistortionMeshError error = DistortionMapMeasureError ( map, distortion, eyeToSourceUV, eyePixels );
+            LogText ( "%-6s %4dx%-4d   %9.2f  %9d  %7d  %8.2f  %10.6f  %10.6f\n", formatNum == 0 ? "RG16" : "RG32F",
+                      resolution.w, resolution.h, createTime * 1000.0, 3 * map.GetChannelSize() / 1024,
+                      fileBytes / 1024, loadTime * 1000.0, error.MaxUVError, error.RmsUVError );
+            DistortionMapDestroy ( &map );
+        }
+    }
+}
+#endif // OVR_DISTORTION_MAP_TEST
+
+
+}}} // namespace OVR::Util::Render
@@ -0,0 +1,103 @@
+/************************************************************************************
+
+Filename    :   Util_Render_LookupMap.h
+Content     :   Per-pixel distortion lookup maps
+Created     :   October 17, 2026
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#ifndef OVR_Util_Render_LookupMap_h
+#define OVR_Util_Render_LookupMap_h
+
+#include "Util_Render_Stereo.h"
+
+// Define this to compile-in the lookup map report
+//#define OVR_DISTORTION_MAP_TEST
+
+namespace OVR { namespace Util { namespace Render {
+
+
+//-----------------------------------------------------------------------------------
+// *****  Distortion Lookup Map
+//
+// The alternative to the distortion mesh: a texture per colour channel holding, for every
+// pixel of the eye's part of the screen, the rendertarget UV to sample. Nothing is
+// interpolated between vertices, so at full resolution it is exact at every pixel centre.
+// There is no timewarp or vignette, those need the tan angles the mesh carries.
+
+enum DistortionMapFormat
+{
+    DistortionMapFormat_RG16,       // Unsigned normalized, decoded as texel * UVScale + UVBias.
+    DistortionMapFormat_RG32F       // The UVs as they are.
+};
+
+struct DistortionMap
+{
+    Sizei               Resolution;
+    DistortionMapFormat Format;
+    // Map from a [0,1] RG16 texel to UV. Covers every UV in the map, and is 1 and 0 for RG32F.
+    Vector2f            UVScale;
+    Vector2f            UVBias;
+    // CRC of the distortion and eyeToSourceUV it was made from.
+    uint32_t            SourceKey;
+    // The red, green and blue maps one after the other, each Resolution.w * Resolution.h
+    // RG texels. Texel centres sit at pixel centres when Resolution is the eye's pixel size,
+    // and row 0 is at screen NDC y = -1, so each map uploads as it is.
+    void               *pTexels;
+
+    DistortionMap() : Format(DistortionMapFormat_RG16), UVScale(1.0f), UVBias(0.0f), SourceKey(0), pTexels(NULL) { }
+
+    int     GetTexelSize() const   { return ( Format == DistortionMapFormat_RG16 ) ? 2 * sizeof(uint16_t) : 2 * sizeof(float); }
+    int     GetChannelSize() const { return Resolution.w * Resolution.h * GetTexelSize(); }
+    void   *GetChannel ( int channel ) const { return (uint8_t*)pTexels + channel * GetChannelSize(); }
+
+    // Decodes one texel of channel 0, 1 or 2 (red, green, blue).
+    Vector2f GetUV ( int channel, int x, int y ) const;
+};
+
+// Fills in the map for one eye at the given resolution, usually the eye's size in
+// screen pixels. The rows are spread over numThreads threads including the caller;
+// 0 uses one per CPU. Returns false if out of memory.
+bool DistortionMapCreate ( DistortionMap *pMap, Sizei resolution, DistortionMapFormat format,
+                           const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceUV,
+                           int numThreads = 0 );
+
+void DistortionMapDestroy ( DistortionMap *pMap );
+
+// RG16 maps are stored as the error of a prediction along each row, about a byte per
+// component for a smooth lens, so half their size in memory. RG32F maps are stored as they are.
+bool DistortionMapSave ( const DistortionMap &map, const char *path );
+
+// Fails if the file is missing or damaged, or was made from another distortion or
+// eyeToSourceUV, in which case create the map again.
+bool DistortionMapLoad ( DistortionMap *pMap, const char *path,
+                         const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceUV );
+
+#ifdef OVR_DISTORTION_MAP_TEST
+// Logs generation time, memory and file size, and UV error of the maps in both formats
+// at full and half resolution against the uniform mesh, for the left eye of the debug DK2.
+// The file sizes come from saving to tempPath.
+void DistortionMapLogReport ( const char *tempPath );
+#endif
+
+
+}}} // namespace OVR::Util::Render
+
+#endif // OVR_Util_Render_LookupMap_h
@@ -0,0 +1,332 @@
+/************************************************************************************
+
+Filename    :   Util_Render_MultiRes.cpp
+Content     :   Lens-matched multi-resolution eye buffer planning
+Created     :   October 17, 2026
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "Util_Render_MultiRes.h"
+#include "Util_Render_Stereo.h"
+#include "../Kernel/OVR_Alg.h"
+#include "../Kernel/OVR_Log.h"
+#include "../Kernel/OVR_Std.h"
+
+#include <math.h>
+#include <float.h>
+#include <limits.h>
+
+namespace OVR { namespace Util { namespace Render {
+
+
+//-----------------------------------------------------------------------------------
+// ***** Multi-resolution eye buffers
+
+// Tan angle samples across each axis of the FOV when planning. The needed density changes
+// slowly, and the check afterwards samples MRP_CheckFactor times as finely.
+static const int MRP_NumSamples     = 128;
+static const int MRP_CheckFactor    = 4;
+
+
+Vector2f CalculateNeededPixelDensity ( DistortionRenderDesc const &distortion, Vector2f tanEyeAngle )
+{
+    // DistortionFn takes a distance from the lens centre on the screen, in the lens's tan angle
+    // units, to the tan angle the eye sees it at. The inverse finds that distance on the screen,
+    // and the slope there says how much the lens stretches the screen along the radius.
+    LensConfig const &lens = distortion.Lens;
+    float r = tanEyeAngle.Length();
+    if ( r < 1e-5f )
+    {
+        return Vector2f ( 1.0f );
+    }
+    float slopeAtCenter = lens.DistortionFnDerivative ( 0.0f );
+    float screenR       = lens.DistortionFnInverse ( r );
+    // Screen distance per tan angle along and across the radius, relative to the centre.
+    float radial        = slopeAtCenter / lens.DistortionFnDerivative ( screenR );
+    float tangential    = slopeAtCenter * screenR / r;
+    float c = tanEyeAngle.x / r;
+    float s = tanEyeAngle.y / r;
+    return Vector2f ( sqrtf ( radial * radial * c * c + tangential * tangential * s * s ),
+                      sqrtf ( radial * radial * s * s + tangential * tangential * c * c ) );
+}
+
+
+// The columns or the rows of a plan.
+struct MultiResAxis
+{
+    int     NumSpans;
+    float   Tan[MultiResPlan::MaxSplits+1];
+    int     Pixels[MultiResPlan::MaxSplits];
+    float   Density[MultiResPlan::MaxSplits];
+};
+
+static int MultiResSpanPixels ( float tanWidth, float pixelsPerTan, float density )
+{
+    // Rounded up, so the span is never rendered below the density asked for.
+    return (int)ceilf ( tanWidth * pixelsPerTan * density );
+}
+
+// Splits one axis of the FOV into up to three spans, trying every pair of sample positions for
+// the edges of the middle span and keeping the pair that needs the fewest pixels in total.
+// pNeed holds the density needed at MRP_NumSamples+1 evenly spaced tan angles from lowTan to highTan.
+static void MultiResPlanAxis ( MultiResAxis *pAxis, float lowTan, float highTan, float const *pNeed,
+                               float pixelsPerTan, float densityScale )
+{
+    const int n = MRP_NumSamples;
+    float step = ( highTan - lowTan ) / (float)n;
+
+    // A span needs the most any sample in it needs. The peak can fall between samples,
+    // so each sample also stands for its neighbours.
+    float need[MRP_NumSamples+1];
+    for ( int k = 0; k <= n; k++ )
+    {
+        need[k] = pNeed[k];
+        if ( k > 0 ) need[k] = Alg::Max ( need[k], pNeed[k-1] );
+        if ( k < n ) need[k] = Alg::Max ( need[k], pNeed[k+1] );
+        need[k] *= densityScale;
+    }
+    float prefixMax[MRP_NumSamples+1];
+    float suffixMax[MRP_NumSamples+1];
+    prefixMax[0] = need[0];
+    suffixMax[n] = need[n];
+    for ( int k = 1; k <= n; k++ )
+    {
+        prefixMax[k]   = Alg::Max ( prefixMax[k-1], need[k] );
+        suffixMax[n-k] = Alg::Max ( suffixMax[n-k+1], need[n-k] );
+    }
+
+    int bestPixels = INT_MAX;
+    int bestA = 0, bestB = n;
+    for ( int a = 0; a <= n; a++ )
+    {
+        int leftPixels = ( a > 0 ) ? MultiResSpanPixels ( step * (float)a, pixelsPerTan, prefixMax[a] ) : 0;
+        float middleNeed = 0.0f;
+        for ( int b = a; b <= n; b++ )
+        {
+            middleNeed = Alg::Max ( middleNeed, need[b] );
+            int pixels = leftPixels;
+            if ( b > a )
+            {
+                pixels += MultiResSpanPixels ( step * (float)( b - a ), pixelsPerTan, middleNeed );
+            }
+            if ( b < n )
+            {
+                pixels += MultiResSpanPixels ( step * (float)( n - b ), pixelsPerTan, suffixMax[b] );
+            }
+            if ( pixels < bestPixels )
+            {
+                bestPixels  = pixels;
+                bestA       = a;
+                bestB       = b;
+            }
+        }
+    }
+
+    int edges[MultiResPlan::MaxSplits+1] = { 0, bestA, bestB, n };
+    pAxis->NumSpans = 0;
+    pAxis->Tan[0] = lowTan;
+    for ( int span = 0; span < MultiResPlan::MaxSplits; span++ )
+    {
+        int k0 = edges[span];
+        int k1 = edges[span+1];
+        if ( k1 == k0 )
+        {
+            continue;
+        }
+        float spanNeed = 0.0f;
+        for ( int k = k0; k <= k1; k++ )
+        {
+            spanNeed = Alg::Max ( spanNeed, need[k] );
+        }
+        float tanWidth = step * (float)( k1 - k0 );
+        int i = pAxis->NumSpans++;
+        pAxis->Tan[i+1]     = ( k1 == n ) ? highTan : lowTan + step * (float)k1;
+        pAxis->Pixels[i]    = MultiResSpanPixels ( tanWidth, pixelsPerTan, spanNeed );
+        pAxis->Density[i]   = (float)pAxis->Pixels[i] / ( tanWidth * pixelsPerTan );
+    }
+}
+
+static int MultiResFindSpan ( float const *pEdges, int numSpans, float tan )
+{
+    int span = 0;
+    while ( ( span < numSpans - 1 ) && ( tan >= pEdges[span+1] ) )
+    {
+        span++;
+    }
+    return span;
+}
+
+MultiResPlan CalculateMultiResPlan ( StereoEye eyeType, DistortionRenderDesc const &distortion,
+                                     FovPort fov, float pixelsPerDisplayPixel, float maxDensityLoss,
+                                     bool rightHandedProjection /*= true*/, float zNear /*= 0.01f*/, float zFar /*= 10000.0f*/ )
+{
+    MultiResPlan plan;
+    maxDensityLoss = Alg::Clamp ( maxDensityLoss, 0.0f, 0.99f );
+    Vector2f lowTan  ( -fov.LeftTan, -fov.UpTan );
+    Vector2f highTan ( fov.RightTan, fov.DownTan );
+    Vector2f step = ( highTan - lowTan ) / (float)MRP_NumSamples;
+
+    // Each column needs the most any point in it needs, and likewise each row.
+    float needX[MRP_NumSamples+1];
+    float needY[MRP_NumSamples+1];
+    for ( int k = 0; k <= MRP_NumSamples; k++ )
+    {
+        needX[k] = 0.0f;
+        needY[k] = 0.0f;
+    }
+    for ( int y = 0; y <= MRP_NumSamples; y++ )
+    {
+        for ( int x = 0; x <= MRP_NumSamples; x++ )
+        {
+            Vector2f tan = lowTan + Vector2f ( (float)x, (float)y ).EntrywiseMultiply ( step );
+            Vector2f need = CalculateNeededPixelDensity ( distortion, tan );
+            needX[x] = Alg::Max ( needX[x], Alg::Min ( need.x, 1.0f ) );
+            needY[y] = Alg::Max ( needY[y], Alg::Min ( need.y, 1.0f ) );
+        }
+    }
+
+    Vector2f pixelsPerTan = distortion.PixelsPerTanAngleAtCenter * pixelsPerDisplayPixel;
+    MultiResAxis columns, rows;
+    MultiResPlanAxis ( &columns, lowTan.x, highTan.x, needX, pixelsPerTan.x, 1.0f - maxDensityLoss );
+    MultiResPlanAxis ( &rows,    lowTan.y, highTan.y, needY, pixelsPerTan.y, 1.0f - maxDensityLoss );
+
+    plan.NumColumns = columns.NumSpans;
+    plan.NumRows    = rows.NumSpans;
+    plan.BufferSize = Sizei ( 0 );
+    for ( int column = 0; column <= plan.NumColumns; column++ )
+    {
+        plan.ColumnTan[column] = columns.Tan[column];
+        plan.BufferSize.w += ( column < plan.NumColumns ) ? columns.Pixels[column] : 0;
+    }
+    for ( int row = 0; row <= plan.NumRows; row++ )
+    {
+        plan.RowTan[row] = rows.Tan[row];
+        plan.BufferSize.h += ( row < plan.NumRows ) ? rows.Pixels[row] : 0;
+    }
+
+    int viewportY = 0;
+    for ( int row = 0; row < plan.NumRows; row++ )
+    {
+        int viewportX = 0;
+        for ( int column = 0; column < plan.NumColumns; column++ )
+        {
+            MultiResRegion &region = plan.Regions[row * plan.NumColumns + column];
+            region.Fov.LeftTan  = -plan.ColumnTan[column];
+            region.Fov.RightTan =  plan.ColumnTan[column+1];
+            region.Fov.UpTan    = -plan.RowTan[row];
+            region.Fov.DownTan  =  plan.RowTan[row+1];
+            region.Viewport     = Recti ( viewportX, viewportY, columns.Pixels[column], rows.Pixels[row] );
+            region.Density      = Vector2f ( columns.Density[column], rows.Density[row] );
+            region.Projection   = CreateProjection ( rightHandedProjection, region.Fov, zNear, zFar );
+            region.EyeToSourceUV = CreateUVScaleAndOffsetfromNDCScaleandOffset ( CreateNDCScaleAndOffsetFromFov ( region.Fov ),
+                                                                                 region.Viewport, plan.BufferSize );
+            viewportX += columns.Pixels[column];
+        }
+        viewportY += rows.Pixels[row];
+    }
+
+    plan.UniformSize = CalculateIdealPixelSize ( eyeType, distortion, fov, pixelsPerDisplayPixel );
+    float uniformPixels = (float)plan.UniformSize.w * (float)plan.UniformSize.h;
+    if ( uniformPixels > 0.0f )
+    {
+        plan.PixelSavings = 1.0f - (float)plan.BufferSize.w * (float)plan.BufferSize.h / uniformPixels;
+    }
+
+    // Check the result between the samples it was planned from.
+    const int numCheckSamples = MRP_NumSamples * MRP_CheckFactor;
+    Vector2f checkStep = ( highTan - lowTan ) / (float)numCheckSamples;
+    plan.MinDensityRatio = FLT_MAX;
+    for ( int y = 0; y <= numCheckSamples; y++ )
+    {
+        for ( int x = 0; x <= numCheckSamples; x++ )
+        {
+            Vector2f tan = lowTan + Vector2f ( (float)x, (float)y ).EntrywiseMultiply ( checkStep );
+            Vector2f need = CalculateNeededPixelDensity ( distortion, tan );
+            int column = MultiResFindSpan ( plan.ColumnTan, plan.NumColumns, tan.x );
+            int row    = MultiResFindSpan ( plan.RowTan,    plan.NumRows,    tan.y );
+            plan.MinDensityRatio = Alg::Min ( plan.MinDensityRatio, columns.Density[column] / Alg::Min ( need.x, 1.0f ) );
+            plan.MinDensityRatio = Alg::Min ( plan.MinDensityRatio, rows.Density[row]       / Alg::Min ( need.y, 1.0f ) );
+        }
+    }
+    return plan;
+}
+
+Vector2f TransformTanFovSpaceToMultiResUV ( MultiResPlan const &plan, Vector2f tanEyeAngle )
+{
+    int column = MultiResFindSpan ( plan.ColumnTan, plan.NumColumns, tanEyeAngle.x );
+    int row    = MultiResFindSpan ( plan.RowTan,    plan.NumRows,    tanEyeAngle.y );
+    ScaleAndOffset2D const &eyeToSourceUV = plan.GetRegion ( row, column ).EyeToSourceUV;
+    return tanEyeAngle.EntrywiseMultiply ( eyeToSourceUV.Scale ) + eyeToSourceUV.Offset;
+}
+
+
+#ifdef OVR_MULTIRES_PLAN_TEST
+static void MultiResFormatDensities ( char *pBuffer, size_t bufferSize, int numSpans, float const *pDensities )
+{
+    pBuffer[0] = 0;
+    for ( int span = 0; span < numSpans; span++ )
+    {
+        size_t used = OVR_strlen ( pBuffer );
+        OVR_sprintf ( pBuffer + used, bufferSize - used, span ? " %4.2f" : "%4.2f", pDensities[span] );
+    }
+}
+
+void MultiResPlanLogReport ( )
+{
+    const HmdTypeEnum hmdTypes[]    = { HmdType_DK1, HmdType_DK2 };
+    const char *      hmdNames[]    = { "DK1", "DK2" };
+    const float       losses[]      = { 0.0f, 0.1f, 0.2f, 0.3f };
+
+    LogText ( "Multi-res eye buffers, left eye at the default FOV\n" );
+    LogText ( "HMD loss  uniform    buffer     saved  min density  columns         rows\n" );
+    for ( int hmdNum = 0; hmdNum < 2; hmdNum++ )
+    {
+        DebugHmdSetup hmd = CreateDebugHmdSetup ( hmdTypes[hmdNum] );
+        DistortionRenderDesc const &distortion = hmd.Distortion[0];
+        FovPort const &fov = hmd.Fov[0];
+
+        for ( int lossNum = 0; lossNum < (int)( sizeof(losses) / sizeof(losses[0]) ); lossNum++ )
+        {
+            MultiResPlan plan = CalculateMultiResPlan ( StereoEye_Left, distortion, fov, 1.0f, losses[lossNum] );
+
+            float columnDensities[MultiResPlan::MaxSplits];
+            float rowDensities[MultiResPlan::MaxSplits];
+            for ( int column = 0; column < plan.NumColumns; column++ )
+            {
+                columnDensities[column] = plan.GetRegion ( 0, column ).Density.x;
+            }
+            for ( int row = 0; row < plan.NumRows; row++ )
+            {
+                rowDensities[row] = plan.GetRegion ( row, 0 ).Density.y;
+            }
+            char columnText[32], rowText[32];
+            MultiResFormatDensities ( columnText, sizeof(columnText), plan.NumColumns, columnDensities );
+            MultiResFormatDensities ( rowText,    sizeof(rowText),    plan.NumRows,    rowDensities );
+
+            LogText ( "%-3s %4.2f  %4dx%-4d  %4dx%-4d  %5.1f%%  %11.3f  %-14s  %s\n", hmdNames[hmdNum], losses[lossNum],
+                      plan.UniformSize.w, plan.UniformSize.h, plan.BufferSize.w, plan.BufferSize.h,
+                      plan.PixelSavings * 100.0f, plan.MinDensityRatio, columnText, rowText );
+        }
+    }
+}
+#endif // OVR_MULTIRES_PLAN_TEST
+
+
+}}} // namespace OVR::Util::Render
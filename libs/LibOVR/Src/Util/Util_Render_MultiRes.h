@@ -0,0 +1,106 @@
+/************************************************************************************
+
+Filename    :   Util_Render_MultiRes.h
+Content     :   Lens-matched multi-resolution eye buffer planning
+Created     :   October 17, 2026
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#ifndef OVR_Util_Render_MultiRes_h
+#define OVR_Util_Render_MultiRes_h
+
+#include "../OVR_Stereo.h"
+
+// Define this to compile-in the multi-res plan report
+//#define OVR_MULTIRES_PLAN_TEST
+
+namespace OVR { namespace Util { namespace Render {
+
+
+//-----------------------------------------------------------------------------------
+// ***** Multi-resolution eye buffers
+//
+// Through the lens a screen pixel covers more of the view the further it is from the
+// centre, so an eye buffer sized for the centre, as CalculateIdealPixelSize does, has
+// more pixels towards its edges than the screen can show. A plan cuts the eye's FOV
+// into up to 3x3 sub-frustums: a centre region at full density, and border columns and
+// rows at the lower density the lens needs there. Each column has one horizontal density
+// and each row one vertical density, so the regions pack edge to edge into one buffer
+// and the mapping from tan angles to its UVs stays piecewise linear along each axis.
+
+struct MultiResRegion
+{
+    FovPort             Fov;            // This region's part of the eye FOV. Off-centre regions have a negative tan.
+    Recti               Viewport;       // Where the region is rendered in the buffer.
+    Vector2f            Density;        // Horizontal and vertical pixel density, relative to CalculateIdealPixelSize.
+    Matrix4f            Projection;     // CreateProjection for Fov.
+    ScaleAndOffset2D    EyeToSourceUV;  // Tan angles inside Fov to UVs of the whole buffer, for the distortion pass.
+};
+
+struct MultiResPlan
+{
+    enum { MaxSplits = 3 };
+
+    // Columns and rows of no width are left out, so there are 1 to 3 of each.
+    int                 NumColumns;
+    int                 NumRows;
+    float               ColumnTan[MaxSplits+1];     // Edges of the columns, left to right, +X right.
+    float               RowTan[MaxSplits+1];        // Edges of the rows, top to bottom, +Y down.
+    MultiResRegion      Regions[MaxSplits*MaxSplits];   // Row by row.
+
+    Sizei               BufferSize;
+    Sizei               UniformSize;        // CalculateIdealPixelSize for the whole FOV.
+    float               PixelSavings;       // Share of the uniform buffer's pixels the plan does without.
+    // The lowest ratio of rendered to needed density anywhere in the FOV, along either axis,
+    // measured more finely than the plan was made. Needed density is capped at the uniform buffer's.
+    float               MinDensityRatio;
+
+    MultiResPlan() : NumColumns(0), NumRows(0), PixelSavings(0.0f), MinDensityRatio(0.0f) { }
+
+    MultiResRegion const &GetRegion ( int row, int column ) const { return Regions[row * NumColumns + column]; }
+};
+
+// The pixel density the lens needs at a tan angle, horizontally and vertically, relative
+// to the density at the centre of the lens. Works from the green channel's distortion.
+Vector2f CalculateNeededPixelDensity ( DistortionRenderDesc const &distortion, Vector2f tanEyeAngle );
+
+// Plans one eye's buffer. maxDensityLoss is how far below the density the lens needs any
+// part of the FOV may be rendered, as a fraction: 0 loses nothing, 0.25 allows rendering at
+// three quarters. The needed density never exceeds what a uniform buffer of pixelsPerDisplayPixel
+// provides, so the plan is never bigger than one. The column and row edges are chosen to need the
+// fewest pixels. Pure math, no rendering state.
+MultiResPlan CalculateMultiResPlan ( StereoEye eyeType, DistortionRenderDesc const &distortion,
+                                     FovPort fov, float pixelsPerDisplayPixel, float maxDensityLoss,
+                                     bool rightHandedProjection = true, float zNear = 0.01f, float zFar = 10000.0f );
+
+// What the distortion pass does with a tan angle: picks the column and row it falls in and
+// applies their region's EyeToSourceUV. Tan angles beyond the FOV use the nearest border region.
+Vector2f TransformTanFovSpaceToMultiResUV ( MultiResPlan const &plan, Vector2f tanEyeAngle );
+
+#ifdef OVR_MULTIRES_PLAN_TEST
+// Logs the plans for the left eye of the debug DK1 and DK2 at their default FOVs,
+// for several density losses.
+void MultiResPlanLogReport ( );
+#endif
+
+
+}}} // namespace OVR::Util::Render
+
+#endif // OVR_Util_Render_MultiRes_h
@@ -0,0 +1,808 @@
+/************************************************************************************
+
+Filename    :   Util_Render_SoftwareDistortion.cpp
+Content     :   CPU reference for the distortion pass
+Created     :   October 17, 2026
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "Util_Render_SoftwareDistortion.h"
+#include "Util_Render_DistortionJob.h"
+#include "../Kernel/OVR_Timer.h"
+#include "../Kernel/OVR_SysFile.h"
+
+// The bilinear filter runs the three colour channels side by side.
+#if defined(OVR_CPU_SSE) && ( defined(__SSE2__) || defined(_M_AMD64) || ( defined(_M_IX86_FP) && ( _M_IX86_FP >= 2 ) ) )
+    #define OVR_SOFTWARE_DISTORTION_SSE2
+    #include <emmintrin.h>
+#elif defined(OVR_CPU_ARM_NEON)
+    #define OVR_SOFTWARE_DISTORTION_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace OVR { namespace Util { namespace Render {
+
+
+//-----------------------------------------------------------------------------------
+// *****  Software Distortion
+
+static const int SWD_TileSize       = 32;
+// Vertex positions snap to 1/256 pixel, as on a GPU, so the edge tests are exact integer maths.
+static const int SWD_SubpixelBits   = 8;
+static const int SWD_SubpixelScale  = 1 << SWD_SubpixelBits;
+// Positions further off the screen than this are clamped, keeping edge products in 64 bits.
+static const float SWD_MaxPixelPosition = 65536.0f;
+
+bool SoftwareImageCreate ( SoftwareImage *pImage, Sizei size )
+{
+    pImage->Size    = Sizei ( 0 );
+    pImage->pPixels = NULL;
+    if ( ( size.w <= 0 ) || ( size.h <= 0 ) )
+    {
+        return false;
+    }
+    int numPixels = size.w * size.h;
+    pImage->pPixels = (uint8_t*)OVR_ALLOC ( numPixels * 4 );
+    if ( !pImage->pPixels )
+    {
+        return false;
+    }
+    pImage->Size = size;
+    for ( int pixel = 0; pixel < numPixels; pixel++ )
+    {
+        uint8_t *p = pImage->pPixels + pixel * 4;
+        p[0] = p[1] = p[2] = 0;
+        p[3] = 255;
+    }
+    return true;
+}
+
+void SoftwareImageDestroy ( SoftwareImage *pImage )
+{
+    OVR_FREE ( pImage->pPixels );
+    pImage->pPixels = NULL;
+    pImage->Size    = Sizei ( 0 );
+}
+
+bool SoftwareImageSave ( const SoftwareImage &image, const char *path )
+{
+    if ( !image.pPixels )
+    {
+        return false;
+    }
+    int rowBytes = image.Size.w * 3;
+    uint8_t *pRow = (uint8_t*)OVR_ALLOC ( rowBytes );
+    if ( !pRow )
+    {
+        return false;
+    }
+    SysFile f;
+    if ( !f.Open ( path, File::Open_Write | File::Open_Create | File::Open_Truncate, File::Mode_Write ) )
+    {
+        OVR_FREE ( pRow );
+        return false;
+    }
+    char header[64];
+    int headerBytes = (int)OVR_sprintf ( header, sizeof(header), "P6\n%d %d\n255\n", image.Size.w, image.Size.h );
+    bool ok = ( f.Write ( (uint8_t const*)header, headerBytes ) == headerBytes );
+    for ( int y = 0; ok && ( y < image.Size.h ); y++ )
+    {
+        uint8_t const *pSource = image.pPixels + y * image.Size.w * 4;
+        for ( int x = 0; x < image.Size.w; x++ )
+        {
+            pRow[x*3+0] = pSource[x*4+0];
+            pRow[x*3+1] = pSource[x*4+1];
+            pRow[x*3+2] = pSource[x*4+2];
+        }
+        ok = ( f.Write ( pRow, rowBytes ) == rowBytes );
+    }
+    f.Close();
+    OVR_FREE ( pRow );
+    return ok;
+}
+
+// Reads the next number of a PPM header, skipping whitespace and comments.
+static bool SoftwareImageReadHeaderNumber ( uint8_t const *pData, int dataBytes, int *pPos, int *pValue )
+{
+    int pos = *pPos;
+    for ( ;; )
+    {
+        while ( ( pos < dataBytes ) && ( ( pData[pos] == ' ' ) || ( pData[pos] == '\t' ) || ( pData[pos] == '\r' ) || ( pData[pos] == '\n' ) ) )
+        {
+            pos++;
+        }
+        if ( ( pos < dataBytes ) && ( pData[pos] == '#' ) )
+        {
+            while ( ( pos < dataBytes ) && ( pData[pos] != '\n' ) )
+            {
+                pos++;
+            }
+            continue;
+        }
+        break;
+    }
+    int value = 0;
+    int numDigits = 0;
+    while ( ( pos < dataBytes ) && ( pData[pos] >= '0' ) && ( pData[pos] <= '9' ) && ( numDigits < 6 ) )
+    {
+        value = value * 10 + ( pData[pos] - '0' );
+        pos++;
+        numDigits++;
+    }
+    *pPos   = pos;
+    *pValue = value;
+    return numDigits > 0;
+}
+
+bool SoftwareImageLoad ( SoftwareImage *pImage, const char *path )
+{
+    pImage->Size    = Sizei ( 0 );
+    pImage->pPixels = NULL;
+
+    SysFile f;
+    if ( !f.Open ( path, File::Open_Read, File::Mode_Read ) )
+    {
+        return false;
+    }
+    int length = f.GetLength();
+    uint8_t *pData = ( length > 0 ) ? (uint8_t*)OVR_ALLOC ( length ) : NULL;
+    bool ok = ( pData != NULL ) && ( f.Read ( pData, length ) == length );
+    f.Close();
+
+    int pos = 2;
+    int width = 0, height = 0, maxValue = 0;
+    ok = ok && ( length > 2 ) && ( pData[0] == 'P' ) && ( pData[1] == '6' ) &&
+         SoftwareImageReadHeaderNumber ( pData, length, &pos, &width ) &&
+         SoftwareImageReadHeaderNumber ( pData, length, &pos, &height ) &&
+         SoftwareImageReadHeaderNumber ( pData, length, &pos, &maxValue ) &&
+         ( maxValue == 255 ) && ( width > 0 ) && ( height > 0 ) &&
+         // One whitespace byte ends the header.
+         ( length - ( pos + 1 ) == width * height * 3 );
+    ok = ok && SoftwareImageCreate ( pImage, Sizei ( width, height ) );
+    if ( ok )
+    {
+        uint8_t const *pSource = pData + pos + 1;
+        for ( int pixel = 0; pixel < width * height; pixel++ )
+        {
+            pImage->pPixels[pixel*4+0] = pSource[pixel*3+0];
+            pImage->pPixels[pixel*4+1] = pSource[pixel*3+1];
+            pImage->pPixels[pixel*4+2] = pSource[pixel*3+2];
+        }
+    }
+    OVR_FREE ( pData );
+    return ok;
+}
+
+SoftwareImageDifference SoftwareImageCompare ( const SoftwareImage &a, const SoftwareImage &b, int tolerance /*= 0*/ )
+{
+    SoftwareImageDifference result;
+    result.MaxDifference = 0;
+    result.NumPixelsOver = 0;
+    if ( ( a.Size != b.Size ) || !a.pPixels || !b.pPixels )
+    {
+        result.MaxDifference = 255;
+        result.NumPixelsOver = Alg::Max ( a.Size.w * a.Size.h, b.Size.w * b.Size.h );
+        return result;
+    }
+    for ( int pixel = 0; pixel < a.Size.w * a.Size.h; pixel++ )
+    {
+        int difference = 0;
+        for ( int channel = 0; channel < 3; channel++ )
+        {
+            difference = Alg::Max ( difference, Alg::Abs ( (int)a.pPixels[pixel*4+channel] - (int)b.pPixels[pixel*4+channel] ) );
+        }
+        result.MaxDifference = Alg::Max ( result.MaxDifference, difference );
+        if ( difference > tolerance )
+        {
+            result.NumPixelsOver++;
+        }
+    }
+    return result;
+}
+
+
+// What OculusWarpVert hands OculusWarpFrag for one vertex, with each channel's UV already
+// scaled to texels of the source and moved so texel centres are at whole numbers.
+struct SoftwareDistortionVarying
+{
+    float       Texel[3][2];
+    float       Shade;
+};
+
+static void SoftwareDistortionShadeVertex ( SoftwareDistortionVarying *pout, DistortionMeshVertexData const &vertex,
+                                            SoftwareDistortionEye const &eye )
+{
+    Matrix4f const &start   = eye.EyeRotationStart;
+    Matrix4f const &end     = eye.EyeRotationEnd;
+    float lerp = vertex.TimewarpLerp;
+    float rotation[3][3];
+    for ( int row = 0; row < 3; row++ )
+    {
+        for ( int column = 0; column < 3; column++ )
+        {
+            rotation[row][column] = start.M[row][column] + ( end.M[row][column] - start.M[row][column] ) * lerp;
+        }
+    }
+
+    Vector2f sourceSize ( (float)eye.pSource->Size.w, (float)eye.pSource->Size.h );
+    Vector2f const *pTanEyeAngles = &vertex.TanEyeAnglesR;
+    for ( int channel = 0; channel < 3; channel++ )
+    {
+        // Rotate the direction (x,y,1) and project it back onto the z = 1 plane of the rendered image.
+        Vector2f tan = pTanEyeAngles[channel];
+        float x = rotation[0][0] * tan.x + rotation[0][1] * tan.y + rotation[0][2];
+        float y = rotation[1][0] * tan.x + rotation[1][1] * tan.y + rotation[1][2];
+        float z = rotation[2][0] * tan.x + rotation[2][1] * tan.y + rotation[2][2];
+        Vector2f flattened ( x / z, y / z );
+        Vector2f uv = flattened.EntrywiseMultiply ( eye.EyeToSourceUV.Scale ) + eye.EyeToSourceUV.Offset;
+        Vector2f texel = uv.EntrywiseMultiply ( sourceSize ) - Vector2f ( 0.5f );
+        pout->Texel[channel][0] = texel.x;
+        pout->Texel[channel][1] = texel.y;
+    }
+    pout->Shade = vertex.Shade;
+}
+
+struct SoftwareDistortionTriangle
+{
+    // Fixed point pixel positions, ordered so the edge functions are positive inside.
+    int64_t     X[3];
+    int64_t     Y[3];
+    int64_t     DoubleArea;
+    // -1 for edges that do not own the pixels exactly on them.
+    int64_t     EdgeBias[3];
+    // Pixels whose centres may be inside, inclusive.
+    int         MinX, MaxX, MinY, MaxY;
+    int         Varying[3];
+    int         Eye;
+};
+
+// Sets up the triangle, returning false if it covers no pixel centre of the framebuffer.
+static bool SoftwareDistortionSetUpTriangle ( SoftwareDistortionTriangle *ptri, Vector2f const pixel[3], Sizei framebufferSize )
+{
+    for ( int k = 0; k < 3; k++ )
+    {
+        float x = Alg::Clamp ( pixel[k].x, -SWD_MaxPixelPosition, SWD_MaxPixelPosition );
+        float y = Alg::Clamp ( pixel[k].y, -SWD_MaxPixelPosition, SWD_MaxPixelPosition );
+        ptri->X[k] = (int64_t)floorf ( x * (float)SWD_SubpixelScale + 0.5f );
+        ptri->Y[k] = (int64_t)floorf ( y * (float)SWD_SubpixelScale + 0.5f );
+    }
+    ptri->DoubleArea = ( ptri->X[2] - ptri->X[1] ) * ( ptri->Y[0] - ptri->Y[1] ) - ( ptri->Y[2] - ptri->Y[1] ) * ( ptri->X[0] - ptri->X[1] );
+    if ( ptri->DoubleArea < 0 )
+    {
+        Alg::Swap ( ptri->X[1], ptri->X[2] );
+        Alg::Swap ( ptri->Y[1], ptri->Y[2] );
+        Alg::Swap ( ptri->Varying[1], ptri->Varying[2] );
+        ptri->DoubleArea = -ptri->DoubleArea;
+    }
+    if ( ptri->DoubleArea == 0 )
+    {
+        return false;
+    }
+
+    for ( int i = 0; i < 3; i++ )
+    {
+        // A pixel exactly on an edge shared by two triangles has edge function 0 in both, with
+        // opposite coefficients, so exactly one of them takes it.
+        int j = ( i + 1 ) % 3;
+        int k = ( i + 2 ) % 3;
+        int64_t a = -( ptri->Y[k] - ptri->Y[j] );
+        int64_t b =    ptri->X[k] - ptri->X[j];
+        ptri->EdgeBias[i] = ( ( a > 0 ) || ( ( a == 0 ) && ( b > 0 ) ) ) ? 0 : -1;
+    }
+
+    // Pixel x is a candidate if its centre, x + 0.5, lies within the triangle's bounds.
+    const int64_t half = SWD_SubpixelScale / 2;
+    int64_t minX = Alg::Min ( ptri->X[0], Alg::Min ( ptri->X[1], ptri->X[2] ) );
+    int64_t maxX = Alg::Max ( ptri->X[0], Alg::Max ( ptri->X[1], ptri->X[2] ) );
+    int64_t minY = Alg::Min ( ptri->Y[0], Alg::Min ( ptri->Y[1], ptri->Y[2] ) );
+    int64_t maxY = Alg::Max ( ptri->Y[0], Alg::Max ( ptri->Y[1], ptri->Y[2] ) );
+    ptri->MinX = Alg::Max ( 0,                        (int)ceil  ( (double)( minX - half ) / SWD_SubpixelScale ) );
+    ptri->MaxX = Alg::Min ( framebufferSize.w - 1,    (int)floor ( (double)( maxX - half ) / SWD_SubpixelScale ) );
+    ptri->MinY = Alg::Max ( 0,                        (int)ceil  ( (double)( minY - half ) / SWD_SubpixelScale ) );
+    ptri->MaxY = Alg::Min ( framebufferSize.h - 1,    (int)floor ( (double)( maxY - half ) / SWD_SubpixelScale ) );
+    return ( ptri->MinX <= ptri->MaxX ) && ( ptri->MinY <= ptri->MaxY );
+}
+
+// OculusWarpFrag for one pixel: each colour channel from its own bilinear fetch, with clamp to
+// edge addressing, times the vignette. The channels run side by side in SIMD lanes; the scalar
+// version does the same operations in the same order, so both give the same bytes.
+static inline void SoftwareDistortionShadePixel ( uint8_t *pout, SoftwareImage const &source, float const texel[3][2], float shade )
+{
+    const int       width       = source.Size.w;
+    const float     sizeX       = (float)source.Size.w;
+    const float     sizeY       = (float)source.Size.h;
+    uint8_t const  *pPixels     = source.pPixels;
+
+#if defined(OVR_SOFTWARE_DISTORTION_SSE2)
+    // Beyond a texel outside the image every position samples the edge, so clamping there first
+    // keeps the integer conversions in range and changes nothing.
+    __m128 tx = _mm_setr_ps ( texel[0][0], texel[1][0], texel[2][0], 0.0f );
+    __m128 ty = _mm_setr_ps ( texel[0][1], texel[1][1], texel[2][1], 0.0f );
+    tx = _mm_min_ps ( _mm_max_ps ( tx, _mm_set1_ps ( -1.0f ) ), _mm_set1_ps ( sizeX ) );
+    ty = _mm_min_ps ( _mm_max_ps ( ty, _mm_set1_ps ( -1.0f ) ), _mm_set1_ps ( sizeY ) );
+    // floor, from a truncation that is one too high for negative fractions.
+    __m128 one = _mm_set1_ps ( 1.0f );
+    __m128 x0 = _mm_cvtepi32_ps ( _mm_cvttps_epi32 ( tx ) );
+    __m128 y0 = _mm_cvtepi32_ps ( _mm_cvttps_epi32 ( ty ) );
+    x0 = _mm_sub_ps ( x0, _mm_and_ps ( _mm_cmpgt_ps ( x0, tx ), one ) );
+    y0 = _mm_sub_ps ( y0, _mm_and_ps ( _mm_cmpgt_ps ( y0, ty ), one ) );
+    __m128 fx = _mm_sub_ps ( tx, x0 );
+    __m128 fy = _mm_sub_ps ( ty, y0 );
+    __m128 zero = _mm_setzero_ps();
+    __m128 maxX = _mm_set1_ps ( sizeX - 1.0f );
+    __m128 maxY = _mm_set1_ps ( sizeY - 1.0f );
+    OVR_ALIGNAS(16) int32_t ix0[4], ix1[4], iy0[4], iy1[4];
+    _mm_store_si128 ( (__m128i*)ix0, _mm_cvttps_epi32 ( _mm_min_ps ( _mm_max_ps ( x0, zero ), maxX ) ) );
+    _mm_store_si128 ( (__m128i*)ix1, _mm_cvttps_epi32 ( _mm_min_ps ( _mm_max_ps ( _mm_add_ps ( x0, one ), zero ), maxX ) ) );
+    _mm_store_si128 ( (__m128i*)iy0, _mm_cvttps_epi32 ( _mm_min_ps ( _mm_max_ps ( y0, zero ), maxY ) ) );
+    _mm_store_si128 ( (__m128i*)iy1, _mm_cvttps_epi32 ( _mm_min_ps ( _mm_max_ps ( _mm_add_ps ( y0, one ), zero ), maxY ) ) );
+
+    #define OVR_SWD_FETCH(X,Y,c) ( (float)pPixels[ ( (Y)[c] * width + (X)[c] ) * 4 + (c) ] )
+    __m128 t00 = _mm_setr_ps ( OVR_SWD_FETCH(ix0,iy0,0), OVR_SWD_FETCH(ix0,iy0,1), OVR_SWD_FETCH(ix0,iy0,2), 0.0f );
+    __m128 t10 = _mm_setr_ps ( OVR_SWD_FETCH(ix1,iy0,0), OVR_SWD_FETCH(ix1,iy0,1), OVR_SWD_FETCH(ix1,iy0,2), 0.0f );
+    __m128 t01 = _mm_setr_ps ( OVR_SWD_FETCH(ix0,iy1,0), OVR_SWD_FETCH(ix0,iy1,1), OVR_SWD_FETCH(ix0,iy1,2), 0.0f );
+    __m128 t11 = _mm_setr_ps ( OVR_SWD_FETCH(ix1,iy1,0), OVR_SWD_FETCH(ix1,iy1,1), OVR_SWD_FETCH(ix1,iy1,2), 0.0f );
+    #undef OVR_SWD_FETCH
+
+    __m128 top    = _mm_add_ps ( t00, _mm_mul_ps ( fx, _mm_sub_ps ( t10, t00 ) ) );
+    __m128 bottom = _mm_add_ps ( t01, _mm_mul_ps ( fx, _mm_sub_ps ( t11, t01 ) ) );
+    __m128 value  = _mm_add_ps ( top, _mm_mul_ps ( fy, _mm_sub_ps ( bottom, top ) ) );
+    value = _mm_mul_ps ( value, _mm_set1_ps ( shade ) );
+    // The shade is not clamped and can be negative; NaNs from a degenerate timewarp become 0.
+    value = _mm_min_ps ( _mm_max_ps ( value, zero ), _mm_set1_ps ( 255.0f ) );
+    OVR_ALIGNAS(16) int32_t result[4];
+    _mm_store_si128 ( (__m128i*)result, _mm_cvttps_epi32 ( _mm_add_ps ( value, _mm_set1_ps ( 0.5f ) ) ) );
+    pout[0] = (uint8_t)result[0];
+    pout[1] = (uint8_t)result[1];
+    pout[2] = (uint8_t)result[2];
+
+#elif defined(OVR_SOFTWARE_DISTORTION_NEON)
+    float32x4_t tx = { texel[0][0], texel[1][0], texel[2][0], 0.0f };
+    float32x4_t ty = { texel[0][1], texel[1][1], texel[2][1], 0.0f };
+    tx = vminq_f32 ( vmaxq_f32 ( tx, vdupq_n_f32 ( -1.0f ) ), vdupq_n_f32 ( sizeX ) );
+    ty = vminq_f32 ( vmaxq_f32 ( ty, vdupq_n_f32 ( -1.0f ) ), vdupq_n_f32 ( sizeY ) );
+    float32x4_t one = vdupq_n_f32 ( 1.0f );
+    float32x4_t x0 = vcvtq_f32_s32 ( vcvtq_s32_f32 ( tx ) );
+    float32x4_t y0 = vcvtq_f32_s32 ( vcvtq_s32_f32 ( ty ) );
+    x0 = vsubq_f32 ( x0, vreinterpretq_f32_u32 ( vandq_u32 ( vcgtq_f32 ( x0, tx ), vreinterpretq_u32_f32 ( one ) ) ) );
+    y0 = vsubq_f32 ( y0, vreinterpretq_f32_u32 ( vandq_u32 ( vcgtq_f32 ( y0, ty ), vreinterpretq_u32_f32 ( one ) ) ) );
+    float32x4_t fx = vsubq_f32 ( tx, x0 );
+    float32x4_t fy = vsubq_f32 ( ty, y0 );
+    float32x4_t zero = vdupq_n_f32 ( 0.0f );
+    float32x4_t maxX = vdupq_n_f32 ( sizeX - 1.0f );
+    float32x4_t maxY = vdupq_n_f32 ( sizeY - 1.0f );
+    int32_t ix0[4], ix1[4], iy0[4], iy1[4];
+    vst1q_s32 ( ix0, vcvtq_s32_f32 ( vminq_f32 ( vmaxq_f32 ( x0, zero ), maxX ) ) );
+    vst1q_s32 ( ix1, vcvtq_s32_f32 ( vminq_f32 ( vmaxq_f32 ( vaddq_f32 ( x0, one ), zero ), maxX ) ) );
+    vst1q_s32 ( iy0, vcvtq_s32_f32 ( vminq_f32 ( vmaxq_f32 ( y0, zero ), maxY ) ) );
+    vst1q_s32 ( iy1, vcvtq_s32_f32 ( vminq_f32 ( vmaxq_f32 ( vaddq_f32 ( y0, one ), zero ), maxY ) ) );
+
+    #define OVR_SWD_FETCH(X,Y,c) ( (float)pPixels[ ( (Y)[c] * width + (X)[c] ) * 4 + (c) ] )
+    float32x4_t t00 = { OVR_SWD_FETCH(ix0,iy0,0), OVR_SWD_FETCH(ix0,iy0,1), OVR_SWD_FETCH(ix0,iy0,2), 0.0f };
+    float32x4_t t10 = { OVR_SWD_FETCH(ix1,iy0,0), OVR_SWD_FETCH(ix1,iy0,1), OVR_SWD_FETCH(ix1,iy0,2), 0.0f };
+    float32x4_t t01 = { OVR_SWD_FETCH(ix0,iy1,0), OVR_SWD_FETCH(ix0,iy1,1), OVR_SWD_FETCH(ix0,iy1,2), 0.0f };
+    float32x4_t t11 = { OVR_SWD_FETCH(ix1,iy1,0), OVR_SWD_FETCH(ix1,iy1,1), OVR_SWD_FETCH(ix1,iy1,2), 0.0f };
+    #undef OVR_SWD_FETCH
+
+    float32x4_t top    = vaddq_f32 ( t00, vmulq_f32 ( fx, vsubq_f32 ( t10, t00 ) ) );
+    float32x4_t bottom = vaddq_f32 ( t01, vmulq_f32 ( fx, vsubq_f32 ( t11, t01 ) ) );
+    float32x4_t value  = vaddq_f32 ( top, vmulq_f32 ( fy, vsubq_f32 ( bottom, top ) ) );
+    value = vmulq_f32 ( value, vdupq_n_f32 ( shade ) );
+    value = vminq_f32 ( vmaxq_f32 ( value, zero ), vdupq_n_f32 ( 255.0f ) );
+    int32_t result[4];
+    vst1q_s32 ( result, vcvtq_s32_f32 ( vaddq_f32 ( value, vdupq_n_f32 ( 0.5f ) ) ) );
+    pout[0] = (uint8_t)result[0];
+    pout[1] = (uint8_t)result[1];
+    pout[2] = (uint8_t)result[2];
+
+#else
+    for ( int channel = 0; channel < 3; channel++ )
+    {
+        float tx = texel[channel][0];
+        float ty = texel[channel][1];
+        // Written so a NaN goes to the low end, as the SIMD min and max do.
+        tx = ( tx > -1.0f ) ? Alg::Min ( tx, sizeX ) : -1.0f;
+        ty = ( ty > -1.0f ) ? Alg::Min ( ty, sizeY ) : -1.0f;
+        float x0 = floorf ( tx );
+        float y0 = floorf ( ty );
+        float fx = tx - x0;
+        float fy = ty - y0;
+        int ix0 = (int)Alg::Min ( Alg::Max ( x0,        0.0f ), sizeX - 1.0f );
+        int ix1 = (int)Alg::Min ( Alg::Max ( x0 + 1.0f, 0.0f ), sizeX - 1.0f );
+        int iy0 = (int)Alg::Min ( Alg::Max ( y0,        0.0f ), sizeY - 1.0f );
+        int iy1 = (int)Alg::Min ( Alg::Max ( y0 + 1.0f, 0.0f ), sizeY - 1.0f );
+        float t00 = (float)pPixels[ ( iy0 * width + ix0 ) * 4 + channel ];
+        float t10 = (float)pPixels[ ( iy0 * width + ix1 ) * 4 + channel ];
+        float t01 = (float)pPixels[ ( iy1 * width + ix0 ) * 4 + channel ];
+        float t11 = (float)pPixels[ ( iy1 * width + ix1 ) * 4 + channel ];
+        float top    = t00 + fx * ( t10 - t00 );
+        float bottom = t01 + fx * ( t11 - t01 );
+        float value  = ( top + fy * ( bottom - top ) ) * shade;
+        value = ( value > 0.0f ) ? Alg::Min ( value, 255.0f ) : 0.0f;
+        pout[channel] = (uint8_t)(int)( value + 0.5f );
+    }
+#endif
+    pout[3] = 255;
+}
+
+// Screen tiles handed out like rows, each drawing the triangles binned to it.
+class SoftwareDistortionJob : public DistortionRowJob
+{
+public:
+    SoftwareDistortionJob() : pFramebuffer(NULL), pEyes(NULL), pVaryings(NULL), pTriangles(NULL),
+                              pTileStarts(NULL), pTileTriangles(NULL), NumTilesX(0) { }
+
+    virtual void DoRow ( int tile );
+
+    SoftwareImage                      *pFramebuffer;
+    SoftwareDistortionEye const        *pEyes;
+    SoftwareDistortionVarying const    *pVaryings;
+    SoftwareDistortionTriangle const   *pTriangles;
+    // The triangles of tile t are pTileTriangles[pTileStarts[t]] up to pTileTriangles[pTileStarts[t+1]].
+    int const                          *pTileStarts;
+    int const                          *pTileTriangles;
+    int                                 NumTilesX;
+};
+
+void SoftwareDistortionJob::DoRow ( int tile )
+{
+    Sizei size = pFramebuffer->Size;
+    int tileMinX = ( tile % NumTilesX ) * SWD_TileSize;
+    int tileMinY = ( tile / NumTilesX ) * SWD_TileSize;
+    int tileMaxX = Alg::Min ( tileMinX + SWD_TileSize, size.w ) - 1;
+    int tileMaxY = Alg::Min ( tileMinY + SWD_TileSize, size.h ) - 1;
+
+    for ( int y = tileMinY; y <= tileMaxY; y++ )
+    {
+        uint8_t *p = pFramebuffer->pPixels + ( y * size.w + tileMinX ) * 4;
+        for ( int x = tileMinX; x <= tileMaxX; x++, p += 4 )
+        {
+            p[0] = p[1] = p[2] = 0;
+            p[3] = 255;
+        }
+    }
+
+    // Triangles are drawn in mesh order, so where a folded mesh overlaps itself the later one wins, as on a GPU.
+    for ( int ref = pTileStarts[tile]; ref < pTileStarts[tile+1]; ref++ )
+    {
+        SoftwareDistortionTriangle const &tri = pTriangles[ pTileTriangles[ref] ];
+        SoftwareImage const &source = *pEyes[tri.Eye].pSource;
+        SoftwareDistortionVarying const &v0 = pVaryings[tri.Varying[0]];
+        SoftwareDistortionVarying const &v1 = pVaryings[tri.Varying[1]];
+        SoftwareDistortionVarying const &v2 = pVaryings[tri.Varying[2]];
+        float recipDoubleArea = 1.0f / (float)tri.DoubleArea;
+
+        int minX = Alg::Max ( tri.MinX, tileMinX );
+        int maxX = Alg::Min ( tri.MaxX, tileMaxX );
+        int minY = Alg::Max ( tri.MinY, tileMinY );
+        int maxY = Alg::Min ( tri.MaxY, tileMaxY );
+
+        int64_t stepX[3];
+        for ( int i = 0; i < 3; i++ )
+        {
+            int j = ( i + 1 ) % 3;
+            int k = ( i + 2 ) % 3;
+            stepX[i] = -( tri.Y[k] - tri.Y[j] ) * SWD_SubpixelScale;
+        }
+
+        for ( int y = minY; y <= maxY; y++ )
+        {
+            int64_t centerX = (int64_t)minX * SWD_SubpixelScale + SWD_SubpixelScale / 2;
+            int64_t centerY = (int64_t)y    * SWD_SubpixelScale + SWD_SubpixelScale / 2;
+            int64_t edge[3];
+            for ( int i = 0; i < 3; i++ )
+            {
+                int j = ( i + 1 ) % 3;
+                int k = ( i + 2 ) % 3;
+                edge[i] = ( tri.X[k] - tri.X[j] ) * ( centerY - tri.Y[j] ) - ( tri.Y[k] - tri.Y[j] ) * ( centerX - tri.X[j] );
+            }
+
+            uint8_t *p = pFramebuffer->pPixels + ( y * size.w + minX ) * 4;
+            for ( int x = minX; x <= maxX; x++, p += 4 )
+            {
+                if ( ( ( edge[0] + tri.EdgeBias[0] ) | ( edge[1] + tri.EdgeBias[1] ) | ( edge[2] + tri.EdgeBias[2] ) ) >= 0 )
+                {
+                    float b1 = (float)edge[1] * recipDoubleArea;
+                    float b2 = (float)edge[2] * recipDoubleArea;
+                    float texel[3][2];
+                    for ( int channel = 0; channel < 3; channel++ )
+                    {
+                        for ( int axis = 0; axis < 2; axis++ )
+                        {
+                            float t0 = v0.Texel[channel][axis];
+                            texel[channel][axis] = t0 + b1 * ( v1.Texel[channel][axis] - t0 ) + b2 * ( v2.Texel[channel][axis] - t0 );
+                        }
+                    }
+                    float shade = v0.Shade + b1 * ( v1.Shade - v0.Shade ) + b2 * ( v2.Shade - v0.Shade );
+                    SoftwareDistortionShadePixel ( p, source, texel, shade );
+                }
+                edge[0] += stepX[0];
+                edge[1] += stepX[1];
+                edge[2] += stepX[2];
+            }
+        }
+    }
+}
+
+bool SoftwareDistortionRender ( SoftwareImage *pFramebuffer, const SoftwareDistortionEye eyes[2], int numThreads /*= 0*/ )
+{
+    if ( !pFramebuffer->pPixels )
+    {
+        return false;
+    }
+    Sizei size = pFramebuffer->Size;
+    int numVertices  = 0;
+    int numTriangles = 0;
+    for ( int eyeNum = 0; eyeNum < 2; eyeNum++ )
+    {
+        if ( eyes[eyeNum].pVertices && eyes[eyeNum].pSource && eyes[eyeNum].pSource->pPixels )
+        {
+            numVertices  += eyes[eyeNum].NumVertices;
+            numTriangles += eyes[eyeNum].NumTriangles;
+        }
+    }
+    int numTilesX = ( size.w + SWD_TileSize - 1 ) / SWD_TileSize;
+    int numTilesY = ( size.h + SWD_TileSize - 1 ) / SWD_TileSize;
+    int numTiles  = numTilesX * numTilesY;
+
+    SoftwareDistortionVarying  *pVaryings   = (SoftwareDistortionVarying*)OVR_ALLOC ( Alg::Max ( numVertices, 1 ) * sizeof(SoftwareDistortionVarying) );
+    SoftwareDistortionTriangle *pTriangles  = (SoftwareDistortionTriangle*)OVR_ALLOC ( Alg::Max ( numTriangles, 1 ) * sizeof(SoftwareDistortionTriangle) );
+    int                        *pTileStarts = (int*)OVR_ALLOC ( ( numTiles + 1 ) * sizeof(int) );
+    int                        *pTileTriangles = NULL;
+    bool ok = ( pVaryings != NULL ) && ( pTriangles != NULL ) && ( pTileStarts != NULL );
+
+    // OculusWarpVert, once per vertex, and triangle setup.
+    int numSetUpTriangles = 0;
+    int firstVarying = 0;
+    for ( int eyeNum = 0; ok && ( eyeNum < 2 ); eyeNum++ )
+    {
+        SoftwareDistortionEye const &eye = eyes[eyeNum];
+        if ( !eye.pVertices || !eye.pSource || !eye.pSource->pPixels )
+        {
+            continue;
+        }
+        Vector2f pixel[3];
+        for ( int vertexNum = 0; vertexNum < eye.NumVertices; vertexNum++ )
+        {
+            SoftwareDistortionShadeVertex ( &pVaryings[firstVarying + vertexNum], eye.pVertices[vertexNum], eye );
+        }
+        for ( int triNum = 0; triNum < eye.NumTriangles; triNum++ )
+        {
+            SoftwareDistortionTriangle &tri = pTriangles[numSetUpTriangles];
+            for ( int k = 0; k < 3; k++ )
+            {
+                int index = eye.pTriangleListIndices[triNum * 3 + k];
+                OVR_ASSERT ( index < eye.NumVertices );
+                Vector2f screenPosNDC = eye.pVertices[index].ScreenPosNDC;
+                // ScreenPosNDC has +Y up, the framebuffer row 0 at the top.
+                pixel[k].x = ( screenPosNDC.x * 0.5f + 0.5f ) * (float)size.w;
+                pixel[k].y = ( 0.5f - screenPosNDC.y * 0.5f ) * (float)size.h;
+                tri.Varying[k] = firstVarying + index;
+            }
+            tri.Eye = eyeNum;
+            if ( SoftwareDistortionSetUpTriangle ( &tri, pixel, size ) )
+            {
+                numSetUpTriangles++;
+            }
+        }
+        firstVarying += eye.NumVertices;
+    }
+
+    // Bin the triangles by the tiles their bounds overlap, counting first to size the lists.
+    if ( ok )
+    {
+        memset ( pTileStarts, 0, ( numTiles + 1 ) * sizeof(int) );
+        for ( int pass = 0; ok && ( pass < 2 ); pass++ )
+        {
+            for ( int triNum = 0; triNum < numSetUpTriangles; triNum++ )
+            {
+                SoftwareDistortionTriangle const &tri = pTriangles[triNum];
+                for ( int tileY = tri.MinY / SWD_TileSize; tileY <= tri.MaxY / SWD_TileSize; tileY++ )
+                {
+                    for ( int tileX = tri.MinX / SWD_TileSize; tileX <= tri.MaxX / SWD_TileSize; tileX++ )
+                    {
+                        int tile = tileY * numTilesX + tileX;
+                        if ( pass == 0 )
+                        {
+                            pTileStarts[tile + 1]++;
+                        }
+                        else
+                        {
+                            pTileTriangles[ pTileStarts[tile]++ ] = triNum;
+                        }
+                    }
+                }
+            }
+            if ( pass == 0 )
+            {
+                for ( int tile = 0; tile < numTiles; tile++ )
+                {
+                    pTileStarts[tile + 1] += pTileStarts[tile];
+                }
+                pTileTriangles = (int*)OVR_ALLOC ( Alg::Max ( pTileStarts[numTiles], 1 ) * sizeof(int) );
+                ok = ( pTileTriangles != NULL );
+            }
+        }
+        // The fill pass moved each start to the next tile's start.
+        for ( int tile = numTiles; tile > 0; tile-- )
+        {
+            pTileStarts[tile] = pTileStarts[tile - 1];
+        }
+        pTileStarts[0] = 0;
+    }
+
+    if ( ok )
+    {
+        Ptr<SoftwareDistortionJob> job = *new SoftwareDistortionJob;
+        job->pFramebuffer   = pFramebuffer;
+        job->pEyes          = eyes;
+        job->pVaryings      = pVaryings;
+        job->pTriangles     = pTriangles;
+        job->pTileStarts    = pTileStarts;
+        job->pTileTriangles = pTileTriangles;
+        job->NumTilesX      = numTilesX;
+        job->NumRows        = numTiles;
+        DistortionRowJobRun ( job, numThreads );
+    }
+
+    OVR_FREE ( pVaryings );
+    OVR_FREE ( pTriangles );
+    OVR_FREE ( pTileStarts );
+    OVR_FREE ( pTileTriangles );
+    return ok;
+}
+
+
+#ifdef OVR_SOFTWARE_DISTORTION_TEST
+// A pattern with detail at every scale: a coloured gradient under 16 and 2 pixel checkerboards,
+// each eye tinted differently so a swapped eye shows.
+static void SoftwareDistortionDrawTestPattern ( SoftwareImage *pImage, Recti const viewports[2] )
+{
+    for ( int eyeNum = 0; eyeNum < 2; eyeNum++ )
+    {
+        Recti vp = viewports[eyeNum];
+        for ( int y = vp.y; y < vp.y + vp.h; y++ )
+        {
+            for ( int x = vp.x; x < vp.x + vp.w; x++ )
+            {
+                int localX = x - vp.x;
+                int localY = y - vp.y;
+                bool coarse = ( ( ( localX >> 4 ) ^ ( localY >> 4 ) ) & 1 ) != 0;
+                bool fine   = ( ( ( localX >> 1 ) ^ ( localY >> 1 ) ) & 1 ) != 0;
+                int level = ( coarse ? 160 : 64 ) + ( fine ? 32 : 0 );
+                uint8_t *p = pImage->pPixels + ( y * pImage->Size.w + x ) * 4;
+                p[0] = (uint8_t)( ( level * ( 64 + 191 * localX / vp.w ) ) >> 8 );
+                p[1] = (uint8_t)( ( level * ( 64 + 191 * localY / vp.h ) ) >> 8 );
+                p[2] = (uint8_t)( eyeNum ? level : 255 - level );
+                p[3] = 255;
+            }
+        }
+    }
+}
+
+void SoftwareDistortionLogReport ( const char *goldenPathPrefix /*= NULL*/ )
+{
+    const HmdTypeEnum hmdTypes[]    = { HmdType_DK1, HmdType_DK2 };
+    const char *      hmdNames[]    = { "dk1", "dk2" };
+    const char *      caseNames[]   = { "static", "timewarp" };
+    const int         numRepeats    = 3;
+
+    LogText ( "Software distortion, both eyes at the recommended rendertarget size, best of %d\n", numRepeats );
+    LogText ( "hmd case      screen     source     triangles  1 thread ms  Mpix/s  %d threads ms  Mpix/s  same\n", Thread::GetCPUCount() );
+    for ( int hmdNum = 0; hmdNum < 2; hmdNum++ )
+    {
+        // Both eyes side by side in one rendertarget, as the addon does.
+        DebugHmdSetup hmd = CreateDebugHmdSetup ( hmdTypes[hmdNum] );
+        HmdRenderInfo const &renderInfo = hmd.RenderInfo;
+        DistortionRenderDesc const *distortion = hmd.Distortion;
+        ScaleAndOffset2D const *eyeToSourceNDC = hmd.EyeToSourceNDC;
+
+        Recti viewports[2];
+        Sizei sourceSize ( 0 );
+        for ( int eyeNum = 0; eyeNum < 2; eyeNum++ )
+        {
+            StereoEye eyeType = ( eyeNum == 0 ) ? StereoEye_Left : StereoEye_Right;
+            Sizei eyeSize = CalculateIdealPixelSize ( eyeType, distortion[eyeNum], hmd.Fov[eyeNum], 1.0f );
+            viewports[eyeNum] = Recti ( sourceSize.w, 0, eyeSize.w, eyeSize.h );
+            sourceSize.w += eyeSize.w;
+            sourceSize.h  = Alg::Max ( sourceSize.h, eyeSize.h );
+        }
+
+        SoftwareImage source, framebuffer, reference;
+        if ( !SoftwareImageCreate ( &source, sourceSize ) ||
+             !SoftwareImageCreate ( &framebuffer, renderInfo.ResolutionInPixels ) ||
+             !SoftwareImageCreate ( &reference, renderInfo.ResolutionInPixels ) )
+        {
+            SoftwareImageDestroy ( &source );
+            SoftwareImageDestroy ( &framebuffer );
+            SoftwareImageDestroy ( &reference );
+            continue;
+        }
+        SoftwareDistortionDrawTestPattern ( &source, viewports );
+
+        SoftwareDistortionEye eyes[2];
+        DistortionMeshVertexData *pVertices[2] = { NULL, NULL };
+        uint16_t *pIndices[2] = { NULL, NULL };
+        int totalTriangles = 0;
+        for ( int eyeNum = 0; eyeNum < 2; eyeNum++ )
+        {
+            DistortionMeshCreate ( &pVertices[eyeNum], &pIndices[eyeNum], &eyes[eyeNum].NumVertices, &eyes[eyeNum].NumTriangles,
+                                   eyeNum == 1, renderInfo, distortion[eyeNum], eyeToSourceNDC[eyeNum] );
+            eyes[eyeNum].pVertices              = pVertices[eyeNum];
+            eyes[eyeNum].pTriangleListIndices   = pIndices[eyeNum];
+            eyes[eyeNum].pSource                = &source;
+            eyes[eyeNum].EyeToSourceUV          = CreateUVScaleAndOffsetfromNDCScaleandOffset ( eyeToSourceNDC[eyeNum], viewports[eyeNum], sourceSize );
+            totalTriangles += eyes[eyeNum].NumTriangles;
+        }
+
+        for ( int caseNum = 0; caseNum < 2; caseNum++ )
+        {
+            // A head turning left at about 60 degrees a second, over a 16 ms scanout.
+            for ( int eyeNum = 0; eyeNum < 2; eyeNum++ )
+            {
+                float yaw = ( caseNum == 0 ) ? 0.0f : 0.5f * MATH_FLOAT_DEGREETORADFACTOR;
+                eyes[eyeNum].EyeRotationStart   = Matrix4f::RotationY ( yaw );
+                eyes[eyeNum].EyeRotationEnd     = Matrix4f::RotationY ( yaw * 3.0f );
+            }
+
+            double bestTime[2] = { 1e10, 1e10 };
+            int threadCounts[2] = { 1, 0 };
+            for ( int runNum = 0; runNum < 2; runNum++ )
+            {
+                SoftwareImage *pTarget = ( runNum == 0 ) ? &reference : &framebuffer;
+                for ( int repeat = 0; repeat < numRepeats; repeat++ )
+                {
+                    double start = Timer::GetSeconds();
+                    SoftwareDistortionRender ( pTarget, eyes, threadCounts[runNum] );
+                    bestTime[runNum] = Alg::Min ( bestTime[runNum], Timer::GetSeconds() - start );
+                }
+            }
+            SoftwareImageDifference difference = SoftwareImageCompare ( reference, framebuffer );
+
+            double megapixels = (double)framebuffer.Size.w * (double)framebuffer.Size.h * 1e-6;
+            LogText ( "%s %-8s  %4dx%-4d  %4dx%-4d  %9d  %11.2f  %6.1f  %12.2f  %6.1f  %s\n",
+                      hmdNames[hmdNum], caseNames[caseNum], framebuffer.Size.w, framebuffer.Size.h, sourceSize.w, sourceSize.h,
+                      totalTriangles, bestTime[0] * 1000.0, megapixels / bestTime[0], bestTime[1] * 1000.0, megapixels / bestTime[1],
+                      ( difference.MaxDifference == 0 ) ? "yes" : "NO" );
+
+            if ( goldenPathPrefix )
+            {
+                String path = String ( goldenPathPrefix ) + hmdNames[hmdNum] + "_" + caseNames[caseNum] + ".ppm";
+                SoftwareImage loaded;
+                bool saved = SoftwareImageSave ( reference, path.ToCStr() ) && SoftwareImageLoad ( &loaded, path.ToCStr() ) &&
+                             ( SoftwareImageCompare ( reference, loaded ).MaxDifference == 0 );
+                LogText ( "    %s %s\n", saved ? "wrote" : "could not write", path.ToCStr() );
+                SoftwareImageDestroy ( &loaded );
+            }
+        }
+
+        for ( int eyeNum = 0; eyeNum < 2; eyeNum++ )
+        {
+            DistortionMeshDestroy ( pVertices[eyeNum], pIndices[eyeNum] );
+        }
+        SoftwareImageDestroy ( &source );
+        SoftwareImageDestroy ( &framebuffer );
+        SoftwareImageDestroy ( &reference );
+    }
+}
+#endif // OVR_SOFTWARE_DISTORTION_TEST
+
+
+}}} // namespace OVR::Util::Render
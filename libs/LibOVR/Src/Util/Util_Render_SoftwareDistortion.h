@@ -0,0 +1,107 @@
+/************************************************************************************
+
+Filename    :   Util_Render_SoftwareDistortion.h
+Content     :   CPU reference for the distortion pass
+Created     :   October 17, 2026
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#ifndef OVR_Util_Render_SoftwareDistortion_h
+#define OVR_Util_Render_SoftwareDistortion_h
+
+#include "Util_Render_Stereo.h"
+
+// Define this to compile-in the software distortion report
+//#define OVR_SOFTWARE_DISTORTION_TEST
+
+namespace OVR { namespace Util { namespace Render {
+
+
+//-----------------------------------------------------------------------------------
+// *****  Software Distortion
+//
+// A CPU reference for the distortion pass, for machines with no GPU. It rasterizes the distortion
+// meshes and samples the eye rendertargets the way the addon's OculusWarpVert and OculusWarpFrag
+// shaders do: timewarp rotations lerped per vertex, one UV per colour channel, bilinear filtering
+// and the vignette. The output does not depend on the thread count, so it can be compared against
+// golden images.
+
+// An 8 bit RGBA image, rows top to bottom with no padding between them.
+struct SoftwareImage
+{
+    Sizei       Size;
+    uint8_t    *pPixels;
+
+    SoftwareImage() : Size(0), pPixels(NULL) { }
+};
+
+// The pixels start opaque black. Returns false if out of memory.
+bool SoftwareImageCreate ( SoftwareImage *pImage, Sizei size );
+void SoftwareImageDestroy ( SoftwareImage *pImage );
+
+// Binary PPM, which most image viewers and diff tools read. Alpha is not stored, Load sets it to 255.
+bool SoftwareImageSave ( const SoftwareImage &image, const char *path );
+bool SoftwareImageLoad ( SoftwareImage *pImage, const char *path );
+
+struct SoftwareImageDifference
+{
+    int     MaxDifference;      // Largest difference in any colour channel, 0 to 255.
+    int     NumPixelsOver;      // Pixels with a colour channel differing by more than the tolerance.
+};
+
+// Images of different sizes differ by 255 everywhere.
+SoftwareImageDifference SoftwareImageCompare ( const SoftwareImage &a, const SoftwareImage &b, int tolerance = 0 );
+
+// One eye's mesh, as DistortionMeshCreate or ovrHmd_CreateDistortionMesh make it, and the
+// shader uniforms that go with it.
+struct SoftwareDistortionEye
+{
+    const DistortionMeshVertexData *pVertices;
+    const uint16_t                 *pTriangleListIndices;
+    int                             NumVertices;
+    int                             NumTriangles;
+    // The rendertarget the eye was rendered to, UV y = 0 at row 0. Both eyes may share one.
+    const SoftwareImage            *pSource;
+    ScaleAndOffset2D                EyeToSourceUV;
+    // As ovrHmd_GetEyeTimewarpMatrices returns them, lerped by each vertex's TimewarpLerp.
+    // Leave them identity for no timewarp.
+    Matrix4f                        EyeRotationStart;
+    Matrix4f                        EyeRotationEnd;
+
+    SoftwareDistortionEye() : pVertices(NULL), pTriangleListIndices(NULL), NumVertices(0), NumTriangles(0), pSource(NULL) { }
+};
+
+// Clears pFramebuffer, which covers the whole screen, to opaque black and draws both eyes into it.
+// Vertices snap to 1/256 pixel and a fill rule gives each pixel on a shared edge to one triangle,
+// as on a GPU. Screen tiles are spread over numThreads threads including the caller; 0 uses one
+// per CPU. Returns false if out of memory.
+bool SoftwareDistortionRender ( SoftwareImage *pFramebuffer, const SoftwareDistortionEye eyes[2], int numThreads = 0 );
+
+#ifdef OVR_SOFTWARE_DISTORTION_TEST
+// Draws a test pattern through the meshes of the debug DK1 and DK2, with and without timewarp,
+// and logs the time for one thread and for one per CPU, checking both give the same image.
+// With goldenPathPrefix, also writes each frame to <prefix><hmd>_<case>.ppm.
+void SoftwareDistortionLogReport ( const char *goldenPathPrefix = NULL );
+#endif
+
+
+}}} // namespace OVR::Util::Render
+
+#endif // OVR_Util_Render_SoftwareDistortion_h
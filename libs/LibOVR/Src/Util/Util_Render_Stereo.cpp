@@ -25,6 +25,10 @@ limitations under the License.
 *************************************************************************************/
 
 #include "Util_Render_Stereo.h"
+#include "Util_Render_DistortionJob.h"
+#include "../Kernel/OVR_Threads.h"
+#include "../Kernel/OVR_Timer.h"
+#include "../Kernel/OVR_System.h"
 
 namespace OVR { namespace Util { namespace Render {
 
@@ -74,6 +78,24 @@ char const* GetDebugNameHmdType ( HmdTypeEnum hmdType )
     }
 }
 
+DebugHmdSetup CreateDebugHmdSetup ( HmdTypeEnum hmdType )
+{
+    HMDInfo hmdInfo = CreateDebugHMDInfo ( hmdType );
+    Ptr<Profile> profile = *ProfileManager::GetInstance()->GetDefaultProfile ( hmdType );
+
+    DebugHmdSetup setup;
+    setup.RenderInfo = GenerateHmdRenderInfoFromHmdInfo ( hmdInfo, profile );
+    setup.EyePixels = Sizei ( setup.RenderInfo.ResolutionInPixels.w / 2, setup.RenderInfo.ResolutionInPixels.h );
+    for ( int eyeNum = 0; eyeNum < 2; eyeNum++ )
+    {
+        StereoEye eye = ( eyeNum == 0 ) ? StereoEye_Left : StereoEye_Right;
+        setup.Distortion[eyeNum] = CalculateDistortionRenderDesc ( eye, setup.RenderInfo );
+        setup.Fov[eyeNum] = CalculateFovFromHmdInfo ( eye, setup.Distortion[eyeNum], setup.RenderInfo );
+        setup.EyeToSourceNDC[eyeNum] = CreateNDCScaleAndOffsetFromFov ( setup.Fov[eyeNum] );
+    }
+    return setup;
+}
+
 
 //-----------------------------------------------------------------------------------
 // **** Internal pipeline functions.
@@ -92,7 +114,7 @@ static DistortionAndFov CalculateDistortionAndFovInternal ( StereoEye eyeType, H
     // pLensOverride can be NULL, which means no override.
 
     DistortionRenderDesc localDistortion  = CalculateDistortionRenderDesc ( eyeType, hmd, pLensOverride );
-    FovPort              fov              = CalculateFovFromHmdInfo ( eyeType, localDistortion, hmd, extraEyeRotationInRadians );
+    FovPort              fov              = CachedCalculateFovFromHmdInfo ( eyeType, localDistortion, hmd, extraEyeRotationInRadians );
     // Here the app or the user would optionally clamp this visible fov to a smaller number if
     // they want more perf or resolution and are willing to give up FOV.
     // They may also choose to clamp UDLR differently e.g. to get cinemascope-style views.
@@ -359,6 +381,88 @@ ViewportScaleAndOffset ModifyRenderDensity ( StereoEyeParams const &params,
 }
 
 
+#ifdef OVR_STEREO_CACHE_TEST
+// The render state of one HMD, as HMDState::UpdateRenderProfile and HMDRenderState::GetDesc build it.
+struct StereoCacheReportState
+{
+    HmdRenderInfo           RenderInfo;
+    DistortionRenderDesc    Distortion[2];
+    FovPort                 DefaultFov[2];
+    FovPort                 MaxFov[2];
+};
+
+static void StereoCacheReportConfigure ( StereoCacheReportState *pstate, HMDInfo const &hmdInfo, Profile const *profile )
+{
+    pstate->RenderInfo = GenerateHmdRenderInfoFromHmdInfo ( hmdInfo, profile );
+    for ( int eyeNum = 0; eyeNum < 2; eyeNum++ )
+    {
+        StereoEye eyeType = ( eyeNum == 0 ) ? StereoEye_Left : StereoEye_Right;
+        pstate->Distortion[eyeNum] = CalculateDistortionRenderDesc ( eyeType, pstate->RenderInfo );
+        pstate->DefaultFov[eyeNum] = CachedCalculateFovFromHmdInfo ( eyeType, pstate->Distortion[eyeNum], pstate->RenderInfo );
+        pstate->MaxFov[eyeNum]     = CachedGetPhysicalScreenFov ( eyeType, pstate->Distortion[eyeNum] );
+    }
+}
+
+void StereoCacheLogReport ( )
+{
+    const HmdTypeEnum   hmdTypes[2]     = { HmdType_DK1, HmdType_DK2 };
+    const int           numReconfigures = 200;
+
+    HMDInfo         hmdInfo[2];
+    Ptr<Profile>    profile[2];
+    for ( int hmdNum = 0; hmdNum < 2; hmdNum++ )
+    {
+        hmdInfo[hmdNum] = CreateDebugHMDInfo ( hmdTypes[hmdNum] );
+        profile[hmdNum] = *ProfileManager::GetInstance()->GetDefaultProfile ( hmdTypes[hmdNum] );
+    }
+
+    int savedCapacity = GetStereoCacheStats().Capacity;
+    int capacities[2] = { 0, StereoCacheDefaultCapacity };
+    StereoCacheReportState lastState[2][2];
+    double passTime[2];
+
+    LogText ( "Stereo cache, %d reconfigurations alternating DK1 and DK2\n", numReconfigures );
+    for ( int passNum = 0; passNum < 2; passNum++ )
+    {
+        SetStereoCacheCapacity ( capacities[passNum] );
+        ClearStereoCache();
+
+        double start = Timer::GetSeconds();
+        for ( int reconfigureNum = 0; reconfigureNum < numReconfigures; reconfigureNum++ )
+        {
+            int hmdNum = reconfigureNum & 1;
+            StereoCacheReportConfigure ( &lastState[passNum][hmdNum], hmdInfo[hmdNum], profile[hmdNum] );
+        }
+        passTime[passNum] = Timer::GetSeconds() - start;
+
+        StereoCacheStats stats = GetStereoCacheStats();
+        LogText ( "capacity %2d: %8.1f us per reconfiguration, lens %d hits %d misses, fov %d hits %d misses, max fov %d hits %d misses\n",
+                  capacities[passNum], passTime[passNum] * 1e6 / numReconfigures,
+                  stats.LensConfig.Hits, stats.LensConfig.Misses, stats.Fov.Hits, stats.Fov.Misses,
+                  stats.PhysicalScreenFov.Hits, stats.PhysicalScreenFov.Misses );
+    }
+
+    bool match = true;
+    for ( int hmdNum = 0; hmdNum < 2; hmdNum++ )
+    {
+        StereoCacheReportState const &uncached = lastState[0][hmdNum];
+        StereoCacheReportState const &cached   = lastState[1][hmdNum];
+        for ( int eyeNum = 0; eyeNum < 2; eyeNum++ )
+        {
+            match = match && ( memcmp ( &uncached.Distortion[eyeNum], &cached.Distortion[eyeNum], sizeof(DistortionRenderDesc) ) == 0 );
+            match = match && ( memcmp ( &uncached.DefaultFov[eyeNum], &cached.DefaultFov[eyeNum], sizeof(FovPort) ) == 0 );
+            match = match && ( memcmp ( &uncached.MaxFov[eyeNum],     &cached.MaxFov[eyeNum],     sizeof(FovPort) ) == 0 );
+        }
+    }
+    LogText ( "speedup %.1fx, cached results %s the uncached ones\n",
+              passTime[0] / Alg::Max ( passTime[1], 1e-9 ), match ? "match" : "DIFFER FROM" );
+
+    SetStereoCacheCapacity ( savedCapacity );
+    ClearStereoCache();
+}
+#endif // OVR_STEREO_CACHE_TEST
+
+
 //-----------------------------------------------------------------------------------
 // **** StereoConfig Implementation
 
@@ -787,13 +891,18 @@ static const int DMA_GridSizeLog2   = 6;
 static const int DMA_GridSize       = 1<<DMA_GridSizeLog2;
 static const int DMA_NumVertsPerEye = (DMA_GridSize+1)*(DMA_GridSize+1);
 static const int DMA_NumTrisPerEye  = (DMA_GridSize)*(DMA_GridSize)*2;
+// The finest lattice the adaptive mesh may start from; 129x129 still fits 16 bit indices.
+static const int DMA_MaxGridSizeLog2 = 7;
+static const int DMA_MaxGridSize     = 1<<DMA_MaxGridSizeLog2;
 
 
 
-DistortionMeshVertexData DistortionMeshMakeVertex ( Vector2f screenNDC,
-                                                    bool rightEye,
-                                                    const HmdRenderInfo &hmdRenderInfo, 
-                                                    const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC )
+// Everything in a vertex apart from the distortion itself, which the caller has already done.
+static DistortionMeshVertexData DistortionMeshMakeVertexFromTanEyeAngles ( Vector2f screenNDC,
+                                                                           Vector2f tanEyeAnglesR, Vector2f tanEyeAnglesG, Vector2f tanEyeAnglesB,
+                                                                           bool rightEye,
+                                                                           const HmdRenderInfo &hmdRenderInfo, 
+                                                                           const ScaleAndOffset2D &eyeToSourceNDC )
 {
     DistortionMeshVertexData result;
 
@@ -803,10 +912,6 @@ DistortionMeshVertexData DistortionMeshMakeVertex ( Vector2f screenNDC,
         xOffset = 1.0f;
     }
 
-    Vector2f tanEyeAnglesR, tanEyeAnglesG, tanEyeAnglesB;
-    TransformScreenNDCToTanFovSpaceChroma ( &tanEyeAnglesR, &tanEyeAnglesG, &tanEyeAnglesB,
-                                            distortion, screenNDC );
-			
 	result.TanEyeAnglesR = tanEyeAnglesR;
 	result.TanEyeAnglesG = tanEyeAnglesG;
 	result.TanEyeAnglesB = tanEyeAnglesB;
@@ -873,6 +978,18 @@ DistortionMeshVertexData DistortionMeshMakeVertex ( Vector2f screenNDC,
     return result;
 }
 
+DistortionMeshVertexData DistortionMeshMakeVertex ( Vector2f screenNDC,
+                                                    bool rightEye,
+                                                    const HmdRenderInfo &hmdRenderInfo, 
+                                                    const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC )
+{
+    Vector2f tanEyeAnglesR, tanEyeAnglesG, tanEyeAnglesB;
+    TransformScreenNDCToTanFovSpaceChroma ( &tanEyeAnglesR, &tanEyeAnglesG, &tanEyeAnglesB,
+                                            distortion, screenNDC );
+    return DistortionMeshMakeVertexFromTanEyeAngles ( screenNDC, tanEyeAnglesR, tanEyeAnglesG, tanEyeAnglesB,
+                                                      rightEye, hmdRenderInfo, eyeToSourceNDC );
+}
+
 
 void DistortionMeshDestroy ( DistortionMeshVertexData *pVertices, uint16_t *pTriangleMeshIndices )
 {
@@ -897,79 +1014,313 @@ void DistortionMeshCreate ( DistortionMeshVertexData **ppVertices, uint16_t **pp
 }
 
 
-// Generate distortion mesh for a eye.
-void DistortionMeshCreate( DistortionMeshVertexData **ppVertices, uint16_t **ppTriangleListIndices,
-                           int *pNumVertices, int *pNumTriangles,
-                           bool rightEye,
-                           const HmdRenderInfo &hmdRenderInfo, 
-                           const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC )
+// One eye's worth of the vertex pass.
+struct DistortionMeshEyeJob
 {
-    *pNumVertices  = DMA_NumVertsPerEye;
-    *pNumTriangles = DMA_NumTrisPerEye;
+    DistortionMeshVertexData   *pVertices;
+    bool                        RightEye;
+    const HmdRenderInfo        *pHmdRenderInfo;
+    const DistortionRenderDesc *pDistortion;
+    ScaleAndOffset2D            EyeToSourceNDC;
+    const LensInverseTable     *pInverseTable;      // NULL to invert the lens with Newton.
+};
 
-    *ppVertices = (DistortionMeshVertexData*)
-                      OVR_ALLOC( sizeof(DistortionMeshVertexData) * (*pNumVertices) );
-    *ppTriangleListIndices  = (uint16_t*) OVR_ALLOC( sizeof(uint16_t) * (*pNumTriangles) * 3 );
+// Builds row y of one eye's vertex grid.
+// The row is distorted in one batch, which lets the lens spline run four vertices at a time.
+static void DistortionMeshCreateRow ( DistortionMeshEyeJob const &eye, int gridSize, int y )
+{
+    Vector2f rowScreenNDC[DMA_MaxGridSize+1];
+    Vector2f rowTanEyeAnglesR[DMA_MaxGridSize+1];
+    Vector2f rowTanEyeAnglesG[DMA_MaxGridSize+1];
+    Vector2f rowTanEyeAnglesB[DMA_MaxGridSize+1];
 
-    if (!*ppVertices || !*ppTriangleListIndices)
+    for ( int x = 0; x <= gridSize; x++ )
     {
-        if (*ppVertices)
+        Vector2f sourceCoordNDC;
+        // NDC texture coords [-1,+1]
+        sourceCoordNDC.x = 2.0f * ( (float)x / (float)gridSize ) - 1.0f;
+        sourceCoordNDC.y = 2.0f * ( (float)y / (float)gridSize ) - 1.0f;
+        Vector2f tanEyeAngle = TransformRendertargetNDCToTanFovSpace ( eye.EyeToSourceNDC, sourceCoordNDC );
+
+        // Find a corresponding screen position.
+        // Note - this function does not have to be precise - we're just trying to match the mesh tessellation
+        // with the shape of the distortion to minimise the number of trianlges needed.
+        Vector2f screenNDC = eye.pInverseTable ?
+                                TransformTanFovSpaceToScreenNDC ( *eye.pDistortion, *eye.pInverseTable, tanEyeAngle ) :
+                                TransformTanFovSpaceToScreenNDC ( *eye.pDistortion, tanEyeAngle, false );
+        // ...but don't let verts overlap to the other eye.
+        screenNDC.x = Alg::Max ( -1.0f, Alg::Min ( screenNDC.x, 1.0f ) );
+        screenNDC.y = Alg::Max ( -1.0f, Alg::Min ( screenNDC.y, 1.0f ) );
+
+        rowScreenNDC[x] = screenNDC;
+    }
+
+    // From those screen positions, generate the vertices.
+    TransformScreenNDCToTanFovSpaceChroma ( rowTanEyeAnglesR, rowTanEyeAnglesG, rowTanEyeAnglesB,
+                                            *eye.pDistortion, rowScreenNDC, gridSize+1 );
+    DistortionMeshVertexData* pcurVert = eye.pVertices + y * (gridSize+1);
+    for ( int x = 0; x <= gridSize; x++ )
+    {
+        *pcurVert = DistortionMeshMakeVertexFromTanEyeAngles ( rowScreenNDC[x],
+                                                               rowTanEyeAnglesR[x], rowTanEyeAnglesG[x], rowTanEyeAnglesB[x],
+                                                               eye.RightEye, *eye.pHmdRenderInfo, eye.EyeToSourceNDC );
+        pcurVert++;
+    }
+}
+
+// The rows of every eye in the job, one after the other.
+class DistortionMeshJob : public DistortionRowJob
+{
+public:
+    DistortionMeshJob() : GridSize(DMA_GridSize), NumEyes(0)
+    {
+        Eyes[0].pInverseTable = NULL;
+        Eyes[1].pInverseTable = NULL;
+    }
+
+    virtual void DoRow ( int row )
+    {
+        DistortionMeshCreateRow ( Eyes[row / (GridSize+1)], GridSize, row % (GridSize+1) );
+    }
+
+    // Call once the rest of the eye is filled in.
+    void SetInverse ( int eyeNum, DistortionMeshInverse inverse )
+    {
+        DistortionMeshEyeJob &eye = Eyes[eyeNum];
+        eye.pInverseTable = NULL;
+        if ( inverse != DistortionMeshInverse_Table )
         {
-            OVR_FREE(*ppVertices);
+            return;
         }
-        if (*ppTriangleListIndices)
+        // Tan angle is linear in rendertarget NDC, so the corners are the largest radii the grid inverts.
+        float maxR = 0.0f;
+        for ( int corner = 0; corner < 4; corner++ )
         {
-            OVR_FREE(*ppTriangleListIndices);
+            Vector2f cornerNDC ( ( corner & 1 ) ? 1.0f : -1.0f, ( corner & 2 ) ? 1.0f : -1.0f );
+            maxR = Alg::Max ( maxR, TransformRendertargetNDCToTanFovSpace ( eye.EyeToSourceNDC, cornerNDC ).Length() );
         }
-        *ppVertices             = NULL;
-        *ppTriangleListIndices  = NULL;
-        *pNumTriangles          = 0;
-        *pNumVertices           = 0;
-        return;
+        InverseTables[eyeNum].Build ( eye.pDistortion->Lens, maxR );
+        eye.pInverseTable = &InverseTables[eyeNum];
     }
 
-      
-    
-    // Populate vertex buffer info
-
-    // First pass - build up raw vertex data.
-    DistortionMeshVertexData* pcurVert = *ppVertices;
+    DistortionMeshEyeJob        Eyes[2];
+    LensInverseTable            InverseTables[2];
+    int                         GridSize;
+    int                         NumEyes;
+};
 
-    for ( int y = 0; y <= DMA_GridSize; y++ )
+static void DistortionRowJobDoRows ( DistortionRowJob *pjob )
+{
+    for ( ;; )
     {
-        for ( int x = 0; x <= DMA_GridSize; x++ )
+        int row = pjob->NextRow.ExchangeAdd_Sync ( 1 );
+        if ( row >= pjob->NumRows )
         {
+            break;
+        }
+        pjob->DoRow ( row );
+        if ( pjob->RowsDone.ExchangeAdd_Sync ( 1 ) + 1 == pjob->NumRows )
+        {
+            pjob->Finished.SetEvent();
+        }
+    }
+}
 
-            Vector2f sourceCoordNDC;
-            // NDC texture coords [-1,+1]
-            sourceCoordNDC.x = 2.0f * ( (float)x / (float)DMA_GridSize ) - 1.0f;
-            sourceCoordNDC.y = 2.0f * ( (float)y / (float)DMA_GridSize ) - 1.0f;
-            Vector2f tanEyeAngle = TransformRendertargetNDCToTanFovSpace ( eyeToSourceNDC, sourceCoordNDC );
+#ifdef OVR_ENABLE_THREADS
 
-            // Find a corresponding screen position.
-            // Note - this function does not have to be precise - we're just trying to match the mesh tessellation
-            // with the shape of the distortion to minimise the number of trianlges needed.
-            Vector2f screenNDC = TransformTanFovSpaceToScreenNDC ( distortion, tanEyeAngle, false );
-            // ...but don't let verts overlap to the other eye.
-            screenNDC.x = Alg::Max ( -1.0f, Alg::Min ( screenNDC.x, 1.0f ) );
-            screenNDC.y = Alg::Max ( -1.0f, Alg::Min ( screenNDC.y, 1.0f ) );
+// Helper threads kept between jobs, so a mesh build only wakes threads instead of creating them.
+// They sleep until a job is posted and are stopped with the rest of the SDK's threads at System::Destroy.
+class DistortionRowJobPool : public NewOverrideBase, public SystemSingletonBase<DistortionRowJobPool>
+{
+    OVR_DECLARE_SINGLETON(DistortionRowJobPool);
+
+public:
+    // Hands the job to up to numHelpers sleeping workers, starting more if there are too few.
+    // Returns false if another job still has the pool, in which case the caller runs it alone.
+    bool Post ( DistortionRowJob *pjob, int numHelpers );
+    // Called once the posted job has finished, so the workers stop picking it up.
+    void Clear ( DistortionRowJob *pjob );
+
+    virtual void OnThreadDestroy();
+
+private:
+    static int WorkerFn ( Thread *pthread, void *h );
+
+    Mutex                   PoolLock;
+    WaitCondition           WorkPosted;
+    Array< Ptr<Thread> >    Workers;
+    Ptr<DistortionRowJob>   CurrentJob;
+    int                     HelpersWanted;
+    bool                    ShuttingDown;
+};
 
-            // From those screen positions, generate the vertex.
-            *pcurVert = DistortionMeshMakeVertex ( screenNDC, rightEye, hmdRenderInfo, distortion, eyeToSourceNDC );
-            pcurVert++;
+}}} // namespace OVR::Util::Render
+
+OVR_DEFINE_SINGLETON(OVR::Util::Render::DistortionRowJobPool);
+
+namespace OVR { namespace Util { namespace Render {
+
+DistortionRowJobPool::DistortionRowJobPool() : HelpersWanted(0), ShuttingDown(false)
+{
+    // Must be at end of function
+    PushDestroyCallbacks();
+}
+
+DistortionRowJobPool::~DistortionRowJobPool()
+{
+}
+
+void DistortionRowJobPool::OnThreadDestroy()
+{
+    Mutex::Locker locker ( &PoolLock );
+    ShuttingDown = true;
+    WorkPosted.NotifyAll();
+}
+
+void DistortionRowJobPool::OnSystemDestroy()
+{
+    delete this;
+}
+
+bool DistortionRowJobPool::Post ( DistortionRowJob *pjob, int numHelpers )
+{
+    Mutex::Locker locker ( &PoolLock );
+    if ( CurrentJob || ShuttingDown )
+    {
+        return false;
+    }
+    // If a worker fails to start, the others simply take more rows.
+    while ( Workers.GetSizeI() < numHelpers )
+    {
+        Ptr<Thread> worker = *new Thread ( WorkerFn, this );
+        if ( !worker->Start() )
+        {
+            break;
         }
+        worker->SetThreadName ( "DistortionRows" );
+        Workers.PushBack ( worker );
     }
+    CurrentJob      = pjob;
+    HelpersWanted   = numHelpers;
+    WorkPosted.NotifyAll();
+    return true;
+}
 
+void DistortionRowJobPool::Clear ( DistortionRowJob *pjob )
+{
+    Mutex::Locker locker ( &PoolLock );
+    OVR_ASSERT ( CurrentJob == pjob );
+    OVR_UNUSED ( pjob );
+    CurrentJob      = NULL;
+    HelpersWanted   = 0;
+}
 
-    // Populate index buffer info  
-    uint16_t *pcurIndex = *ppTriangleListIndices;
+int DistortionRowJobPool::WorkerFn ( Thread *pthread, void *h )
+{
+    OVR_UNUSED ( pthread );
+    DistortionRowJobPool *pool = (DistortionRowJobPool*)h;
+    for ( ;; )
+    {
+        // The reference keeps the job alive if its caller finishes and lets go first.
+        Ptr<DistortionRowJob> job;
+        {
+            Mutex::Locker locker ( &pool->PoolLock );
+            while ( !pool->ShuttingDown && ( !pool->CurrentJob || pool->HelpersWanted <= 0 ) )
+            {
+                pool->WorkPosted.Wait ( &pool->PoolLock );
+            }
+            if ( pool->ShuttingDown )
+            {
+                return 0;
+            }
+            pool->HelpersWanted--;
+            job = pool->CurrentJob;
+        }
+        DistortionRowJobDoRows ( job );
+    }
+}
+
+#endif // OVR_ENABLE_THREADS
+
+void DistortionRowJobRun ( DistortionRowJob *pjob, int numThreads )
+{
+    if ( numThreads <= 0 )
+    {
+        numThreads = Thread::GetCPUCount();
+    }
+    numThreads = Alg::Clamp ( numThreads, 1, pjob->NumRows );
+
+#ifdef OVR_ENABLE_THREADS
+    // The calling thread takes rows too, so it only needs numThreads-1 helpers.
+    DistortionRowJobPool *pool = ( numThreads > 1 ) ? DistortionRowJobPool::GetInstance() : NULL;
+    bool posted = pool && pool->Post ( pjob, numThreads - 1 );
+#endif
+
+    DistortionRowJobDoRows ( pjob );
+    pjob->Finished.Wait();
+
+#ifdef OVR_ENABLE_THREADS
+    if ( posted )
+    {
+        pool->Clear ( pjob );
+    }
+#endif
+}
+
+static void DistortionMeshRunJob ( DistortionMeshJob *pjob, int numThreads )
+{
+    pjob->NumRows = pjob->NumEyes * (pjob->GridSize+1);
+    DistortionRowJobRun ( pjob, numThreads );
+}
+
+static bool DistortionMeshAlloc ( DistortionMeshVertexData **ppVertices, uint16_t **ppTriangleListIndices )
+{
+    *ppVertices = (DistortionMeshVertexData*)
+                      OVR_ALLOC( sizeof(DistortionMeshVertexData) * DMA_NumVertsPerEye );
+    *ppTriangleListIndices  = (uint16_t*) OVR_ALLOC( sizeof(uint16_t) * DMA_NumTrisPerEye * 3 );
 
-    for ( int triNum = 0; triNum < DMA_GridSize * DMA_GridSize; triNum++ )
+    if (!*ppVertices || !*ppTriangleListIndices)
     {
-        // Use a Morton order to help locality of FB, texture and vertex cache.
-        // (0.325ms raster order -> 0.257ms Morton order)
-        OVR_ASSERT ( DMA_GridSize <= 256 );
-        int x = ( ( triNum & 0x0001 ) >> 0 ) |
+        if (*ppVertices)
+        {
+            OVR_FREE(*ppVertices);
+        }
+        if (*ppTriangleListIndices)
+        {
+            OVR_FREE(*ppTriangleListIndices);
+        }
+        *ppVertices             = NULL;
+        *ppTriangleListIndices  = NULL;
+        return false;
+    }
+    return true;
+}
+
+// Order of the triangles in the index buffers of the uniform distortion and heightmap grids.
+// Morton order stays the default: the optimizer only beats it by a few percent on these
+// grids, and not at all once the cache holds 32 vertices.
+enum GridMeshOrder
+{
+    GridMeshOrder_Raster,           // Row by row.
+    GridMeshOrder_Morton,           // Z-order curve, the default.
+    GridMeshOrder_VertexCache       // Morton order rearranged by OptimizeVertexCache.
+};
+
+// Triangles for a (gridSize+1) square lattice of vertices, shared by the distortion and heightmap meshes.
+static void GridMeshCreateIndices ( uint16_t *pTriangleListIndices, int gridSize, GridMeshOrder order,
+                                    int cacheSize = VertexCacheDefaultSize )
+{
+    OVR_ASSERT ( gridSize <= 256 );
+    uint16_t *pcurIndex = pTriangleListIndices;
+    for ( int triNum = 0; triNum < gridSize * gridSize; triNum++ )
+    {
+        int x = triNum / gridSize;
+        int y = triNum % gridSize;
+        if ( order != GridMeshOrder_Raster )
+        {
+            // Use a Morton order to help locality of FB, texture and vertex cache.
+            // (0.325ms raster order -> 0.257ms Morton order)
+            x = ( ( triNum & 0x0001 ) >> 0 ) |
                 ( ( triNum & 0x0004 ) >> 1 ) |
                 ( ( triNum & 0x0010 ) >> 2 ) |
                 ( ( triNum & 0x0040 ) >> 3 ) |
@@ -977,7 +1328,7 @@ void DistortionMeshCreate( DistortionMeshVertexData **ppVertices, uint16_t **ppT
                 ( ( triNum & 0x0400 ) >> 5 ) |
                 ( ( triNum & 0x1000 ) >> 6 ) |
                 ( ( triNum & 0x4000 ) >> 7 );
-        int y = ( ( triNum & 0x0002 ) >> 1 ) |
+            y = ( ( triNum & 0x0002 ) >> 1 ) |
                 ( ( triNum & 0x0008 ) >> 2 ) |
                 ( ( triNum & 0x0020 ) >> 3 ) |
                 ( ( triNum & 0x0080 ) >> 4 ) |
@@ -985,7 +1336,8 @@ void DistortionMeshCreate( DistortionMeshVertexData **ppVertices, uint16_t **ppT
                 ( ( triNum & 0x0800 ) >> 6 ) |
                 ( ( triNum & 0x2000 ) >> 7 ) |
                 ( ( triNum & 0x8000 ) >> 8 );
-        int FirstVertex = x * (DMA_GridSize+1) + y;
+        }
+        int FirstVertex = x * (gridSize+1) + y;
         // Another twist - we want the top-left and bottom-right quadrants to
         // have the triangles split one way, the other two split the other.
         // +---+---+---+---+
@@ -1007,29 +1359,797 @@ void DistortionMeshCreate( DistortionMeshVertexData **ppVertices, uint16_t **ppT
         // +---+---+---+---+
         // This way triangle edges don't span long distances over the distortion function,
         // so linear interpolation works better & we can use fewer tris.
-        if ( ( x < DMA_GridSize/2 ) != ( y < DMA_GridSize/2 ) )       // != is logical XOR
+        if ( ( x < gridSize/2 ) != ( y < gridSize/2 ) )       // != is logical XOR
         {
             *pcurIndex++ = (uint16_t)FirstVertex;
             *pcurIndex++ = (uint16_t)FirstVertex+1;
-            *pcurIndex++ = (uint16_t)FirstVertex+(DMA_GridSize+1)+1;
+            *pcurIndex++ = (uint16_t)FirstVertex+(gridSize+1)+1;
 
-            *pcurIndex++ = (uint16_t)FirstVertex+(DMA_GridSize+1)+1;
-            *pcurIndex++ = (uint16_t)FirstVertex+(DMA_GridSize+1);
+            *pcurIndex++ = (uint16_t)FirstVertex+(gridSize+1)+1;
+            *pcurIndex++ = (uint16_t)FirstVertex+(gridSize+1);
             *pcurIndex++ = (uint16_t)FirstVertex;
         }
         else
         {
             *pcurIndex++ = (uint16_t)FirstVertex;
             *pcurIndex++ = (uint16_t)FirstVertex+1;
-            *pcurIndex++ = (uint16_t)FirstVertex+(DMA_GridSize+1);
+            *pcurIndex++ = (uint16_t)FirstVertex+(gridSize+1);
 
             *pcurIndex++ = (uint16_t)FirstVertex+1;
-            *pcurIndex++ = (uint16_t)FirstVertex+(DMA_GridSize+1)+1;
-            *pcurIndex++ = (uint16_t)FirstVertex+(DMA_GridSize+1);
+            *pcurIndex++ = (uint16_t)FirstVertex+(gridSize+1)+1;
+            *pcurIndex++ = (uint16_t)FirstVertex+(gridSize+1);
+        }
+    }
+    if ( order == GridMeshOrder_VertexCache )
+    {
+        // Starting from Morton order gives the optimizer local restart points.
+        OptimizeVertexCache ( pTriangleListIndices, gridSize * gridSize * 2, (gridSize+1) * (gridSize+1), cacheSize );
+    }
+}
+
+
+// Generate distortion mesh for a eye.
+void DistortionMeshCreate( DistortionMeshVertexData **ppVertices, uint16_t **ppTriangleListIndices,
+                           int *pNumVertices, int *pNumTriangles,
+                           bool rightEye,
+                           const HmdRenderInfo &hmdRenderInfo, 
+                           const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC,
+                           int numThreads /*= 0*/, DistortionMeshInverse inverse /*= DistortionMeshInverse_Newton*/ )
+{
+    if ( !DistortionMeshAlloc ( ppVertices, ppTriangleListIndices ) )
+    {
+        *pNumTriangles          = 0;
+        *pNumVertices           = 0;
+        return;
+    }
+    *pNumVertices  = DMA_NumVertsPerEye;
+    *pNumTriangles = DMA_NumTrisPerEye;
+
+    // Populate vertex buffer info
+    Ptr<DistortionMeshJob> job = *new DistortionMeshJob;
+    job->NumEyes                = 1;
+    job->Eyes[0].pVertices      = *ppVertices;
+    job->Eyes[0].RightEye       = rightEye;
+    job->Eyes[0].pHmdRenderInfo = &hmdRenderInfo;
+    job->Eyes[0].pDistortion    = &distortion;
+    job->Eyes[0].EyeToSourceNDC = eyeToSourceNDC;
+    job->SetInverse ( 0, inverse );
+    DistortionMeshRunJob ( job, numThreads );
+
+    // Populate index buffer info  
+    GridMeshCreateIndices ( *ppTriangleListIndices, DMA_GridSize, GridMeshOrder_Morton );
+}
+
+void DistortionMeshCreateBothEyes ( DistortionMeshVertexData *ppVertices[2], uint16_t *ppTriangleListIndices[2],
+                                    int *pNumVertices, int *pNumTriangles,
+                                    const HmdRenderInfo &hmdRenderInfo,
+                                    const DistortionRenderDesc distortion[2], const ScaleAndOffset2D eyeToSourceNDC[2],
+                                    int numThreads /*= 0*/, DistortionMeshInverse inverse /*= DistortionMeshInverse_Newton*/ )
+{
+    bool allocated = DistortionMeshAlloc ( &ppVertices[0], &ppTriangleListIndices[0] );
+    if ( allocated && !DistortionMeshAlloc ( &ppVertices[1], &ppTriangleListIndices[1] ) )
+    {
+        DistortionMeshDestroy ( ppVertices[0], ppTriangleListIndices[0] );
+        allocated = false;
+    }
+    if ( !allocated )
+    {
+        for ( int eyeNum = 0; eyeNum < 2; eyeNum++ )
+        {
+            ppVertices[eyeNum]              = NULL;
+            ppTriangleListIndices[eyeNum]   = NULL;
         }
+        *pNumTriangles          = 0;
+        *pNumVertices           = 0;
+        return;
+    }
+    *pNumVertices  = DMA_NumVertsPerEye;
+    *pNumTriangles = DMA_NumTrisPerEye;
+
+    // Both grids go into one job, so the rows of the two eyes share the same threads.
+    Ptr<DistortionMeshJob> job = *new DistortionMeshJob;
+    job->NumEyes = 2;
+    for ( int eyeNum = 0; eyeNum < 2; eyeNum++ )
+    {
+        job->Eyes[eyeNum].pVertices         = ppVertices[eyeNum];
+        job->Eyes[eyeNum].RightEye          = ( eyeNum == 1 );
+        job->Eyes[eyeNum].pHmdRenderInfo    = &hmdRenderInfo;
+        job->Eyes[eyeNum].pDistortion       = &distortion[eyeNum];
+        job->Eyes[eyeNum].EyeToSourceNDC    = eyeToSourceNDC[eyeNum];
+        job->SetInverse ( eyeNum, inverse );
     }
+    DistortionMeshRunJob ( job, numThreads );
+
+    GridMeshCreateIndices ( ppTriangleListIndices[0], DMA_GridSize, GridMeshOrder_Morton );
+    memcpy ( ppTriangleListIndices[1], ppTriangleListIndices[0], sizeof(uint16_t) * DMA_NumTrisPerEye * 3 );
 }
 
+#ifdef OVR_DISTORTION_MESH_TEST
+void DistortionMeshLogThreadScalingReport ( int maxThreads /*= 0*/ )
+{
+    if ( maxThreads <= 0 )
+    {
+        maxThreads = Thread::GetCPUCount();
+    }
+
+    DebugHmdSetup hmd = CreateDebugHmdSetup ( HmdType_DK2 );
+
+    // One thread gives the reference meshes.
+    DistortionMeshVertexData *pReference[2];
+    uint16_t *pReferenceIndices[2];
+    int numVertices = 0, numTriangles = 0;
+    DistortionMeshCreateBothEyes ( pReference, pReferenceIndices, &numVertices, &numTriangles,
+                                   hmd.RenderInfo, hmd.Distortion, hmd.EyeToSourceNDC, 1 );
+    if ( !pReference[0] )
+    {
+        return;
+    }
+
+    const int numRuns = 50;
+    double singleThreadTime = 0.0;
+    LogText ( "Distortion mesh, both DK2 eyes, %d verts each, mean of %d builds\n", numVertices, numRuns );
+    LogText ( "threads      ms  speedup  same as 1 thread\n" );
+    for ( int numThreads = 1; numThreads <= maxThreads; numThreads++ )
+    {
+        bool same = true;
+        double start = Timer::GetSeconds();
+        for ( int run = 0; run < numRuns; run++ )
+        {
+            DistortionMeshVertexData *pVertices[2];
+            uint16_t *pIndices[2];
+            DistortionMeshCreateBothEyes ( pVertices, pIndices, &numVertices, &numTriangles,
+                                           hmd.RenderInfo, hmd.Distortion, hmd.EyeToSourceNDC, numThreads );
+            if ( !pVertices[0] )
+            {
+                same = false;
+                continue;
+            }
+            for ( int eyeNum = 0; eyeNum < 2; eyeNum++ )
+            {
+                same = same && memcmp ( pVertices[eyeNum], pReference[eyeNum], sizeof(DistortionMeshVertexData) * numVertices ) == 0;
+                DistortionMeshDestroy ( pVertices[eyeNum], pIndices[eyeNum] );
+            }
+        }
+        double time = ( Timer::GetSeconds() - start ) / (double)numRuns;
+        if ( numThreads == 1 )
+        {
+            singleThreadTime = time;
+        }
+        LogText ( "%7d  %6.3f  %6.2fx  %s\n", numThreads, time * 1000.0, singleThreadTime / time, same ? "yes" : "NO" );
+    }
+
+    for ( int eyeNum = 0; eyeNum < 2; eyeNum++ )
+    {
+        DistortionMeshDestroy ( pReference[eyeNum], pReferenceIndices[eyeNum] );
+    }
+}
+#endif // OVR_DISTORTION_MESH_TEST
+
+//-----------------------------------------------------------------------------------
+// *****  Adaptive Distortion Mesh
+//
+// Starts from the same kind of lattice as DistortionMeshCreate, then covers it with a quadtree
+// whose leaves are split only while two triangles across them miss the lattice points inside by
+// more than the allowed error. Leaves bordering smaller ones get a centre vertex and a fan through
+// every lattice point on their edges that a neighbour uses, so no T-junctions are left to crack.
+// The fan's triangles are checked against the same error, and a leaf whose fan misses is split too.
+
+// The vignette fade is interpolated across the same triangles, so it gets a tolerance of its own.
+static const float DMA_MaxShadeError = 1.0f / 32.0f;
+
+struct DistortionMeshAdaptiveState
+{
+    const DistortionMeshVertexData *pLattice;
+    int                             GridSize;
+    Vector2f                        TanToUV;    // Scale from a tan angle error to a rendertarget UV error.
+    float                           MaxUVError;
+    Array<uint8_t>                  Used;       // Per lattice point, whether the mesh keeps it.
+    Array<int>                      Leaves;     // x, y, size of every leaf, in quadtree order.
+
+    const DistortionMeshVertexData &Vertex ( int x, int y ) const
+    {
+        return pLattice[y * (GridSize+1) + x];
+    }
+};
+
+// The two triangles of a quad are split the same way as the uniform mesh, so its
+// quadrants keep their triangle edges away from the centre of the distortion.
+static bool DistortionMeshSplitsAlongAD ( int x, int y, int gridSize )
+{
+    return ( x < gridSize/2 ) != ( y < gridSize/2 );
+}
+
+// Error in UV units and in shade of interpolating the vertex at p from the triangle v0 v1 v2,
+// using barycentrics taken from the screen positions like the rasterizer does.
+static void DistortionMeshInterpolationError ( DistortionMeshAdaptiveState const &state,
+                                               DistortionMeshVertexData const &v0, DistortionMeshVertexData const &v1,
+                                               DistortionMeshVertexData const &v2, DistortionMeshVertexData const &p,
+                                               float *pUVError, float *pShadeError )
+{
+    Vector2f e1 = v1.ScreenPosNDC - v0.ScreenPosNDC;
+    Vector2f e2 = v2.ScreenPosNDC - v0.ScreenPosNDC;
+    Vector2f ep = p.ScreenPosNDC - v0.ScreenPosNDC;
+    float det = e1.x * e2.y - e1.y * e2.x;
+    if ( det == 0.0f )
+    {
+        // Collapsed against the screen edge clamp, so it covers no pixels at all.
+        *pUVError    = 0.0f;
+        *pShadeError = 0.0f;
+        return;
+    }
+    float b1 = ( ep.x * e2.y - ep.y * e2.x ) / det;
+    float b2 = ( e1.x * ep.y - e1.y * ep.x ) / det;
+    float b0 = 1.0f - b1 - b2;
+
+    Vector2f const *pTan0 = &v0.TanEyeAnglesR;
+    Vector2f const *pTan1 = &v1.TanEyeAnglesR;
+    Vector2f const *pTan2 = &v2.TanEyeAnglesR;
+    Vector2f const *pTanP = &p.TanEyeAnglesR;
+    float uvError = 0.0f;
+    for ( int channel = 0; channel < 3; channel++ )
+    {
+        Vector2f tan = pTan0[channel] * b0 + pTan1[channel] * b1 + pTan2[channel] * b2;
+        Vector2f error = ( tan - pTanP[channel] ).EntrywiseMultiply ( state.TanToUV );
+        uvError = Alg::Max ( uvError, error.Length() );
+    }
+    *pUVError    = uvError;
+    *pShadeError = Alg::Abs ( v0.Shade * b0 + v1.Shade * b1 + v2.Shade * b2 - p.Shade );
+}
+
+static bool DistortionMeshQuadIsFlat ( DistortionMeshAdaptiveState const &state, int x0, int y0, int size )
+{
+    DistortionMeshVertexData const &a = state.Vertex ( x0,        y0 );
+    DistortionMeshVertexData const &b = state.Vertex ( x0 + size, y0 );
+    DistortionMeshVertexData const &c = state.Vertex ( x0,        y0 + size );
+    DistortionMeshVertexData const &d = state.Vertex ( x0 + size, y0 + size );
+    bool alongAD = DistortionMeshSplitsAlongAD ( x0, y0, state.GridSize );
+
+    for ( int j = 0; j <= size; j++ )
+    {
+        for ( int i = 0; i <= size; i++ )
+        {
+            // Pick the triangle by lattice position; the screen space barycentrics do the rest.
+            DistortionMeshVertexData const &p = state.Vertex ( x0 + i, y0 + j );
+            float uvError, shadeError;
+            if ( alongAD )
+            {
+                if ( i >= j )
+                    DistortionMeshInterpolationError ( state, a, b, d, p, &uvError, &shadeError );
+                else
+                    DistortionMeshInterpolationError ( state, a, d, c, p, &uvError, &shadeError );
+            }
+            else
+            {
+                if ( i + j <= size )
+                    DistortionMeshInterpolationError ( state, a, b, c, p, &uvError, &shadeError );
+                else
+                    DistortionMeshInterpolationError ( state, b, d, c, p, &uvError, &shadeError );
+            }
+            if ( ( uvError > state.MaxUVError ) || ( shadeError > DMA_MaxShadeError ) )
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// The points a leaf's fan goes through: every used lattice point on its edges, walking a -> b -> d -> c.
+static void DistortionMeshLeafBoundary ( DistortionMeshAdaptiveState const &state, int x0, int y0, int size,
+                                         Array<int> &boundary )
+{
+    int stride = state.GridSize + 1;
+    boundary.Clear();
+    for ( int k = 0; k < size; k++ ) if ( state.Used[ y0 * stride + x0 + k ] )                       boundary.PushBack (   y0 * stride + x0 + k );
+    for ( int k = 0; k < size; k++ ) if ( state.Used[ (y0 + k) * stride + x0 + size ] )              boundary.PushBack ( ( y0 + k ) * stride + x0 + size );
+    for ( int k = size; k > 0; k-- ) if ( state.Used[ (y0 + size) * stride + x0 + k ] )              boundary.PushBack ( ( y0 + size ) * stride + x0 + k );
+    for ( int k = size; k > 0; k-- ) if ( state.Used[ (y0 + k) * stride + x0 ] )                     boundary.PushBack ( ( y0 + k ) * stride + x0 );
+}
+
+// Same test as DistortionMeshQuadIsFlat, for the fan from the leaf's centre through the boundary.
+static bool DistortionMeshFanIsFlat ( DistortionMeshAdaptiveState const &state, int x0, int y0, int size,
+                                      Array<int> const &boundary )
+{
+    int stride = state.GridSize + 1;
+    int cx = x0 + size/2, cy = y0 + size/2;
+    DistortionMeshVertexData const &centre = state.Vertex ( cx, cy );
+    for ( int j = 0; j <= size; j++ )
+    {
+        for ( int i = 0; i <= size; i++ )
+        {
+            // Pick the triangle by lattice position, as the quad test does. Every point is
+            // inside or on the edge of one of them, since they cover the leaf.
+            int px = x0 + i, py = y0 + j;
+            for ( UPInt k = 0; k < boundary.GetSize(); k++ )
+            {
+                int b0 = boundary[k], b1 = boundary[ ( k + 1 ) % boundary.GetSize() ];
+                int x1 = b0 % stride, y1 = b0 / stride;
+                int x2 = b1 % stride, y2 = b1 / stride;
+                // Counter-clockwise in lattice space, so a point inside is left of all three edges.
+                if ( ( x1 - cx ) * ( py - cy ) - ( y1 - cy ) * ( px - cx ) < 0 ||
+                     ( x2 - x1 ) * ( py - y1 ) - ( y2 - y1 ) * ( px - x1 ) < 0 ||
+                     ( cx - x2 ) * ( py - y2 ) - ( cy - y2 ) * ( px - x2 ) < 0 )
+                {
+                    continue;
+                }
+                float uvError, shadeError;
+                DistortionMeshInterpolationError ( state, centre, state.Vertex ( x1, y1 ), state.Vertex ( x2, y2 ),
+                                                   state.Vertex ( px, py ), &uvError, &shadeError );
+                if ( ( uvError > state.MaxUVError ) || ( shadeError > DMA_MaxShadeError ) )
+                {
+                    return false;
+                }
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+static void DistortionMeshRefine ( DistortionMeshAdaptiveState &state, int x0, int y0, int size )
+{
+    if ( ( size > 1 ) && !DistortionMeshQuadIsFlat ( state, x0, y0, size ) )
+    {
+        int half = size / 2;
+        DistortionMeshRefine ( state, x0,        y0,        half );
+        DistortionMeshRefine ( state, x0 + half, y0,        half );
+        DistortionMeshRefine ( state, x0,        y0 + half, half );
+        DistortionMeshRefine ( state, x0 + half, y0 + half, half );
+        return;
+    }
+
+    state.Leaves.PushBack ( x0 );
+    state.Leaves.PushBack ( y0 );
+    state.Leaves.PushBack ( size );
+    int stride = state.GridSize + 1;
+    state.Used[  y0          * stride + x0        ] = 1;
+    state.Used[  y0          * stride + x0 + size ] = 1;
+    state.Used[ (y0 + size)  * stride + x0        ] = 1;
+    state.Used[ (y0 + size)  * stride + x0 + size ] = 1;
+}
+
+static void DistortionMeshBuildAdaptive ( DistortionMeshVertexData **ppVertices, uint16_t **ppTriangleListIndices,
+                                         int *pNumVertices, int *pNumTriangles,
+                                         bool rightEye,
+                                         const HmdRenderInfo &hmdRenderInfo, 
+                                         const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC,
+                                         float maxUVError, int gridSizeLog2, int numThreads, bool optimizeOrder,
+                                         DistortionMeshInverse inverse )
+{
+    *ppVertices             = NULL;
+    *ppTriangleListIndices  = NULL;
+    *pNumVertices           = 0;
+    *pNumTriangles          = 0;
+
+    gridSizeLog2 = Alg::Clamp ( gridSizeLog2, 1, DMA_MaxGridSizeLog2 );
+    const int gridSize    = 1 << gridSizeLog2;
+    const int stride      = gridSize + 1;
+    const int numLattice  = stride * stride;
+
+    // The full lattice, exactly as the uniform mesh would have it.
+    DistortionMeshVertexData *pLattice = (DistortionMeshVertexData*)
+                                            OVR_ALLOC( sizeof(DistortionMeshVertexData) * numLattice );
+    if ( !pLattice )
+    {
+        return;
+    }
+    Ptr<DistortionMeshJob> job = *new DistortionMeshJob;
+    job->GridSize               = gridSize;
+    job->NumEyes                = 1;
+    job->Eyes[0].pVertices      = pLattice;
+    job->Eyes[0].RightEye       = rightEye;
+    job->Eyes[0].pHmdRenderInfo = &hmdRenderInfo;
+    job->Eyes[0].pDistortion    = &distortion;
+    job->Eyes[0].EyeToSourceNDC = eyeToSourceNDC;
+    job->SetInverse ( 0, inverse );
+    DistortionMeshRunJob ( job, numThreads );
+
+    DistortionMeshAdaptiveState state;
+    state.pLattice      = pLattice;
+    state.GridSize      = gridSize;
+    // UV is NDC * 0.5 + 0.5, and NDC is tan angle * EyeToSourceNDC.Scale.
+    state.TanToUV       = Vector2f ( Alg::Abs ( eyeToSourceNDC.Scale.x ), Alg::Abs ( eyeToSourceNDC.Scale.y ) ) * 0.5f;
+    state.MaxUVError    = Alg::Max ( maxUVError, 0.0f );
+    state.Used.Resize ( numLattice );
+    memset ( &state.Used[0], 0, numLattice );
+    DistortionMeshRefine ( state, 0, 0, gridSize );
+
+    // Leaves whose edges carry a neighbour's corner are fanned from their centre, so they keep that too.
+    // Splitting a leaf whose fan misses can put new points on its neighbours' edges, so this repeats
+    // until no leaf splits. It ends because leaves only get smaller, and the smallest are never fanned.
+    int numLeaves = 0;
+    Array<int> boundary;
+    Array<uint16_t> indices;
+    Array<int> fanLeaves;
+    Array<int> previousLeaves;
+    for ( ;; )
+    {
+        numLeaves = (int)state.Leaves.GetSize() / 3;
+        fanLeaves.Clear();
+        for ( int leaf = 0; leaf < numLeaves; leaf++ )
+        {
+            int x0 = state.Leaves[leaf*3+0], y0 = state.Leaves[leaf*3+1], size = state.Leaves[leaf*3+2];
+            bool needsFan = false;
+            for ( int k = 1; ( k < size ) && !needsFan; k++ )
+            {
+                needsFan = state.Used[ y0 * stride + x0 + k ] || state.Used[ (y0 + size) * stride + x0 + k ] ||
+                           state.Used[ (y0 + k) * stride + x0 ] || state.Used[ (y0 + k) * stride + x0 + size ];
+            }
+            fanLeaves.PushBack ( needsFan ? 1 : 0 );
+        }
+        // The centre is a corner of the leaf's quadrants, so it stays used if the leaf is split.
+        for ( int leaf = 0; leaf < numLeaves; leaf++ )
+        {
+            if ( fanLeaves[leaf] )
+            {
+                int x0 = state.Leaves[leaf*3+0], y0 = state.Leaves[leaf*3+1], size = state.Leaves[leaf*3+2];
+                state.Used[ (y0 + size/2) * stride + x0 + size/2 ] = 1;
+            }
+        }
+
+        // Rebuild the leaves in the same quadtree order, refining the ones whose fan misses.
+        previousLeaves = state.Leaves;
+        state.Leaves.Clear();
+        bool split = false;
+        for ( int leaf = 0; leaf < numLeaves; leaf++ )
+        {
+            int x0 = previousLeaves[leaf*3+0], y0 = previousLeaves[leaf*3+1], size = previousLeaves[leaf*3+2];
+            if ( fanLeaves[leaf] )
+            {
+                DistortionMeshLeafBoundary ( state, x0, y0, size, boundary );
+                if ( !DistortionMeshFanIsFlat ( state, x0, y0, size, boundary ) )
+                {
+                    int half = size / 2;
+                    DistortionMeshRefine ( state, x0,        y0,        half );
+                    DistortionMeshRefine ( state, x0 + half, y0,        half );
+                    DistortionMeshRefine ( state, x0,        y0 + half, half );
+                    DistortionMeshRefine ( state, x0 + half, y0 + half, half );
+                    split = true;
+                    continue;
+                }
+            }
+            state.Leaves.PushBack ( x0 );
+            state.Leaves.PushBack ( y0 );
+            state.Leaves.PushBack ( size );
+        }
+        if ( !split )
+        {
+            break;
+        }
+    }
+
+    // Keep the used points in lattice order.
+    Array<int> remap;
+    remap.Resize ( numLattice );
+    int numVertices = 0;
+    for ( int i = 0; i < numLattice; i++ )
+    {
+        remap[i] = state.Used[i] ? numVertices++ : -1;
+    }
+    OVR_ASSERT ( numVertices <= 65536 );
+
+    // Everything is wound the same way as the uniform mesh: counter-clockwise in lattice space.
+    for ( int leaf = 0; leaf < numLeaves; leaf++ )
+    {
+        int x0 = state.Leaves[leaf*3+0], y0 = state.Leaves[leaf*3+1], size = state.Leaves[leaf*3+2];
+        uint16_t a = (uint16_t)remap[  y0         * stride + x0        ];
+        uint16_t b = (uint16_t)remap[  y0         * stride + x0 + size ];
+        uint16_t c = (uint16_t)remap[ (y0 + size) * stride + x0        ];
+        uint16_t d = (uint16_t)remap[ (y0 + size) * stride + x0 + size ];
+        if ( !fanLeaves[leaf] )
+        {
+            if ( DistortionMeshSplitsAlongAD ( x0, y0, gridSize ) )
+            {
+                indices.PushBack ( a ); indices.PushBack ( b ); indices.PushBack ( d );
+                indices.PushBack ( d ); indices.PushBack ( c ); indices.PushBack ( a );
+            }
+            else
+            {
+                indices.PushBack ( a ); indices.PushBack ( b ); indices.PushBack ( c );
+                indices.PushBack ( b ); indices.PushBack ( d ); indices.PushBack ( c );
+            }
+            continue;
+        }
+
+        DistortionMeshLeafBoundary ( state, x0, y0, size, boundary );
+        uint16_t centre = (uint16_t)remap[ (y0 + size/2) * stride + x0 + size/2 ];
+        for ( UPInt k = 0; k < boundary.GetSize(); k++ )
+        {
+            indices.PushBack ( centre );
+            indices.PushBack ( (uint16_t)remap[ boundary[k] ] );
+            indices.PushBack ( (uint16_t)remap[ boundary[ ( k + 1 ) % boundary.GetSize() ] ] );
+        }
+    }
+
+    int numIndices = (int)indices.GetSize();
+    *ppVertices = (DistortionMeshVertexData*) OVR_ALLOC( sizeof(DistortionMeshVertexData) * numVertices );
+    *ppTriangleListIndices = (uint16_t*) OVR_ALLOC( sizeof(uint16_t) * numIndices );
+    if ( !*ppVertices || !*ppTriangleListIndices )
+    {
+        DistortionMeshDestroy ( *ppVertices, *ppTriangleListIndices );
+        *ppVertices             = NULL;
+        *ppTriangleListIndices  = NULL;
+        OVR_FREE ( pLattice );
+        return;
+    }
+    for ( int i = 0; i < numLattice; i++ )
+    {
+        if ( remap[i] >= 0 )
+        {
+            (*ppVertices)[remap[i]] = pLattice[i];
+        }
+    }
+    memcpy ( *ppTriangleListIndices, &indices[0], sizeof(uint16_t) * numIndices );
+    OVR_FREE ( pLattice );
+
+    // Unlike the grids, the quadtree order leaves the optimizer plenty to gain.
+    if ( optimizeOrder )
+    {
+        OptimizeVertexCache ( *ppTriangleListIndices, numIndices / 3, numVertices );
+        OptimizeVertexFetch ( *ppVertices, sizeof(DistortionMeshVertexData), *ppTriangleListIndices, numIndices / 3, numVertices );
+    }
+
+    *pNumVertices  = numVertices;
+    *pNumTriangles = numIndices / 3;
+}
+
+void DistortionMeshCreateAdaptive ( DistortionMeshVertexData **ppVertices, uint16_t **ppTriangleListIndices,
+                                    int *pNumVertices, int *pNumTriangles,
+                                    bool rightEye,
+                                    const HmdRenderInfo &hmdRenderInfo, 
+                                    const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC,
+                                    float maxUVError, int gridSizeLog2 /*= 6*/, int numThreads /*= 0*/,
+                                    DistortionMeshInverse inverse /*= DistortionMeshInverse_Newton*/ )
+{
+    DistortionMeshBuildAdaptive ( ppVertices, ppTriangleListIndices, pNumVertices, pNumTriangles, rightEye,
+                                  hmdRenderInfo, distortion, eyeToSourceNDC, maxUVError, gridSizeLog2, numThreads, true,
+                                  inverse );
+}
+
+
+DistortionMeshError DistortionMeshMeasureError ( const DistortionMeshVertexData *pVertices, const uint16_t *pTriangleListIndices,
+                                                 int numTriangles, bool rightEye,
+                                                 const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC,
+                                                 Sizei eyePixels )
+{
+    DistortionMeshError result;
+    result.MaxUVError   = 0.0f;
+    result.RmsUVError   = 0.0f;
+    result.NumPixels    = 0;
+    if ( ( eyePixels.w <= 0 ) || ( eyePixels.h <= 0 ) )
+    {
+        return result;
+    }
+
+    Vector2f tanToUV = Vector2f ( Alg::Abs ( eyeToSourceNDC.Scale.x ), Alg::Abs ( eyeToSourceNDC.Scale.y ) ) * 0.5f;
+    float xOffset = rightEye ? 1.0f : 0.0f;
+    Array<uint8_t> covered;
+    covered.Resize ( eyePixels.w * eyePixels.h );
+    memset ( &covered[0], 0, covered.GetSize() );
+    double sumSquares = 0.0;
+
+    for ( int tri = 0; tri < numTriangles; tri++ )
+    {
+        // Undo DistortionMeshMakeVertex's mapping to get back to this eye's screen NDC, then to pixels.
+        DistortionMeshVertexData const *pv[3];
+        Vector2f pixel[3];
+        for ( int k = 0; k < 3; k++ )
+        {
+            pv[k] = &pVertices[ pTriangleListIndices[tri*3+k] ];
+            Vector2f screenNDC ( ( pv[k]->ScreenPosNDC.x + 0.5f - xOffset ) * 2.0f, -pv[k]->ScreenPosNDC.y );
+            pixel[k].x = ( screenNDC.x * 0.5f + 0.5f ) * (float)eyePixels.w;
+            pixel[k].y = ( screenNDC.y * 0.5f + 0.5f ) * (float)eyePixels.h;
+        }
+        Vector2f e1 = pixel[1] - pixel[0];
+        Vector2f e2 = pixel[2] - pixel[0];
+        float det = e1.x * e2.y - e1.y * e2.x;
+        if ( det == 0.0f )
+        {
+            continue;
+        }
+
+        int minX = Alg::Max ( 0,               (int)floorf ( Alg::Min ( pixel[0].x, Alg::Min ( pixel[1].x, pixel[2].x ) ) ) );
+        int maxX = Alg::Min ( eyePixels.w - 1, (int)ceilf  ( Alg::Max ( pixel[0].x, Alg::Max ( pixel[1].x, pixel[2].x ) ) ) );
+        int minY = Alg::Max ( 0,               (int)floorf ( Alg::Min ( pixel[0].y, Alg::Min ( pixel[1].y, pixel[2].y ) ) ) );
+        int maxY = Alg::Min ( eyePixels.h - 1, (int)ceilf  ( Alg::Max ( pixel[0].y, Alg::Max ( pixel[1].y, pixel[2].y ) ) ) );
+        for ( int y = minY; y <= maxY; y++ )
+        {
+            for ( int x = minX; x <= maxX; x++ )
+            {
+                // Pixels on a shared edge are only counted by the first triangle that reaches them.
+                uint8_t &isCovered = covered[ y * eyePixels.w + x ];
+                if ( isCovered )
+                {
+                    continue;
+                }
+                Vector2f ep = Vector2f ( (float)x + 0.5f, (float)y + 0.5f ) - pixel[0];
+                float b1 = ( ep.x * e2.y - ep.y * e2.x ) / det;
+                float b2 = ( e1.x * ep.y - e1.y * ep.x ) / det;
+                float b0 = 1.0f - b1 - b2;
+                if ( ( b0 < 0.0f ) || ( b1 < 0.0f ) || ( b2 < 0.0f ) )
+                {
+                    continue;
+                }
+                isCovered = 1;
+
+                Vector2f screenNDC ( ( (float)x + 0.5f ) / (float)eyePixels.w * 2.0f - 1.0f,
+                                     ( (float)y + 0.5f ) / (float)eyePixels.h * 2.0f - 1.0f );
+                Vector2f exact[3];
+                TransformScreenNDCToTanFovSpaceChroma ( &exact[0], &exact[1], &exact[2], distortion, screenNDC );
+
+                float error = 0.0f;
+                for ( int channel = 0; channel < 3; channel++ )
+                {
+                    Vector2f const *pTan0 = &pv[0]->TanEyeAnglesR;
+                    Vector2f const *pTan1 = &pv[1]->TanEyeAnglesR;
+                    Vector2f const *pTan2 = &pv[2]->TanEyeAnglesR;
+                    Vector2f tan = pTan0[channel] * b0 + pTan1[channel] * b1 + pTan2[channel] * b2;
+                    error = Alg::Max ( error, ( tan - exact[channel] ).EntrywiseMultiply ( tanToUV ).Length() );
+                }
+                result.MaxUVError = Alg::Max ( result.MaxUVError, error );
+                sumSquares += (double)error * (double)error;
+                result.NumPixels++;
+            }
+        }
+    }
+
+    if ( result.NumPixels > 0 )
+    {
+        result.RmsUVError = (float)sqrt ( sumSquares / (double)result.NumPixels );
+    }
+    return result;
+}
+
+
+#ifdef OVR_DISTORTION_MESH_TEST
+// The adaptive mesh's worst error at the points of the lattice it was built from, which is what
+// maxUVError bounds. Each point is interpolated from the triangle that covers it on screen.
+// Near the corners the lattice's outer edge curves on screen and a coarse leaf's straight edge
+// cuts across it; the points left outside are never drawn, so they are only counted.
+static float DistortionMeshLatticeError ( const DistortionMeshVertexData *pVertices, const uint16_t *pTriangleListIndices,
+                                          int numTriangles,
+                                          const DistortionMeshVertexData *pLattice, int numLatticeVertices,
+                                          const ScaleAndOffset2D &eyeToSourceNDC, int *pNumUncovered )
+{
+    Vector2f tanToUV = Vector2f ( Alg::Abs ( eyeToSourceNDC.Scale.x ), Alg::Abs ( eyeToSourceNDC.Scale.y ) ) * 0.5f;
+    // Points on a shared edge or corner can land just outside both triangles through rounding.
+    const float edgeSlack = 1e-4f;
+    Array<uint8_t> found;
+    found.Resize ( numLatticeVertices );
+    memset ( &found[0], 0, found.GetSize() );
+    float maxError = 0.0f;
+
+    for ( int tri = 0; tri < numTriangles; tri++ )
+    {
+        DistortionMeshVertexData const &v0 = pVertices[ pTriangleListIndices[tri*3+0] ];
+        DistortionMeshVertexData const &v1 = pVertices[ pTriangleListIndices[tri*3+1] ];
+        DistortionMeshVertexData const &v2 = pVertices[ pTriangleListIndices[tri*3+2] ];
+        Vector2f e1 = v1.ScreenPosNDC - v0.ScreenPosNDC;
+        Vector2f e2 = v2.ScreenPosNDC - v0.ScreenPosNDC;
+        float det = e1.x * e2.y - e1.y * e2.x;
+        if ( det == 0.0f )
+        {
+            continue;
+        }
+        Vector2f minPos ( Alg::Min ( v0.ScreenPosNDC.x, Alg::Min ( v1.ScreenPosNDC.x, v2.ScreenPosNDC.x ) ),
+                          Alg::Min ( v0.ScreenPosNDC.y, Alg::Min ( v1.ScreenPosNDC.y, v2.ScreenPosNDC.y ) ) );
+        Vector2f maxPos ( Alg::Max ( v0.ScreenPosNDC.x, Alg::Max ( v1.ScreenPosNDC.x, v2.ScreenPosNDC.x ) ),
+                          Alg::Max ( v0.ScreenPosNDC.y, Alg::Max ( v1.ScreenPosNDC.y, v2.ScreenPosNDC.y ) ) );
+
+        for ( int i = 0; i < numLatticeVertices; i++ )
+        {
+            DistortionMeshVertexData const &p = pLattice[i];
+            if ( found[i] ||
+                 ( p.ScreenPosNDC.x < minPos.x ) || ( p.ScreenPosNDC.x > maxPos.x ) ||
+                 ( p.ScreenPosNDC.y < minPos.y ) || ( p.ScreenPosNDC.y > maxPos.y ) )
+            {
+                continue;
+            }
+            Vector2f ep = p.ScreenPosNDC - v0.ScreenPosNDC;
+            float b1 = ( ep.x * e2.y - ep.y * e2.x ) / det;
+            float b2 = ( e1.x * ep.y - e1.y * ep.x ) / det;
+            float b0 = 1.0f - b1 - b2;
+            if ( ( b0 < -edgeSlack ) || ( b1 < -edgeSlack ) || ( b2 < -edgeSlack ) )
+            {
+                continue;
+            }
+            found[i] = 1;
+
+            Vector2f const *pTan0 = &v0.TanEyeAnglesR;
+            Vector2f const *pTan1 = &v1.TanEyeAnglesR;
+            Vector2f const *pTan2 = &v2.TanEyeAnglesR;
+            Vector2f const *pTanP = &p.TanEyeAnglesR;
+            for ( int channel = 0; channel < 3; channel++ )
+            {
+                Vector2f tan = pTan0[channel] * b0 + pTan1[channel] * b1 + pTan2[channel] * b2;
+                maxError = Alg::Max ( maxError, ( tan - pTanP[channel] ).EntrywiseMultiply ( tanToUV ).Length() );
+            }
+        }
+    }
+
+    *pNumUncovered = 0;
+    for ( int i = 0; i < numLatticeVertices; i++ )
+    {
+        *pNumUncovered += found[i] ? 0 : 1;
+    }
+    return maxError;
+}
+
+bool DistortionMeshLogErrorReport ( float maxUVError )
+{
+    const HmdTypeEnum hmdTypes[]    = { HmdType_DK1, HmdType_DK2 };
+    const char *      hmdNames[]    = { "DK1", "DK2" };
+    bool passed = true;
+
+    LogText ( "Distortion mesh error, adaptive target %.5f UV\n", maxUVError );
+    LogText ( "HMD eye  mesh      verts   tris  lattice err  undrawn  max UV err  rms UV err\n" );
+    for ( int hmdNum = 0; hmdNum < 2; hmdNum++ )
+    {
+        DebugHmdSetup hmd = CreateDebugHmdSetup ( hmdTypes[hmdNum] );
+        HmdRenderInfo const &renderInfo = hmd.RenderInfo;
+
+        for ( int eyeNum = 0; eyeNum < 2; eyeNum++ )
+        {
+            DistortionRenderDesc const &distortion = hmd.Distortion[eyeNum];
+            ScaleAndOffset2D const &eyeToSourceNDC = hmd.EyeToSourceNDC[eyeNum];
+
+            // The uniform mesh goes first, since its vertices are the lattice the adaptive one is held to.
+            DistortionMeshVertexData *pLattice = NULL;
+            uint16_t *pLatticeIndices = NULL;
+            int numLatticeVertices = 0;
+            for ( int adaptive = 0; adaptive < 2; adaptive++ )
+            {
+                DistortionMeshVertexData *pVertices = NULL;
+                uint16_t *pIndices = NULL;
+                int numVertices = 0, numTriangles = 0;
+                if ( adaptive )
+                {
+                    DistortionMeshCreateAdaptive ( &pVertices, &pIndices, &numVertices, &numTriangles, eyeNum == 1,
+                                                   renderInfo, distortion, eyeToSourceNDC, maxUVError );
+                }
+                else
+                {
+                    DistortionMeshCreate ( &pVertices, &pIndices, &numVertices, &numTriangles, eyeNum == 1,
+                                           renderInfo, distortion, eyeToSourceNDC );
+                }
+                if ( !pVertices )
+                {
+                    continue;
+                }
+                if ( !adaptive )
+                {
+                    pLattice           = pVertices;
+                    pLatticeIndices    = pIndices;
+                    numLatticeVertices = numVertices;
+                }
+                int numUncovered = 0;
+                float latticeError = pLattice ? DistortionMeshLatticeError ( pVertices, pIndices, numTriangles,
+                                                                             pLattice, numLatticeVertices, eyeToSourceNDC,
+                                                                             &numUncovered )
+                                              : 0.0f;
+                DistortionMeshError error = DistortionMeshMeasureError ( pVertices, pIndices, numTriangles, eyeNum == 1,
+                                                                         distortion, eyeToSourceNDC, hmd.EyePixels );
+                LogText ( "%-3s %-5s %-8s %6d %6d  %11.6f  %7d  %10.6f  %10.6f\n", hmdNames[hmdNum], eyeNum == 0 ? "left" : "right",
+                          adaptive ? "adaptive" : "uniform", numVertices, numTriangles, latticeError, numUncovered,
+                          error.MaxUVError, error.RmsUVError );
+                if ( adaptive )
+                {
+                    DistortionMeshDestroy ( pVertices, pIndices );
+                    if ( latticeError > maxUVError )
+                    {
+                        LogError ( "{ERR-DMESH} %s %s adaptive mesh lattice error %g is over %g", hmdNames[hmdNum],
+                                   eyeNum == 0 ? "left" : "right", latticeError, maxUVError );
+                        passed = false;
+                    }
+                }
+            }
+            DistortionMeshDestroy ( pLattice, pLatticeIndices );
+        }
+    }
+    return passed;
+}
+#endif // OVR_DISTORTION_MESH_TEST
+
 //-----------------------------------------------------------------------------------
 // *****  Heightmap Mesh Rendering
 
@@ -1153,73 +2273,63 @@ void HeightmapMeshCreate( HeightmapMeshVertexData **ppVertices, uint16_t **ppTri
 
 
     // Populate index buffer info  
-    uint16_t *pcurIndex = *ppTriangleListIndices;
+    GridMeshCreateIndices ( *ppTriangleListIndices, HMA_GridSize, GridMeshOrder_Morton );
+}
 
-    for ( int triNum = 0; triNum < HMA_GridSize * HMA_GridSize; triNum++ )
+#ifdef OVR_DISTORTION_MESH_TEST
+void DistortionMeshLogVertexCacheReport ( int cacheSize /*= VertexCacheDefaultSize*/ )
+{
+    const GridMeshOrder orders[]        = { GridMeshOrder_Raster, GridMeshOrder_Morton, GridMeshOrder_VertexCache };
+    const char *        orderNames[]    = { "raster", "morton", "optimized" };
+    const int           gridSizes[]     = { DMA_GridSize, HMA_GridSize };
+    const char *        gridNames[]     = { "distortion", "heightmap" };
+
+    LogText ( "Vertex cache use, %d entry FIFO\n", cacheSize );
+    LogText ( "mesh       order      verts   tris   ACMR   ATVR\n" );
+    for ( int gridNum = 0; gridNum < 2; gridNum++ )
     {
-        // Use a Morton order to help locality of FB, texture and vertex cache.
-        // (0.325ms raster order -> 0.257ms Morton order)
-        OVR_ASSERT ( HMA_GridSize < 256 );
-        int x = ( ( triNum & 0x0001 ) >> 0 ) |
-                ( ( triNum & 0x0004 ) >> 1 ) |
-                ( ( triNum & 0x0010 ) >> 2 ) |
-                ( ( triNum & 0x0040 ) >> 3 ) |
-                ( ( triNum & 0x0100 ) >> 4 ) |
-                ( ( triNum & 0x0400 ) >> 5 ) |
-                ( ( triNum & 0x1000 ) >> 6 ) |
-                ( ( triNum & 0x4000 ) >> 7 );
-        int y = ( ( triNum & 0x0002 ) >> 1 ) |
-                ( ( triNum & 0x0008 ) >> 2 ) |
-                ( ( triNum & 0x0020 ) >> 3 ) |
-                ( ( triNum & 0x0080 ) >> 4 ) |
-                ( ( triNum & 0x0200 ) >> 5 ) |
-                ( ( triNum & 0x0800 ) >> 6 ) |
-                ( ( triNum & 0x2000 ) >> 7 ) |
-                ( ( triNum & 0x8000 ) >> 8 );
-        int FirstVertex = x * (HMA_GridSize+1) + y;
-        // Another twist - we want the top-left and bottom-right quadrants to
-        // have the triangles split one way, the other two split the other.
-        // +---+---+---+---+
-        // |  /|  /|\  |\  |
-        // | / | / | \ | \ |
-        // |/  |/  |  \|  \|
-        // +---+---+---+---+
-        // |  /|  /|\  |\  |
-        // | / | / | \ | \ |
-        // |/  |/  |  \|  \|
-        // +---+---+---+---+
-        // |\  |\  |  /|  /|
-        // | \ | \ | / | / |
-        // |  \|  \|/  |/  |
-        // +---+---+---+---+
-        // |\  |\  |  /|  /|
-        // | \ | \ | / | / |
-        // |  \|  \|/  |/  |
-        // +---+---+---+---+
-        // This way triangle edges don't span long distances over the distortion function,
-        // so linear interpolation works better & we can use fewer tris.
-        if ( ( x < HMA_GridSize/2 ) != ( y < HMA_GridSize/2 ) )       // != is logical XOR
+        int gridSize     = gridSizes[gridNum];
+        int numVertices  = (gridSize+1) * (gridSize+1);
+        int numTriangles = gridSize * gridSize * 2;
+        Array<uint16_t> indices;
+        indices.Resize ( numTriangles * 3 );
+        for ( int orderNum = 0; orderNum < 3; orderNum++ )
         {
-            *pcurIndex++ = (uint16_t)FirstVertex;
-            *pcurIndex++ = (uint16_t)FirstVertex+1;
-            *pcurIndex++ = (uint16_t)FirstVertex+(HMA_GridSize+1)+1;
+            GridMeshCreateIndices ( &indices[0], gridSize, orders[orderNum], cacheSize );
+            VertexCacheStats stats = MeasureVertexCache ( &indices[0], numTriangles, numVertices, cacheSize );
+            LogText ( "%-10s %-9s %6d %6d  %5.3f  %5.3f\n", gridNames[gridNum], orderNames[orderNum],
+                      numVertices, numTriangles, stats.ACMR, stats.ATVR );
+        }
+    }
 
-            *pcurIndex++ = (uint16_t)FirstVertex+(HMA_GridSize+1)+1;
-            *pcurIndex++ = (uint16_t)FirstVertex+(HMA_GridSize+1);
-            *pcurIndex++ = (uint16_t)FirstVertex;
+    DebugHmdSetup hmd = CreateDebugHmdSetup ( HmdType_DK2 );
+
+    for ( int optimized = 0; optimized < 2; optimized++ )
+    {
+        DistortionMeshVertexData *pVertices = NULL;
+        uint16_t *pIndices = NULL;
+        int numVertices = 0, numTriangles = 0;
+        DistortionMeshBuildAdaptive ( &pVertices, &pIndices, &numVertices, &numTriangles, false,
+                                      hmd.RenderInfo, hmd.Distortion[0], hmd.EyeToSourceNDC[0], 1.0f / 1024.0f, 6, 0, false,
+                                      DistortionMeshInverse_Newton );
+        if ( !pVertices )
+        {
+            return;
         }
-        else
+        if ( optimized )
         {
-            *pcurIndex++ = (uint16_t)FirstVertex;
-            *pcurIndex++ = (uint16_t)FirstVertex+1;
-            *pcurIndex++ = (uint16_t)FirstVertex+(HMA_GridSize+1);
-
-            *pcurIndex++ = (uint16_t)FirstVertex+1;
-            *pcurIndex++ = (uint16_t)FirstVertex+(HMA_GridSize+1)+1;
-            *pcurIndex++ = (uint16_t)FirstVertex+(HMA_GridSize+1);
+            // Same as DistortionMeshCreateAdaptive, but for the cache size being measured.
+            OptimizeVertexCache ( pIndices, numTriangles, numVertices, cacheSize );
+            OptimizeVertexFetch ( pVertices, sizeof(DistortionMeshVertexData), pIndices, numTriangles, numVertices );
         }
+        VertexCacheStats stats = MeasureVertexCache ( pIndices, numTriangles, numVertices, cacheSize );
+        LogText ( "%-10s %-9s %6d %6d  %5.3f  %5.3f\n", "adaptive", optimized ? "optimized" : "quadtree",
+                  numVertices, numTriangles, stats.ACMR, stats.ATVR );
+        DistortionMeshDestroy ( pVertices, pIndices );
     }
 }
+#endif // OVR_DISTORTION_MESH_TEST
+
 
 //-----------------------------------------------------------------------------------
 // ***** Prediction and timewarp.
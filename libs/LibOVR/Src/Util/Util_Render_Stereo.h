@@ -29,6 +29,13 @@ limitations under the License.
 
 #include "../OVR_Stereo.h"
 #include "../Tracking/Tracking_SensorStateReader.h"
+#include "Util_MeshOptimizer.h"
+
+// Define this to compile-in the stereo cache report
+//#define OVR_STEREO_CACHE_TEST
+
+// Define this to compile-in the distortion mesh error, vertex cache and threading reports
+//#define OVR_DISTORTION_MESH_TEST
 
 namespace OVR { namespace Util { namespace Render {
 
@@ -41,6 +48,18 @@ namespace OVR { namespace Util { namespace Render {
 char const* GetDebugNameEyeCupType ( EyeCupType eyeCupType );
 char const* GetDebugNameHmdType ( HmdTypeEnum hmdType );
 
+// A debug HMD set up the way the CAPI sets one up, with the default profile, for the test reports.
+// The per-eye arrays hold the left eye first; the FOV is the CAPI's default one.
+struct DebugHmdSetup
+{
+    HmdRenderInfo           RenderInfo;
+    DistortionRenderDesc    Distortion[2];
+    FovPort                 Fov[2];
+    ScaleAndOffset2D        EyeToSourceNDC[2];
+    Sizei                   EyePixels;          // One eye's half of the screen.
+};
+DebugHmdSetup CreateDebugHmdSetup ( HmdTypeEnum hmdType );
+
 
 
 //-----------------------------------------------------------------------------------
@@ -67,6 +86,12 @@ StereoEyeParams CalculateStereoEyeParams ( HmdRenderInfo const &hmd,
 Vector3f CalculateEyeVirtualCameraOffset(HmdRenderInfo const &hmd,
                                          StereoEye eyeType, bool bMonoRenderingMode );
 
+#ifdef OVR_STEREO_CACHE_TEST
+// Times reconfiguring the debug DK1 and DK2 in turn, redoing what ovrHmd_Create does to
+// describe the HMD, with the stereo cache off and then on, and logs the cache counters.
+void StereoCacheLogReport ( );
+#endif
+
 
 // These are two components from StereoEyeParams that can be changed
 // very easily without full recomputation of everything.
@@ -338,16 +363,84 @@ void DistortionMeshCreate ( DistortionMeshVertexData **ppVertices, uint16_t **pp
                             int *pNumVertices, int *pNumTriangles,
                             const StereoEyeParams &stereoParams, const HmdRenderInfo &hmdRenderInfo );
 
+// How mesh generation inverts the lens to find where each grid point goes on the screen.
+// Only the vertex positions depend on it: the tan angles of a vertex are always computed
+// exactly from where it lands, so the table adds no distortion error.
+enum DistortionMeshInverse
+{
+    DistortionMeshInverse_Newton,   // LensConfig::DistortionFnInverse at every vertex.
+    DistortionMeshInverse_Table,    // A LensInverseTable per eye, built from 64 solves instead of one per vertex.
+};
+
 // Generate distortion mesh for a eye.
 // This version requires less data then stereoParms, supporting dynamic change in render target viewport.
+// The rows of the grid are spread over numThreads threads including the caller; 0 uses one per CPU.
+// The result is identical for any thread count.
 void DistortionMeshCreate( DistortionMeshVertexData **ppVertices, uint16_t **ppTriangleListIndices,
                            int *pNumVertices, int *pNumTriangles,
                            bool rightEye,
                            const HmdRenderInfo &hmdRenderInfo, 
-                           const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC );
+                           const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC,
+                           int numThreads = 0, DistortionMeshInverse inverse = DistortionMeshInverse_Newton );
+
+// Same, for the left [0] and right [1] eyes at once, with the rows of both grids sharing the threads.
+// Vertex and triangle counts are the same for both eyes. Free each eye with DistortionMeshDestroy.
+void DistortionMeshCreateBothEyes ( DistortionMeshVertexData *ppVertices[2], uint16_t *ppTriangleListIndices[2],
+                                    int *pNumVertices, int *pNumTriangles,
+                                    const HmdRenderInfo &hmdRenderInfo,
+                                    const DistortionRenderDesc distortion[2], const ScaleAndOffset2D eyeToSourceNDC[2],
+                                    int numThreads = 0, DistortionMeshInverse inverse = DistortionMeshInverse_Newton );
+
+// Generate a distortion mesh that only tessellates as finely as the lens needs.
+// Starts from a (1<<gridSizeLog2)+1 square lattice (gridSizeLog2 up to 7), and keeps
+// a coarser quad wherever interpolating across it stays within maxUVError of the
+// lattice, in rendertarget UV units. A maxUVError of 0 keeps the whole lattice.
+// The bound holds at the lattice points the mesh draws; between them it also carries
+// the lattice's own interpolation error, as the uniform mesh does. Near the corners a
+// coarse edge can cut a sliver off the lattice's curved outer edge, where the fade is.
+// Triangles and vertices come out in OptimizeVertexCache and OptimizeVertexFetch order.
+// Freed with DistortionMeshDestroy like the uniform mesh.
+void DistortionMeshCreateAdaptive ( DistortionMeshVertexData **ppVertices, uint16_t **ppTriangleListIndices,
+                                    int *pNumVertices, int *pNumTriangles,
+                                    bool rightEye,
+                                    const HmdRenderInfo &hmdRenderInfo, 
+                                    const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC,
+                                    float maxUVError, int gridSizeLog2 = 6, int numThreads = 0,
+                                    DistortionMeshInverse inverse = DistortionMeshInverse_Newton );
 
 void DistortionMeshDestroy ( DistortionMeshVertexData *pVertices, uint16_t *pTriangleMeshIndices );
 
+struct DistortionMeshError
+{
+    float       MaxUVError;
+    float       RmsUVError;
+    int         NumPixels;      // Pixels of the eye's viewport covered by the mesh.
+};
+
+// Rasterizes the mesh on the CPU at the eye's pixel resolution and compares the
+// interpolated tan angles against the exact distortion at every pixel centre.
+// Errors are the worst of the three colour channels, in rendertarget UV units.
+DistortionMeshError DistortionMeshMeasureError ( const DistortionMeshVertexData *pVertices, const uint16_t *pTriangleListIndices,
+                                                 int numTriangles, bool rightEye,
+                                                 const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC,
+                                                 Sizei eyePixels );
+
+#ifdef OVR_DISTORTION_MESH_TEST
+// Logs vertex counts and measured error of the uniform and adaptive meshes for
+// both eyes of the debug DK1 and DK2, at the lattice points and at every pixel.
+// Returns false if the adaptive mesh misses a lattice point it draws by more than maxUVError.
+bool DistortionMeshLogErrorReport ( float maxUVError );
+
+// Logs the average cache miss ratio (transforms per triangle) and average transform to
+// vertex ratio of the distortion and heightmap grids in each GridMeshOrder, and of an
+// adaptive DK2 mesh before and after OptimizeVertexCache, through a FIFO of cacheSize.
+void DistortionMeshLogVertexCacheReport ( int cacheSize = VertexCacheDefaultSize );
+
+// Times DistortionMeshCreateBothEyes for the debug DK2 on 1 up to maxThreads threads (0 for one
+// per CPU), checks each thread count builds the same meshes as one thread, and logs the speedups.
+void DistortionMeshLogThreadScalingReport ( int maxThreads = 0 );
+#endif
+
 
 //-----------------------------------------------------------------------------------
 // *****  Heightmap Mesh Rendering
@@ -12,6 +12,8 @@
 
 #include <stdio.h>  // XXX mattebb for testing, printf
 
+#include "ofxOculusDK2Simd.h"
+
 //#define SDK_RENDER 1
 
 #define GLSL(version, shader)  "#version " #version "\n#extension GL_ARB_texture_rectangle : enable\n" #shader
@@ -127,11 +129,98 @@ ovrVector3f toOVR(const ofVec3f& v ){
 	return ov;
 }
 
+//projects a point the way ofVec3f * ofMatrix4x4 does, including the divide by w
+static inline void projectPoint(const float* m, float x, float y, float z, float& ox, float& oy, float& oz){
+	float d = 1.0f / (m[3]*x + m[7]*y + m[11]*z + m[15]);
+	ox = (m[0]*x + m[4]*y + m[ 8]*z + m[12]) * d;
+	oy = (m[1]*x + m[5]*y + m[ 9]*z + m[13]) * d;
+	oz = (m[2]*x + m[6]*y + m[10]*z + m[14]) * d;
+}
+
+//projects count points through one view projection matrix, or the average of
+//two when mB is set, and maps the result into viewport pixels like
+//ofCamera::worldToScreen
+static void projectToViewport(const ofVec3f* in, ofVec3f* out, size_t count,
+							  const ofMatrix4x4& matA, const ofMatrix4x4* matB, const ofRectangle& viewport){
+	const float* mA = matA.getPtr();
+	const float* mB = matB != NULL ? matB->getPtr() : NULL;
+	const float halfW = viewport.width * 0.5f;
+	const float halfH = viewport.height * 0.5f;
+	size_t i = 0;
+
+#if OFX_OCULUS_SIMD
+	float4 a[16], b[16];
+	for(int k = 0; k < 16; k++){
+		a[k] = splat4(mA[k]);
+		b[k] = splat4(mB != NULL ? mB[k] : 0.0f);
+	}
+	const float4 half = splat4(0.5f);
+	const float4 scaleX = splat4(halfW), offsetX = splat4(halfW + viewport.x);
+	const float4 scaleY = splat4(-halfH), offsetY = splat4(halfH + viewport.y);
+	float sx[4], sy[4], sz[4];
+
+	for(; i + 4 <= count; i += 4){
+		const ofVec3f* p = in + i;
+		float4 x = set4(p[0].x, p[1].x, p[2].x, p[3].x);
+		float4 y = set4(p[0].y, p[1].y, p[2].y, p[3].y);
+		float4 z = set4(p[0].z, p[1].z, p[2].z, p[3].z);
+
+		float4 d = rcp4(add4(add4(mul4(a[3], x), mul4(a[7], y)), add4(mul4(a[11], z), a[15])));
+		float4 cx = mul4(add4(add4(mul4(a[0], x), mul4(a[4], y)), add4(mul4(a[ 8], z), a[12])), d);
+		float4 cy = mul4(add4(add4(mul4(a[1], x), mul4(a[5], y)), add4(mul4(a[ 9], z), a[13])), d);
+		float4 cz = mul4(add4(add4(mul4(a[2], x), mul4(a[6], y)), add4(mul4(a[10], z), a[14])), d);
+
+		if(mB != NULL){
+			d = rcp4(add4(add4(mul4(b[3], x), mul4(b[7], y)), add4(mul4(b[11], z), b[15])));
+			cx = mul4(add4(cx, mul4(add4(add4(mul4(b[0], x), mul4(b[4], y)), add4(mul4(b[ 8], z), b[12])), d)), half);
+			cy = mul4(add4(cy, mul4(add4(add4(mul4(b[1], x), mul4(b[5], y)), add4(mul4(b[ 9], z), b[13])), d)), half);
+			cz = mul4(add4(cz, mul4(add4(add4(mul4(b[2], x), mul4(b[6], y)), add4(mul4(b[10], z), b[14])), d)), half);
+		}
+
+		// (x + 1) / 2 * w + vx  and  (1 - y) / 2 * h + vy
+		store4(sx, add4(mul4(cx, scaleX), offsetX));
+		store4(sy, add4(mul4(cy, scaleY), offsetY));
+		store4(sz, cz);
+		for(int k = 0; k < 4; k++){
+			out[i+k].set(sx[k], sy[k], sz[k]);
+		}
+	}
+#endif
+
+	for(; i < count; i++){
+		float cx, cy, cz;
+		projectPoint(mA, in[i].x, in[i].y, in[i].z, cx, cy, cz);
+		if(mB != NULL){
+			float bx, by, bz;
+			projectPoint(mB, in[i].x, in[i].y, in[i].z, bx, by, bz);
+			cx = (cx + bx) * 0.5f;
+			cy = (cy + by) * 0.5f;
+			cz = (cz + bz) * 0.5f;
+		}
+		out[i].set((cx + 1.0f) * halfW + viewport.x,
+				   (1.0f - cy) * halfH + viewport.y,
+				   cz);
+	}
+}
+
 ofxOculusDK2::ofxOculusDK2(){
     hmd = 0;
     insideFrame = false;
     frameIndex = 0;
 
+    renderScale = 1.0;
+    allocatedRenderScale = 1.0;
+    bDynamicResolution = false;
+    frameStartSeconds = 0;
+
+    bPoseLatched = false;
+    poseFrameNum = 0;
+    poseTraceRecorder = NULL;
+    bSimulatedTracking = false;
+    bSimulatedSensorNoise = false;
+    trackingQueries = 0;
+    trackingQueriesLastFrame = 0;
+
     bUsingDebugHmd = false;
     startTrackingCaps = 0;
     
@@ -144,9 +233,12 @@ ofxOculusDK2::ofxOculusDK2(){
 	bSetup = false;
 	lockView = false;
 	bUsePredictedOrientation = true;
-	bUseOverlay = false;
 	bUseBackground = false;
-	overlayZDistance = -200;
+	defaultOverlayLayer = -1;
+	currentOverlayLayer = -1;
+	bDistortionHalfFloats = false;
+	distortionMeshMaxError = 0;
+	bHiddenAreaMask = false;
 	oculusScreenSpaceScale = 2;
 	applyTranslation = true;
 }
@@ -158,6 +250,13 @@ ofxOculusDK2::~ofxOculusDK2(){
             ovrHmd_Destroy(hmd);
             hmd = 0;
         }
+        posePredictor.Clear();
+        delete poseTraceRecorder;
+        poseTraceRecorder = NULL;
+        if (simulatedTracking) {
+            simulatedTracking->Stop();
+            simulatedTracking.Clear();
+        }
         
         ovr_Shutdown();
         
@@ -203,6 +302,9 @@ bool ofxOculusDK2::setup(ofFbo::Settings& render_settings){
             ofLogNotice("ofxOculusDK2::setup") << "HMD not found, creating simulated device.";
             printf("simulated hmd->resolution %d %d \n", hmd->Resolution.w, hmd->Resolution.h);
             bUsingDebugHmd = true;
+            if (bSimulatedTracking) {
+                startSimulatedTracking();
+            }
         }
 	}
     
@@ -225,8 +327,12 @@ bool ofxOculusDK2::setup(ofFbo::Settings& render_settings){
 	eyeFov[0] = hmd->DefaultEyeFov[0];
 	eyeFov[1] = hmd->DefaultEyeFov[1];
     
-    Sizei recommenedTex0Size = ovrHmd_GetFovTextureSize(hmd, ovrEye_Left, eyeFov[0], 1.0f);
-	Sizei recommenedTex1Size = ovrHmd_GetFovTextureSize(hmd, ovrEye_Right, eyeFov[1], 1.0f);
+	// over allocate when dynamic resolution is allowed to go above the recommended size
+	allocatedRenderScale = MAX(resolutionController.getMaxScale(), 1.0f);
+	renderScale = allocatedRenderScale;
+
+    Sizei recommenedTex0Size = ovrHmd_GetFovTextureSize(hmd, ovrEye_Left, eyeFov[0], allocatedRenderScale);
+	Sizei recommenedTex1Size = ovrHmd_GetFovTextureSize(hmd, ovrEye_Right, eyeFov[1], allocatedRenderScale);
     
 	renderTargetSize.w = recommenedTex0Size.w + recommenedTex1Size.w;
 	renderTargetSize.h = max ( recommenedTex0Size.h, recommenedTex1Size.h );
@@ -247,10 +353,17 @@ bool ofxOculusDK2::setup(ofFbo::Settings& render_settings){
     hmdToEyeViewOffsets[0] = eyeRenderDesc[0].HmdToEyeViewOffset;
     hmdToEyeViewOffsets[1] = eyeRenderDesc[1].HmdToEyeViewOffset;
 
+	//the eye fov never changes after setup, so neither does the projection
+	eyeProjectionMatrix[0] = toOf(ovrMatrix4f_Projection(eyeRenderDesc[0].Fov, .01f, 10000.0f, true));
+	eyeProjectionMatrix[1] = toOf(ovrMatrix4f_Projection(eyeRenderDesc[1].Fov, .01f, 10000.0f, true));
+	setupCombinedFrustum();
+
 	eyeRenderViewport[0].Pos  = Vector2i(0,0);
     eyeRenderViewport[0].Size = Sizei(renderTargetSize.w / 2, renderTargetSize.h);
     eyeRenderViewport[1].Pos  = Vector2i((renderTargetSize.w + 1) / 2, 0);
     eyeRenderViewport[1].Size = eyeRenderViewport[0].Size;
+    eyeFullViewport[0] = eyeRenderViewport[0];
+    eyeFullViewport[1] = eyeRenderViewport[1];
 
     unsigned int distortionCaps = ovrDistortionCap_Chromatic | ovrDistortionCap_TimeWarp | ovrDistortionCap_Vignette | ovrDistortionCap_Overdrive | ovrDistortionCap_SRGB;
     
@@ -297,54 +410,79 @@ bool ofxOculusDK2::setup(ofFbo::Settings& render_settings){
     
     // END mattebb SDK rendering test
 #else
-	//Generate distortion mesh for each eye
+	//Generate distortion mesh for each eye, or load it from the last run
+	unsigned long long meshStart = ofGetElapsedTimeMicros();
+	unsigned long long meshKey[2];
+	bool meshLoaded[2];
 	for ( int eyeNum = 0; eyeNum < 2; eyeNum++ ){
-		// Allocate & generate distortion mesh vertices.
-		ovrDistortionMesh meshData;
-
-		ovrHmd_CreateDistortionMesh(hmd, eyeRenderDesc[eyeNum].Eye, eyeRenderDesc[eyeNum].Fov, distortionCaps, &meshData);
 		ovrHmd_GetRenderScaleAndOffset(eyeRenderDesc[eyeNum].Fov, renderTargetSize, eyeRenderViewport[eyeNum], UVScaleOffset[eyeNum]);
 
-		// Now parse the vertex data and create a render ready vertex buffer from it
-		ofVboMesh& v = eyeMesh[eyeNum];
-		v.clear();
-		v.getVertices().resize(meshData.VertexCount);
-		v.getColors().resize(meshData.VertexCount);
-		v.getNormals().resize(meshData.VertexCount);
-//		v.getTexCoords().resize(meshData.VertexCount);
-		ovrDistortionVertex * ov = meshData.pVertexData;
-		for( unsigned vertNum = 0; vertNum < meshData.VertexCount; vertNum++ ){
-			
-			v.getVertices()[vertNum].x = ov->ScreenPosNDC.x;
-			v.getVertices()[vertNum].y = ov->ScreenPosNDC.y;
-			//cout << vertNum<< "/" << meshData.VertexCount << "SCREEN POS IS " << ov->ScreenPosNDC.x << " " <<  ov->ScreenPosNDC.y << endl;
-			v.getVertices()[vertNum].z = ov->TimeWarpFactor;
-
-			v.getNormals()[vertNum].x = ov->TanEyeAnglesR.x;
-			v.getNormals()[vertNum].y = ov->TanEyeAnglesR.y;
-			v.getNormals()[vertNum].z = ov->VignetteFactor;
-
-			v.getColors()[vertNum].r = ov->TanEyeAnglesG.x;
-			v.getColors()[vertNum].g = ov->TanEyeAnglesG.y;
-			v.getColors()[vertNum].b = ov->TanEyeAnglesB.x;
-			v.getColors()[vertNum].a = ov->TanEyeAnglesB.y;
-			
-			ov++;
-		}
+		meshKey[eyeNum] = ofxOculusDK2MeshCache::makeKey(hmd, eyeRenderDesc[eyeNum].Eye, eyeRenderDesc[eyeNum].Fov, distortionCaps, distortionMeshMaxError);
+		meshLoaded[eyeNum] = meshCache.load(eyeRenderDesc[eyeNum].Eye, meshKey[eyeNum], bDistortionHalfFloats, eyeMesh[eyeNum]);
+	}
 
-		//Register this mesh with the renderer
-		v.getIndices().resize(meshData.IndexCount);
+	// Allocate & generate distortion mesh vertices. When both eyes are needed
+	// the sdk builds them together, spread over all cores
+	ovrDistortionMesh meshData[2];
+	memset(meshData, 0, sizeof(meshData));
+	if(distortionMeshMaxError > 0){
+		for ( int eyeNum = 0; eyeNum < 2; eyeNum++ ){
+			if(!meshLoaded[eyeNum]){
+				ovrHmd_CreateDistortionMeshAdaptive(hmd, eyeRenderDesc[eyeNum].Eye, eyeRenderDesc[eyeNum].Fov, distortionCaps, distortionMeshMaxError, &meshData[eyeNum]);
+			}
+		}
+	}
+	else if(!meshLoaded[0] && !meshLoaded[1]){
+		ovrFovPort meshFov[2] = { eyeRenderDesc[0].Fov, eyeRenderDesc[1].Fov };
+		ovrHmd_CreateDistortionMeshes(hmd, meshFov, distortionCaps, meshData);
+	}
+	else{
+		for ( int eyeNum = 0; eyeNum < 2; eyeNum++ ){
+			if(!meshLoaded[eyeNum]){
+				ovrHmd_CreateDistortionMesh(hmd, eyeRenderDesc[eyeNum].Eye, eyeRenderDesc[eyeNum].Fov, distortionCaps, &meshData[eyeNum]);
+			}
+		}
+	}
 
-		unsigned short * oi = meshData.pIndexData;
-		for(int i = 0; i < meshData.IndexCount; i++){
-			v.getIndices()[i] = *oi;
-			oi++;
+	for ( int eyeNum = 0; eyeNum < 2; eyeNum++ ){
+		if(meshLoaded[eyeNum]){
+			continue;
 		}
 
-		ovrHmd_DestroyDistortionMesh( &meshData );
+		// Repack into a render ready vertex buffer, keeping the 16 bit indices
+		ofxOculusDK2DistortionMesh& v = eyeMesh[eyeNum];
+		v.setup(meshData[eyeNum], bDistortionHalfFloats);
+
+		ovrHmd_DestroyDistortionMesh( &meshData[eyeNum] );
+
+		meshCache.save(eyeRenderDesc[eyeNum].Eye, meshKey[eyeNum], v);
+	}
+	ofLogVerbose("ofxOculusDK2::setup") << "distortion meshes ready in " << (ofGetElapsedTimeMicros() - meshStart) / 1000.0
+		<< " ms, " << meshCache.getHits() << " of 2 from the cache";
+
+	// Vertices come in the eye viewport's NDC and go at the near plane
+	for ( int eyeNum = 0; eyeNum < 2; eyeNum++ ){
+		hiddenAreaMesh[eyeNum].clear();
+		ovrHiddenAreaMesh hiddenData;
+		memset(&hiddenData, 0, sizeof(hiddenData));
+		if(!ovrHmd_CreateHiddenAreaMesh(hmd, eyeRenderDesc[eyeNum].Eye, eyeRenderDesc[eyeNum].Fov, &hiddenData)){
+			ofLogWarning("ofxOculusDK2::setup") << "Could not create the hidden area mesh";
+			continue;
+		}
+		for(unsigned int i = 0; i < hiddenData.VertexCount; i++){
+			hiddenAreaMesh[eyeNum].addVertex(ofVec3f(hiddenData.pVertexData[i].x, hiddenData.pVertexData[i].y, -1));
+		}
+		for(unsigned int i = 0; i < hiddenData.IndexCount; i++){
+			hiddenAreaMesh[eyeNum].addIndex(hiddenData.pIndexData[i]);
+		}
+		ovrHmd_DestroyHiddenAreaMesh(&hiddenData);
 	}
     
     reloadShader();
+
+	if(bDynamicResolution){
+		applyRenderScale(resolutionController.getScale());
+	}
     
 #endif
 
@@ -364,10 +502,127 @@ void ofxOculusDK2::reset(){
 	}
 }
 
+void ofxOculusDK2::latchPose(){
+	if(!bSetup) return;
+
+	//a snapshot from an earlier app frame expires even if draw() never released it
+	if(bPoseLatched && poseFrameNum != ofGetFrameNum()){
+		releasePose();
+	}
+	if(bPoseLatched) return;
+
+	trackingState = ovrHmd_GetTrackingState(hmd, ovr_GetTimeInSeconds());
+	trackingQueries++;
+	poseFrameNum = ofGetFrameNum();
+	bPoseLatched = true;
+
+	if(poseTraceRecorder){
+		OVR::CAPI::HMDState* hmds = (OVR::CAPI::HMDState*)hmd->Handle;
+		poseTraceRecorder->Update(hmds->SharedStateReader.Get(), hmds->SharedPoseHistoryReader.Get());
+	}
+}
+
+void ofxOculusDK2::releasePose(){
+	bPoseLatched = false;
+	trackingQueriesLastFrame = trackingQueries;
+	trackingQueries = 0;
+}
+
+const ovrTrackingState& ofxOculusDK2::getTrackingState(){
+	//first query of the frame samples the sensor, the rest reuse the snapshot
+	latchPose();
+	return trackingState;
+}
+
+unsigned int ofxOculusDK2::getTrackingQueriesLastFrame(){
+	return trackingQueriesLastFrame;
+}
+
+void ofxOculusDK2::setPosePredictor(OVR::Tracking::PosePredictor* predictor){
+	if(!bSetup){
+		ofLogError("ofxOculusDK2::setPosePredictor") << "Call setup() first";
+		return;
+	}
+	posePredictor = predictor;
+	((OVR::CAPI::HMDState*)hmd->Handle)->TheSensorStateReader.SetPredictor(predictor);
+}
+
+void ofxOculusDK2::startRecordingPoseTrace(){
+	if(!bSetup){
+		ofLogError("ofxOculusDK2::startRecordingPoseTrace") << "Call setup() first";
+		return;
+	}
+	if(!poseTraceRecorder){
+		poseTraceRecorder = new OVR::Tracking::PoseTraceRecorder();
+	}
+	poseTraceRecorder->Clear();
+}
+
+void ofxOculusDK2::setSimulatedTracking(bool enabled, string tracePath, bool sensorNoise){
+	if(bSetup){
+		ofLogError("ofxOculusDK2::setSimulatedTracking") << "Call before setup()";
+		return;
+	}
+	bSimulatedTracking = enabled;
+	simulatedTracePath = tracePath;
+	bSimulatedSensorNoise = sensorNoise;
+}
+
+bool ofxOculusDK2::isTrackingSimulated(){
+	return simulatedTracking != NULL;
+}
+
+void ofxOculusDK2::startSimulatedTracking(){
+	simulatedTracking = *new OVR::Tracking::SimulatedTrackingService();
+	if(simulatedTracePath != ""){
+		string path = ofToDataPath(simulatedTracePath, true);
+		OVR::Array< OVR::PoseState<double> > trace;
+		if(OVR::Tracking::LoadPoseTrace(path.c_str(), trace) && trace.GetSize() > 0){
+			simulatedTracking->SetTrace(&trace[0], (int)trace.GetSize());
+		}
+		else{
+			ofLogWarning("ofxOculusDK2::setup") << "Could not read " << path << ", simulating scripted motion";
+		}
+	}
+	simulatedTracking->SetSensorNoise(bSimulatedSensorNoise);
+
+	//the debug hmd reads the simulation the way a real one reads the tracking service
+	HMDState* hmds = (HMDState*)hmd->Handle;
+	if(!simulatedTracking->Open() || !simulatedTracking->Start() ||
+	   !hmds->AttachSharedState(simulatedTracking->GetSharedMemoryName())){
+		ofLogError("ofxOculusDK2::setup") << "Could not start simulated tracking";
+		if(simulatedTracking->GetThreadState() != OVR::Thread::NotRunning){
+			simulatedTracking->Stop();
+		}
+		simulatedTracking.Clear();
+		return;
+	}
+	ofLogNotice("ofxOculusDK2::setup") << "Simulating head tracking as " << simulatedTracking->GetSharedMemoryName();
+}
+
+bool ofxOculusDK2::stopRecordingPoseTrace(string path){
+	if(!poseTraceRecorder || poseTraceRecorder->Trace.GetSize() == 0){
+		ofLogWarning("ofxOculusDK2::stopRecordingPoseTrace") << "Nothing was recorded";
+		delete poseTraceRecorder;
+		poseTraceRecorder = NULL;
+		return false;
+	}
+	path = ofToDataPath(path, true);
+	bool ok = OVR::Tracking::SavePoseTrace(path.c_str(), &poseTraceRecorder->Trace[0], (int)poseTraceRecorder->Trace.GetSize());
+	if(!ok){
+		ofLogError("ofxOculusDK2::stopRecordingPoseTrace") << "Could not write " << path;
+	}
+	delete poseTraceRecorder;
+	poseTraceRecorder = NULL;
+	return ok;
+}
+
 ofQuaternion ofxOculusDK2::getOrientationQuat(){
 //	return toOf(pFusionResult->GetPredictedOrientation());
 
-	ovrTrackingState ts = ovrHmd_GetTrackingState(hmd, ovr_GetTimeInSeconds());
+	if(!bSetup) return ofQuaternion();
+
+	const ovrTrackingState& ts = getTrackingState();
 	if (ts.StatusFlags & (ovrStatus_OrientationTracked | ovrStatus_PositionTracked)){
 		return toOf(ts.HeadPose.ThePose.Orientation);
 	}
@@ -375,12 +630,16 @@ ofQuaternion ofxOculusDK2::getOrientationQuat(){
 }
 
 ofMatrix4x4 ofxOculusDK2::getProjectionMatrix(ovrEyeType eye) {
-    return toOf(ovrMatrix4f_Projection(eyeRenderDesc[eye].Fov, .01f, 10000.0f, true) );
+    return eyeProjectionMatrix[eye];
 }
 
 ofMatrix4x4 ofxOculusDK2::getViewMatrix(ovrEyeType eye) {
 
-    ofMatrix4x4 baseCameraMatrix = baseCamera->getModelViewMatrix();
+    // without a base camera the head pose is relative to the origin
+    ofMatrix4x4 baseCameraMatrix;
+    if(baseCamera != NULL){
+        baseCameraMatrix = baseCamera->getModelViewMatrix();
+    }
 
     // head orientation and position
     ofMatrix4x4 hmdView =   ofMatrix4x4::newRotationMatrix( toOf(headPose[eye].Orientation)) * \
@@ -390,6 +649,88 @@ ofMatrix4x4 ofxOculusDK2::getViewMatrix(ovrEyeType eye) {
     return baseCameraMatrix * hmdView.getInverse();
 }
 
+void ofxOculusDK2::setupCombinedFrustum(){
+
+	// widest tangent of either eye on every side
+	ovrFovPort combinedFov;
+	combinedFov.UpTan = MAX(eyeRenderDesc[0].Fov.UpTan, eyeRenderDesc[1].Fov.UpTan);
+	combinedFov.DownTan = MAX(eyeRenderDesc[0].Fov.DownTan, eyeRenderDesc[1].Fov.DownTan);
+	combinedFov.LeftTan = MAX(eyeRenderDesc[0].Fov.LeftTan, eyeRenderDesc[1].Fov.LeftTan);
+	combinedFov.RightTan = MAX(eyeRenderDesc[0].Fov.RightTan, eyeRenderDesc[1].Fov.RightTan);
+
+	// pull the apex back from the center eye until each eye's side planes lie
+	// inside the combined ones. eye positions are the negated view offsets
+	Vector3f center = -(Vector3f(hmdToEyeViewOffsets[0]) + Vector3f(hmdToEyeViewOffsets[1])) * 0.5f;
+	combinedEyeBack = 0;
+	float depth = 0;
+	for(int eye = 0; eye < 2; eye++){
+		Vector3f rel = -Vector3f(hmdToEyeViewOffsets[eye]) - center;
+		combinedEyeBack = MAX(combinedEyeBack, MAX(-rel.x, 0.0f) / combinedFov.LeftTan);
+		combinedEyeBack = MAX(combinedEyeBack, MAX(rel.x, 0.0f) / combinedFov.RightTan);
+		combinedEyeBack = MAX(combinedEyeBack, MAX(rel.y, 0.0f) / combinedFov.UpTan);
+		combinedEyeBack = MAX(combinedEyeBack, MAX(-rel.y, 0.0f) / combinedFov.DownTan);
+		depth = MAX(depth, fabsf(rel.z));
+	}
+	combinedEyeBack += depth;
+
+	// the apex is combinedEyeBack behind the eyes, so the far plane goes out as far again
+	// to stay behind both eyes' far planes
+	combinedProjectionMatrix = toOf(ovrMatrix4f_Projection(combinedFov, .01f, 10000.0f + combinedEyeBack, true));
+}
+
+ofMatrix4x4 ofxOculusDK2::getCombinedViewMatrix(){
+
+	// midpoint of the eyes, moved back along the view direction (+z is backwards)
+	Quatf orientation = headPose[0].Orientation;
+	Vector3f position = (Vector3f(headPose[0].Position) + Vector3f(headPose[1].Position)) * 0.5f +
+						orientation.Rotate(Vector3f(0, 0, combinedEyeBack));
+
+	ofMatrix4x4 hmdView = ofMatrix4x4::newRotationMatrix( toOf(orientation)) *
+						  ofMatrix4x4::newTranslationMatrix( ofVec3f(position.x, position.y, position.z));
+
+	if(baseCamera == NULL){
+		return hmdView.getInverse();
+	}
+	return baseCamera->getModelViewMatrix() * hmdView.getInverse();
+}
+
+void ofxOculusDK2::cullSpheres(const vector<ofVec3f>& centers, const vector<float>& radii, vector<unsigned char>& visibility){
+	if(!frustumCuller.isReady()){
+		// nothing rendered yet, leave everything visible
+		visibility.assign(MIN(centers.size(), radii.size()), OFX_OCULUS_VISIBLE_LEFT | OFX_OCULUS_VISIBLE_RIGHT);
+		return;
+	}
+	frustumCuller.cullSpheres(centers, radii, visibility);
+}
+
+void ofxOculusDK2::cullBoxes(const vector<ofVec3f>& boxMin, const vector<ofVec3f>& boxMax, vector<unsigned char>& visibility){
+	if(!frustumCuller.isReady()){
+		visibility.assign(MIN(boxMin.size(), boxMax.size()), OFX_OCULUS_VISIBLE_LEFT | OFX_OCULUS_VISIBLE_RIGHT);
+		return;
+	}
+	frustumCuller.cullBoxes(boxMin, boxMax, visibility);
+}
+
+ofxOculusDK2FrustumCuller& ofxOculusDK2::getFrustumCuller(){
+	return frustumCuller;
+}
+
+void ofxOculusDK2::updateEyePoses(){
+	
+	// one prediction for both eyes, so they render from the same sample.
+	// draw() reuses headPose for the timewarp matrices
+    ovrHmd_GetEyePoses(hmd, frameIndex, hmdToEyeViewOffsets, headPose, NULL);
+	//runs its own tracking prediction, separate from the latched snapshot
+	trackingQueries++;
+
+	eyeViewMatrix[ovrEye_Left] = getViewMatrix(ovrEye_Left);
+	eyeViewMatrix[ovrEye_Right] = getViewMatrix(ovrEye_Right);
+
+	frustumCuller.setFrustum(ofxOculusDK2FrustumCuller::FRUSTUM_LEFT, eyeViewMatrix[ovrEye_Left] * eyeProjectionMatrix[ovrEye_Left]);
+	frustumCuller.setFrustum(ofxOculusDK2FrustumCuller::FRUSTUM_RIGHT, eyeViewMatrix[ovrEye_Right] * eyeProjectionMatrix[ovrEye_Right]);
+	frustumCuller.setFrustum(ofxOculusDK2FrustumCuller::FRUSTUM_COMBINED, getCombinedViewMatrix() * combinedProjectionMatrix);
+}
+
 void ofxOculusDK2::setupEyeParams(ovrEyeType eye){
 	
 	if(bUseBackground){
@@ -399,26 +740,122 @@ void ofxOculusDK2::setupEyeParams(ovrEyeType eye){
 		backgroundTarget.getTextureReference().draw(toOf(eyeRenderViewport[eye]));
 		glPopAttrib();
 	}
-    
-    // xxx mattebb
-    ovrHmd_GetEyePoses(hmd, frameIndex, hmdToEyeViewOffsets, headPose, NULL);
+
 
     //cout << "viewport" << toOf(eyeRenderViewport[eye]) << endl;
 	ofViewport(toOf(eyeRenderViewport[eye]));
 
+	if(bHiddenAreaMask){
+		drawHiddenAreaMask(eye);
+	}
+
 	ofSetMatrixMode(OF_MATRIX_PROJECTION);
 	ofLoadIdentityMatrix();
-	ofLoadMatrix( getProjectionMatrix(eye) );
+	ofLoadMatrix( eyeProjectionMatrix[eye] );
     
 	ofSetMatrixMode(OF_MATRIX_MODELVIEW);
 	ofLoadIdentityMatrix();
-    ofLoadMatrix( getViewMatrix(eye) );
+    ofLoadMatrix( eyeViewMatrix[eye] );
+}
+
+void ofxOculusDK2::drawHiddenAreaMask(ovrEyeType eye){
+	if(hiddenAreaMesh[eye].getNumIndices() == 0){
+		return;
+	}
+
+	// The mesh is loaded the same way as the eye projection, so it lands on
+	// the same pixels whatever the fbo orientation
+	ofSetMatrixMode(OF_MATRIX_PROJECTION);
+	ofLoadIdentityMatrix();
+	ofSetMatrixMode(OF_MATRIX_MODELVIEW);
+	ofLoadIdentityMatrix();
+
+	// Depth only, at the near plane, so every depth tested fragment behind it fails
+	GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+	GLint depthFunc;
+	glGetIntegerv(GL_DEPTH_FUNC, &depthFunc);
+	glEnable(GL_DEPTH_TEST);
+	glDepthFunc(GL_ALWAYS);
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	hiddenAreaMesh[eye].draw();
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glDepthFunc(depthFunc);
+	if(!depthTest){
+		glDisable(GL_DEPTH_TEST);
+	}
 }
 
 ofRectangle ofxOculusDK2::getOculusViewport(){
 //	OVR::Util::Render::StereoEyeParams eyeRenderParams = stereo.GetEyeRenderParams( OVR::Util::Render::StereoEye_Left );
 //	return toOf(eyeRenderParams.VP);
-    return toOf(eyeRenderViewport[0]);
+    return toOf(eyeFullViewport[0]);
+}
+
+void ofxOculusDK2::setDynamicResolution(bool enabled){
+	bDynamicResolution = enabled;
+	if(!bSetup) return;
+
+	resolutionController.reset();
+	applyRenderScale(bDynamicResolution ? resolutionController.getScale() : allocatedRenderScale);
+}
+
+bool ofxOculusDK2::getDynamicResolution(){
+	return bDynamicResolution;
+}
+
+ofxOculusDK2ResolutionController& ofxOculusDK2::getResolutionController(){
+	return resolutionController;
+}
+
+float ofxOculusDK2::getRenderScale(){
+	return renderScale;
+}
+
+ofxOculusDK2MeshCache& ofxOculusDK2::getDistortionMeshCache(){
+	return meshCache;
+}
+
+void ofxOculusDK2::setDistortionHalfFloats(bool halfFloats){
+	if(bSetup){
+		ofLogWarning("ofxOculusDK2::setDistortionHalfFloats") << "Only takes effect before setup()";
+	}
+	bDistortionHalfFloats = halfFloats;
+}
+
+bool ofxOculusDK2::getDistortionHalfFloats(){
+	return bDistortionHalfFloats;
+}
+
+void ofxOculusDK2::setDistortionMeshMaxError(float maxUVError){
+	if(bSetup){
+		ofLogWarning("ofxOculusDK2::setDistortionMeshMaxError") << "Only takes effect before setup()";
+	}
+	distortionMeshMaxError = MAX(maxUVError, 0.0f);
+}
+
+float ofxOculusDK2::getDistortionMeshMaxError(){
+	return distortionMeshMaxError;
+}
+
+void ofxOculusDK2::setHiddenAreaMask(bool enabled){
+	bHiddenAreaMask = enabled;
+}
+
+bool ofxOculusDK2::getHiddenAreaMask(){
+	return bHiddenAreaMask;
+}
+
+void ofxOculusDK2::applyRenderScale(float scale){
+	renderScale = ofClamp(scale, 0.1f, allocatedRenderScale);
+	float fraction = renderScale / allocatedRenderScale;
+
+	for(int eye = 0; eye < 2; eye++){
+		// viewport keeps its corner, only the size shrinks inside the full buffer
+		eyeRenderViewport[eye].Pos = eyeFullViewport[eye].Pos;
+		eyeRenderViewport[eye].Size = Sizei(MAX(1, (int)(eyeFullViewport[eye].Size.w * fraction + 0.5f)),
+											MAX(1, (int)(eyeFullViewport[eye].Size.h * fraction + 0.5f)));
+		ovrHmd_GetRenderScaleAndOffset(eyeRenderDesc[eye].Fov, renderTargetSize, eyeRenderViewport[eye], UVScaleOffset[eye]);
+	}
 }
 
 void ofxOculusDK2::reloadShader(){
@@ -470,38 +907,107 @@ void ofxOculusDK2::endBackground(){
 }
 
 void ofxOculusDK2::beginOverlay(float overlayZ, float scale,  float width, float height){
-	bUseOverlay = true;
-	overlayZDistance = overlayZ;
-	
-	if((int)overlayTarget.getWidth() != (int)width || (int)overlayTarget.getHeight() != (int)height){
-		overlayTarget.allocate(width, height, GL_RGBA);
+	// the single overlay is a layer like any other, shown for the frame it is drawn in
+	if(defaultOverlayLayer == -1){
+		defaultOverlayLayer = overlayLayers.addLayer(width, height, overlayZ, scale);
 	}
-	
-	overlayMesh.clear();
-	ofRectangle overlayrect = ofRectangle(-width/2*scale,-height/2*scale,width*scale,height*scale);
-	overlayMesh.addVertex( ofVec3f(overlayrect.getMinX(), overlayrect.getMinY(), overlayZ) );
-	overlayMesh.addVertex( ofVec3f(overlayrect.getMaxX(), overlayrect.getMinY(), overlayZ) );
-	overlayMesh.addVertex( ofVec3f(overlayrect.getMinX(), overlayrect.getMaxY(), overlayZ) );
-	overlayMesh.addVertex( ofVec3f(overlayrect.getMaxX(), overlayrect.getMaxY(), overlayZ) );
-
-	overlayMesh.addTexCoord( ofVec2f(0, height ) );
-	overlayMesh.addTexCoord( ofVec2f(width, height) );
-	overlayMesh.addTexCoord( ofVec2f(0,0) );
-	overlayMesh.addTexCoord( ofVec2f(width, 0) );
-	
-	overlayMesh.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
-	
-	overlayTarget.begin();
+	else{
+		overlayLayers.setSize(defaultOverlayLayer, width, height);
+		overlayLayers.setDepth(defaultOverlayLayer, overlayZ);
+		overlayLayers.setScale(defaultOverlayLayer, scale);
+		overlayLayers.setVisible(defaultOverlayLayer, true);
+	}
+
+	beginOverlayLayer(defaultOverlayLayer);
+}
+
+void ofxOculusDK2::endOverlay(){
+	endOverlayLayer();
+}
+
+int ofxOculusDK2::addOverlayLayer(float width, float height, float overlayZ, float scale){
+	return overlayLayers.addLayer(width, height, overlayZ, scale);
+}
+
+void ofxOculusDK2::removeOverlayLayer(int layer){
+	if(layer == defaultOverlayLayer){
+		defaultOverlayLayer = -1;
+	}
+	overlayLayers.removeLayer(layer);
+}
+
+void ofxOculusDK2::beginOverlayLayer(int layer){
+	if(!overlayLayers.isLayer(layer)){
+		ofLogError("ofxOculusDK2::beginOverlayLayer") << "Invalid overlay layer " << layer;
+		return;
+	}
+	currentOverlayLayer = layer;
+
+	getOverlayLayerTarget(layer).begin();
     ofClear(0.0, 0.0, 0.0, 0.0);
-	
+
+	// pooled targets can be larger than the layer, draw into the corner
+	// its texture coordinates cover
+	float width = overlayLayers.getWidth(layer);
+	float height = overlayLayers.getHeight(layer);
+	ofViewport(0, 0, width, height, false);
+	ofSetupScreenPerspective(width, height);
+
     ofPushView();
     ofPushMatrix();
 }
 
-void ofxOculusDK2::endOverlay(){
+void ofxOculusDK2::endOverlayLayer(){
+	if(currentOverlayLayer == -1) return;
+
     ofPopMatrix();
     ofPopView();
-    overlayTarget.end();
+    getOverlayLayerTarget(currentOverlayLayer).end();
+	currentOverlayLayer = -1;
+}
+
+ofFbo& ofxOculusDK2::getOverlayLayerTarget(int layer){
+	return getOverlaySlotTarget(overlayLayers.getSlot(layer));
+}
+
+ofxOculusDK2OverlayLayers& ofxOculusDK2::getOverlayLayers(){
+	return overlayLayers;
+}
+
+ofRectangle ofxOculusDK2::getOverlayRectangle(){
+	if(defaultOverlayLayer == -1){
+		return ofRectangle();
+	}
+	return ofRectangle(0,0,
+					   overlayLayers.getWidth(defaultOverlayLayer),
+					   overlayLayers.getHeight(defaultOverlayLayer));
+}
+
+ofFbo& ofxOculusDK2::getOverlayTarget(){
+	if(defaultOverlayLayer == -1){
+		defaultOverlayLayer = overlayLayers.addLayer(256, 256);
+		overlayLayers.setVisible(defaultOverlayLayer, false);
+	}
+	return getOverlayLayerTarget(defaultOverlayLayer);
+}
+
+ofFbo& ofxOculusDK2::getOverlaySlotTarget(int slot){
+	static ofFbo invalidTarget;
+	if(slot < 0){
+		return invalidTarget;
+	}
+
+	while((int)overlayTargets.size() <= slot){
+		overlayTargets.push_back(ofPtr<ofFbo>(new ofFbo()));
+	}
+
+	// a slot's bucket size never changes, so this only allocates once
+	const ofxOculusDK2OverlayLayers::Slot& size = overlayLayers.getSlots()[slot];
+	ofFbo& target = *overlayTargets[slot];
+	if(!target.isAllocated()){
+		target.allocate(size.width, size.height, GL_RGBA);
+	}
+	return target;
 }
 
 void ofxOculusDK2::beginLeftEye(){
@@ -515,6 +1021,11 @@ void ofxOculusDK2::beginLeftEye(){
 #endif
     
 	insideFrame = true;
+	frameStartSeconds = ovr_GetTimeInSeconds();
+
+	//keeps the snapshot if update() already latched one this frame
+	latchPose();
+	updateEyePoses();
 
 	renderTarget.begin();
 	ofClear(0,0,255);
@@ -529,9 +1040,7 @@ void ofxOculusDK2::beginLeftEye(){
 void ofxOculusDK2::endLeftEye(){
 	if(!bSetup) return;
 	
-	if(bUseOverlay){
-		renderOverlay();
-	}
+	renderOverlay();
 	
 	ofPopMatrix();
 	ofPopView();
@@ -549,26 +1058,45 @@ void ofxOculusDK2::beginRightEye(){
 void ofxOculusDK2::endRightEye(){
 	if(!bSetup) return;
 
-	if(bUseOverlay){
-		renderOverlay();
-	}
+	renderOverlay();
 
 	ofPopMatrix();
 	ofPopView();
 	renderTarget.end();	
 }
 
+void ofxOculusDK2::drawStereo(ofxOculusDK2DrawList& drawList){
+	if(!bSetup) return;
+
+	beginLeftEye();
+	drawList.replay(drawListBackend, eyeViewMatrix[ovrEye_Left], eyeProjectionMatrix[ovrEye_Left], OFX_OCULUS_VISIBLE_LEFT);
+	endLeftEye();
+
+	beginRightEye();
+	drawList.replay(drawListBackend, eyeViewMatrix[ovrEye_Right], eyeProjectionMatrix[ovrEye_Right], OFX_OCULUS_VISIBLE_RIGHT);
+	endRightEye();
+}
+
 void ofxOculusDK2::renderOverlay(){
 
-	// cout << "renering overlay!" << endl;
-	
+	// only dirty layers get new quads, the second eye finds nothing to do
+	overlayLayers.update();
+	const vector<int>& layers = overlayLayers.getDrawOrder();
+	if(layers.empty()){
+		return;
+	}
+
 	ofPushStyle();
 	ofPushMatrix();
-	glPushAttrib(GL_ALL_ATTRIB_BITS);
-	glDisable(GL_LIGHTING);
+
+	// save just the state we change instead of the whole attribute stack
+	bool depthTestWasEnabled = glIsEnabled(GL_DEPTH_TEST);
+	bool lightingWasEnabled = !ofIsGLProgrammableRenderer() && glIsEnabled(GL_LIGHTING);
+	if(lightingWasEnabled){
+		glDisable(GL_LIGHTING);
+	}
 	ofDisableDepthTest();
 
-	
 	if(baseCamera != NULL){
 		ofTranslate(baseCamera->getPosition());
 		ofMatrix4x4 baseRotation;
@@ -582,11 +1110,19 @@ void ofxOculusDK2::renderOverlay(){
 	}
 	
 	ofEnableAlphaBlending();
-	overlayTarget.getTextureReference().bind();
-	overlayMesh.draw();
-	overlayTarget.getTextureReference().unbind();
-	
-	glPopAttrib();
+	for(size_t i = 0; i < layers.size(); i++){
+		ofTexture& texture = getOverlayLayerTarget(layers[i]).getTextureReference();
+		texture.bind();
+		overlayLayers.getMesh(layers[i]).draw();
+		texture.unbind();
+	}
+
+	if(lightingWasEnabled){
+		glEnable(GL_LIGHTING);
+	}
+	if(depthTestWasEnabled){
+		ofEnableDepthTest();
+	}
 	ofPopMatrix();
 	ofPopStyle();
 
@@ -607,8 +1143,8 @@ ofVec3f ofxOculusDK2::worldToScreen(ofVec3f worldPosition, bool considerHeadOrie
         // We'll combine both left and right eye projections to get a midpoint.
 
 
-        ofMatrix4x4 projectionMatrixLeft = toOf(ovrMatrix4f_Projection(eyeRenderDesc[ovrEye_Left].Fov, 0.01f, 10000.0f, true));
-        ofMatrix4x4 projectionMatrixRight = toOf(ovrMatrix4f_Projection(eyeRenderDesc[ovrEye_Right].Fov, 0.01f, 10000.0f, true));
+        const ofMatrix4x4& projectionMatrixLeft = eyeProjectionMatrix[ovrEye_Left];
+        const ofMatrix4x4& projectionMatrixRight = eyeProjectionMatrix[ovrEye_Right];
         
         ofMatrix4x4 modelViewMatrix = getOrientationMat();
         modelViewMatrix = modelViewMatrix * baseCamera->getGlobalTransformMatrix();
@@ -633,7 +1169,9 @@ ofMatrix4x4 ofxOculusDK2::getOrientationMat(){
 	
 	//return toOf(Matrix4f(pFusionResult->GetPredictedOrientation()));
 	
-	ovrTrackingState ts = ovrHmd_GetTrackingState(hmd, ovr_GetTimeInSeconds());
+	if(!bSetup) return ofMatrix4x4();
+
+	const ovrTrackingState& ts = getTrackingState();
 	if (ts.StatusFlags & (ovrStatus_OrientationTracked | ovrStatus_PositionTracked)){
 		return toOf( Matrix4f(ts.HeadPose.ThePose.Orientation));
 	}
@@ -684,6 +1222,136 @@ float ofxOculusDK2::distanceFromScreenPoint(ofVec3f worldPoint, ofVec2f screenPo
 	return dist;
 }
 
+void ofxOculusDK2::worldToScreen(const vector<ofVec3f>& worldPositions, vector<ofVec3f>& screenPositions, bool considerHeadOrientation){
+
+	screenPositions.resize(worldPositions.size());
+	if(baseCamera == NULL){
+		std::fill(screenPositions.begin(), screenPositions.end(), ofVec3f(0,0,0));
+		return;
+	}
+	if(worldPositions.empty()){
+		return;
+	}
+
+	ofRectangle viewport = getOculusViewport();
+
+	if(considerHeadOrientation){
+		// same midpoint of the left and right eye projections as the single point version
+		ofMatrix4x4 modelViewMatrix = (getOrientationMat() * baseCamera->getGlobalTransformMatrix()).getInverse();
+		ofMatrix4x4 viewProjectionLeft = modelViewMatrix * eyeProjectionMatrix[ovrEye_Left];
+		ofMatrix4x4 viewProjectionRight = modelViewMatrix * eyeProjectionMatrix[ovrEye_Right];
+		projectToViewport(&worldPositions[0], &screenPositions[0], worldPositions.size(),
+						  viewProjectionLeft, &viewProjectionRight, viewport);
+	}
+	else{
+		ofMatrix4x4 viewProjection = baseCamera->getModelViewProjectionMatrix(viewport);
+		projectToViewport(&worldPositions[0], &screenPositions[0], worldPositions.size(),
+						  viewProjection, NULL, viewport);
+	}
+}
+
+void ofxOculusDK2::distanceFromGaze(const vector<ofVec3f>& worldPoints, vector<float>& distances){
+	vector<ofVec3f> screenPositions;
+	worldToScreen(worldPoints, screenPositions, true);
+
+	ofVec2f center = getOculusViewport().getCenter();
+	distances.resize(screenPositions.size());
+	for(size_t i = 0; i < screenPositions.size(); i++){
+		distances[i] = ofDist(screenPositions[i].x, screenPositions[i].y, center.x, center.y);
+	}
+}
+
+void ofxOculusDK2::distanceFromMouse(const vector<ofVec3f>& worldPoints, vector<float>& distances){
+	distanceFromScreenPoint(worldPoints, ofVec2f(ofGetMouseX(), ofGetMouseY()), distances);
+}
+
+void ofxOculusDK2::distanceFromScreenPoint(const vector<ofVec3f>& worldPoints, ofVec2f screenPoint, vector<float>& distances){
+	vector<ofVec3f> screenPositions;
+	worldToScreen(worldPoints, screenPositions);
+
+	ofVec3f cursorRiftSpace = screenToOculus2D(screenPoint);
+	distances.resize(screenPositions.size());
+	for(size_t i = 0; i < screenPositions.size(); i++){
+		distances[i] = ofDist(cursorRiftSpace.x, cursorRiftSpace.y,
+							  screenPositions[i].x, screenPositions[i].y);
+	}
+}
+
+int ofxOculusDK2::addPickableSphere(ofVec3f center, float radius){
+	return pickables.addSphere(center, radius);
+}
+
+int ofxOculusDK2::addPickableBox(ofVec3f boxMin, ofVec3f boxMax){
+	return pickables.addBox(boxMin, boxMax);
+}
+
+void ofxOculusDK2::updatePickableSphere(int id, ofVec3f center, float radius){
+	pickables.updateSphere(id, center, radius);
+}
+
+void ofxOculusDK2::updatePickableBox(int id, ofVec3f boxMin, ofVec3f boxMax){
+	pickables.updateBox(id, boxMin, boxMax);
+}
+
+void ofxOculusDK2::removePickable(int id){
+	pickables.remove(id);
+}
+
+void ofxOculusDK2::clearPickables(){
+	pickables.clear();
+}
+
+int ofxOculusDK2::pickGaze(float* hitDistance){
+	if(baseCamera == NULL){
+		return -1;
+	}
+	ofVec3f origin, direction;
+	getGazeRay(origin, direction);
+	return pickables.pick(origin, direction, hitDistance);
+}
+
+int ofxOculusDK2::pickMouse(float* hitDistance){
+	if(baseCamera == NULL){
+		return -1;
+	}
+	ofVec3f origin, direction;
+	getMouseRay(origin, direction);
+	return pickables.pick(origin, direction, hitDistance);
+}
+
+void ofxOculusDK2::getGazeRay(ofVec3f& origin, ofVec3f& direction){
+	if(baseCamera == NULL){
+		origin.set(0,0,0);
+		direction.set(0,0,-1);
+		return;
+	}
+
+	// same head transform getViewMatrix() inverts, taken from the latched pose
+	ofMatrix4x4 headToWorld;
+	if(bSetup){
+		const ovrTrackingState& ts = getTrackingState();
+		if (ts.StatusFlags & (ovrStatus_OrientationTracked | ovrStatus_PositionTracked)){
+			headToWorld = ofMatrix4x4::newRotationMatrix(toOf(ts.HeadPose.ThePose.Orientation)) *
+						  ofMatrix4x4::newTranslationMatrix(toOf(ts.HeadPose.ThePose.Position));
+		}
+	}
+	headToWorld = headToWorld * baseCamera->getGlobalTransformMatrix();
+
+	origin = ofVec3f(0,0,0) * headToWorld;
+	direction = (ofVec3f(0,0,-1) * headToWorld - origin).getNormalized();
+}
+
+void ofxOculusDK2::getMouseRay(ofVec3f& origin, ofVec3f& direction){
+	if(baseCamera == NULL){
+		origin.set(0,0,0);
+		direction.set(0,0,-1);
+		return;
+	}
+
+	// unproject the mouse at the near plane and half way into the depth range
+	origin = screenToWorld(ofVec3f(ofGetMouseX(), ofGetMouseY(), -1));
+	direction = (screenToWorld(ofVec3f(ofGetMouseX(), ofGetMouseY(), 0)) - origin).getNormalized();
+}
 
 void ofxOculusDK2::multBillboardMatrix(){
 	multBillboardMatrix(mousePosition3D());
@@ -732,9 +1400,13 @@ void ofxOculusDK2::draw(){
     if (!ofIsGLProgrammableRenderer())
         glUseProgram(0);
     
-    bUseOverlay = false;
+	//beginOverlay() has to be called again to show the single overlay next frame
+	if(defaultOverlayLayer != -1){
+		overlayLayers.setVisible(defaultOverlayLayer, false);
+	}
 	bUseBackground = false;
 	insideFrame = false;
+	releasePose();
 }
 #else
 void ofxOculusDK2::draw(){
@@ -743,6 +1415,8 @@ void ofxOculusDK2::draw(){
 	
 	if(!insideFrame) return;
 
+	double cpuFrameTime = ovr_GetTimeInSeconds() - frameStartSeconds;
+
 	ovr_WaitTillTime(frameTiming.TimewarpPointSeconds);
    
 	///JG START HERE 
@@ -772,13 +1446,26 @@ void ofxOculusDK2::draw(){
 	
 	/////////////////////
 	ovrHmd_EndFrameTiming(hmd);
+
+	if(bDynamicResolution){
+		// the new scale applies from the next frame on
+		double frameInterval = frameTiming.NextFrameSeconds - frameTiming.ThisFrameSeconds;
+		if(frameInterval > 0){
+			resolutionController.setTargetFrameTime(frameInterval);
+		}
+		applyRenderScale(resolutionController.update(cpuFrameTime, frameTiming.DeltaSeconds));
+	}
     
 
 	ofEnableDepthTest();
 
-	bUseOverlay = false;
+	//beginOverlay() has to be called again to show the single overlay next frame
+	if(defaultOverlayLayer != -1){
+		overlayLayers.setVisible(defaultOverlayLayer, false);
+	}
 	bUseBackground = false;
 	insideFrame = false;
+	releasePose();
 }
 #endif
 
@@ -799,3 +1486,180 @@ bool ofxOculusDK2::isHD(){
 	}
 	return false;
 }
+
+#ifdef OFX_OCULUS_BENCHMARKS
+void ofxOculusDK2::logEyePoseBenchmark(int frames){
+	if(!bSetup || insideFrame || frames <= 0) return;
+
+	//the next beginLeftEye() predicts the poses again, only the query count needs restoring
+	unsigned int savedQueries = trackingQueries;
+
+	//what each eye used to do on its own: predict both poses, then build its projection and view
+	unsigned long long start = ofGetElapsedTimeMicros();
+	for(int i = 0; i < frames; i++){
+		for(int eye = 0; eye < 2; eye++){
+			ovrHmd_GetEyePoses(hmd, frameIndex, hmdToEyeViewOffsets, headPose, NULL);
+			eyeProjectionMatrix[eye] = toOf(ovrMatrix4f_Projection(eyeRenderDesc[eye].Fov, .01f, 10000.0f, true));
+			eyeViewMatrix[eye] = getViewMatrix((ovrEyeType)eye);
+		}
+	}
+	double perEyeMicros = (ofGetElapsedTimeMicros() - start) / (double)frames;
+
+	//one prediction per frame, including the culling frusta the old path did not build
+	start = ofGetElapsedTimeMicros();
+	for(int i = 0; i < frames; i++){
+		updateEyePoses();
+	}
+	double perFrameMicros = (ofGetElapsedTimeMicros() - start) / (double)frames;
+
+	trackingQueries = savedQueries;
+
+	ofLogNotice("ofxOculusDK2::logEyePoseBenchmark") << frames << " frames, eye poses per eye: " << perEyeMicros
+		<< "us/frame, once per frame: " << perFrameMicros << "us/frame";
+}
+
+void ofxOculusDK2::logWorldToScreenBenchmark(){
+	if(!bSetup || baseCamera == NULL){
+		ofLogError("ofxOculusDK2::logWorldToScreenBenchmark") << "Call setup() and set baseCamera first";
+		return;
+	}
+
+	const int counts[] = { 100, 10000, 1000000 };
+	vector<ofVec3f> points;
+	vector<ofVec3f> screenPositions;
+	for(int c = 0; c < 3; c++){
+		points.resize(counts[c]);
+		for(int i = 0; i < counts[c]; i++){
+			points[i] = baseCamera->getPosition() + ofVec3f(ofRandom(-100, 100), ofRandom(-100, 100), ofRandom(-100, 100));
+		}
+		screenPositions.resize(points.size());
+
+		for(int head = 0; head < 2; head++){
+			unsigned long long start = ofGetElapsedTimeMicros();
+			for(size_t i = 0; i < points.size(); i++){
+				screenPositions[i] = worldToScreen(points[i], head == 1);
+			}
+			unsigned long long perPointMicros = ofGetElapsedTimeMicros() - start;
+
+			start = ofGetElapsedTimeMicros();
+			worldToScreen(points, screenPositions, head == 1);
+			unsigned long long batchMicros = ofGetElapsedTimeMicros() - start;
+
+			ofLogNotice("ofxOculusDK2::logWorldToScreenBenchmark") << counts[c] << " points" << (head ? " following the head" : "")
+				<< ", per point: " << perPointMicros << "us, batch: " << batchMicros << "us";
+		}
+	}
+}
+
+void ofxOculusDK2::logMeshCacheBenchmark(int runs){
+	if(!bSetup || runs <= 0) return;
+
+	//a cache of its own, so the one setup() reads is left alone
+	ofxOculusDK2MeshCache cache;
+	cache.setDirectory(ofFilePath::join(meshCache.getDirectory(), "benchmark"));
+	ofDirectory::createDirectory(cache.getDirectory(), false, true);
+	unsigned int distortionCaps = ovrDistortionCap_Chromatic | ovrDistortionCap_TimeWarp | ovrDistortionCap_Vignette | ovrDistortionCap_Overdrive | ovrDistortionCap_SRGB;
+
+	unsigned long long coldMicros = 0;
+	unsigned long long warmMicros = 0;
+	int warmHits = 0;
+	for(int run = 0; run < runs; run++){
+		ofxOculusDK2DistortionMesh mesh[2];
+		unsigned long long key[2];
+
+		//what setup() does with an empty cache: generate, repack and write both eyes
+		cache.clear();
+		unsigned long long start = ofGetElapsedTimeMicros();
+		for(int eyeNum = 0; eyeNum < 2; eyeNum++){
+			key[eyeNum] = ofxOculusDK2MeshCache::makeKey(hmd, eyeRenderDesc[eyeNum].Eye, eyeRenderDesc[eyeNum].Fov, distortionCaps, distortionMeshMaxError);
+			ovrDistortionMesh meshData;
+			memset(&meshData, 0, sizeof(meshData));
+			if(distortionMeshMaxError > 0){
+				ovrHmd_CreateDistortionMeshAdaptive(hmd, eyeRenderDesc[eyeNum].Eye, eyeRenderDesc[eyeNum].Fov, distortionCaps, distortionMeshMaxError, &meshData);
+			}
+			else{
+				ovrHmd_CreateDistortionMesh(hmd, eyeRenderDesc[eyeNum].Eye, eyeRenderDesc[eyeNum].Fov, distortionCaps, &meshData);
+			}
+			mesh[eyeNum].setup(meshData, bDistortionHalfFloats);
+			ovrHmd_DestroyDistortionMesh(&meshData);
+			cache.save(eyeRenderDesc[eyeNum].Eye, key[eyeNum], mesh[eyeNum]);
+		}
+		coldMicros += ofGetElapsedTimeMicros() - start;
+
+		//and with the files from the run before
+		start = ofGetElapsedTimeMicros();
+		for(int eyeNum = 0; eyeNum < 2; eyeNum++){
+			if(cache.load(eyeRenderDesc[eyeNum].Eye, key[eyeNum], bDistortionHalfFloats, mesh[eyeNum])){
+				warmHits++;
+			}
+		}
+		warmMicros += ofGetElapsedTimeMicros() - start;
+	}
+	cache.clear();
+
+	ofLogNotice("ofxOculusDK2::logMeshCacheBenchmark") << runs << " runs, cold: " << coldMicros / (1000.0 * runs)
+		<< " ms, warm: " << warmMicros / (1000.0 * runs) << " ms, " << warmHits << " of " << 2 * runs << " loads hit";
+}
+
+void ofxOculusDK2::logCullBenchmark(int count){
+	if(!bSetup || insideFrame || count <= 0) return;
+
+	//the frusta come from the last frame, or from a prediction of our own before the first
+	if(!frustumCuller.isReady()){
+		unsigned int savedQueries = trackingQueries;
+		updateEyePoses();
+		trackingQueries = savedQueries;
+	}
+
+	//spread through a 200 unit cube around the eyes, so some are in view and most are not
+	ofVec3f eyes = (eyeViewMatrix[ovrEye_Left].getInverse().getTranslation() + eyeViewMatrix[ovrEye_Right].getInverse().getTranslation()) * 0.5f;
+	vector<ofVec3f> centers(count);
+	vector<float> radii(count);
+	vector<ofVec3f> boxMin(count);
+	vector<ofVec3f> boxMax(count);
+	for(int i = 0; i < count; i++){
+		centers[i] = eyes + ofVec3f(ofRandom(-100, 100), ofRandom(-100, 100), ofRandom(-100, 100));
+		radii[i] = ofRandom(0.5, 2);
+		boxMin[i] = centers[i] - radii[i];
+		boxMax[i] = centers[i] + radii[i];
+	}
+
+	vector<unsigned char> visibility;
+	for(int boxes = 0; boxes < 2; boxes++){
+		unsigned long long start = ofGetElapsedTimeMicros();
+		if(boxes){
+			frustumCuller.cullBoxes(boxMin, boxMax, visibility);
+		}
+		else{
+			frustumCuller.cullSpheres(centers, radii, visibility);
+		}
+		unsigned long long batchMicros = ofGetElapsedTimeMicros() - start;
+
+		//what each eye would do on its own, one object at a time
+		int visible = 0;
+		int mismatches = 0;
+		start = ofGetElapsedTimeMicros();
+		for(int i = 0; i < count; i++){
+			unsigned char v = 0;
+			for(int eye = 0; eye < 2; eye++){
+				ofxOculusDK2FrustumCuller::Frustum frustum = eye == 0 ? ofxOculusDK2FrustumCuller::FRUSTUM_LEFT : ofxOculusDK2FrustumCuller::FRUSTUM_RIGHT;
+				bool inside = boxes ? frustumCuller.isBoxVisible(frustum, boxMin[i], boxMax[i]) :
+									  frustumCuller.isSphereVisible(frustum, centers[i], radii[i]);
+				if(inside){
+					v |= eye == 0 ? OFX_OCULUS_VISIBLE_LEFT : OFX_OCULUS_VISIBLE_RIGHT;
+				}
+			}
+			if(v != 0){
+				visible++;
+			}
+			if(v != visibility[i]){
+				mismatches++;
+			}
+		}
+		unsigned long long perEyeMicros = ofGetElapsedTimeMicros() - start;
+
+		ofLogNotice("ofxOculusDK2::logCullBenchmark") << count << (boxes ? " boxes" : " spheres") << ", " << visible
+			<< " visible, batch: " << batchMicros << "us, per eye: " << perEyeMicros << "us, " << mismatches << " different";
+	}
+}
+#endif
@@ -10,6 +10,13 @@
 #pragma once 
 
 #include "ofMain.h"
+#include "ofxOculusDK2PickIndex.h"
+#include "ofxOculusDK2ResolutionController.h"
+#include "ofxOculusDK2FrustumCuller.h"
+#include "ofxOculusDK2DrawList.h"
+#include "ofxOculusDK2OverlayLayers.h"
+#include "ofxOculusDK2MeshCache.h"
+#include "ofxOculusDK2DistortionMesh.h"
 
 //#include "OVR.h"
 #include "OVR_Kernel.h"
@@ -24,6 +31,8 @@ using namespace OVR::Util::Render;
 #include "CAPI/CAPI_HMDState.h"
 using namespace OVR::CAPI;
 
+#include "Tracking/Tracking_SimulatedService.h"
+
 #include "Sensors/OVR_DeviceConstants.h"
 #include <iostream>
 
@@ -56,12 +65,24 @@ class ofxOculusDK2
 	void beginOverlay(float overlayZDistance = -150, float scale = 1.0, float width = 256, float height = 256);
     void endOverlay();
 
+	//retained overlay layers. a layer keeps its contents and stays on screen
+	//until it is hidden or removed, so only redraw it when it changes
+	int addOverlayLayer(float width, float height, float overlayZDistance = -150, float scale = 1.0);
+	void removeOverlayLayer(int layer);
+	void beginOverlayLayer(int layer);
+	void endOverlayLayer();
+	ofFbo& getOverlayLayerTarget(int layer);
+	ofxOculusDK2OverlayLayers& getOverlayLayers();
+
 	void beginLeftEye();
 	void endLeftEye();
 	
 	void beginRightEye();
 	void endRightEye();
 	
+	//replaces the begin/end eye pairs: replays a scene recorded once for each eye
+	void drawStereo(ofxOculusDK2DrawList& drawList);
+
 	void draw();
     void drawSDK();
     
@@ -75,6 +96,33 @@ class ofxOculusDK2
 	ofQuaternion getOrientationQuat();
 	ofMatrix4x4 getOrientationMat();
     ofVec3f getTranslation();
+
+	//samples the head tracking state once and reuses it for every orientation
+	//query until the frame is drawn, or until the next app frame if it never is.
+	//beginLeftEye() calls this for you, call it yourself in update() to make gaze
+	//tests see the same pose as the render
+	void latchPose();
+	//number of tracking queries issued during the last frame: the latched
+	//ovrHmd_GetTrackingState plus the eye pose prediction in beginLeftEye()
+	unsigned int getTrackingQueriesLastFrame();
+
+	//replaces how the head pose is predicted ahead of the sensor, NULL for the SDK's
+	//default. the predictors and a report comparing them on a recorded trace are in
+	//Tracking/Tracking_PosePredictor.h. create the predictor after setup(), it is
+	//released when the hmd is
+	void setPosePredictor(OVR::Tracking::PosePredictor* predictor);
+	//records what the tracker publishes for replaying through the predictors later.
+	//every pose is kept when the service keeps a pose history, otherwise one per frame.
+	//call after setup()
+	void startRecordingPoseTrace();
+	bool stopRecordingPoseTrace(string path);
+
+	//with no headset plugged in, drives the simulated hmd with scripted head motion,
+	//or a trace from stopRecordingPoseTrace if a path is given, published at the
+	//tracker's 1000hz. sensorNoise makes the scripted motion's velocities as noisy
+	//as a dk2's, traces are played as recorded. call before setup()
+	void setSimulatedTracking(bool enabled, string tracePath = "", bool sensorNoise = false);
+	bool isTrackingSimulated();
 	
 	//default 1 has more constrained mouse movement,
 	//while turning it up increases the reach of the mouse
@@ -98,15 +146,38 @@ class ofxOculusDK2
 
 	float distanceFromMouse(ofVec3f worldPoint);
 	float distanceFromScreenPoint(ofVec3f worldPoint, ofVec2f screenPoint);
+
+	//batch versions of the above for gaze or mouse testing many objects at once.
+	//matrices are built once per call and the points are projected four at a time
+	void worldToScreen(const vector<ofVec3f>& worldPositions, vector<ofVec3f>& screenPositions, bool considerHeadOrientation = false);
+	//distance in pixels from the center of the oculus viewport, following the head
+	void distanceFromGaze(const vector<ofVec3f>& worldPoints, vector<float>& distances);
+	void distanceFromMouse(const vector<ofVec3f>& worldPoints, vector<float>& distances);
+	void distanceFromScreenPoint(const vector<ofVec3f>& worldPoints, ofVec2f screenPoint, vector<float>& distances);
 	
-	ofRectangle getOverlayRectangle() {
-		return ofRectangle(0,0,
-						   overlayTarget.getWidth(),
-						   overlayTarget.getHeight());
-	}
-	ofFbo& getOverlayTarget(){
-		return overlayTarget;
-	}
+	//culls against this frame's eye poses in one pass for both eyes, call after beginLeftEye().
+	//each entry of visibility gets OFX_OCULUS_VISIBLE_LEFT and/or OFX_OCULUS_VISIBLE_RIGHT
+	void cullSpheres(const vector<ofVec3f>& centers, const vector<float>& radii, vector<unsigned char>& visibility);
+	void cullBoxes(const vector<ofVec3f>& boxMin, const vector<ofVec3f>& boxMax, vector<unsigned char>& visibility);
+	ofxOculusDK2FrustumCuller& getFrustumCuller();
+
+	//register bounds for ray picking, the returned id is what pickGaze and pickMouse report.
+	//use the update calls for moving objects, small moves are cheap
+	int addPickableSphere(ofVec3f center, float radius);
+	int addPickableBox(ofVec3f boxMin, ofVec3f boxMax);
+	void updatePickableSphere(int id, ofVec3f center, float radius);
+	void updatePickableBox(int id, ofVec3f boxMin, ofVec3f boxMax);
+	void removePickable(int id);
+	void clearPickables();
+
+	//closest pickable along the head gaze ray or under the mouse, -1 if there is none
+	int pickGaze(float* hitDistance = NULL);
+	int pickMouse(float* hitDistance = NULL);
+	void getGazeRay(ofVec3f& origin, ofVec3f& direction);
+	void getMouseRay(ofVec3f& origin, ofVec3f& direction);
+
+	ofRectangle getOverlayRectangle();
+	ofFbo& getOverlayTarget();
 	ofFbo& getBackgroundTarget(){
 		return backgroundTarget;
 	}
@@ -116,9 +187,48 @@ class ofxOculusDK2
     
 	ofRectangle getOculusViewport();
 	bool isHD();
+
+	//shrinks the eye viewports inside the render target when frames run long.
+	//the render target is allocated at the controller's max scale, so set the
+	//scale bounds before setup() to leave room above the recommended size
+	void setDynamicResolution(bool enabled);
+	bool getDynamicResolution();
+	ofxOculusDK2ResolutionController& getResolutionController();
+	//pixel density the eyes are currently rendered at, 1 is the recommended size
+	float getRenderScale();
+
+	//distortion meshes are kept on disk between runs. configure before setup()
+	ofxOculusDK2MeshCache& getDistortionMeshCache();
+	//packs the distortion mesh into half floats, call before setup()
+	void setDistortionHalfFloats(bool halfFloats);
+	bool getDistortionHalfFloats();
+	//above 0 the distortion mesh is only tessellated as finely as the lens needs to stay
+	//within this error, in render target UV units. 0.0005 roughly halves the DK2 mesh.
+	//call before setup()
+	void setDistortionMeshMaxError(float maxUVError);
+	float getDistortionMeshMaxError();
+	//primes the depth buffer over the parts of each eye the lens never shows, so
+	//depth tested drawing skips shading them. saves most on the DK1
+	void setHiddenAreaMask(bool enabled);
+	bool getHiddenAreaMask();
+
 	//allows you to disable moving the camera based on inner ocular distance
 	bool applyTranslation;
 
+#ifdef OFX_OCULUS_BENCHMARKS
+	//time the per-frame paths against what they replaced and log the results.
+	//compiled in when the project defines OFX_OCULUS_BENCHMARKS. call after setup(),
+	//outside a frame
+	void logEyePoseBenchmark(int frames = 10000);
+	//100, 10k and 1M points through worldToScreen one at a time and as a batch, needs baseCamera
+	void logWorldToScreenBenchmark();
+	//distortion mesh startup with an empty cache and with the files already written
+	void logMeshCacheBenchmark(int runs = 10);
+	//random spheres and boxes around the eyes through cullSpheres() and cullBoxes(), and
+	//through a scalar test against each eye's frustum, counting any that disagree
+	void logCullBenchmark(int count = 100000);
+#endif
+
   private:
 	bool bSetup;
     bool insideFrame;
@@ -132,16 +242,43 @@ class ofxOculusDK2
     
 	bool bUsePredictedOrientation;
 	bool bUseBackground;
-	bool bUseOverlay;
-	float overlayZDistance;
 
     ovrHmd              hmd;
 	ovrFovPort			eyeFov[2];
 	ovrEyeRenderDesc	eyeRenderDesc[2];
 	ovrRecti			eyeRenderViewport[2];
+	ovrRecti			eyeFullViewport[2];
 	ovrVector2f			UVScaleOffset[2][2];
-	ofVboMesh			eyeMesh[2];
+	ofxOculusDK2DistortionMesh eyeMesh[2];
+	bool bDistortionHalfFloats;
+	float distortionMeshMaxError;
+	bool bHiddenAreaMask;
+	ofVboMesh hiddenAreaMesh[2];
+	void drawHiddenAreaMask(ovrEyeType eye);
+	ofxOculusDK2MeshCache meshCache;
 	ovrPosef headPose[2];
+	ofMatrix4x4 eyeProjectionMatrix[2];
+	ofMatrix4x4 eyeViewMatrix[2];
+	//frustum containing both eyes, its apex sits behind the eyes by combinedEyeBack
+	ofMatrix4x4 combinedProjectionMatrix;
+	float combinedEyeBack;
+	ofxOculusDK2FrustumCuller frustumCuller;
+	ofxOculusDK2DrawList::GLBackend drawListBackend;
+	void setupCombinedFrustum();
+	ofMatrix4x4 getCombinedViewMatrix();
+	ovrTrackingState trackingState;
+	bool bPoseLatched;
+	int poseFrameNum;
+	//both allocate from the sdk, so they go before ovr_Shutdown()
+	OVR::Ptr<OVR::Tracking::PosePredictor> posePredictor;
+	OVR::Tracking::PoseTraceRecorder* poseTraceRecorder;
+	bool bSimulatedTracking;
+	string simulatedTracePath;
+	bool bSimulatedSensorNoise;
+	OVR::Ptr<OVR::Tracking::SimulatedTrackingService> simulatedTracking;
+	void startSimulatedTracking();
+	unsigned int trackingQueries;
+	unsigned int trackingQueriesLastFrame;
 	ovrFrameTiming frameTiming;// = ovrHmd_BeginFrameTiming(hmd, 0);
     unsigned int frameIndex;
     
@@ -155,7 +292,11 @@ class ofxOculusDK2
     
 	OVR::Util::Render::StereoConfig stereo;
 	float renderScale;
-	ofMesh overlayMesh;
+	float allocatedRenderScale;
+	bool bDynamicResolution;
+	double frameStartSeconds;
+	ofxOculusDK2ResolutionController resolutionController;
+	void applyRenderScale(float scale);
 	ofMatrix4x4 orientationMatrix;
 	
 	ofVboMesh leftEyeMesh;
@@ -164,18 +305,29 @@ class ofxOculusDK2
     Sizei renderTargetSize;
 	ofFbo renderTarget;
     ofFbo backgroundTarget;
-	ofFbo overlayTarget;
+	//one fbo per overlay pool slot
+	vector< ofPtr<ofFbo> > overlayTargets;
+	ofxOculusDK2OverlayLayers overlayLayers;
+	int defaultOverlayLayer;
+	int currentOverlayLayer;
 	ofShader distortionShader;
     
+    ofxOculusDK2PickIndex pickables;
+
     ofShader debugShader;   // XXX mattebb
     ofMesh debugMesh;
     ofImage debugImage;
     
+	const ovrTrackingState& getTrackingState();
+	void releasePose();
+
+	void updateEyePoses();
 	void setupEyeParams(ovrEyeType eye);
 	void setupShaderUniforms(ovrEyeType eye);
     
     ofMatrix4x4 getProjectionMatrix(ovrEyeType eye);
     ofMatrix4x4 getViewMatrix(ovrEyeType eye);
 	
+	ofFbo& getOverlaySlotTarget(int slot);
 	void renderOverlay();
 };
@@ -0,0 +1,339 @@
+//
+//  ofxOculusDK2DistortionMesh.cpp
+//  OculusRiftRendering
+//
+
+#include "ofxOculusDK2DistortionMesh.h"
+
+#ifndef GL_HALF_FLOAT
+#define GL_HALF_FLOAT 0x140B
+#endif
+
+// the warp shaders read these, so the layouts must not drift apart
+typedef char VertexSizeCheck[sizeof(ofxOculusDK2DistortionMesh::Vertex) == sizeof(float) * 10 ? 1 : -1];
+typedef char HalfVertexSizeCheck[sizeof(ofxOculusDK2DistortionMesh::HalfVertex) == sizeof(unsigned short) * 10 ? 1 : -1];
+
+union FloatBits {
+	float f;
+	unsigned int u;
+};
+
+unsigned short ofxOculusDK2DistortionMesh::toHalf(float f){
+	FloatBits bits;
+	bits.f = f;
+	unsigned int sign = (bits.u >> 16) & 0x8000;
+	unsigned int floatExponent = (bits.u >> 23) & 0xff;
+	unsigned int mantissa = bits.u & 0x7fffff;
+	int exponent = (int)floatExponent - 127 + 15;
+
+	if(floatExponent == 0xff){
+		return sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0);
+	}
+	if(exponent >= 31){
+		return sign | 0x7c00;
+	}
+
+	// round to nearest even in both the normal and the denormal range
+	if(exponent <= 0){
+		if(exponent < -10){
+			return sign;
+		}
+		mantissa |= 0x800000;
+		unsigned int shift = 14 - exponent;
+		unsigned int half = mantissa >> shift;
+		unsigned int rest = mantissa & ((1u << shift) - 1);
+		unsigned int halfway = 1u << (shift - 1);
+		if(rest > halfway || (rest == halfway && (half & 1))){
+			half++;
+		}
+		return sign | half;
+	}
+
+	unsigned int half = sign | (exponent << 10) | (mantissa >> 13);
+	unsigned int rest = mantissa & 0x1fff;
+	if(rest > 0x1000 || (rest == 0x1000 && (half & 1))){
+		// a carry out of the mantissa correctly bumps the exponent
+		half++;
+	}
+	return half;
+}
+
+float ofxOculusDK2DistortionMesh::fromHalf(unsigned short h){
+	unsigned int sign = (h & 0x8000) << 16;
+	unsigned int exponent = (h >> 10) & 0x1f;
+	unsigned int mantissa = h & 0x3ff;
+
+	FloatBits bits;
+	if(exponent == 0){
+		float value = ldexpf((float)mantissa, -24);
+		return sign ? -value : value;
+	}
+	else if(exponent == 31){
+		bits.u = sign | 0x7f800000 | (mantissa << 13);
+	}
+	else{
+		bits.u = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+	}
+	return bits.f;
+}
+
+void ofxOculusDK2DistortionMesh::convert(const ovrDistortionVertex* in, size_t count, Vertex* out){
+	for(size_t i = 0; i < count; i++){
+		const ovrDistortionVertex& v = in[i];
+		Vertex& o = out[i];
+		o.position[0] = v.ScreenPosNDC.x;
+		o.position[1] = v.ScreenPosNDC.y;
+		o.position[2] = v.TimeWarpFactor;
+		o.normal[0] = v.TanEyeAnglesR.x;
+		o.normal[1] = v.TanEyeAnglesR.y;
+		o.normal[2] = v.VignetteFactor;
+		o.color[0] = v.TanEyeAnglesG.x;
+		o.color[1] = v.TanEyeAnglesG.y;
+		o.color[2] = v.TanEyeAnglesB.x;
+		o.color[3] = v.TanEyeAnglesB.y;
+	}
+}
+
+void ofxOculusDK2DistortionMesh::convert(const ovrDistortionVertex* in, size_t count, HalfVertex* out){
+	for(size_t i = 0; i < count; i++){
+		const ovrDistortionVertex& v = in[i];
+		HalfVertex& o = out[i];
+		o.position[0] = toHalf(v.ScreenPosNDC.x);
+		o.position[1] = toHalf(v.ScreenPosNDC.y);
+		o.position[2] = toHalf(v.TimeWarpFactor);
+		o.normal[0] = toHalf(v.TanEyeAnglesR.x);
+		o.normal[1] = toHalf(v.TanEyeAnglesR.y);
+		o.normal[2] = toHalf(v.VignetteFactor);
+		o.color[0] = toHalf(v.TanEyeAnglesG.x);
+		o.color[1] = toHalf(v.TanEyeAnglesG.y);
+		o.color[2] = toHalf(v.TanEyeAnglesB.x);
+		o.color[3] = toHalf(v.TanEyeAnglesB.y);
+	}
+}
+
+ofxOculusDK2DistortionMesh::ofxOculusDK2DistortionMesh(){
+	bHalfFloats = false;
+	bUploaded = false;
+	vertexBuffer = 0;
+	indexBuffer = 0;
+	vertexArray = 0;
+}
+
+ofxOculusDK2DistortionMesh::~ofxOculusDK2DistortionMesh(){
+	releaseBuffers();
+}
+
+void ofxOculusDK2DistortionMesh::setup(const ovrDistortionMesh& meshData, bool halfFloats){
+	clear();
+	bHalfFloats = halfFloats;
+
+	vertices.resize(meshData.VertexCount * getVertexSize());
+	if(meshData.VertexCount > 0){
+		if(bHalfFloats){
+			convert(meshData.pVertexData, meshData.VertexCount, (HalfVertex*)&vertices[0]);
+		}
+		else{
+			convert(meshData.pVertexData, meshData.VertexCount, (Vertex*)&vertices[0]);
+		}
+	}
+	indices.assign(meshData.pIndexData, meshData.pIndexData + meshData.IndexCount);
+}
+
+void ofxOculusDK2DistortionMesh::setup(const void* vertexData, int vertexCount, bool halfFloats, const unsigned short* indexData, int indexCount){
+	clear();
+	bHalfFloats = halfFloats;
+
+	const unsigned char* bytes = (const unsigned char*)vertexData;
+	vertices.assign(bytes, bytes + vertexCount * getVertexSize());
+	indices.assign(indexData, indexData + indexCount);
+}
+
+void ofxOculusDK2DistortionMesh::clear(){
+	vertices.clear();
+	indices.clear();
+	bUploaded = false;
+}
+
+void ofxOculusDK2DistortionMesh::draw(){
+	if(indices.empty()){
+		return;
+	}
+	if(!bUploaded){
+		upload();
+	}
+
+	if(vertexArray != 0){
+		glBindVertexArray(vertexArray);
+		glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_SHORT, 0);
+		glBindVertexArray(0);
+	}
+	else{
+		glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+		setAttributePointers();
+		glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_SHORT, 0);
+		glDisableClientState(GL_VERTEX_ARRAY);
+		glDisableClientState(GL_NORMAL_ARRAY);
+		glDisableClientState(GL_COLOR_ARRAY);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+}
+
+void ofxOculusDK2DistortionMesh::upload(){
+	if(vertexBuffer == 0){
+		glGenBuffers(1, &vertexBuffer);
+		glGenBuffers(1, &indexBuffer);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size(), &vertices[0], GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// the programmable renderer needs a vertex array object, the fixed
+	// function one sets the client state pointers on every draw
+	if(ofIsGLProgrammableRenderer()){
+		if(vertexArray == 0){
+			glGenVertexArrays(1, &vertexArray);
+		}
+		glBindVertexArray(vertexArray);
+		glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), &indices[0], GL_STATIC_DRAW);
+		setAttributePointers();
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	else{
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), &indices[0], GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+
+	bUploaded = true;
+}
+
+void ofxOculusDK2DistortionMesh::setAttributePointers(){
+	GLenum type = bHalfFloats ? GL_HALF_FLOAT : GL_FLOAT;
+	int component = bHalfFloats ? sizeof(unsigned short) : sizeof(float);
+	GLsizei stride = getVertexSize();
+	const char* normalOffset = (const char*)0 + 3 * component;
+	const char* colorOffset = (const char*)0 + 6 * component;
+
+	if(ofIsGLProgrammableRenderer()){
+		glEnableVertexAttribArray(ofShader::POSITION_ATTRIBUTE);
+		glVertexAttribPointer(ofShader::POSITION_ATTRIBUTE, 3, type, GL_FALSE, stride, 0);
+		glEnableVertexAttribArray(ofShader::NORMAL_ATTRIBUTE);
+		glVertexAttribPointer(ofShader::NORMAL_ATTRIBUTE, 3, type, GL_FALSE, stride, normalOffset);
+		glEnableVertexAttribArray(ofShader::COLOR_ATTRIBUTE);
+		glVertexAttribPointer(ofShader::COLOR_ATTRIBUTE, 4, type, GL_FALSE, stride, colorOffset);
+	}
+	else{
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glVertexPointer(3, type, stride, 0);
+		glEnableClientState(GL_NORMAL_ARRAY);
+		glNormalPointer(type, stride, normalOffset);
+		glEnableClientState(GL_COLOR_ARRAY);
+		glColorPointer(4, type, stride, colorOffset);
+	}
+}
+
+void ofxOculusDK2DistortionMesh::releaseBuffers(){
+	if(vertexArray != 0){
+		glDeleteVertexArrays(1, &vertexArray);
+		vertexArray = 0;
+	}
+	if(vertexBuffer != 0){
+		glDeleteBuffers(1, &vertexBuffer);
+		glDeleteBuffers(1, &indexBuffer);
+		vertexBuffer = 0;
+		indexBuffer = 0;
+	}
+	bUploaded = false;
+}
+
+bool ofxOculusDK2DistortionMesh::usesHalfFloats(){
+	return bHalfFloats;
+}
+
+int ofxOculusDK2DistortionMesh::getVertexSize(){
+	return bHalfFloats ? sizeof(HalfVertex) : sizeof(Vertex);
+}
+
+int ofxOculusDK2DistortionMesh::getNumVertices(){
+	return vertices.size() / getVertexSize();
+}
+
+int ofxOculusDK2DistortionMesh::getNumIndices(){
+	return indices.size();
+}
+
+const unsigned char* ofxOculusDK2DistortionMesh::getVertexData(){
+	return vertices.empty() ? NULL : &vertices[0];
+}
+
+const unsigned short* ofxOculusDK2DistortionMesh::getIndexData(){
+	return indices.empty() ? NULL : &indices[0];
+}
+
+#ifdef OFX_OCULUS_BENCHMARKS
+void ofxOculusDK2DistortionMesh::logConvertBenchmark(int vertexCount, int runs){
+	if(vertexCount <= 0 || runs <= 0) return;
+
+	vector<ovrDistortionVertex> in(vertexCount);
+	for(int i = 0; i < vertexCount; i++){
+		ovrDistortionVertex& v = in[i];
+		v.ScreenPosNDC.x = ofRandom(-1, 1);
+		v.ScreenPosNDC.y = ofRandom(-1, 1);
+		v.TimeWarpFactor = ofRandom(0, 1);
+		v.VignetteFactor = ofRandom(0, 1);
+		v.TanEyeAnglesR.x = ofRandom(-1, 1);
+		v.TanEyeAnglesR.y = ofRandom(-1, 1);
+		v.TanEyeAnglesG.x = ofRandom(-1, 1);
+		v.TanEyeAnglesG.y = ofRandom(-1, 1);
+		v.TanEyeAnglesB.x = ofRandom(-1, 1);
+		v.TanEyeAnglesB.y = ofRandom(-1, 1);
+	}
+
+	ofMesh mesh;
+	unsigned long long start = ofGetElapsedTimeMicros();
+	for(int run = 0; run < runs; run++){
+		mesh.clear();
+		mesh.getVertices().resize(vertexCount);
+		mesh.getColors().resize(vertexCount);
+		mesh.getNormals().resize(vertexCount);
+		const ovrDistortionVertex* ov = &in[0];
+		for(int vertNum = 0; vertNum < vertexCount; vertNum++){
+			mesh.getVertices()[vertNum].x = ov->ScreenPosNDC.x;
+			mesh.getVertices()[vertNum].y = ov->ScreenPosNDC.y;
+			mesh.getVertices()[vertNum].z = ov->TimeWarpFactor;
+			mesh.getNormals()[vertNum].x = ov->TanEyeAnglesR.x;
+			mesh.getNormals()[vertNum].y = ov->TanEyeAnglesR.y;
+			mesh.getNormals()[vertNum].z = ov->VignetteFactor;
+			mesh.getColors()[vertNum].r = ov->TanEyeAnglesG.x;
+			mesh.getColors()[vertNum].g = ov->TanEyeAnglesG.y;
+			mesh.getColors()[vertNum].b = ov->TanEyeAnglesB.x;
+			mesh.getColors()[vertNum].a = ov->TanEyeAnglesB.y;
+			ov++;
+		}
+	}
+	double meshMicros = (ofGetElapsedTimeMicros() - start) / (double)runs;
+
+	vector<Vertex> out(vertexCount);
+	start = ofGetElapsedTimeMicros();
+	for(int run = 0; run < runs; run++){
+		convert(&in[0], vertexCount, &out[0]);
+	}
+	double convertMicros = (ofGetElapsedTimeMicros() - start) / (double)runs;
+
+	vector<HalfVertex> halfOut(vertexCount);
+	start = ofGetElapsedTimeMicros();
+	for(int run = 0; run < runs; run++){
+		convert(&in[0], vertexCount, &halfOut[0]);
+	}
+	double halfMicros = (ofGetElapsedTimeMicros() - start) / (double)runs;
+
+	ofLogNotice("ofxOculusDK2DistortionMesh::logConvertBenchmark") << vertexCount << " vertices, ofMesh fields: "
+		<< meshMicros << "us, convert: " << convertMicros << "us, convert to half floats: " << halfMicros << "us";
+}
+#endif
@@ -0,0 +1,82 @@
+//
+//  ofxOculusDK2DistortionMesh.h
+//  OculusRiftRendering
+//
+//  A distortion mesh kept in one interleaved vertex buffer with 16 bit
+//  indices, optionally packed to half floats. The attributes line up with
+//  what the warp shaders already read: position is the NDC position and
+//  timewarp factor, normal the red tan angles and vignette, color the green
+//  and blue tan angles.
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "OVR_CAPI.h"
+
+class ofxOculusDK2DistortionMesh
+{
+  public:
+
+	//ovrDistortionVertex with the vignette moved after the red tan angles
+	struct Vertex {
+		float position[3];
+		float normal[3];
+		float color[4];
+	};
+
+	struct HalfVertex {
+		unsigned short position[3];
+		unsigned short normal[3];
+		unsigned short color[4];
+	};
+
+	ofxOculusDK2DistortionMesh();
+	~ofxOculusDK2DistortionMesh();
+
+	//repacks the sdk vertices, no GL involved
+	static void convert(const ovrDistortionVertex* in, size_t count, Vertex* out);
+	static void convert(const ovrDistortionVertex* in, size_t count, HalfVertex* out);
+	static unsigned short toHalf(float f);
+	static float fromHalf(unsigned short h);
+
+#ifdef OFX_OCULUS_BENCHMARKS
+	//times convert() against filling an ofMesh field by field, the way setup()
+	//used to, and logs both. compiled in with OFX_OCULUS_BENCHMARKS
+	static void logConvertBenchmark(int vertexCount = 2 * 65 * 65, int runs = 100);
+#endif
+
+	//copies the sdk mesh. half floats halve the vertex buffer at roughly a
+	//quarter pixel of error at the edge of the lens
+	void setup(const ovrDistortionMesh& meshData, bool halfFloats = false);
+	//takes vertices already in Vertex or HalfVertex layout
+	void setup(const void* vertexData, int vertexCount, bool halfFloats, const unsigned short* indexData, int indexCount);
+	void clear();
+
+	//uploads on first use
+	void draw();
+
+	bool usesHalfFloats();
+	int getVertexSize();
+	int getNumVertices();
+	int getNumIndices();
+	const unsigned char* getVertexData();
+	const unsigned short* getIndexData();
+
+  private:
+	vector<unsigned char> vertices;
+	vector<unsigned short> indices;
+	bool bHalfFloats;
+	bool bUploaded;
+	GLuint vertexBuffer;
+	GLuint indexBuffer;
+	GLuint vertexArray;
+
+	void upload();
+	void setAttributePointers();
+	void releaseBuffers();
+
+	//owns GL objects
+	ofxOculusDK2DistortionMesh(const ofxOculusDK2DistortionMesh&);
+	ofxOculusDK2DistortionMesh& operator=(const ofxOculusDK2DistortionMesh&);
+};
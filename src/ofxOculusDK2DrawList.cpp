@@ -0,0 +1,163 @@
+//
+//  ofxOculusDK2DrawList.cpp
+//  OculusRiftRendering
+//
+
+#include "ofxOculusDK2DrawList.h"
+
+ofxOculusDK2DrawList::Material::Material(){
+	material = NULL;
+	shader = NULL;
+	texture = NULL;
+	color = ofColor(255);
+}
+
+//--------------------------------------------------------------
+ofxOculusDK2DrawList::GLBackend::GLBackend(){
+	current = NULL;
+}
+
+void ofxOculusDK2DrawList::GLBackend::begin(const ofMatrix4x4& view, const ofMatrix4x4& projection){
+	ofSetMatrixMode(OF_MATRIX_PROJECTION);
+	ofLoadMatrix(projection);
+	ofSetMatrixMode(OF_MATRIX_MODELVIEW);
+	ofLoadMatrix(view);
+	current = NULL;
+}
+
+void ofxOculusDK2DrawList::GLBackend::setMaterial(const Material* material){
+	if(material == current){
+		return;
+	}
+
+	// unbind in reverse order of binding
+	if(current != NULL){
+		if(current->texture != NULL) current->texture->unbind();
+		if(current->shader != NULL) current->shader->end();
+		if(current->material != NULL) current->material->end();
+	}
+
+	if(material != NULL){
+		if(material->material != NULL) material->material->begin();
+		if(material->shader != NULL) material->shader->begin();
+		if(material->texture != NULL) material->texture->bind();
+		ofSetColor(material->color);
+	}
+	else{
+		ofSetColor(255);
+	}
+	current = material;
+}
+
+void ofxOculusDK2DrawList::GLBackend::drawMesh(ofMesh& mesh, const ofMatrix4x4& model){
+	ofPushMatrix();
+	ofMultMatrix(model);
+	mesh.draw();
+	ofPopMatrix();
+}
+
+void ofxOculusDK2DrawList::GLBackend::end(){
+	setMaterial(NULL);
+}
+
+//--------------------------------------------------------------
+ofxOculusDK2DrawList::NullBackend::NullBackend(){
+	reset();
+}
+
+void ofxOculusDK2DrawList::NullBackend::reset(){
+	passes = 0;
+	materialChanges = 0;
+	meshDraws = 0;
+	vertices = 0;
+}
+
+void ofxOculusDK2DrawList::NullBackend::begin(const ofMatrix4x4& view, const ofMatrix4x4& projection){
+	passes++;
+}
+
+void ofxOculusDK2DrawList::NullBackend::setMaterial(const Material* material){
+	materialChanges++;
+}
+
+void ofxOculusDK2DrawList::NullBackend::drawMesh(ofMesh& mesh, const ofMatrix4x4& model){
+	meshDraws++;
+	vertices += mesh.getNumVertices();
+}
+
+void ofxOculusDK2DrawList::NullBackend::end(){
+}
+
+//--------------------------------------------------------------
+ofxOculusDK2DrawList::ofxOculusDK2DrawList(){
+	currentMaterial = -1;
+}
+
+void ofxOculusDK2DrawList::clear(){
+	// materials are kept, they usually outlive a single frame
+	commands.clear();
+	matrices.clear();
+	currentMaterial = -1;
+}
+
+int ofxOculusDK2DrawList::addMaterial(const Material& material){
+	if(materials.size() >= SHRT_MAX){
+		ofLogError("ofxOculusDK2DrawList::addMaterial") << "Too many materials";
+		return -1;
+	}
+	materials.push_back(material);
+	return materials.size() - 1;
+}
+
+void ofxOculusDK2DrawList::setMaterial(int materialIndex){
+	if(materialIndex >= (int)materials.size()){
+		ofLogError("ofxOculusDK2DrawList::setMaterial") << "Invalid material " << materialIndex;
+		return;
+	}
+	currentMaterial = MAX(materialIndex, -1);
+}
+
+void ofxOculusDK2DrawList::draw(ofMesh& mesh, const ofMatrix4x4& model, unsigned char eyes){
+	if(eyes == 0){
+		return;
+	}
+
+	// consecutive draws with the same transform share one matrix
+	if(matrices.empty() || memcmp(matrices.back().getPtr(), model.getPtr(), sizeof(float) * 16) != 0){
+		matrices.push_back(model);
+	}
+
+	Command c;
+	c.mesh = &mesh;
+	c.matrixIndex = matrices.size() - 1;
+	c.materialIndex = currentMaterial;
+	c.eyes = eyes;
+	commands.push_back(c);
+}
+
+void ofxOculusDK2DrawList::replay(Backend& backend, const ofMatrix4x4& view, const ofMatrix4x4& projection, unsigned char eye){
+	backend.begin(view, projection);
+
+	int lastMaterial = -2;
+	for(size_t i = 0; i < commands.size(); i++){
+		const Command& c = commands[i];
+		if((c.eyes & eye) == 0){
+			continue;
+		}
+		if(c.materialIndex != lastMaterial){
+			backend.setMaterial(c.materialIndex < 0 ? NULL : &materials[c.materialIndex]);
+			lastMaterial = c.materialIndex;
+		}
+		backend.drawMesh(*c.mesh, matrices[c.matrixIndex]);
+	}
+
+	backend.end();
+}
+
+int ofxOculusDK2DrawList::size(){
+	return commands.size();
+}
+
+int ofxOculusDK2DrawList::getNumMaterials(){
+	return materials.size();
+}
@@ -0,0 +1,98 @@
+//
+//  ofxOculusDK2DrawList.h
+//  OculusRiftRendering
+//
+//  Records a scene once per frame as mesh, matrix and material references
+//  and replays it for each eye with only the view and projection swapped,
+//  so the app walks and culls its scene graph once instead of twice.
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxOculusDK2FrustumCuller.h"
+
+class ofxOculusDK2DrawList
+{
+  public:
+
+	struct Material {
+		Material();
+		ofMaterial* material;
+		ofShader* shader;
+		ofTexture* texture;
+		ofColor color;
+	};
+
+	//receives the replayed commands. material is NULL when the default state is wanted
+	class Backend {
+	  public:
+		virtual ~Backend(){}
+		virtual void begin(const ofMatrix4x4& view, const ofMatrix4x4& projection) = 0;
+		virtual void setMaterial(const Material* material) = 0;
+		virtual void drawMesh(ofMesh& mesh, const ofMatrix4x4& model) = 0;
+		virtual void end() = 0;
+	};
+
+	//draws through the openFrameworks matrix stack
+	class GLBackend : public Backend {
+	  public:
+		GLBackend();
+		void begin(const ofMatrix4x4& view, const ofMatrix4x4& projection);
+		void setMaterial(const Material* material);
+		void drawMesh(ofMesh& mesh, const ofMatrix4x4& model);
+		void end();
+	  private:
+		const Material* current;
+	};
+
+	//only counts what it is sent, for headless tests and timing the replay itself
+	class NullBackend : public Backend {
+	  public:
+		NullBackend();
+		void begin(const ofMatrix4x4& view, const ofMatrix4x4& projection);
+		void setMaterial(const Material* material);
+		void drawMesh(ofMesh& mesh, const ofMatrix4x4& model);
+		void end();
+		void reset();
+
+		int passes;
+		int materialChanges;
+		int meshDraws;
+		int vertices;
+	};
+
+	ofxOculusDK2DrawList();
+
+	void clear();
+
+	//materials are referenced by index so commands stay small
+	int addMaterial(const Material& material);
+	//applies to the draws recorded after it, -1 for the default state
+	void setMaterial(int materialIndex);
+
+	//the mesh must stay alive until the list is cleared.
+	//eyes takes OFX_OCULUS_VISIBLE_LEFT / RIGHT flags, e.g. from the frustum culler
+	void draw(ofMesh& mesh, const ofMatrix4x4& model,
+			  unsigned char eyes = OFX_OCULUS_VISIBLE_LEFT | OFX_OCULUS_VISIBLE_RIGHT);
+
+	//replays every command tagged with eye, which is OFX_OCULUS_VISIBLE_LEFT or _RIGHT
+	void replay(Backend& backend, const ofMatrix4x4& view, const ofMatrix4x4& projection,
+				unsigned char eye = OFX_OCULUS_VISIBLE_LEFT | OFX_OCULUS_VISIBLE_RIGHT);
+
+	int size();
+	int getNumMaterials();
+
+  private:
+	struct Command {
+		ofMesh* mesh;
+		int matrixIndex;
+		short materialIndex;
+		unsigned char eyes;
+	};
+
+	vector<Command> commands;
+	vector<ofMatrix4x4> matrices;
+	vector<Material> materials;
+	int currentMaterial;
+};
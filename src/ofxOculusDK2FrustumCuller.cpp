@@ -0,0 +1,183 @@
+//
+//  ofxOculusDK2FrustumCuller.cpp
+//  OculusRiftRendering
+//
+
+#include "ofxOculusDK2FrustumCuller.h"
+#include "ofxOculusDK2Simd.h"
+
+#if OFX_OCULUS_SIMD
+//lanes whose sphere is at least partly inside all six planes
+static inline mask4 spheresInside(const float (*planes)[4], float4 x, float4 y, float4 z, float4 negRadius){
+	mask4 inside = true4();
+	for(int p = 0; p < 6; p++){
+		float4 dist = add4(add4(mul4(splat4(planes[p][0]), x), mul4(splat4(planes[p][1]), y)),
+						   add4(mul4(splat4(planes[p][2]), z), splat4(planes[p][3])));
+		inside = and4(inside, ge4(dist, negRadius));
+	}
+	return inside;
+}
+
+//lanes whose box has its most positive corner inside all six planes
+static inline mask4 boxesInside(const float (*planes)[4], float4 minX, float4 minY, float4 minZ,
+								float4 maxX, float4 maxY, float4 maxZ){
+	mask4 inside = true4();
+	float4 zero = splat4(0);
+	for(int p = 0; p < 6; p++){
+		// the corner is picked per plane, so every lane uses the same selection
+		float4 x = planes[p][0] >= 0 ? maxX : minX;
+		float4 y = planes[p][1] >= 0 ? maxY : minY;
+		float4 z = planes[p][2] >= 0 ? maxZ : minZ;
+		float4 dist = add4(add4(mul4(splat4(planes[p][0]), x), mul4(splat4(planes[p][1]), y)),
+						   add4(mul4(splat4(planes[p][2]), z), splat4(planes[p][3])));
+		inside = and4(inside, ge4(dist, zero));
+	}
+	return inside;
+}
+#endif
+
+static inline bool sphereInside(const float (*planes)[4], const ofVec3f& c, float radius){
+	for(int p = 0; p < 6; p++){
+		if(planes[p][0] * c.x + planes[p][1] * c.y + planes[p][2] * c.z + planes[p][3] < -radius){
+			return false;
+		}
+	}
+	return true;
+}
+
+static inline bool boxInside(const float (*planes)[4], const ofVec3f& boxMin, const ofVec3f& boxMax){
+	for(int p = 0; p < 6; p++){
+		float x = planes[p][0] >= 0 ? boxMax.x : boxMin.x;
+		float y = planes[p][1] >= 0 ? boxMax.y : boxMin.y;
+		float z = planes[p][2] >= 0 ? boxMax.z : boxMin.z;
+		if(planes[p][0] * x + planes[p][1] * y + planes[p][2] * z + planes[p][3] < 0){
+			return false;
+		}
+	}
+	return true;
+}
+
+ofxOculusDK2FrustumCuller::ofxOculusDK2FrustumCuller(){
+	memset(planes, 0, sizeof(planes));
+	frustaSet = 0;
+}
+
+void ofxOculusDK2FrustumCuller::setFrustum(Frustum frustum, const ofMatrix4x4& viewProjection){
+	// Gribb & Hartmann plane extraction. With row vectors clip = v * M, so the
+	// planes come from the columns of M
+	const float* m = viewProjection.getPtr();
+	float col[4][4];
+	for(int i = 0; i < 4; i++){
+		col[i][0] = m[i];
+		col[i][1] = m[4 + i];
+		col[i][2] = m[8 + i];
+		col[i][3] = m[12 + i];
+	}
+
+	float (*out)[4] = planes[frustum];
+	for(int k = 0; k < 4; k++){
+		out[0][k] = col[3][k] + col[0][k];	// left
+		out[1][k] = col[3][k] - col[0][k];	// right
+		out[2][k] = col[3][k] + col[1][k];	// bottom
+		out[3][k] = col[3][k] - col[1][k];	// top
+		out[4][k] = col[3][k] + col[2][k];	// near, loose for 0..1 depth projections
+		out[5][k] = col[3][k] - col[2][k];	// far
+	}
+	for(int p = 0; p < 6; p++){
+		float len = sqrtf(out[p][0] * out[p][0] + out[p][1] * out[p][1] + out[p][2] * out[p][2]);
+		if(len > 0){
+			for(int k = 0; k < 4; k++){
+				out[p][k] /= len;
+			}
+		}
+	}
+
+	frustaSet |= 1 << frustum;
+}
+
+bool ofxOculusDK2FrustumCuller::isReady(){
+	return frustaSet == 7;
+}
+
+bool ofxOculusDK2FrustumCuller::isSphereVisible(Frustum frustum, ofVec3f center, float radius){
+	return sphereInside(planes[frustum], center, radius);
+}
+
+bool ofxOculusDK2FrustumCuller::isBoxVisible(Frustum frustum, ofVec3f boxMin, ofVec3f boxMax){
+	return boxInside(planes[frustum], boxMin, boxMax);
+}
+
+void ofxOculusDK2FrustumCuller::cullSpheres(const vector<ofVec3f>& centers, const vector<float>& radii, vector<unsigned char>& visibility){
+	size_t count = MIN(centers.size(), radii.size());
+	visibility.resize(count);
+	size_t i = 0;
+
+#if OFX_OCULUS_SIMD
+	for(; i + 4 <= count; i += 4){
+		const ofVec3f* c = &centers[i];
+		float4 x = set4(c[0].x, c[1].x, c[2].x, c[3].x);
+		float4 y = set4(c[0].y, c[1].y, c[2].y, c[3].y);
+		float4 z = set4(c[0].z, c[1].z, c[2].z, c[3].z);
+		float4 negRadius = set4(-radii[i], -radii[i+1], -radii[i+2], -radii[i+3]);
+
+		mask4 combined = spheresInside(planes[FRUSTUM_COMBINED], x, y, z, negRadius);
+		int left = 0, right = 0;
+		if(bits4(combined) != 0){
+			left = bits4(and4(combined, spheresInside(planes[FRUSTUM_LEFT], x, y, z, negRadius)));
+			right = bits4(and4(combined, spheresInside(planes[FRUSTUM_RIGHT], x, y, z, negRadius)));
+		}
+		for(int k = 0; k < 4; k++){
+			visibility[i+k] = ((left >> k) & 1) * OFX_OCULUS_VISIBLE_LEFT |
+							  ((right >> k) & 1) * OFX_OCULUS_VISIBLE_RIGHT;
+		}
+	}
+#endif
+
+	for(; i < count; i++){
+		unsigned char v = 0;
+		if(sphereInside(planes[FRUSTUM_COMBINED], centers[i], radii[i])){
+			if(sphereInside(planes[FRUSTUM_LEFT], centers[i], radii[i])) v |= OFX_OCULUS_VISIBLE_LEFT;
+			if(sphereInside(planes[FRUSTUM_RIGHT], centers[i], radii[i])) v |= OFX_OCULUS_VISIBLE_RIGHT;
+		}
+		visibility[i] = v;
+	}
+}
+
+void ofxOculusDK2FrustumCuller::cullBoxes(const vector<ofVec3f>& boxMin, const vector<ofVec3f>& boxMax, vector<unsigned char>& visibility){
+	size_t count = MIN(boxMin.size(), boxMax.size());
+	visibility.resize(count);
+	size_t i = 0;
+
+#if OFX_OCULUS_SIMD
+	for(; i + 4 <= count; i += 4){
+		const ofVec3f* lo = &boxMin[i];
+		const ofVec3f* hi = &boxMax[i];
+		float4 minX = set4(lo[0].x, lo[1].x, lo[2].x, lo[3].x);
+		float4 minY = set4(lo[0].y, lo[1].y, lo[2].y, lo[3].y);
+		float4 minZ = set4(lo[0].z, lo[1].z, lo[2].z, lo[3].z);
+		float4 maxX = set4(hi[0].x, hi[1].x, hi[2].x, hi[3].x);
+		float4 maxY = set4(hi[0].y, hi[1].y, hi[2].y, hi[3].y);
+		float4 maxZ = set4(hi[0].z, hi[1].z, hi[2].z, hi[3].z);
+
+		mask4 combined = boxesInside(planes[FRUSTUM_COMBINED], minX, minY, minZ, maxX, maxY, maxZ);
+		int left = 0, right = 0;
+		if(bits4(combined) != 0){
+			left = bits4(and4(combined, boxesInside(planes[FRUSTUM_LEFT], minX, minY, minZ, maxX, maxY, maxZ)));
+			right = bits4(and4(combined, boxesInside(planes[FRUSTUM_RIGHT], minX, minY, minZ, maxX, maxY, maxZ)));
+		}
+		for(int k = 0; k < 4; k++){
+			visibility[i+k] = ((left >> k) & 1) * OFX_OCULUS_VISIBLE_LEFT |
+							  ((right >> k) & 1) * OFX_OCULUS_VISIBLE_RIGHT;
+		}
+	}
+#endif
+
+	for(; i < count; i++){
+		unsigned char v = 0;
+		if(boxInside(planes[FRUSTUM_COMBINED], boxMin[i], boxMax[i])){
+			if(boxInside(planes[FRUSTUM_LEFT], boxMin[i], boxMax[i])) v |= OFX_OCULUS_VISIBLE_LEFT;
+			if(boxInside(planes[FRUSTUM_RIGHT], boxMin[i], boxMax[i])) v |= OFX_OCULUS_VISIBLE_RIGHT;
+		}
+		visibility[i] = v;
+	}
+}
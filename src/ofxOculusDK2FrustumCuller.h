@@ -0,0 +1,45 @@
+//
+//  ofxOculusDK2FrustumCuller.h
+//  OculusRiftRendering
+//
+//  Culls batches of bounding spheres or boxes against both eye frusta at once.
+//  Everything is first tested against a conservative frustum that contains
+//  both eyes, only the survivors are tested per eye.
+//
+
+#pragma once
+
+#include "ofMain.h"
+
+#define OFX_OCULUS_VISIBLE_LEFT		1
+#define OFX_OCULUS_VISIBLE_RIGHT	2
+
+class ofxOculusDK2FrustumCuller
+{
+  public:
+
+	enum Frustum {
+		FRUSTUM_LEFT = 0,
+		FRUSTUM_RIGHT = 1,
+		FRUSTUM_COMBINED = 2
+	};
+
+	ofxOculusDK2FrustumCuller();
+
+	//extracts the planes of a view * projection matrix in openFrameworks order
+	void setFrustum(Frustum frustum, const ofMatrix4x4& viewProjection);
+	//true once all three frusta have been set
+	bool isReady();
+
+	//each entry of visibility gets OFX_OCULUS_VISIBLE_LEFT and/or OFX_OCULUS_VISIBLE_RIGHT
+	void cullSpheres(const vector<ofVec3f>& centers, const vector<float>& radii, vector<unsigned char>& visibility);
+	void cullBoxes(const vector<ofVec3f>& boxMin, const vector<ofVec3f>& boxMax, vector<unsigned char>& visibility);
+
+	bool isSphereVisible(Frustum frustum, ofVec3f center, float radius);
+	bool isBoxVisible(Frustum frustum, ofVec3f boxMin, ofVec3f boxMax);
+
+  private:
+	//a, b, c, d with a*x + b*y + c*z + d >= 0 inside, normalized
+	float planes[3][6][4];
+	int frustaSet;
+};
@@ -0,0 +1,205 @@
+//
+//  ofxOculusDK2MeshCache.cpp
+//  OculusRiftRendering
+//
+
+#include "ofxOculusDK2MeshCache.h"
+
+#include "OVR_Version.h"
+#include "CAPI/CAPI_HMDState.h"
+
+// bump whenever the layout of the file or of the cached mesh changes
+static const unsigned int CACHE_FORMAT = 2;
+static const char CACHE_MAGIC[4] = { 'O', 'D', 'M', 'C' };
+
+struct CacheHeader {
+	char magic[4];
+	unsigned int format;
+	unsigned long long key;
+	unsigned int vertexCount;
+	unsigned int indexCount;
+	// vertex size doubles as the full or half float flag
+	unsigned int vertexSize;
+	unsigned int indexSize;
+	unsigned long long checksum;
+};
+
+// 64 bit FNV-1a, used for both the key and the payload checksum
+static unsigned long long hashBytes(const void* data, size_t size, unsigned long long hash = 14695981039346656037ULL){
+	const unsigned char* bytes = (const unsigned char*)data;
+	for(size_t i = 0; i < size; i++){
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+static unsigned long long hashPayload(const char* vertices, size_t vertexBytes, const char* indices, size_t indexBytes){
+	return hashBytes(indices, indexBytes, hashBytes(vertices, vertexBytes));
+}
+
+ofxOculusDK2MeshCache::ofxOculusDK2MeshCache(){
+	bEnabled = true;
+	hits = 0;
+	misses = 0;
+}
+
+void ofxOculusDK2MeshCache::setEnabled(bool enabled){
+	bEnabled = enabled;
+}
+
+bool ofxOculusDK2MeshCache::isEnabled(){
+	return bEnabled;
+}
+
+void ofxOculusDK2MeshCache::setDirectory(string _directory){
+	directory = _directory;
+}
+
+string ofxOculusDK2MeshCache::getDirectory(){
+	if(directory.empty()){
+		return ofToDataPath("ofxOculusDK2", true);
+	}
+	return directory;
+}
+
+unsigned long long ofxOculusDK2MeshCache::makeKey(ovrHmd hmd, ovrEyeType eye, ovrFovPort fov, unsigned int distortionCaps, float maxUVError){
+	// the distortion and screen descriptions hold only 4 byte members, so
+	// hashing them as bytes sees no padding. the distortion includes the
+	// lens config for the current profile's eye relief
+	OVR::CAPI::HMDState* hmds = (OVR::CAPI::HMDState*)hmd->Handle;
+	const OVR::DistortionRenderDesc& distortion = hmds->RenderState.Distortion[eye];
+	const OVR::HmdRenderInfo& renderInfo = hmds->RenderState.RenderInfo;
+
+	unsigned long long key = hashBytes(OVR_VERSION_STRING, strlen(OVR_VERSION_STRING));
+	key = hashBytes(&CACHE_FORMAT, sizeof(CACHE_FORMAT), key);
+	key = hashBytes(&distortion, sizeof(distortion), key);
+	key = hashBytes(&renderInfo, sizeof(renderInfo), key);
+	key = hashBytes(&eye, sizeof(eye), key);
+	key = hashBytes(&fov, sizeof(fov), key);
+	key = hashBytes(&maxUVError, sizeof(maxUVError), key);
+	return hashBytes(&distortionCaps, sizeof(distortionCaps), key);
+}
+
+bool ofxOculusDK2MeshCache::load(ovrEyeType eye, unsigned long long key, bool halfFloats, ofxOculusDK2DistortionMesh& mesh){
+	if(!bEnabled){
+		return false;
+	}
+
+	string path = getPath(eye);
+	if(!ofFile::doesFileExist(path, false)){
+		misses++;
+		return false;
+	}
+
+	ofBuffer buffer = ofBufferFromFile(path, true);
+	const char* data = buffer.getBinaryBuffer();
+	size_t size = buffer.size();
+
+	unsigned int vertexSize = halfFloats ? sizeof(ofxOculusDK2DistortionMesh::HalfVertex) : sizeof(ofxOculusDK2DistortionMesh::Vertex);
+	CacheHeader header;
+	if(size < sizeof(header)){
+		ofLogWarning("ofxOculusDK2MeshCache::load") << "Truncated cache file " << path;
+		misses++;
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+
+	if(memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.format != CACHE_FORMAT ||
+	   header.vertexSize != vertexSize || header.indexSize != sizeof(unsigned short)){
+		ofLogVerbose("ofxOculusDK2MeshCache::load") << "Cache file " << path << " has an old format";
+		misses++;
+		return false;
+	}
+	if(header.key != key){
+		ofLogVerbose("ofxOculusDK2MeshCache::load") << "Cache file " << path << " was made for other lenses or settings";
+		misses++;
+		return false;
+	}
+	size_t expected = sizeof(header) + (size_t)header.vertexCount * header.vertexSize + (size_t)header.indexCount * header.indexSize;
+	if(size != expected || header.vertexCount == 0 || header.indexCount == 0){
+		ofLogWarning("ofxOculusDK2MeshCache::load") << "Cache file " << path << " has the wrong size";
+		misses++;
+		return false;
+	}
+
+	const char* vertices = data + sizeof(header);
+	const char* indices = vertices + (size_t)header.vertexCount * header.vertexSize;
+	if(hashPayload(vertices, indices - vertices, indices, (size_t)header.indexCount * header.indexSize) != header.checksum){
+		ofLogWarning("ofxOculusDK2MeshCache::load") << "Cache file " << path << " is corrupt";
+		misses++;
+		return false;
+	}
+
+	mesh.setup(vertices, header.vertexCount, halfFloats, (const unsigned short*)indices, header.indexCount);
+	hits++;
+	return true;
+}
+
+bool ofxOculusDK2MeshCache::save(ovrEyeType eye, unsigned long long key, ofxOculusDK2DistortionMesh& mesh){
+	if(!bEnabled){
+		return false;
+	}
+
+	if(mesh.getNumVertices() == 0 || mesh.getNumIndices() == 0){
+		ofLogError("ofxOculusDK2MeshCache::save") << "Mesh is empty";
+		return false;
+	}
+
+	ofDirectory::createDirectory(getDirectory(), false, true);
+
+	const char* vertices = (const char*)mesh.getVertexData();
+	const char* indices = (const char*)mesh.getIndexData();
+	size_t vertexBytes = (size_t)mesh.getNumVertices() * mesh.getVertexSize();
+	size_t indexBytes = (size_t)mesh.getNumIndices() * sizeof(unsigned short);
+
+	CacheHeader header;
+	memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.format = CACHE_FORMAT;
+	header.key = key;
+	header.vertexCount = mesh.getNumVertices();
+	header.indexCount = mesh.getNumIndices();
+	header.vertexSize = mesh.getVertexSize();
+	header.indexSize = sizeof(unsigned short);
+	header.checksum = hashPayload(vertices, vertexBytes, indices, indexBytes);
+
+	string path = getPath(eye);
+	ofFile file(path, ofFile::WriteOnly, true);
+	if(!file.is_open()){
+		ofLogError("ofxOculusDK2MeshCache::save") << "Could not write " << path;
+		return false;
+	}
+	file.write((const char*)&header, sizeof(header));
+	file.write(vertices, vertexBytes);
+	file.write(indices, indexBytes);
+	bool ok = file.good();
+	file.close();
+
+	// a half written file would fail its checksum on the next launch anyway
+	if(!ok){
+		ofLogError("ofxOculusDK2MeshCache::save") << "Could not write " << path;
+		ofFile::removeFile(path, false);
+	}
+	return ok;
+}
+
+void ofxOculusDK2MeshCache::clear(){
+	for(int eye = 0; eye < 2; eye++){
+		string path = getPath((ovrEyeType)eye);
+		if(ofFile::doesFileExist(path, false)){
+			ofFile::removeFile(path, false);
+		}
+	}
+}
+
+int ofxOculusDK2MeshCache::getHits(){
+	return hits;
+}
+
+int ofxOculusDK2MeshCache::getMisses(){
+	return misses;
+}
+
+string ofxOculusDK2MeshCache::getPath(ovrEyeType eye){
+	return ofFilePath::join(getDirectory(), eye == ovrEye_Left ? "distortion_left.bin" : "distortion_right.bin");
+}
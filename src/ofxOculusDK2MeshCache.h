@@ -0,0 +1,50 @@
+//
+//  ofxOculusDK2MeshCache.h
+//  OculusRiftRendering
+//
+//  Keeps the render ready distortion meshes on disk so setup() can skip
+//  generating them. Files are keyed by a hash of everything the mesh depends
+//  on: the lens config and screen description of the headset, the eye fov,
+//  the distortion caps and the SDK version. A file whose key, format or
+//  checksum does not match is treated as missing and gets rewritten.
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "OVR_CAPI.h"
+#include "ofxOculusDK2DistortionMesh.h"
+
+class ofxOculusDK2MeshCache
+{
+  public:
+	ofxOculusDK2MeshCache();
+
+	void setEnabled(bool enabled);
+	bool isEnabled();
+
+	//defaults to ofxOculusDK2/ in the data folder
+	void setDirectory(string directory);
+	string getDirectory();
+
+	//maxUVError is the adaptive mesh target, 0 for the uniform mesh
+	static unsigned long long makeKey(ovrHmd hmd, ovrEyeType eye, ovrFovPort fov, unsigned int distortionCaps, float maxUVError = 0);
+
+	//the file holds the mesh's vertex and index buffers exactly as they are uploaded
+	//misses when the file was written with the other vertex format
+	bool load(ovrEyeType eye, unsigned long long key, bool halfFloats, ofxOculusDK2DistortionMesh& mesh);
+	bool save(ovrEyeType eye, unsigned long long key, ofxOculusDK2DistortionMesh& mesh);
+	//removes the files for both eyes
+	void clear();
+
+	int getHits();
+	int getMisses();
+
+  private:
+	bool bEnabled;
+	string directory;
+	int hits;
+	int misses;
+
+	string getPath(ovrEyeType eye);
+};
@@ -0,0 +1,255 @@
+//
+//  ofxOculusDK2OverlayLayers.cpp
+//  OculusRiftRendering
+//
+
+#include "ofxOculusDK2OverlayLayers.h"
+
+struct FartherFirst {
+	FartherFirst(const vector<float>& _depths) : depths(_depths) {}
+	bool operator()(int a, int b) const { return depths[a] < depths[b]; }
+	const vector<float>& depths;
+};
+
+ofxOculusDK2OverlayLayers::ofxOculusDK2OverlayLayers(){
+	bOrderDirty = false;
+	geometryRebuilds = 0;
+}
+
+int ofxOculusDK2OverlayLayers::getBucketSize(float size){
+	int bucket = 16;
+	while(bucket < (int)ceilf(size)){
+		bucket <<= 1;
+	}
+	return bucket;
+}
+
+int ofxOculusDK2OverlayLayers::addLayer(float width, float height, float zDistance, float scale){
+	int id = -1;
+	for(size_t i = 0; i < layers.size(); i++){
+		if(!layers[i].used){
+			id = i;
+			break;
+		}
+	}
+	if(id == -1){
+		id = layers.size();
+		layers.push_back(Layer());
+	}
+
+	Layer& layer = layers[id];
+	layer.used = true;
+	layer.width = width;
+	layer.height = height;
+	layer.zDistance = zDistance;
+	layer.scale = scale;
+	layer.visible = true;
+	layer.dirty = true;
+	layer.slot = acquireSlot(width, height);
+	layer.mesh.clear();
+
+	bOrderDirty = true;
+	return id;
+}
+
+void ofxOculusDK2OverlayLayers::removeLayer(int id){
+	Layer* layer = getLayer(id, "removeLayer");
+	if(layer == NULL) return;
+
+	releaseSlot(layer->slot);
+	layer->used = false;
+	layer->slot = -1;
+	layer->mesh.clear();
+	bOrderDirty = true;
+}
+
+void ofxOculusDK2OverlayLayers::clear(){
+	for(size_t i = 0; i < layers.size(); i++){
+		if(layers[i].used){
+			removeLayer(i);
+		}
+	}
+}
+
+bool ofxOculusDK2OverlayLayers::isLayer(int id){
+	return id >= 0 && id < (int)layers.size() && layers[id].used;
+}
+
+void ofxOculusDK2OverlayLayers::setSize(int id, float width, float height){
+	Layer* layer = getLayer(id, "setSize");
+	if(layer == NULL || (layer->width == width && layer->height == height)) return;
+
+	// keep the slot when the new size still falls in the same bucket
+	if(getBucketSize(width) != getBucketSize(layer->width) || getBucketSize(height) != getBucketSize(layer->height)){
+		releaseSlot(layer->slot);
+		layer->slot = acquireSlot(width, height);
+	}
+	layer->width = width;
+	layer->height = height;
+	layer->dirty = true;
+}
+
+void ofxOculusDK2OverlayLayers::setDepth(int id, float zDistance){
+	Layer* layer = getLayer(id, "setDepth");
+	if(layer == NULL || layer->zDistance == zDistance) return;
+
+	layer->zDistance = zDistance;
+	layer->dirty = true;
+	bOrderDirty = true;
+}
+
+void ofxOculusDK2OverlayLayers::setScale(int id, float scale){
+	Layer* layer = getLayer(id, "setScale");
+	if(layer == NULL || layer->scale == scale) return;
+
+	layer->scale = scale;
+	layer->dirty = true;
+}
+
+void ofxOculusDK2OverlayLayers::setVisible(int id, bool visible){
+	Layer* layer = getLayer(id, "setVisible");
+	if(layer == NULL || layer->visible == visible) return;
+
+	layer->visible = visible;
+	bOrderDirty = true;
+}
+
+float ofxOculusDK2OverlayLayers::getWidth(int id){
+	Layer* layer = getLayer(id, "getWidth");
+	return layer != NULL ? layer->width : 0;
+}
+
+float ofxOculusDK2OverlayLayers::getHeight(int id){
+	Layer* layer = getLayer(id, "getHeight");
+	return layer != NULL ? layer->height : 0;
+}
+
+float ofxOculusDK2OverlayLayers::getDepth(int id){
+	Layer* layer = getLayer(id, "getDepth");
+	return layer != NULL ? layer->zDistance : 0;
+}
+
+float ofxOculusDK2OverlayLayers::getScale(int id){
+	Layer* layer = getLayer(id, "getScale");
+	return layer != NULL ? layer->scale : 0;
+}
+
+bool ofxOculusDK2OverlayLayers::isVisible(int id){
+	Layer* layer = getLayer(id, "isVisible");
+	return layer != NULL && layer->visible;
+}
+
+int ofxOculusDK2OverlayLayers::getSlot(int id){
+	Layer* layer = getLayer(id, "getSlot");
+	return layer != NULL ? layer->slot : -1;
+}
+
+ofMesh& ofxOculusDK2OverlayLayers::getMesh(int id){
+	return layers[id].mesh;
+}
+
+int ofxOculusDK2OverlayLayers::update(){
+	int rebuilt = 0;
+	for(size_t i = 0; i < layers.size(); i++){
+		if(layers[i].used && layers[i].dirty){
+			buildQuad(layers[i]);
+			layers[i].dirty = false;
+			rebuilt++;
+		}
+	}
+	geometryRebuilds += rebuilt;
+
+	if(bOrderDirty){
+		vector<float> depths(layers.size());
+		drawOrder.clear();
+		for(size_t i = 0; i < layers.size(); i++){
+			depths[i] = layers[i].zDistance;
+			if(layers[i].used && layers[i].visible){
+				drawOrder.push_back(i);
+			}
+		}
+		// z is negative in front of the viewer, so the most negative is farthest
+		stable_sort(drawOrder.begin(), drawOrder.end(), FartherFirst(depths));
+		bOrderDirty = false;
+	}
+	return rebuilt;
+}
+
+const vector<int>& ofxOculusDK2OverlayLayers::getDrawOrder(){
+	return drawOrder;
+}
+
+bool ofxOculusDK2OverlayLayers::hasVisibleLayers(){
+	if(bOrderDirty){
+		for(size_t i = 0; i < layers.size(); i++){
+			if(layers[i].used && layers[i].visible){
+				return true;
+			}
+		}
+		return false;
+	}
+	return !drawOrder.empty();
+}
+
+const vector<ofxOculusDK2OverlayLayers::Slot>& ofxOculusDK2OverlayLayers::getSlots(){
+	return slots;
+}
+
+int ofxOculusDK2OverlayLayers::getGeometryRebuilds(){
+	return geometryRebuilds;
+}
+
+int ofxOculusDK2OverlayLayers::acquireSlot(float width, float height){
+	int bucketWidth = getBucketSize(width);
+	int bucketHeight = getBucketSize(height);
+	for(size_t i = 0; i < slots.size(); i++){
+		if(!slots[i].inUse && slots[i].width == bucketWidth && slots[i].height == bucketHeight){
+			slots[i].inUse = true;
+			return i;
+		}
+	}
+
+	Slot slot;
+	slot.width = bucketWidth;
+	slot.height = bucketHeight;
+	slot.inUse = true;
+	slots.push_back(slot);
+	return slots.size() - 1;
+}
+
+void ofxOculusDK2OverlayLayers::releaseSlot(int slot){
+	if(slot >= 0 && slot < (int)slots.size()){
+		slots[slot].inUse = false;
+	}
+}
+
+void ofxOculusDK2OverlayLayers::buildQuad(Layer& layer){
+	// contents sit in the corner of the pooled target, so the texture
+	// coordinates only cover the layer's own size
+	float width = layer.width;
+	float height = layer.height;
+	float scale = layer.scale;
+	float z = layer.zDistance;
+
+	layer.mesh.clear();
+	ofRectangle overlayrect = ofRectangle(-width/2*scale,-height/2*scale,width*scale,height*scale);
+	layer.mesh.addVertex( ofVec3f(overlayrect.getMinX(), overlayrect.getMinY(), z) );
+	layer.mesh.addVertex( ofVec3f(overlayrect.getMaxX(), overlayrect.getMinY(), z) );
+	layer.mesh.addVertex( ofVec3f(overlayrect.getMinX(), overlayrect.getMaxY(), z) );
+	layer.mesh.addVertex( ofVec3f(overlayrect.getMaxX(), overlayrect.getMaxY(), z) );
+
+	layer.mesh.addTexCoord( ofVec2f(0, height ) );
+	layer.mesh.addTexCoord( ofVec2f(width, height) );
+	layer.mesh.addTexCoord( ofVec2f(0,0) );
+	layer.mesh.addTexCoord( ofVec2f(width, 0) );
+
+	layer.mesh.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
+}
+
+ofxOculusDK2OverlayLayers::Layer* ofxOculusDK2OverlayLayers::getLayer(int id, const char* caller){
+	if(!isLayer(id)){
+		ofLogError(string("ofxOculusDK2OverlayLayers::") + caller) << "Invalid layer " << id;
+		return NULL;
+	}
+	return &layers[id];
+}
@@ -0,0 +1,84 @@
+//
+//  ofxOculusDK2OverlayLayers.h
+//  OculusRiftRendering
+//
+//  Bookkeeping for retained head locked overlay layers. Each layer keeps its
+//  quad until its size, depth or scale changes, and borrows a render target
+//  slot from a pool bucketed by power of two sizes. Nothing here touches GL,
+//  ofxOculusDK2 owns the actual fbos, one per pool slot.
+//
+
+#pragma once
+
+#include "ofMain.h"
+
+class ofxOculusDK2OverlayLayers
+{
+  public:
+
+	struct Slot {
+		int width;
+		int height;
+		bool inUse;
+	};
+
+	ofxOculusDK2OverlayLayers();
+
+	//returns a layer id that stays valid until the layer is removed
+	int addLayer(float width, float height, float zDistance = -150, float scale = 1.0);
+	void removeLayer(int layer);
+	void clear();
+	bool isLayer(int layer);
+
+	//setters only dirty the layer when the value actually changes
+	void setSize(int layer, float width, float height);
+	void setDepth(int layer, float zDistance);
+	void setScale(int layer, float scale);
+	void setVisible(int layer, bool visible);
+
+	float getWidth(int layer);
+	float getHeight(int layer);
+	float getDepth(int layer);
+	float getScale(int layer);
+	bool isVisible(int layer);
+	//pool slot holding the layer's contents
+	int getSlot(int layer);
+
+	//rebuilds the quads of dirty layers, returns how many were rebuilt
+	int update();
+	ofMesh& getMesh(int layer);
+	//visible layers, farthest first so nearer layers blend over them
+	const vector<int>& getDrawOrder();
+	bool hasVisibleLayers();
+
+	const vector<Slot>& getSlots();
+	//total number of quads rebuilt since the layers were created
+	int getGeometryRebuilds();
+
+	//rounds up to the pool bucket size
+	static int getBucketSize(float size);
+
+  private:
+	struct Layer {
+		bool used;
+		float width;
+		float height;
+		float zDistance;
+		float scale;
+		bool visible;
+		bool dirty;
+		int slot;
+		ofMesh mesh;
+	};
+
+	vector<Layer> layers;
+	vector<Slot> slots;
+	vector<int> drawOrder;
+	bool bOrderDirty;
+	int geometryRebuilds;
+
+	int acquireSlot(float width, float height);
+	void releaseSlot(int slot);
+	void buildQuad(Layer& layer);
+	Layer* getLayer(int layer, const char* caller);
+};
@@ -0,0 +1,566 @@
+//
+//  ofxOculusDK2PickIndex.cpp
+//  OculusRiftRendering
+//
+//  Insertion, removal and rotations follow the dynamic AABB tree from Box2D:
+//  the sibling is chosen by surface area cost and the tree is kept balanced
+//  by rotating along the path back to the root.
+//
+
+#include "ofxOculusDK2PickIndex.h"
+
+#include <float.h>
+
+static inline ofVec3f minVec(const ofVec3f& a, const ofVec3f& b){
+	return ofVec3f(MIN(a.x, b.x), MIN(a.y, b.y), MIN(a.z, b.z));
+}
+
+static inline ofVec3f maxVec(const ofVec3f& a, const ofVec3f& b){
+	return ofVec3f(MAX(a.x, b.x), MAX(a.y, b.y), MAX(a.z, b.z));
+}
+
+static inline float surfaceArea(const ofVec3f& boxMin, const ofVec3f& boxMax){
+	ofVec3f d = boxMax - boxMin;
+	return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+static inline bool contains(const ofVec3f& outerMin, const ofVec3f& outerMax,
+							const ofVec3f& innerMin, const ofVec3f& innerMax){
+	return outerMin.x <= innerMin.x && outerMin.y <= innerMin.y && outerMin.z <= innerMin.z &&
+		   innerMax.x <= outerMax.x && innerMax.y <= outerMax.y && innerMax.z <= outerMax.z;
+}
+
+//slab test, returns the distance where the ray enters the box (0 if it starts inside)
+static inline bool intersectBox(const ofVec3f& origin, const ofVec3f& invDirection,
+								const ofVec3f& boxMin, const ofVec3f& boxMax, float& tEnter){
+	float tx1 = (boxMin.x - origin.x) * invDirection.x;
+	float tx2 = (boxMax.x - origin.x) * invDirection.x;
+	float ty1 = (boxMin.y - origin.y) * invDirection.y;
+	float ty2 = (boxMax.y - origin.y) * invDirection.y;
+	float tz1 = (boxMin.z - origin.z) * invDirection.z;
+	float tz2 = (boxMax.z - origin.z) * invDirection.z;
+
+	float tMin = MAX(MAX(MIN(tx1, tx2), MIN(ty1, ty2)), MIN(tz1, tz2));
+	float tMax = MIN(MIN(MAX(tx1, tx2), MAX(ty1, ty2)), MAX(tz1, tz2));
+	if(tMax < 0 || tMin > tMax){
+		return false;
+	}
+	tEnter = MAX(tMin, 0.0f);
+	return true;
+}
+
+//direction must be normalized
+static inline bool intersectSphere(const ofVec3f& origin, const ofVec3f& direction,
+								   const ofVec3f& center, float radius, float& t){
+	ofVec3f oc = origin - center;
+	float b = oc.dot(direction);
+	float c = oc.dot(oc) - radius * radius;
+	float disc = b * b - c;
+	if(disc < 0){
+		return false;
+	}
+	float s = sqrtf(disc);
+	if(-b + s < 0){
+		return false;
+	}
+	t = MAX(-b - s, 0.0f);
+	return true;
+}
+
+ofxOculusDK2PickIndex::ofxOculusDK2PickIndex(){
+	root = -1;
+	freeList = -1;
+	leafCount = 0;
+	margin = 0.1;
+}
+
+int ofxOculusDK2PickIndex::addSphere(ofVec3f center, float radius){
+	ofVec3f extent(radius, radius, radius);
+	return addLeaf(SHAPE_SPHERE, center - extent, center + extent, center, radius);
+}
+
+int ofxOculusDK2PickIndex::addBox(ofVec3f boxMin, ofVec3f boxMax){
+	return addLeaf(SHAPE_BOX, boxMin, boxMax, boxMin.getMiddle(boxMax), 0);
+}
+
+void ofxOculusDK2PickIndex::updateSphere(int id, ofVec3f center, float radius){
+	ofVec3f extent(radius, radius, radius);
+	updateLeaf(id, SHAPE_SPHERE, center - extent, center + extent, center, radius);
+}
+
+void ofxOculusDK2PickIndex::updateBox(int id, ofVec3f boxMin, ofVec3f boxMax){
+	updateLeaf(id, SHAPE_BOX, boxMin, boxMax, boxMin.getMiddle(boxMax), 0);
+}
+
+void ofxOculusDK2PickIndex::remove(int id){
+	if(!isValidLeaf(id)){
+		ofLogError("ofxOculusDK2PickIndex::remove") << "Invalid id " << id;
+		return;
+	}
+	removeLeaf(id);
+	freeNode(id);
+	leafCount--;
+}
+
+void ofxOculusDK2PickIndex::clear(){
+	nodes.clear();
+	root = -1;
+	freeList = -1;
+	leafCount = 0;
+}
+
+int ofxOculusDK2PickIndex::size(){
+	return leafCount;
+}
+
+void ofxOculusDK2PickIndex::setMargin(float _margin){
+	margin = MAX(_margin, 0.0f);
+}
+
+float ofxOculusDK2PickIndex::getMargin(){
+	return margin;
+}
+
+int ofxOculusDK2PickIndex::pick(ofVec3f origin, ofVec3f direction, float* hitDistance){
+	if(root == -1 || direction.lengthSquared() == 0){
+		return -1;
+	}
+
+	direction.normalize();
+	//keep the slab test away from 0 * inf when the ray runs along a box face
+	ofVec3f invDirection(1.0f / (fabs(direction.x) > FLT_EPSILON ? direction.x : FLT_EPSILON),
+						 1.0f / (fabs(direction.y) > FLT_EPSILON ? direction.y : FLT_EPSILON),
+						 1.0f / (fabs(direction.z) > FLT_EPSILON ? direction.z : FLT_EPSILON));
+
+	int bestId = -1;
+	float bestDistance = FLT_MAX;
+
+	float tRoot;
+	if(!intersectBox(origin, invDirection, nodes[root].boxMin, nodes[root].boxMax, tRoot)){
+		return -1;
+	}
+
+	//nodes are pushed far child first, so the nearest subtree is searched first
+	//and anything entered beyond the best hit so far is skipped
+	vector< pair<int, float> > stack;
+	stack.reserve(64);
+	stack.push_back(make_pair(root, tRoot));
+
+	while(!stack.empty()){
+		int index = stack.back().first;
+		float tEnter = stack.back().second;
+		stack.pop_back();
+
+		if(tEnter >= bestDistance){
+			continue;
+		}
+
+		const Node& node = nodes[index];
+		if(node.isLeaf()){
+			float t;
+			bool hit = node.shape == SHAPE_SPHERE ?
+				intersectSphere(origin, direction, node.center, node.radius, t) :
+				intersectBox(origin, invDirection, node.shapeMin, node.shapeMax, t);
+			if(hit && t < bestDistance){
+				bestDistance = t;
+				bestId = index;
+			}
+			continue;
+		}
+
+		float t1, t2;
+		bool hit1 = intersectBox(origin, invDirection, nodes[node.child1].boxMin, nodes[node.child1].boxMax, t1) && t1 < bestDistance;
+		bool hit2 = intersectBox(origin, invDirection, nodes[node.child2].boxMin, nodes[node.child2].boxMax, t2) && t2 < bestDistance;
+		if(hit1 && hit2){
+			if(t1 < t2){
+				stack.push_back(make_pair(node.child2, t2));
+				stack.push_back(make_pair(node.child1, t1));
+			}
+			else{
+				stack.push_back(make_pair(node.child1, t1));
+				stack.push_back(make_pair(node.child2, t2));
+			}
+		}
+		else if(hit1){
+			stack.push_back(make_pair(node.child1, t1));
+		}
+		else if(hit2){
+			stack.push_back(make_pair(node.child2, t2));
+		}
+	}
+
+	if(bestId != -1 && hitDistance != NULL){
+		*hitDistance = bestDistance;
+	}
+	return bestId;
+}
+
+int ofxOculusDK2PickIndex::allocateNode(){
+	int id;
+	if(freeList != -1){
+		id = freeList;
+		freeList = nodes[id].parent;
+	}
+	else{
+		id = nodes.size();
+		nodes.push_back(Node());
+	}
+
+	Node& node = nodes[id];
+	node.parent = -1;
+	node.child1 = -1;
+	node.child2 = -1;
+	node.height = 0;
+	node.shape = SHAPE_BOX;
+	node.radius = 0;
+	return id;
+}
+
+void ofxOculusDK2PickIndex::freeNode(int id){
+	nodes[id].parent = freeList;
+	nodes[id].height = -1;
+	freeList = id;
+}
+
+bool ofxOculusDK2PickIndex::isValidLeaf(int id){
+	return id >= 0 && id < (int)nodes.size() && nodes[id].height == 0;
+}
+
+int ofxOculusDK2PickIndex::addLeaf(ShapeType shape, ofVec3f shapeMin, ofVec3f shapeMax, ofVec3f center, float radius){
+	int id = allocateNode();
+	Node& node = nodes[id];
+	node.shape = shape;
+	node.shapeMin = shapeMin;
+	node.shapeMax = shapeMax;
+	node.center = center;
+	node.radius = radius;
+	fattenLeaf(id);
+
+	insertLeaf(id);
+	leafCount++;
+	return id;
+}
+
+void ofxOculusDK2PickIndex::updateLeaf(int id, ShapeType shape, ofVec3f shapeMin, ofVec3f shapeMax, ofVec3f center, float radius){
+	if(!isValidLeaf(id)){
+		ofLogError("ofxOculusDK2PickIndex::update") << "Invalid id " << id;
+		return;
+	}
+
+	Node& node = nodes[id];
+	node.shape = shape;
+	node.shapeMin = shapeMin;
+	node.shapeMax = shapeMax;
+	node.center = center;
+	node.radius = radius;
+
+	//small moves stay inside the enlarged box and leave the tree alone
+	if(contains(node.boxMin, node.boxMax, shapeMin, shapeMax)){
+		return;
+	}
+
+	removeLeaf(id);
+	fattenLeaf(id);
+	insertLeaf(id);
+}
+
+void ofxOculusDK2PickIndex::fattenLeaf(int id){
+	Node& node = nodes[id];
+	float extent = (node.shapeMax - node.shapeMin).length() * margin * 0.5f;
+	ofVec3f r(extent, extent, extent);
+	node.boxMin = node.shapeMin - r;
+	node.boxMax = node.shapeMax + r;
+}
+
+void ofxOculusDK2PickIndex::insertLeaf(int leaf){
+	if(root == -1){
+		root = leaf;
+		nodes[root].parent = -1;
+		return;
+	}
+
+	// Find the best sibling for this node
+	ofVec3f leafMin = nodes[leaf].boxMin;
+	ofVec3f leafMax = nodes[leaf].boxMax;
+	int index = root;
+	while(!nodes[index].isLeaf()){
+		const Node& node = nodes[index];
+		int child1 = node.child1;
+		int child2 = node.child2;
+
+		float area = surfaceArea(node.boxMin, node.boxMax);
+		float combinedArea = surfaceArea(minVec(node.boxMin, leafMin), maxVec(node.boxMax, leafMax));
+
+		// Cost of creating a new parent for this node and the new leaf
+		float cost = 2.0f * combinedArea;
+
+		// Minimum cost of pushing the leaf further down the tree
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		float cost1 = surfaceArea(minVec(nodes[child1].boxMin, leafMin), maxVec(nodes[child1].boxMax, leafMax)) + inheritanceCost;
+		if(!nodes[child1].isLeaf()){
+			cost1 -= surfaceArea(nodes[child1].boxMin, nodes[child1].boxMax);
+		}
+		float cost2 = surfaceArea(minVec(nodes[child2].boxMin, leafMin), maxVec(nodes[child2].boxMax, leafMax)) + inheritanceCost;
+		if(!nodes[child2].isLeaf()){
+			cost2 -= surfaceArea(nodes[child2].boxMin, nodes[child2].boxMax);
+		}
+
+		if(cost < cost1 && cost < cost2){
+			break;
+		}
+		index = cost1 < cost2 ? child1 : child2;
+	}
+
+	int sibling = index;
+
+	// Create a new parent
+	int oldParent = nodes[sibling].parent;
+	int newParent = allocateNode();
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].boxMin = minVec(leafMin, nodes[sibling].boxMin);
+	nodes[newParent].boxMax = maxVec(leafMax, nodes[sibling].boxMax);
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[newParent].child1 = sibling;
+	nodes[newParent].child2 = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if(oldParent != -1){
+		if(nodes[oldParent].child1 == sibling){
+			nodes[oldParent].child1 = newParent;
+		}
+		else{
+			nodes[oldParent].child2 = newParent;
+		}
+	}
+	else{
+		root = newParent;
+	}
+
+	// Walk back up the tree fixing heights and boxes
+	refit(nodes[leaf].parent);
+}
+
+void ofxOculusDK2PickIndex::removeLeaf(int leaf){
+	if(leaf == root){
+		root = -1;
+		return;
+	}
+
+	int parent = nodes[leaf].parent;
+	int grandParent = nodes[parent].parent;
+	int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+	if(grandParent != -1){
+		// Destroy parent and connect sibling to grandParent
+		if(nodes[grandParent].child1 == parent){
+			nodes[grandParent].child1 = sibling;
+		}
+		else{
+			nodes[grandParent].child2 = sibling;
+		}
+		nodes[sibling].parent = grandParent;
+		freeNode(parent);
+
+		refit(grandParent);
+	}
+	else{
+		root = sibling;
+		nodes[sibling].parent = -1;
+		freeNode(parent);
+	}
+}
+
+void ofxOculusDK2PickIndex::refit(int index){
+	while(index != -1){
+		index = balance(index);
+
+		Node& node = nodes[index];
+		const Node& child1 = nodes[node.child1];
+		const Node& child2 = nodes[node.child2];
+		node.height = 1 + MAX(child1.height, child2.height);
+		node.boxMin = minVec(child1.boxMin, child2.boxMin);
+		node.boxMax = maxVec(child1.boxMax, child2.boxMax);
+
+		index = node.parent;
+	}
+}
+
+// Perform a left or right rotation if node A is imbalanced.
+// Returns the new root index.
+int ofxOculusDK2PickIndex::balance(int iA){
+	Node& A = nodes[iA];
+	if(A.isLeaf() || A.height < 2){
+		return iA;
+	}
+
+	int iB = A.child1;
+	int iC = A.child2;
+	Node& B = nodes[iB];
+	Node& C = nodes[iC];
+
+	int balance = C.height - B.height;
+
+	// Rotate C up
+	if(balance > 1){
+		int iF = C.child1;
+		int iG = C.child2;
+		Node& F = nodes[iF];
+		Node& G = nodes[iG];
+
+		// Swap A and C
+		C.child1 = iA;
+		C.parent = A.parent;
+		A.parent = iC;
+
+		// A's old parent should point to C
+		if(C.parent != -1){
+			if(nodes[C.parent].child1 == iA){
+				nodes[C.parent].child1 = iC;
+			}
+			else{
+				nodes[C.parent].child2 = iC;
+			}
+		}
+		else{
+			root = iC;
+		}
+
+		// Rotate
+		if(F.height > G.height){
+			C.child2 = iF;
+			A.child2 = iG;
+			G.parent = iA;
+			A.boxMin = minVec(B.boxMin, G.boxMin);
+			A.boxMax = maxVec(B.boxMax, G.boxMax);
+			C.boxMin = minVec(A.boxMin, F.boxMin);
+			C.boxMax = maxVec(A.boxMax, F.boxMax);
+			A.height = 1 + MAX(B.height, G.height);
+			C.height = 1 + MAX(A.height, F.height);
+		}
+		else{
+			C.child2 = iG;
+			A.child2 = iF;
+			F.parent = iA;
+			A.boxMin = minVec(B.boxMin, F.boxMin);
+			A.boxMax = maxVec(B.boxMax, F.boxMax);
+			C.boxMin = minVec(A.boxMin, G.boxMin);
+			C.boxMax = maxVec(A.boxMax, G.boxMax);
+			A.height = 1 + MAX(B.height, F.height);
+			C.height = 1 + MAX(A.height, G.height);
+		}
+		return iC;
+	}
+
+	// Rotate B up
+	if(balance < -1){
+		int iD = B.child1;
+		int iE = B.child2;
+		Node& D = nodes[iD];
+		Node& E = nodes[iE];
+
+		// Swap A and B
+		B.child1 = iA;
+		B.parent = A.parent;
+		A.parent = iB;
+
+		// A's old parent should point to B
+		if(B.parent != -1){
+			if(nodes[B.parent].child1 == iA){
+				nodes[B.parent].child1 = iB;
+			}
+			else{
+				nodes[B.parent].child2 = iB;
+			}
+		}
+		else{
+			root = iB;
+		}
+
+		// Rotate
+		if(D.height > E.height){
+			B.child2 = iD;
+			A.child1 = iE;
+			E.parent = iA;
+			A.boxMin = minVec(C.boxMin, E.boxMin);
+			A.boxMax = maxVec(C.boxMax, E.boxMax);
+			B.boxMin = minVec(A.boxMin, D.boxMin);
+			B.boxMax = maxVec(A.boxMax, D.boxMax);
+			A.height = 1 + MAX(C.height, E.height);
+			B.height = 1 + MAX(A.height, D.height);
+		}
+		else{
+			B.child2 = iE;
+			A.child1 = iD;
+			D.parent = iA;
+			A.boxMin = minVec(C.boxMin, D.boxMin);
+			A.boxMax = maxVec(C.boxMax, D.boxMax);
+			B.boxMin = minVec(A.boxMin, E.boxMin);
+			B.boxMax = maxVec(A.boxMax, E.boxMax);
+			A.height = 1 + MAX(C.height, D.height);
+			B.height = 1 + MAX(A.height, E.height);
+		}
+		return iB;
+	}
+
+	return iA;
+}
+
+#ifdef OFX_OCULUS_BENCHMARKS
+void ofxOculusDK2PickIndex::logBenchmark(int objectCount, int rays){
+	if(objectCount <= 0 || rays <= 0) return;
+
+	//half spheres, half boxes, spread through a 200 unit cube around the origin
+	ofxOculusDK2PickIndex index;
+	vector<int> ids(objectCount);
+	for(int i = 0; i < objectCount; i++){
+		ofVec3f center(ofRandom(-100, 100), ofRandom(-100, 100), ofRandom(-100, 100));
+		float size = ofRandom(0.5, 2);
+		ids[i] = (i & 1) ? index.addSphere(center, size) : index.addBox(center - size, center + size);
+	}
+
+	vector<ofVec3f> directions(rays);
+	for(int r = 0; r < rays; r++){
+		directions[r] = ofVec3f(ofRandom(-1, 1), ofRandom(-1, 1), ofRandom(-1, 1));
+	}
+	ofVec3f origin(0, 0, 0);
+
+	vector<int> treeHits(rays);
+	unsigned long long start = ofGetElapsedTimeMicros();
+	for(int r = 0; r < rays; r++){
+		treeHits[r] = index.pick(origin, directions[r]);
+	}
+	unsigned long long treeMicros = ofGetElapsedTimeMicros() - start;
+
+	//the same exact shape tests on every object, as a gaze loop without the tree would
+	int mismatches = 0;
+	start = ofGetElapsedTimeMicros();
+	for(int r = 0; r < rays; r++){
+		ofVec3f direction = directions[r].getNormalized();
+		ofVec3f invDirection(1.0f / (fabs(direction.x) > FLT_EPSILON ? direction.x : FLT_EPSILON),
+							 1.0f / (fabs(direction.y) > FLT_EPSILON ? direction.y : FLT_EPSILON),
+							 1.0f / (fabs(direction.z) > FLT_EPSILON ? direction.z : FLT_EPSILON));
+		int bestId = -1;
+		float bestDistance = FLT_MAX;
+		for(int i = 0; i < objectCount; i++){
+			const Node& node = index.nodes[ids[i]];
+			float t;
+			bool hit = node.shape == SHAPE_SPHERE ?
+				intersectSphere(origin, direction, node.center, node.radius, t) :
+				intersectBox(origin, invDirection, node.shapeMin, node.shapeMax, t);
+			if(hit && t < bestDistance){
+				bestDistance = t;
+				bestId = ids[i];
+			}
+		}
+		if(bestId != treeHits[r]){
+			mismatches++;
+		}
+	}
+	unsigned long long linearMicros = ofGetElapsedTimeMicros() - start;
+
+	ofLogNotice("ofxOculusDK2PickIndex::logBenchmark") << objectCount << " objects, " << rays << " rays, tree: "
+		<< treeMicros << "us, linear: " << linearMicros << "us, " << mismatches << " different picks";
+}
+#endif
@@ -0,0 +1,90 @@
+//
+//  ofxOculusDK2PickIndex.h
+//  OculusRiftRendering
+//
+//  Dynamic bounding volume tree for gaze and mouse picking.
+//  Leaves keep a slightly enlarged box so objects that drift a little
+//  don't have to be reinserted every frame.
+//
+
+#pragma once
+
+#include "ofMain.h"
+
+class ofxOculusDK2PickIndex
+{
+  public:
+
+	ofxOculusDK2PickIndex();
+
+	//returns an id that stays valid until the object is removed
+	int addSphere(ofVec3f center, float radius);
+	int addBox(ofVec3f boxMin, ofVec3f boxMax);
+
+	void updateSphere(int id, ofVec3f center, float radius);
+	void updateBox(int id, ofVec3f boxMin, ofVec3f boxMax);
+
+	void remove(int id);
+	void clear();
+	int size();
+
+	//returns the id of the closest object hit by the ray, or -1 if nothing is hit.
+	//direction does not need to be normalized, hitDistance is measured from origin
+	int pick(ofVec3f origin, ofVec3f direction, float* hitDistance = NULL);
+
+	//fraction of each object's size added around it in the tree, default 0.1
+	void setMargin(float margin);
+	float getMargin();
+
+#ifdef OFX_OCULUS_BENCHMARKS
+	//times pick() against testing every object along the ray, over random
+	//spheres and boxes, and logs both. compiled in with OFX_OCULUS_BENCHMARKS
+	static void logBenchmark(int objectCount = 10000, int rays = 1000);
+#endif
+
+  private:
+
+	enum ShapeType {
+		SHAPE_SPHERE,
+		SHAPE_BOX
+	};
+
+	struct Node {
+		ofVec3f boxMin;
+		ofVec3f boxMax;
+		int parent;
+		int child1;
+		int child2;
+		//leaf height is 0, free node height is -1
+		int height;
+
+		//exact shape, leaves only
+		ShapeType shape;
+		ofVec3f shapeMin;
+		ofVec3f shapeMax;
+		ofVec3f center;
+		float radius;
+
+		bool isLeaf() const { return child1 == -1; }
+	};
+
+	vector<Node> nodes;
+	int root;
+	int freeList;
+	int leafCount;
+	float margin;
+
+	int allocateNode();
+	void freeNode(int id);
+
+	int addLeaf(ShapeType shape, ofVec3f shapeMin, ofVec3f shapeMax, ofVec3f center, float radius);
+	void updateLeaf(int id, ShapeType shape, ofVec3f shapeMin, ofVec3f shapeMax, ofVec3f center, float radius);
+	void fattenLeaf(int id);
+
+	void insertLeaf(int leaf);
+	void removeLeaf(int leaf);
+	int balance(int a);
+	void refit(int index);
+
+	bool isValidLeaf(int id);
+};
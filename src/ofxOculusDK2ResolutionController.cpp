@@ -0,0 +1,165 @@
+//
+//  ofxOculusDK2ResolutionController.cpp
+//  OculusRiftRendering
+//
+
+#include "ofxOculusDK2ResolutionController.h"
+
+ofxOculusDK2ResolutionController::ofxOculusDK2ResolutionController(){
+	minScale = 0.5;
+	maxScale = 1.0;
+	targetFrameTime = 1.0 / 75.0;
+	lowerThreshold = 0.7;
+	upperThreshold = 0.9;
+	increaseStep = 0.05;
+	increaseDelay = 45;
+	cooldown = 10;
+	maxEvents = 64;
+	reset();
+}
+
+void ofxOculusDK2ResolutionController::reset(){
+	scale = maxScale;
+	smoothedFrameTime = 0;
+	framesBelow = 0;
+	framesToSettle = 0;
+	frameCount = 0;
+	events.clear();
+}
+
+float ofxOculusDK2ResolutionController::update(float cpuFrameTime, float frameDelta){
+	frameCount++;
+
+	// running average, so a single slow frame doesn't swing the scale
+	if(smoothedFrameTime <= 0){
+		smoothedFrameTime = cpuFrameTime;
+	}
+	else{
+		smoothedFrameTime += (cpuFrameTime - smoothedFrameTime) * 0.1f;
+	}
+
+	if(framesToSettle > 0){
+		framesToSettle--;
+		return scale;
+	}
+
+	// missing vsync is the worst case, react to it straight away
+	bool droppedFrame = frameDelta > targetFrameTime * 1.5f;
+	float load = MAX(smoothedFrameTime, droppedFrame ? frameDelta : 0.0f);
+
+	if(load > targetFrameTime * upperThreshold){
+		framesBelow = 0;
+		// gpu and fill cost follow the pixel count, so aim the area at the budget
+		float fit = sqrtf(targetFrameTime * (upperThreshold + lowerThreshold) * 0.5f / load);
+		changeScale(scale * fit, droppedFrame);
+	}
+	else if(smoothedFrameTime < targetFrameTime * lowerThreshold){
+		if(++framesBelow >= increaseDelay){
+			framesBelow = 0;
+			changeScale(scale + increaseStep, false);
+		}
+	}
+	else{
+		framesBelow = 0;
+	}
+
+	return scale;
+}
+
+void ofxOculusDK2ResolutionController::changeScale(float newScale, bool droppedFrame){
+	newScale = ofClamp(newScale, minScale, maxScale);
+	if(newScale == scale){
+		return;
+	}
+
+	Event e;
+	e.frame = frameCount;
+	e.frameTime = smoothedFrameTime;
+	e.oldScale = scale;
+	e.newScale = newScale;
+	e.droppedFrame = droppedFrame;
+	events.push_back(e);
+	while((int)events.size() > maxEvents){
+		events.pop_front();
+	}
+
+	ofLogVerbose("ofxOculusDK2ResolutionController") << "render scale " << scale << " -> " << newScale
+		<< " at " << smoothedFrameTime * 1000.0f << "ms" << (droppedFrame ? " (dropped frame)" : "");
+
+	scale = newScale;
+	framesToSettle = cooldown;
+	// the new scale needs its own measurements
+	smoothedFrameTime = 0;
+}
+
+float ofxOculusDK2ResolutionController::getScale(){
+	return scale;
+}
+
+void ofxOculusDK2ResolutionController::setScale(float _scale){
+	scale = ofClamp(_scale, minScale, maxScale);
+}
+
+void ofxOculusDK2ResolutionController::setTargetFrameTime(float seconds){
+	if(seconds > 0){
+		targetFrameTime = seconds;
+	}
+}
+
+float ofxOculusDK2ResolutionController::getTargetFrameTime(){
+	return targetFrameTime;
+}
+
+void ofxOculusDK2ResolutionController::setScaleBounds(float _minScale, float _maxScale){
+	if(_minScale <= 0 || _maxScale < _minScale){
+		ofLogError("ofxOculusDK2ResolutionController::setScaleBounds") << "Invalid bounds " << _minScale << " " << _maxScale;
+		return;
+	}
+	minScale = _minScale;
+	maxScale = _maxScale;
+	scale = ofClamp(scale, minScale, maxScale);
+}
+
+float ofxOculusDK2ResolutionController::getMinScale(){
+	return minScale;
+}
+
+float ofxOculusDK2ResolutionController::getMaxScale(){
+	return maxScale;
+}
+
+void ofxOculusDK2ResolutionController::setThresholds(float lower, float upper){
+	if(lower <= 0 || upper <= lower){
+		ofLogError("ofxOculusDK2ResolutionController::setThresholds") << "Invalid thresholds " << lower << " " << upper;
+		return;
+	}
+	lowerThreshold = lower;
+	upperThreshold = upper;
+}
+
+void ofxOculusDK2ResolutionController::setIncreaseDelay(int frames){
+	increaseDelay = MAX(frames, 1);
+}
+
+void ofxOculusDK2ResolutionController::setCooldown(int frames){
+	cooldown = MAX(frames, 0);
+}
+
+void ofxOculusDK2ResolutionController::setIncreaseStep(float step){
+	increaseStep = MAX(step, 0.0f);
+}
+
+const deque<ofxOculusDK2ResolutionController::Event>& ofxOculusDK2ResolutionController::getEvents(){
+	return events;
+}
+
+void ofxOculusDK2ResolutionController::clearEvents(){
+	events.clear();
+}
+
+void ofxOculusDK2ResolutionController::setMaxEvents(int _maxEvents){
+	maxEvents = MAX(_maxEvents, 0);
+	while((int)events.size() > maxEvents){
+		events.pop_front();
+	}
+}
@@ -0,0 +1,80 @@
+//
+//  ofxOculusDK2ResolutionController.h
+//  OculusRiftRendering
+//
+//  Picks the eye buffer render scale from measured frame times.
+//  Drops resolution quickly when frames run long and raises it slowly
+//  once there is headroom again. Has no GL or HMD dependency so it can be
+//  driven with synthetic frame times.
+//
+
+#pragma once
+
+#include "ofMain.h"
+
+class ofxOculusDK2ResolutionController
+{
+  public:
+
+	struct Event {
+		unsigned int frame;
+		float frameTime;   // smoothed frame time that triggered the change
+		float oldScale;
+		float newScale;
+		bool droppedFrame;
+	};
+
+	ofxOculusDK2ResolutionController();
+
+	//feed the cpu time spent on the last frame and the time since the previous
+	//frame, returns the scale to render the next frame with
+	float update(float cpuFrameTime, float frameDelta);
+
+	float getScale();
+	void setScale(float scale);
+
+	//time one frame is allowed to take, normally the display refresh interval
+	void setTargetFrameTime(float seconds);
+	float getTargetFrameTime();
+
+	//scale is a linear factor on the eye buffer size, the pixel count follows its square
+	void setScaleBounds(float minScale, float maxScale);
+	float getMinScale();
+	float getMaxScale();
+
+	//lower the scale when the smoothed frame time is above upper * target,
+	//raise it after increaseDelay frames below lower * target
+	void setThresholds(float lower, float upper);
+	void setIncreaseDelay(int frames);
+	//frames to wait after a change before measuring again
+	void setCooldown(int frames);
+	void setIncreaseStep(float step);
+
+	//most recent scale changes, oldest first
+	const deque<Event>& getEvents();
+	void clearEvents();
+	void setMaxEvents(int maxEvents);
+
+	void reset();
+
+  private:
+	float scale;
+	float minScale;
+	float maxScale;
+	float targetFrameTime;
+	float lowerThreshold;
+	float upperThreshold;
+	float increaseStep;
+	int increaseDelay;
+	int cooldown;
+
+	float smoothedFrameTime;
+	int framesBelow;
+	int framesToSettle;
+	unsigned int frameCount;
+
+	deque<Event> events;
+	int maxEvents;
+
+	void changeScale(float newScale, bool droppedFrame);
+};
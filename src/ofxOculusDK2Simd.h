@@ -0,0 +1,61 @@
+//
+//  ofxOculusDK2Simd.h
+//  OculusRiftRendering
+//
+//  Four wide float helpers shared by the batch projection and culling kernels.
+//  OFX_OCULUS_SIMD is 0 when neither SSE nor NEON is available, callers keep
+//  a scalar loop for that case and for leftover elements.
+//
+
+#pragma once
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define OFX_OCULUS_SSE 1
+	#define OFX_OCULUS_SIMD 1
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+	#include <arm_neon.h>
+	#define OFX_OCULUS_NEON 1
+	#define OFX_OCULUS_SIMD 1
+#else
+	#define OFX_OCULUS_SIMD 0
+#endif
+
+#if OFX_OCULUS_SSE
+typedef __m128 float4;
+typedef __m128 mask4;
+static inline float4 splat4(float f){ return _mm_set1_ps(f); }
+static inline float4 set4(float a, float b, float c, float d){ return _mm_setr_ps(a, b, c, d); }
+static inline float4 add4(float4 a, float4 b){ return _mm_add_ps(a, b); }
+static inline float4 sub4(float4 a, float4 b){ return _mm_sub_ps(a, b); }
+static inline float4 mul4(float4 a, float4 b){ return _mm_mul_ps(a, b); }
+static inline float4 rcp4(float4 a){ return _mm_div_ps(_mm_set1_ps(1.0f), a); }
+static inline void store4(float* out, float4 a){ _mm_storeu_ps(out, a); }
+static inline mask4 ge4(float4 a, float4 b){ return _mm_cmpge_ps(a, b); }
+static inline mask4 and4(mask4 a, mask4 b){ return _mm_and_ps(a, b); }
+static inline mask4 true4(){ return _mm_cmpeq_ps(_mm_setzero_ps(), _mm_setzero_ps()); }
+//one bit per lane, lane 0 in bit 0
+static inline int bits4(mask4 m){ return _mm_movemask_ps(m); }
+#elif OFX_OCULUS_NEON
+typedef float32x4_t float4;
+typedef uint32x4_t mask4;
+static inline float4 splat4(float f){ return vdupq_n_f32(f); }
+static inline float4 set4(float a, float b, float c, float d){ float v[4] = { a, b, c, d }; return vld1q_f32(v); }
+static inline float4 add4(float4 a, float4 b){ return vaddq_f32(a, b); }
+static inline float4 sub4(float4 a, float4 b){ return vsubq_f32(a, b); }
+static inline float4 mul4(float4 a, float4 b){ return vmulq_f32(a, b); }
+static inline float4 rcp4(float4 a){
+	// estimate plus two newton steps is within an ulp or two of a real divide
+	float4 r = vrecpeq_f32(a);
+	r = vmulq_f32(vrecpsq_f32(a, r), r);
+	return vmulq_f32(vrecpsq_f32(a, r), r);
+}
+static inline void store4(float* out, float4 a){ vst1q_f32(out, a); }
+static inline mask4 ge4(float4 a, float4 b){ return vcgeq_f32(a, b); }
+static inline mask4 and4(mask4 a, mask4 b){ return vandq_u32(a, b); }
+static inline mask4 true4(){ return vdupq_n_u32(0xffffffff); }
+static inline int bits4(mask4 m){
+	return (vgetq_lane_u32(m, 0) & 1) | (vgetq_lane_u32(m, 1) & 2) |
+		   (vgetq_lane_u32(m, 2) & 4) | (vgetq_lane_u32(m, 3) & 8);
+}
+#endif